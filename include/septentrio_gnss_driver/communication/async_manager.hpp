@@ -56,18 +56,33 @@
 //
 // *****************************************************************************
 
+// C++ library includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <sstream>
+
 // Boost includes
 #include <boost/algorithm/string/join.hpp>
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/bind.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/function.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/condition.hpp>
 
 // ROSaic includes
 #include <septentrio_gnss_driver/communication/circular_buffer.hpp>
+#include <septentrio_gnss_driver/communication/io_service_pool.hpp>
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+#include <septentrio_gnss_driver/communication/pipeline_statistics.hpp>
+#include <septentrio_gnss_driver/communication/stream_recorder.hpp>
+#include <septentrio_gnss_driver/communication/trace_ring.hpp>
 
 #ifndef ASYNC_MANAGER_HPP
 #define ASYNC_MANAGER_HPP
@@ -78,11 +93,67 @@
  * @brief Implements asynchronous operations for an I/O manager
  *
  * Such operations include reading NMEA messages and SBF blocks yet also sending
- * commands to serial port or via TCP/IP.
+ * commands to serial port or via TCP/IP, as well as (re)establishing the
+ * connection to the Rx.
  */
 
 namespace io_comm_rx {
 
+    //! Handler of a connection attempt, called with the outcome of the latter
+    typedef boost::function<void(const boost::system::error_code&)> ConnectHandler;
+
+    /**
+     * @struct ReconnectPolicy
+     * @brief Governs how an I/O manager re-establishes a lost connection
+     */
+    struct ReconnectPolicy
+    {
+        ReconnectPolicy() :
+            initial_delay_s(2.0), max_delay_s(32.0), watchdog_timeout_s(10.0)
+        {
+        }
+        //! Delay before the first reconnection attempt, doubled after every
+        //! failed one
+        double initial_delay_s;
+        //! Upper bound of the delay between two reconnection attempts
+        double max_delay_s;
+        //! Seconds without incoming data after which the connection is deemed
+        //! lost (0 for never), as well as the time a connection attempt may take
+        double watchdog_timeout_s;
+    };
+
+    /**
+     * @struct ConnectionStatistics
+     * @brief Counters describing the connection to the Rx so far
+     */
+    struct ConnectionStatistics
+    {
+        ConnectionStatistics() :
+            connected(false), reconnects(0), failed_attempts(0),
+            watchdog_timeouts(0), downtime_s(0.0)
+        {
+        }
+        //! Whether or not the connection is currently up
+        bool connected;
+        //! Number of times the connection was re-established after being lost
+        uint32_t reconnects;
+        //! Number of connection attempts that failed
+        uint32_t failed_attempts;
+        //! Number of connections closed since no data arrived in time
+        uint32_t watchdog_timeouts;
+        //! Seconds spent disconnected since the connection was first established,
+        //! the ongoing outage included
+        double downtime_s;
+    };
+
+    //! States of the connection of an I/O manager
+    enum ConnectionState_Enum
+    {
+        evConnecting,
+        evConnected,
+        evBackingOff
+    };
+
     /**
      * @class Manager
      * @brief Interface (in C++ terms), that could be used for any I/O manager,
@@ -91,17 +162,31 @@ namespace io_comm_rx {
     class Manager
     {
     public:
-        typedef boost::function<void(const uint8_t*, std::size_t&)> Callback;
+        //! Gets the bytes to be parsed and returns how many of them were consumed
+        typedef boost::function<std::size_t(const uint8_t*, std::size_t)> Callback;
+        //! Called whenever the connection has been (re-)established
+        typedef boost::function<void()> ConnectionCallback;
         virtual ~Manager() {}
         //! Sets the callback function
         virtual void setCallback(const Callback& callback) = 0;
+        //! Sets the function called whenever the connection is (re-)established
+        virtual void setConnectionCallback(const ConnectionCallback& callback) = 0;
+        //! Sets where read latencies and buffer overflows are recorded, must be
+        //! called before start()
+        virtual void setPipelineStatistics(PipelineStatistics* statistics) = 0;
+        //! Sets where every chunk read from the Rx is copied to, must be called
+        //! before start() and outlive the manager
+        virtual void setRecorder(StreamRecorder* recorder) = 0;
+        //! Starts connecting to the receiver and reading from it
+        virtual void start() = 0;
         //! Sends commands to the receiver
         virtual bool send(std::string cmd, std::size_t size) = 0;
-        //! Waits count seconds before throwing ROS_INFO message in case no message
-        //! from the receiver arrived
-        virtual void wait(uint16_t* count) = 0;
+        //! Sends a script of commands to the receiver in a single write
+        virtual bool send(const std::vector<std::string>& commands) = 0;
         //! Determines whether or not the connection is open
         virtual bool isOpen() const = 0;
+        //! Returns the counters describing the connection so far
+        virtual ConnectionStatistics statistics() const = 0;
     };
 
     /**
@@ -109,23 +194,45 @@ namespace io_comm_rx {
      * @brief This is the central interface between ROSaic and the Rx(s), managing
      * I/O operations such as reading messages and sending commands..
      *
+     * The connection is run as a state machine on the threads of an
+     * IoServicePool, which may be shared with the AsyncManagers of other Rxs: All
+     * handlers go through a strand of its own, hence never run concurrently. A
+     * lost connection, be it signaled by a read error or by the lack of incoming
+     * data, is closed and re-established via the connector, after an
+     * exponentially growing delay. The parser and its buffers outlive the
+     * connection, hence reading resumes where it left off.
+     *
      * StreamT is either boost::asio::serial_port or boost::asio::tcp::ip
      */
     template <typename StreamT>
     class AsyncManager : public Manager
     {
     public:
+        //! Opens the stream handed over to it and calls the handler once done,
+        //! the handlers of its asynchronous operations being wrapped by the
+        //! strand such that the stream is never accessed concurrently
+        typedef boost::function<void(StreamT&, boost::asio::io_service::strand&,
+                                     const ConnectHandler&)>
+            Connector;
+
         /**
          * @brief Class constructor
          * @param stream Whether TCP/IP or serial communication, either
          * boost::asio::serial_port or boost::asio::tcp::ip
-         * @param io_service The io_context object. The io_context represents your
-         * program's link to the operating system's I/O services
-         * @param[in] buffer_size Size of the circular buffer in bytes
+         * @param pool The threads running the io_context object "stream" is bound
+         * to, possibly shared with other Rxs
+         * @param connector Opens "stream", each time the connection is
+         * (re-)established
+         * @param policy How lost connections are re-established
+         * @param[in] buffer_size Size in bytes of the scratch buffer used when the
+         * circular buffer is full, the latter being four times as large
          */
         AsyncManager(boost::shared_ptr<StreamT> stream,
-                     boost::shared_ptr<boost::asio::io_service> io_service,
-                     std::size_t buffer_size = 8192);
+                     boost::shared_ptr<IoServicePool> pool,
+                     const Connector& connector,
+                     const ReconnectPolicy& policy = ReconnectPolicy(),
+                     std::size_t buffer_size = 65536);
+        //! Stops the pool, cf. the implementation
         virtual ~AsyncManager();
 
         /**
@@ -135,7 +242,27 @@ namespace io_comm_rx {
          */
         void setCallback(const Callback& callback) { read_callback_ = callback; }
 
-        void wait(uint16_t* count);
+        /**
+         * @brief Sets the function called on strand_ whenever the connection has
+         * been (re-)established, e.g. to (re)configure the Rx
+         * @param callback The function to be called
+         */
+        void setConnectionCallback(const ConnectionCallback& callback)
+        {
+            connection_callback_ = callback;
+        }
+
+        void setPipelineStatistics(PipelineStatistics* statistics)
+        {
+            pipeline_statistics_ = statistics;
+        }
+
+        void setRecorder(StreamRecorder* recorder) { recorder_ = recorder; }
+
+        /**
+         * @brief Launches the parsing thread and attempts to connect right away
+         */
+        void start();
 
         /**
          * @brief Sends commands via the I/O stream.
@@ -144,9 +271,41 @@ namespace io_comm_rx {
          */
         bool send(std::string cmd, std::size_t size);
 
+        /**
+         * @brief Sends a script of commands via the I/O stream, gathered into a
+         * single write so that the Rx receives them back to back
+         * @param commands The commands to be sent, in order
+         */
+        bool send(const std::vector<std::string>& commands);
+
         bool isOpen() const { return stream_->is_open(); }
 
+        ConnectionStatistics statistics() const;
+
     protected:
+        //! Attempts to open stream_ via connector_
+        void connect();
+
+        //! Handler of connector_: Starts reading and arms the watchdog or, if the
+        //! attempt failed, schedules the next one
+        void connected(const boost::system::error_code& error);
+
+        //! Closes stream_ once the connection was lost for the given reason and
+        //! schedules reconnecting
+        void disconnect(const std::string& reason);
+
+        //! Calls connect() after the backoff delay, which grows with the number of
+        //! failed attempts and is jittered such that several nodes that lost their
+        //! Rxs at once do not retry in lockstep
+        void scheduleReconnect();
+
+        //! Lets watchdog_timer_ expire watchdog_timeout_ after the last data
+        void armWatchdog();
+
+        //! Handler of watchdog_timer_, deems the connection lost unless data
+        //! arrived meanwhile, or aborts a connection attempt that takes too long
+        void watchdogExpired(const boost::system::error_code& error);
+
         //! Reads in via async_read_some and hands certain number of bytes
         //! (bytes_transferred) over to async_read_some_handler
         void read();
@@ -158,132 +317,234 @@ namespace io_comm_rx {
         //! Sends command "cmd" to the Rx
         void write(std::string cmd, std::size_t size);
 
+        //! Writes the commands of "script" to the Rx with one gathering
+        //! async_write(), which keeps "script" alive until it completes
+        void writeScript(boost::shared_ptr<std::vector<std::string>> script);
+
+        //! Handler for the async_write() of writeScript()
+        void scriptWritten(boost::shared_ptr<std::vector<std::string>> script,
+                           const boost::system::error_code& error,
+                           std::size_t bytes_transferred);
+
         //! Closes stream "stream_"
         void close();
 
-        //! Tries parsing SBF/NMEA whenever the boolean class variable "try_parsing"
-        //! is true
+        //! Tries parsing SBF/NMEA whenever circular_buffer_ holds unread bytes
         void tryParsing();
 
-        //! Mutex to control changes of class variable "try_parsing"
-        boost::mutex parse_mutex_;
+        //! Blocks tryParsing() until circular_buffer_ has data, returns false if
+        //! nothing arrived for 10 seconds
+        bool waitForData();
+
+        //! Wakes up tryParsing() if (and only if) it went to sleep on an empty
+        //! circular_buffer_
+        void notifyParser();
 
-        //! Determines when the tryParsing() method will attempt parsing SBF/NMEA
-        bool try_parsing_;
+        //! Mutex complementing "parsing_condition_", only taken when the parser
+        //! has run out of data, never on the data path itself
+        boost::mutex parse_mutex_;
 
-        //! Determines when the asyncReadSomeHandler() method should write SBF/NMEA
-        //! into the circular buffer
-        bool allow_writing_;
+        //! Whether or not tryParsing() sleeps on parsing_condition_
+        std::atomic<bool> parser_waiting_;
 
-        //! Condition variable complementing "parse_mutex"
+        //! Condition variable on which tryParsing() sleeps while
+        //! circular_buffer_ is empty
         boost::condition_variable parsing_condition_;
 
         //! Stream, represents either serial or TCP/IP connection
         boost::shared_ptr<StreamT> stream_;
 
-        //! io_context object
-        boost::shared_ptr<boost::asio::io_service> io_service_;
+        //! Threads running the io_context object, the pool being kept alive
+        //! since stream_ and the timers are bound to it
+        boost::shared_ptr<IoServicePool> pool_;
+
+        //! Serializes all handlers of this Rx, which may run on any pool thread
+        boost::asio::io_service::strand strand_;
+
+        //! Opens stream_, e.g. resolves the host and connects the socket
+        Connector connector_;
 
-        //! Buffer for async_read_some() to read continuous SBF/NMEA stream
+        //! How lost connections are re-established
+        const ReconnectPolicy policy_;
+
+        //! Time without incoming data after which the connection is deemed lost,
+        //! zero if the watchdog is disabled
+        const std::chrono::steady_clock::duration watchdog_timeout_;
+
+        //! State of the connection, only accessed on strand_
+        ConnectionState_Enum state_;
+
+        //! Number of connection attempts since data last arrived, determining the
+        //! backoff delay
+        uint32_t attempts_;
+
+        //! Time at which data last arrived (or the connection was established)
+        std::chrono::steady_clock::time_point last_data_;
+
+        //! Timer delaying the next connection attempt
+        boost::asio::steady_timer reconnect_timer_;
+
+        //! Timer closing connections that stopped delivering data and aborting
+        //! connection attempts that hang
+        boost::asio::steady_timer watchdog_timer_;
+
+        //! Source of the backoff jitter
+        std::mt19937 random_engine_;
+
+        //! Called whenever the connection has been (re-)established
+        ConnectionCallback connection_callback_;
+
+        //! Mutex guarding statistics_, disconnected_at_ and ever_connected_, which
+        //! are read by other threads via statistics()
+        mutable boost::mutex statistics_mutex_;
+
+        //! Connection counters, the downtime of the ongoing outage excluded
+        ConnectionStatistics statistics_;
+
+        //! Time at which the last connection was lost
+        std::chrono::steady_clock::time_point disconnected_at_;
+
+        //! Whether or not the connection has been established at least once
+        bool ever_connected_;
+
+        //! Scratch buffer for async_read_some() in case circular_buffer_ is full,
+        //! whatever lands here is dropped
         std::vector<uint8_t> in_;
 
-        //! Circular buffer to avoid unsuccessful SBF/NMEA parsing due to incomplete
-        //! messages
+        //! Lock-free ring between the ASIO reader (producer) and tryParsing()
+        //! (consumer), async_read_some() writes straight into its free span
         CircularBuffer circular_buffer_;
 
-        //! Memory location where read_callback_ will start reading unless part of
-        //! SBF/NMEA had to be appended before
-        uint8_t* to_be_parsed_;
+        //! Whether or not the pending async_read_some() targets in_ rather than
+        //! circular_buffer_
+        bool reading_into_scratch_;
+
+        //! The two spans the pending async_read_some() fills, in this order, the
+        //! second one being empty unless the read wraps around circular_buffer_
+        uint8_t* read_span_;
+        std::size_t read_span_size_;
+        uint8_t* read_wrapped_;
+
+        //! Persistent parse arena handed over to read_callback_: incomplete
+        //! trailing bytes of one cycle are kept at its front and new data from
+        //! circular_buffer_ is appended behind them. It is followed by
+        //! MappedFile::MAPPING_GUARD_SIZE zero bytes for RxMessage::messageSize()
+        //! to look ahead into, just like a mapped SBF file.
+        std::vector<uint8_t> parse_window_;
 
-        //! New thread for receiving incoming messages
-        boost::shared_ptr<boost::thread> async_background_thread_;
+        //! Number of bytes of parse_window_ that may be filled, doubled whenever an
+        //! incomplete message fills all of them
+        std::size_t window_size_;
+
+        //! Upper bound of window_size_, beyond which an incomplete message is
+        //! deemed garbage
+        const static std::size_t MAX_PARSE_WINDOW_SIZE_ = 1 << 22;
+
+        //! Thread running tryParsing()
+        boost::shared_ptr<boost::thread> parsing_thread_;
 
         //! Callback to be called once message arrives
         Callback read_callback_;
 
-        //! Whether or not we want to sever the connection to the Rx
-        bool stopping_;
-
-        /// Size of in_ buffers
-        const std::size_t buffer_size_;
+        //! Receives read and buffering latencies and buffer overflows, if set
+        PipelineStatistics* pipeline_statistics_;
 
-        //! Boost timer for throwing ROS_INFO message once timed out due to lack of
-        //! incoming messages
-        boost::asio::deadline_timer timer_;
+        //! Receives a copy of every chunk read, if set
+        StreamRecorder* recorder_;
 
-        //! Number of seconds before ROS_INFO message is thrown (if no incoming
-        //! message)
-        const uint16_t count_max_;
+        //! Steady clock time in nanoseconds at which the oldest bytes still in
+        //! circular_buffer_ were read, 0 if none are or latencies are not sampled
+        std::atomic<int64_t> pending_since_;
 
-        //! Handles the ROS_INFO throwing (if no incoming message)
-        void callAsyncWait(uint16_t* count);
+        //! Whether or not we want to sever the connection to the Rx
+        std::atomic<bool> stopping_;
 
-        //! Number of times the DoRead() method has been called (only counts
-        //! initially)
-        uint16_t do_read_count_;
+        /// Size of in_ buffers
+        const std::size_t buffer_size_;
     };
 
     template <typename StreamT>
-    void AsyncManager<StreamT>::tryParsing()
+    bool AsyncManager<StreamT>::waitForData()
+    {
+        if (!circular_buffer_.empty())
+            return true;
+        boost::mutex::scoped_lock lock(parse_mutex_);
+        parser_waiting_.store(true);
+        // Pairs with the fence in notifyParser(): either the producer sees
+        // parser_waiting_ or we see its data in the predicate below.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        parsing_condition_.wait_for(
+            lock, boost::chrono::seconds(10),
+            [this]() { return stopping_ || !circular_buffer_.empty(); });
+        parser_waiting_.store(false);
+        return !circular_buffer_.empty();
+    }
+
+    template <typename StreamT>
+    void AsyncManager<StreamT>::notifyParser()
     {
-        uint8_t* to_be_parsed;
-        to_be_parsed = new uint8_t[buffer_size_];
-        to_be_parsed_ = to_be_parsed;
-        bool timed_out = false;
-        std::size_t shift_bytes = 0;
-        std::size_t arg_for_read_callback = 0;
-
-        while (!timed_out) // Loop will stop if condition variable timed out
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parser_waiting_.load())
         {
             boost::mutex::scoped_lock lock(parse_mutex_);
-            parsing_condition_.wait_for(lock, boost::chrono::seconds(10),
-                                        [this]() { return try_parsing_; });
-            bool timed_out = !try_parsing_;
-            if (timed_out)
-                break;
-            try_parsing_ = false;
-            allow_writing_ = true;
-            std::size_t current_buffer_size = circular_buffer_.size();
-            arg_for_read_callback += current_buffer_size;
-            circular_buffer_.read(to_be_parsed + shift_bytes, current_buffer_size);
-
-            lock.unlock();
             parsing_condition_.notify_one();
+        }
+    }
 
-            try
-            {
-                ROS_DEBUG(
-                    "Calling read_callback_() method, with number of bytes to be parsed being %li",
-                    arg_for_read_callback);
-                read_callback_(to_be_parsed_, arg_for_read_callback);
-            } catch (std::size_t& parsing_failed_here)
+    template <typename StreamT>
+    void AsyncManager<StreamT>::tryParsing()
+    {
+        // Number of bytes at the front of parse_window_ still waiting to be parsed
+        std::size_t window_fill = 0;
+
+        while (!stopping_)
+        {
+            // Nothing arrived for 10 seconds, e.g. since the connection is being
+            // re-established, which is the I/O thread's business
+            if (!waitForData())
+                continue;
+            if (window_fill == window_size_)
             {
-                to_be_parsed_ = to_be_parsed + parsing_failed_here;
-                ROS_DEBUG(
-                    "Current buffer size is %li and parsing_failed_here is %li",
-                    current_buffer_size, parsing_failed_here);
-                arg_for_read_callback = arg_for_read_callback - parsing_failed_here;
-                if (arg_for_read_callback < 0) // In case some parsing error was not
-                                               // caught, which should never happen..
+                if (window_size_ < MAX_PARSE_WINDOW_SIZE_)
                 {
-                    delete[] to_be_parsed; // Freeing memory
-                    to_be_parsed = new uint8_t[buffer_size_];
-                    to_be_parsed_ = to_be_parsed;
-                    shift_bytes = 0;
-                    arg_for_read_callback = 0;
-                    continue;
+                    // E.g. a MeasEpoch of many satellites arriving in small reads
+                    window_size_ *= 2;
+                    parse_window_.resize(window_size_ +
+                                         MappedFile::MAPPING_GUARD_SIZE);
+                    ROS_DEBUG("Grew the parse window to %li bytes", window_size_);
+                } else
+                {
+                    ROS_ERROR(
+                        "Incomplete message exceeds the parse window of %li bytes, discarding it.",
+                        window_size_);
+                    window_fill = 0;
                 }
-                shift_bytes += current_buffer_size;
-                continue;
             }
-            delete[] to_be_parsed; // Freeing memory
-            to_be_parsed = new uint8_t[buffer_size_];
-            to_be_parsed_ = to_be_parsed;
-            shift_bytes = 0;
-            arg_for_read_callback = 0;
+            // Taken before reading, such that bytes committed meanwhile restamp it
+            const int64_t pending_since = pending_since_.exchange(0);
+            window_fill += circular_buffer_.read(parse_window_.data() + window_fill,
+                                                 window_size_ - window_fill);
+            if (pipeline_statistics_)
+            {
+                const PipelineStatistics::Clock::time_point received{
+                    PipelineStatistics::Clock::duration(pending_since)};
+                if (pending_since != 0)
+                    pipeline_statistics_->recordStage(
+                        evStageBuffer, received, PipelineStatistics::Clock::now());
+                pipeline_statistics_->setReceiveTime(received);
+            }
+
+            ROSAIC_TRACE_EVENT(evTraceParse, 0, 0, window_fill);
+            std::size_t consumed =
+                std::min(read_callback_(parse_window_.data(), window_fill),
+                         window_fill);
+            window_fill -= consumed;
+            // Moves the incomplete message to the front of the window
+            if ((window_fill > 0) && (consumed > 0))
+                memmove(parse_window_.data(), parse_window_.data() + consumed,
+                        window_fill);
         }
-        ROS_INFO(
-            "TryParsing() method finished since it did not receive anything to parse for 10 seconds..");
+        ROS_DEBUG("TryParsing() method finished since the AsyncManager is stopping");
     }
 
     template <typename StreamT>
@@ -295,89 +556,325 @@ namespace io_comm_rx {
             return true;
         }
 
-        std::vector<uint8_t> vector_temp(cmd.begin(), cmd.end());
-        uint8_t* p = &vector_temp[0];
+        strand_.post(boost::bind(&AsyncManager<StreamT>::write, this, cmd, size));
+        return true;
+    }
 
-        io_service_->post(
-            boost::bind(&AsyncManager<StreamT>::write, this, cmd, size));
+    template <typename StreamT>
+    bool AsyncManager<StreamT>::send(const std::vector<std::string>& commands)
+    {
+        if (commands.empty())
+        {
+            ROS_ERROR("Command script to be sent to the Rx would be empty");
+            return true;
+        }
+        strand_.post(boost::bind(
+            &AsyncManager<StreamT>::writeScript, this,
+            boost::make_shared<std::vector<std::string>>(commands)));
         return true;
     }
 
     template <typename StreamT>
     void AsyncManager<StreamT>::write(std::string cmd, std::size_t size)
     {
-        boost::asio::write(*stream_, boost::asio::buffer(cmd.data(), size));
+        boost::system::error_code error;
+        boost::asio::write(*stream_, boost::asio::buffer(cmd.data(), size), error);
+        if (error)
+        {
+            ROS_ERROR("Could not send the following %li bytes to the Rx: %s\n%s",
+                      size, error.message().c_str(), cmd.c_str());
+            return;
+        }
+        ROSAIC_TRACE_EVENT(evTraceWrite, 0, 1, size);
         // Prints the data that was sent
         ROS_DEBUG("Sent the following %li bytes to the Rx: \n%s", size, cmd.c_str());
     }
 
     template <typename StreamT>
-    void AsyncManager<StreamT>::callAsyncWait(uint16_t* count)
+    void AsyncManager<StreamT>::writeScript(
+        boost::shared_ptr<std::vector<std::string>> script)
+    {
+        std::vector<boost::asio::const_buffer> buffers;
+        buffers.reserve(script->size());
+        for (const std::string& command : *script)
+            buffers.push_back(boost::asio::buffer(command));
+        boost::asio::async_write(
+            *stream_, buffers,
+            strand_.wrap(boost::bind(&AsyncManager<StreamT>::scriptWritten, this,
+                                     script, boost::asio::placeholders::error,
+                                     boost::asio::placeholders::bytes_transferred)));
+    }
+
+    template <typename StreamT>
+    void AsyncManager<StreamT>::scriptWritten(
+        boost::shared_ptr<std::vector<std::string>> script,
+        const boost::system::error_code& error, std::size_t bytes_transferred)
     {
-        timer_.async_wait(boost::bind(&AsyncManager::wait, this, count));
+        if (error)
+        {
+            ROS_ERROR("Writing %li commands to the Rx failed after %li bytes: %s",
+                      script->size(), bytes_transferred, error.message().c_str());
+            return;
+        }
+        ROSAIC_TRACE_EVENT(evTraceWrite, 0, script->size(), bytes_transferred);
+        ROS_DEBUG("Sent %li commands (%li bytes) to the Rx: \n%s", script->size(),
+                  bytes_transferred, boost::algorithm::join(*script, "\n").c_str());
     }
 
     template <typename StreamT>
     AsyncManager<StreamT>::AsyncManager(
         boost::shared_ptr<StreamT> stream,
-        boost::shared_ptr<boost::asio::io_service> io_service,
-        std::size_t buffer_size) :
-        timer_(*(io_service.get()), boost::posix_time::seconds(1)),
-        stopping_(false), try_parsing_(false), allow_writing_(true),
-        do_read_count_(0), buffer_size_(buffer_size), count_max_(6),
-        circular_buffer_(buffer_size)
-    // Since buffer_size = 8912 in declaration, no need in definition any more (even
-    // yields error message, since "overwrite").
+        boost::shared_ptr<IoServicePool> pool, const Connector& connector,
+        const ReconnectPolicy& policy, std::size_t buffer_size) :
+        parser_waiting_(false),
+        pool_(pool), strand_(pool->ioService()), connector_(connector),
+        policy_(policy),
+        watchdog_timeout_(std::chrono::duration_cast<
+                          std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(
+                std::max(policy.watchdog_timeout_s, 0.0)))),
+        state_(evConnecting), attempts_(0), reconnect_timer_(pool->ioService()),
+        watchdog_timer_(pool->ioService()), random_engine_(std::random_device()()),
+        ever_connected_(false), circular_buffer_(4 * buffer_size),
+        reading_into_scratch_(false), read_span_(nullptr), read_span_size_(0),
+        read_wrapped_(nullptr), pipeline_statistics_(nullptr), recorder_(nullptr),
+        pending_since_(0), stopping_(false), buffer_size_(buffer_size)
     {
         ROS_DEBUG(
             "Setting the private stream variable of the AsyncManager instance.");
         stream_ = stream;
-        io_service_ = io_service;
         in_.resize(buffer_size_);
+        window_size_ = circular_buffer_.capacity();
+        parse_window_.resize(window_size_ + MappedFile::MAPPING_GUARD_SIZE);
+    }
 
-        io_service_->post(boost::bind(&AsyncManager<StreamT>::read, this));
-        // This function is used to ask the io_service to execute the given handler,
-        // but without allowing the io_service to call the handler from inside this
-        // function. The function signature of the handler must be: void handler();
-        // The io_service guarantees that the handler (given as parameter) will only
+    template <typename StreamT>
+    void AsyncManager<StreamT>::start()
+    {
+        // This function is used to ask the strand to execute the given handler,
+        // but without allowing it to call the handler from inside this function.
+        // The strand guarantees that the handler (given as parameter) will only
         // be called in a thread in which the run(), run_one(), poll() or poll_one()
-        // member functions is currently being invoked. So the fundamental difference
-        // is that dispatch will execute the work right away if it can and queue it
-        // otherwise while post queues the work no matter what.
-        async_background_thread_.reset(new boost::thread(
-            boost::bind(&boost::asio::io_service::run, io_service_)));
-        // Note that io_service_ is already pointer, hence need dereferencing
-        // operator & (ampersand). If the value of the pointer for the current thread
-        // is changed using reset(), then the previous value is destroyed by calling
-        // the cleanup routine. Alternatively, the stored value can be reset to NULL
-        // and the prior value returned by calling the release() member function,
-        // allowing the application to take back responsibility for destroying the
-        // object.
-        uint16_t count = 0;
-        boost::thread(boost::bind(&AsyncManager::callAsyncWait, this, &count));
+        // member functions of the pool's io_service is currently being invoked,
+        // and never concurrently with the other handlers of this AsyncManager.
+        // Since the connection state machine always keeps an operation
+        // (connecting, reading or waiting) pending, the pool is never idle.
+        strand_.post(boost::bind(&AsyncManager<StreamT>::connect, this));
 
         ROS_DEBUG("Launching tryParsing() thread..");
-        boost::thread(boost::bind(&AsyncManager::tryParsing, this));
-    } // Calls std::terminate() on thread just created
+        parsing_thread_.reset(
+            new boost::thread(boost::bind(&AsyncManager::tryParsing, this)));
+    }
 
+    //! Handlers that are still pending refer to this AsyncManager and cannot be
+    //! withdrawn from the io_service, hence the pool is stopped, which stops the
+    //! AsyncManagers of all Rxs sharing it. Rxs sharing a pool are meant to be
+    //! torn down together anyway, i.e. when the node shuts down.
     template <typename StreamT>
     AsyncManager<StreamT>::~AsyncManager()
     {
-        async_background_thread_->join();
+        stopping_ = true;
+        pool_->stop();
+        {
+            boost::mutex::scoped_lock lock(parse_mutex_);
+            parsing_condition_.notify_one();
+        }
+        if (parsing_thread_)
+            parsing_thread_->join();
+        boost::system::error_code error;
+        stream_->close(error);
+    }
+
+    template <typename StreamT>
+    ConnectionStatistics AsyncManager<StreamT>::statistics() const
+    {
+        boost::mutex::scoped_lock lock(statistics_mutex_);
+        ConnectionStatistics statistics = statistics_;
+        if (ever_connected_ && !statistics.connected)
+            statistics.downtime_s += std::chrono::duration<double>(
+                                         std::chrono::steady_clock::now() -
+                                         disconnected_at_)
+                                         .count();
+        return statistics;
+    }
+
+    template <typename StreamT>
+    void AsyncManager<StreamT>::connect()
+    {
+        if (stopping_)
+            return;
+        state_ = evConnecting;
+        // Bounds the attempt, since the kernel would retry an unanswered TCP SYN
+        // for minutes
+        if (watchdog_timeout_ != std::chrono::steady_clock::duration::zero())
+        {
+            watchdog_timer_.expires_from_now(watchdog_timeout_);
+            watchdog_timer_.async_wait(
+                strand_.wrap(boost::bind(&AsyncManager<StreamT>::watchdogExpired,
+                                         this, boost::asio::placeholders::error)));
+        }
+        // The connector may well call the handler before returning
+        connector_(*stream_, strand_,
+                   boost::bind(&AsyncManager<StreamT>::connected, this,
+                               boost::asio::placeholders::error));
+    }
+
+    template <typename StreamT>
+    void AsyncManager<StreamT>::connected(const boost::system::error_code& error)
+    {
+        if (stopping_)
+            return;
+        if (error)
+        {
+            {
+                boost::mutex::scoped_lock lock(statistics_mutex_);
+                ++statistics_.failed_attempts;
+            }
+            ROS_ERROR("Connecting to the Rx failed: %s", error.message().c_str());
+            boost::system::error_code close_error;
+            stream_->close(close_error);
+            scheduleReconnect();
+            return;
+        }
+        state_ = evConnected;
+        last_data_ = std::chrono::steady_clock::now();
+        {
+            boost::mutex::scoped_lock lock(statistics_mutex_);
+            if (ever_connected_)
+            {
+                double outage_s =
+                    std::chrono::duration<double>(last_data_ - disconnected_at_)
+                        .count();
+                statistics_.downtime_s += outage_s;
+                ++statistics_.reconnects;
+                ROS_INFO(
+                    "Reconnected to the Rx after %.1f s (%u reconnections and %.1f s of downtime so far)",
+                    outage_s, statistics_.reconnects, statistics_.downtime_s);
+            }
+            ever_connected_ = true;
+            statistics_.connected = true;
+        }
+        read();
+        armWatchdog();
+        if (connection_callback_)
+            connection_callback_();
+    }
+
+    template <typename StreamT>
+    void AsyncManager<StreamT>::disconnect(const std::string& reason)
+    {
+        if (state_ != evConnected)
+            return;
+        ROS_ERROR("Lost the connection to the Rx: %s", reason.c_str());
+        {
+            boost::mutex::scoped_lock lock(statistics_mutex_);
+            disconnected_at_ = std::chrono::steady_clock::now();
+            statistics_.connected = false;
+        }
+        // Completes the pending read with operation_aborted, which its handler
+        // ignores since we are no longer connected
+        boost::system::error_code error;
+        stream_->close(error);
+        scheduleReconnect();
+    }
+
+    template <typename StreamT>
+    void AsyncManager<StreamT>::scheduleReconnect()
+    {
+        state_ = evBackingOff;
+        boost::system::error_code error;
+        watchdog_timer_.cancel(error);
+        double growth = std::pow(2.0, static_cast<double>(std::min(attempts_, 16u)));
+        double delay_s =
+            std::min(policy_.initial_delay_s * growth, policy_.max_delay_s);
+        // Equal jitter: at least half the delay, at most all of it
+        std::uniform_real_distribution<double> jitter(0.5, 1.0);
+        delay_s *= jitter(random_engine_);
+        ++attempts_;
+        ROS_INFO("Reconnecting to the Rx in %.1f s..", delay_s);
+        reconnect_timer_.expires_from_now(
+            std::chrono::milliseconds(static_cast<int64_t>(delay_s * 1000.0)));
+        reconnect_timer_.async_wait(
+            strand_.wrap([this](const boost::system::error_code& error) {
+                if (!error)
+                    connect();
+            }));
+    }
+
+    template <typename StreamT>
+    void AsyncManager<StreamT>::armWatchdog()
+    {
+        if (watchdog_timeout_ == std::chrono::steady_clock::duration::zero())
+            return;
+        watchdog_timer_.expires_at(last_data_ + watchdog_timeout_);
+        watchdog_timer_.async_wait(
+            strand_.wrap(boost::bind(&AsyncManager<StreamT>::watchdogExpired, this,
+                                     boost::asio::placeholders::error)));
+    }
+
+    template <typename StreamT>
+    void AsyncManager<StreamT>::watchdogExpired(
+        const boost::system::error_code& error)
+    {
+        if (error || state_ == evBackingOff)
+            return;
+        if (state_ == evConnecting)
+        {
+            // Lets the pending attempt fail with operation_aborted
+            ROS_ERROR("Connecting to the Rx did not succeed within %.1f s",
+                      policy_.watchdog_timeout_s);
+            boost::system::error_code close_error;
+            stream_->close(close_error);
+            return;
+        }
+        // last_data_ is only ever moved forward, so the timer is simply rearmed
+        // instead of being reset for each read
+        if (std::chrono::steady_clock::now() < last_data_ + watchdog_timeout_)
+        {
+            armWatchdog();
+            return;
+        }
+        {
+            boost::mutex::scoped_lock lock(statistics_mutex_);
+            ++statistics_.watchdog_timeouts;
+        }
+        std::stringstream ss;
+        ss << "No data arrived for " << policy_.watchdog_timeout_s << " s";
+        disconnect(ss.str());
     }
 
     template <typename StreamT>
     void AsyncManager<StreamT>::read()
     {
+        // Scatters the read over all free space of circular_buffer_, including the
+        // part that wraps around to its start
+        std::size_t span_size;
+        uint8_t* wrapped;
+        std::size_t wrapped_size;
+        uint8_t* span =
+            circular_buffer_.writeSpans(span_size, wrapped, wrapped_size);
+        reading_into_scratch_ = (span_size == 0);
+        if (reading_into_scratch_)
+        {
+            // Parser is lagging behind: keep draining the stream such that the
+            // kernel buffer does not back up, the bytes are accounted as dropped.
+            span = in_.data();
+            span_size = in_.size();
+            wrapped_size = 0;
+        }
+        read_span_ = span;
+        read_span_size_ = span_size;
+        read_wrapped_ = wrapped;
+        std::array<boost::asio::mutable_buffer, 2> spans = {
+            {boost::asio::buffer(span, span_size),
+             boost::asio::buffer(wrapped, wrapped_size)}};
         stream_->async_read_some(
-            boost::asio::buffer(in_.data(), in_.size()),
-            boost::bind(&AsyncManager<StreamT>::asyncReadSomeHandler, this,
-                        boost::asio::placeholders::error,
-                        boost::asio::placeholders::bytes_transferred));
+            spans, strand_.wrap(boost::bind(
+                       &AsyncManager<StreamT>::asyncReadSomeHandler, this,
+                       boost::asio::placeholders::error,
+                       boost::asio::placeholders::bytes_transferred)));
         // The handler is async_read_some_handler, whose call is postponed to
         // when async_read_some completes.
-        if (do_read_count_ < 5)
-            ++do_read_count_;
     }
 
     template <typename StreamT>
@@ -386,28 +883,77 @@ namespace io_comm_rx {
     {
         if (error)
         {
-            ROS_ERROR("Rx ASIO input buffer read error: %s, %li",
-                      error.message().c_str(), bytes_transferred);
-        } else if (bytes_transferred > 0)
+            // Reading is resumed by connected() once the connection is back
+            if (state_ == evConnected && !stopping_)
+            {
+                std::stringstream ss;
+                ss << "Rx ASIO input buffer read error: " << error.message() << ", "
+                   << bytes_transferred;
+                disconnect(ss.str());
+            }
+            return;
+        }
+        if (bytes_transferred > 0)
         {
+            last_data_ = std::chrono::steady_clock::now();
+            const bool timing =
+                pipeline_statistics_ && pipeline_statistics_->timing();
+            attempts_ = 0;
+            if (recorder_)
+            {
+                // Copied before commitWrite() lets the parser consume the bytes.
+                // Scratch reads are recorded too, such that the files remain
+                // complete while the parser is lagging behind.
+                const std::size_t head =
+                    std::min(bytes_transferred, read_span_size_);
+                recorder_->record(read_span_, head, read_wrapped_,
+                                  bytes_transferred - head);
+            }
             if (read_callback_) // Will be false in InitializeSerial (first call)
                                 // since read_callback_ not added yet..
             {
-                boost::mutex::scoped_lock lock(parse_mutex_);
-                parsing_condition_.wait(lock, [this]() { return allow_writing_; });
-                circular_buffer_.write(in_.data(), bytes_transferred);
-                allow_writing_ = false;
-                try_parsing_ = true;
-                lock.unlock();
-                parsing_condition_.notify_one();
-                std::vector<uint8_t> empty;
-                in_ = empty;
-                in_.resize(buffer_size_);
+                if (reading_into_scratch_)
+                {
+                    circular_buffer_.recordDrop(bytes_transferred);
+                    ROSAIC_TRACE_EVENT(evTraceOverflow, 0, 0, bytes_transferred);
+                    if (pipeline_statistics_)
+                        pipeline_statistics_->recordBufferOverflow(
+                            bytes_transferred);
+                    ROS_ERROR_THROTTLE(
+                        1,
+                        "Circular buffer full, dropped %li bytes (%li overflows and %li bytes in total so far, high-water mark %li of %li bytes)",
+                        bytes_transferred, circular_buffer_.overflowCount(),
+                        circular_buffer_.droppedBytes(),
+                        circular_buffer_.highWaterMark(),
+                        circular_buffer_.capacity());
+                } else
+                {
+                    circular_buffer_.commitWrite(bytes_transferred);
+                    ROSAIC_TRACE_EVENT(evTraceRead, 0, circular_buffer_.size(),
+                                       bytes_transferred);
+                    if (pipeline_statistics_)
+                        pipeline_statistics_->recordBufferFill(
+                            circular_buffer_.size());
+                    if (timing)
+                    {
+                        // Only the oldest unparsed bytes stamp the buffer
+                        int64_t none = 0;
+                        pending_since_.compare_exchange_strong(
+                            none, last_data_.time_since_epoch().count());
+                    }
+                    notifyParser();
+                    if (timing)
+                        pipeline_statistics_->recordStage(
+                            evStageRead, last_data_,
+                            PipelineStatistics::Clock::now());
+                }
             }
         }
 
+        // Re-armed right away rather than via post(), since a completion handler
+        // is never invoked from within the initiating function
         if (!stopping_)
-            io_service_->post(boost::bind(&AsyncManager<StreamT>::read, this));
+            read();
     }
 
     template <typename StreamT>
@@ -422,29 +968,6 @@ namespace io_comm_rx {
                 "Error while closing the AsyncManager: " << error.message().c_str());
         }
     }
-
-    template <typename StreamT>
-    void AsyncManager<StreamT>::wait(uint16_t* count)
-    {
-        if (*count < count_max_)
-        {
-            ++(*count);
-            timer_.expires_at(timer_.expires_at() + boost::posix_time::seconds(1));
-            if (!(*count == count_max_))
-            {
-                timer_.async_wait(boost::bind(&AsyncManager::wait, this, count));
-            }
-        }
-        if ((*count == count_max_) && (do_read_count_ < 3))
-        // Why 3? Even if there are no incoming messages, read() is called once.
-        // It will be called a second time in TCP/IP mode since (just example)
-        // "IP10<" is transmitted.
-        {
-            ROS_INFO(
-                "No incoming messages, driver stopped, ros::spin() will spin forever unless you hit Ctrl+C.");
-            async_background_thread_->interrupt();
-        }
-    }
 } // namespace io_comm_rx
 
 #endif // for ASYNC_MANAGER_HPP
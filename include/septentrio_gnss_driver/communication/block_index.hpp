@@ -0,0 +1,167 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef BLOCK_INDEX_HPP
+#define BLOCK_INDEX_HPP
+
+/**
+ * @file block_index.hpp
+ * @date 15/10/26
+ * @brief Declares the sidecar index of SBF logs that replay seeks with
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @class BlockIndex
+     * @brief Remembers where in an SBF log every so many blocks start and which
+     * receiver time they carry
+     *
+     * The index is built by framing the log on several threads at once and kept
+     * next to the log in a file of the same name ending in ".idx", such that it
+     * needs to be built on the first replay of a log only. It goes stale, and is
+     * rebuilt, whenever the size or modification time of the log changes.
+     *
+     * Times are looked up by bisection as long as the entries are stamped in
+     * ascending order. Logs whose time jumps backwards, e.g. after a reset of the
+     * Rx, are searched linearly in the order of the log instead, which never
+     * misses a block but may replay more than the stretch asked for.
+     */
+    class BlockIndex
+    {
+    public:
+        /**
+         * @struct Entry
+         * @brief Start and time stamp of one indexed block
+         */
+        struct Entry
+        {
+            //! Position of the block's first sync byte within the log
+            uint64_t offset;
+            //! Time of week in ms of the block
+            uint32_t tow;
+            //! GPS week number of the block
+            uint16_t wnc;
+            //! Block number, i.e. the block ID without its revision
+            uint16_t block_number;
+        };
+
+        BlockIndex() : interval_(0), ordered_(true) {}
+
+        /**
+         * @brief Loads the index of "file_name" from its sidecar file, or builds
+         * it from the mapped log and saves it there if there is none up to date
+         * @param[in] file_name The name of (or path to) the log
+         * @param[in] data Start of the mapped log
+         * @param[in] size Size of the log in bytes
+         * @param[in] interval Number of blocks from one entry to the next
+         * @param[in] threads Number of threads to build the index on
+         * @return True if the index was loaded, false if it had to be built
+         */
+        bool open(const std::string& file_name, const uint8_t* data,
+                  std::size_t size, uint32_t interval, std::size_t threads);
+
+        /**
+         * @brief Frames the log on "threads" threads and notes every
+         * interval-th SBF block carrying a valid time stamp
+         * @param[in] data Start of the mapped log
+         * @param[in] size Size of the log in bytes
+         * @param[in] interval Number of blocks from one entry to the next
+         * @param[in] threads Number of threads to build the index on
+         */
+        void build(const uint8_t* data, std::size_t size, uint32_t interval,
+                   std::size_t threads);
+
+        /**
+         * @brief Returns where to start replaying so as not to miss any block
+         * stamped at or after "gps_time"
+         * @param[in] gps_time Milliseconds since the GPS epoch 1980/01/06
+         * @return Offset of the last entry stamped before gps_time, 0 if none is
+         */
+        std::size_t startOffset(uint64_t gps_time) const;
+
+        /**
+         * @brief Returns where to stop replaying so as not to miss any block
+         * stamped at or before "gps_time"
+         * @param[in] gps_time Milliseconds since the GPS epoch 1980/01/06
+         * @param[in] size Size of the log in bytes
+         * @return Offset of the first entry stamped after gps_time, size if none is
+         */
+        std::size_t endOffset(uint64_t gps_time, std::size_t size) const;
+
+        //! The entries, in the order of their offsets
+        const std::vector<Entry>& entries() const { return entries_; }
+
+        //! Name of the sidecar file of the log "file_name"
+        static std::string sidecarName(const std::string& file_name)
+        {
+            return file_name + ".idx";
+        }
+
+    private:
+        //! Indexes the blocks starting in [begin, end) into "entries"
+        static void buildRange(const uint8_t* data, std::size_t size,
+                               std::size_t begin, std::size_t end,
+                               uint32_t interval, std::vector<Entry>* entries);
+
+        //! Reads the sidecar file "index_name", provided it was written for a log
+        //! of "log_size" bytes last modified at "log_mtime" and for "interval"
+        bool load(const std::string& index_name, uint64_t log_size,
+                  int64_t log_mtime, uint32_t interval);
+
+        //! Writes the sidecar file "index_name" via a temporary file, such that a
+        //! replay running at the same time never reads half of it
+        bool save(const std::string& index_name, uint64_t log_size,
+                  int64_t log_mtime) const;
+
+        //! Milliseconds since the GPS epoch at which "entry" is stamped
+        static uint64_t gpsTime(const Entry& entry)
+        {
+            return static_cast<uint64_t>(entry.wnc) * 604800000 + entry.tow;
+        }
+
+        //! Whether or not the entries are stamped in ascending order
+        static bool isOrdered(const std::vector<Entry>& entries);
+
+        //! Number of blocks from one entry to the next
+        uint32_t interval_;
+        std::vector<Entry> entries_;
+        //! Whether or not entries_ may be bisected by time
+        bool ordered_;
+    };
+} // namespace io_comm_rx
+
+#endif // BLOCK_INDEX_HPP
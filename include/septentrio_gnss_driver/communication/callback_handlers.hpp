@@ -94,7 +94,16 @@
 
 // ROSaic and C++ includes
 #include <algorithm>
+#include <septentrio_gnss_driver/communication/command_batch.hpp>
+#include <septentrio_gnss_driver/communication/decode_pipeline.hpp>
+#include <septentrio_gnss_driver/communication/epoch_assembler.hpp>
+#include <septentrio_gnss_driver/communication/framer.hpp>
+#include <septentrio_gnss_driver/communication/pipeline_statistics.hpp>
+#include <septentrio_gnss_driver/communication/publisher_registry.hpp>
+#include <septentrio_gnss_driver/communication/receiver_context.hpp>
+#include <septentrio_gnss_driver/communication/replay_scheduler.hpp>
 #include <septentrio_gnss_driver/communication/rx_message.hpp>
+#include <septentrio_gnss_driver/communication/trace_ring.hpp>
 
 /**
  * @file callback_handlers.hpp
@@ -102,36 +111,7 @@
  * @brief Handles callbacks when reading NMEA/SBF messages
  */
 
-extern bool g_channelstatus_has_arrived_gpsfix;
-extern bool g_measepoch_has_arrived_gpsfix;
-extern bool g_dop_has_arrived_gpsfix;
-extern bool g_pvtgeodetic_has_arrived_gpsfix;
-extern bool g_pvtgeodetic_has_arrived_navsatfix;
-extern bool g_pvtgeodetic_has_arrived_pose;
-extern bool g_poscovgeodetic_has_arrived_gpsfix;
-extern bool g_poscovgeodetic_has_arrived_navsatfix;
-extern bool g_poscovgeodetic_has_arrived_pose;
-extern bool g_velcovgeodetic_has_arrived_gpsfix;
-extern bool g_atteuler_has_arrived_gpsfix;
-extern bool g_atteuler_has_arrived_pose;
-extern bool g_attcoveuler_has_arrived_gpsfix;
-extern bool g_attcoveuler_has_arrived_pose;
-extern bool g_receiverstatus_has_arrived_diagnostics;
-extern bool g_qualityind_has_arrived_diagnostics;
-
-extern bool g_publish_navsatfix;
-extern bool g_publish_gpsfix;
-extern bool g_publish_gpst;
-extern bool g_publish_pose;
-extern bool g_publish_diagnostics;
-extern bool g_response_received;
-extern boost::mutex g_response_mutex;
-extern boost::condition_variable g_response_condition;
-extern bool g_cd_received;
-extern boost::mutex g_cd_mutex;
-extern boost::condition_variable g_cd_condition;
-extern uint32_t g_cd_count;
-extern std::string g_rx_tcp_port;
+extern uint32_t g_decode_threads;
 
 namespace io_comm_rx {
     /**
@@ -142,7 +122,7 @@ namespace io_comm_rx {
     class AbstractCallbackHandler
     {
     public:
-        virtual void handle(RxMessage& rx_message, std::string message_key) = 0;
+        virtual void handle(RxMessage& rx_message, RxID_Enum message_key) = 0;
 
         bool Wait(const boost::posix_time::time_duration& timeout)
         {
@@ -165,26 +145,28 @@ namespace io_comm_rx {
     public:
         virtual const T& Get() { return message_; }
 
-        void handle(RxMessage& rx_message, std::string message_key)
+        //! Decoding errors are logged here rather than propagated, such that a
+        //! single bad message never unwinds the dispatch loop
+        void handle(RxMessage& rx_message, RxID_Enum message_key)
         {
             boost::mutex::scoped_lock lock(mutex_);
             try
             {
                 if (!rx_message.read(message_key))
                 {
-                    std::ostringstream ss;
-                    ss << "Rx decoder error for message with ID (empty field if non-determinable)"
-                       << rx_message.messageID() << ". Reason unknown.";
-                    throw std::runtime_error(ss.str());
+                    ROSAIC_TRACE_EVENT(evTraceDecodeError, message_key, 0,
+                                       rx_message.getCount());
+                    ROS_DEBUG(
+                        "Rx decoder error for message with ID (empty field if non-determinable) %s. Reason unknown.",
+                        rx_message.messageID().c_str());
                     return;
                 }
             } catch (std::runtime_error& e)
             {
-                std::ostringstream ss;
-                ss << "Rx decoder error for message with ID "
-                   << rx_message.messageID() << ".\n"
-                   << e.what();
-                throw std::runtime_error(ss.str());
+                ROSAIC_TRACE_EVENT(evTraceDecodeError, message_key, 0,
+                                   rx_message.getCount());
+                ROS_DEBUG("Rx decoder error for message with ID %s.\n%s",
+                          rx_message.messageID().c_str(), e.what());
                 return;
             }
 
@@ -204,43 +186,43 @@ namespace io_comm_rx {
     {
 
     public:
-        //! Key is std::string and represents the ROS message key, value is
-        //! boost::shared_ptr<CallbackHandler>
-        typedef std::multimap<std::string,
-                              boost::shared_ptr<AbstractCallbackHandler>>
-            CallbackMap;
+        //! Handlers registered for one key
+        typedef std::vector<boost::shared_ptr<AbstractCallbackHandler>>
+            CallbackList;
+        //! Flat table indexed by RxID_Enum, each entry holding the handlers
+        //! registered for that SBF block, NMEA sentence or composite ROS message
+        typedef std::vector<CallbackList> CallbackMap;
 
-        CallbackHandlers() = default;
+        //! Starts g_decode_threads decode workers, shared by all copies
+        CallbackHandlers();
 
         /**
-         * @brief Adds a pair to the multimap "callbackmap_", with the message_key
-         * being the key
+         * @brief Adds a handler to the entry "message_key" of "callbackmap_"
          *
          * This method is called by "handlers_" in rosaic_node.cpp.
          * T would be a (custom or not) ROS message, e.g.
          * septentrio_gnss_driver::PVTGeodetic, or nmea_msgs::GPGGA. Note that
          * "typename" could be omitted in the argument.
-         * @param message_key The pair's key
-         * @return The modified multimap "callbackmap_"
+         * @param message_key The dispatch key, e.g. evPVTGeodetic
+         * @return The modified table "callbackmap_"
          */
         template <typename T>
-        CallbackMap insert(std::string message_key)
+        CallbackMap insert(RxID_Enum message_key)
         {
             boost::mutex::scoped_lock lock(callback_mutex_);
             // Adding typename might be cleaner, but is optional again
             CallbackHandler<T>* handler = new CallbackHandler<T>();
-            callbackmap_.insert(std::make_pair(
-                message_key, boost::shared_ptr<AbstractCallbackHandler>(handler)));
-            CallbackMap::key_type key = message_key;
-            ROS_DEBUG("Key %s successfully inserted into multimap: %s",
-                      message_key.c_str(),
-                      ((unsigned int)callbackmap_.count(key)) ? "true" : "false");
+            callbackmap_[message_key].push_back(
+                boost::shared_ptr<AbstractCallbackHandler>(handler));
+            ROS_DEBUG("Key %u successfully inserted into callback table: %s",
+                      static_cast<unsigned int>(message_key),
+                      callbackmap_[message_key].empty() ? "false" : "true");
             return callbackmap_;
         }
 
         /**
          * @brief Ćalled every time rx_message is found to contain some potentially
-         * useful message
+         * useful message, hands it over to the decode workers
          * @param rx_message
          */
         void handle(RxMessage& rx_message);
@@ -250,73 +232,113 @@ namespace io_comm_rx {
          * decoded/parsed/published
          * @param[in] data Buffer passed on from AsyncManager class
          * @param[in] size Size of the buffer
+         * @return Number of bytes consumed; the remaining ones belong to a message
+         * that has not been fully received yet and must be handed over again
+         * together with the bytes that follow
          */
-        void readCallback(const uint8_t* data, std::size_t& size);
+        std::size_t readCallback(const uint8_t* data, std::size_t size);
 
-        //! Callback handlers multimap for Rx messages; it needs to be public since
+        /**
+         * @brief Restarts the pacing of frames for the replay of a new file
+         * @param[in] rate Replay speed relative to receiver time, 0 for as fast as
+         * possible
+         */
+        void startReplay(double rate) { replay_scheduler_.start(rate); }
+
+        //! Counters and latencies of all stages, shared by all copies
+        PipelineStatistics& statistics() { return *statistics_; }
+
+        //! Settings and parser state of the Rx, shared by all copies. The
+        //! settings are to be adjusted before the first byte is handed over.
+        ReceiverContext& context() { return *context_; }
+
+        //! Publishes the composite ROS messages of epochs that are still incomplete,
+        //! e.g. at the end of a file, and waits until the decode workers are done
+        void flushEpochs();
+
+        /**
+         * @brief Routes the replies of the Rx to "batch" as long as any of its
+         * commands is pending
+         * @param[in] batch The script about to be sent, nullptr to detach it
+         */
+        void setCommandBatch(const boost::shared_ptr<CommandBatch>& batch)
+        {
+            boost::atomic_store(&command_batch_, batch);
+        }
+
+        //! Callback handlers table for Rx messages; it needs to be public since
         //! we copy-assign (did not work otherwise) new callbackmap_, after inserting
         //! a pair to the multimap within the DefineMessages() method of the
         //! ROSaicNode class, onto its old version.
         CallbackMap callbackmap_;
 
+        //! Publishers of all output topics, advertised within the defineMessages()
+        //! method of the ROSaicNode class
+        PublisherRegistry publishers_;
+
     private:
-        //! The "static" keyword resolves construct-by-copying issues related to this
-        //! mutex by making it available throughout the code unit. The mutex
-        //! constructor list contains "mutex (const mutex&) = delete", hence
-        //! construct-by-copying a mutex is explicitly prohibited. The get_handlers()
-        //! method of the Comm_IO class hence forces us to make this mutex static.
-        static boost::mutex callback_mutex_;
+        //! Settings and parser state of the Rx, declared ahead of framer_ since
+        //! the latter refers to it
+        boost::shared_ptr<ReceiverContext> context_;
 
-        //! Determines which of the SBF blocks necessary for the gps_common::GPSFix
-        //! ROS message arrives last and thus launches its construction
-        static std::string do_gpsfix_;
+        //! Cuts the incoming byte stream into complete messages
+        Framer framer_;
 
-        //! Determines which of the SBF blocks necessary for the
-        //! sensor_msgs::NavSatFix ROS message arrives last and thus launches its
-        //! construction
-        static std::string do_navsatfix_;
+        //! Holds back frames read from SBF/PCAP files until they are due
+        ReplayScheduler replay_scheduler_;
 
-        //! Determines which of the SBF blocks necessary for the
-        //! geometry_msgs/PoseWithCovarianceStamped ROS message arrives last and thus
-        //! launches its construction
-        static std::string do_pose_;
+        //! Collects the SBF blocks of composite ROS messages per epoch, only ever
+        //! accessed by the thread calling readCallback()
+        EpochAssembler epoch_assembler_;
 
-        //! Determines which of the SBF blocks necessary for the
-        //! diagnostic_msgs/DiagnosticArray ROS message arrives last and thus
-        //! launches its construction
-        static std::string do_diagnostics_;
+        //! Filled by the framer, the decode workers and the publishers, declared
+        //! ahead of pipeline_ since the latter records into it
+        boost::shared_ptr<PipelineStatistics> statistics_;
 
-        //! Shorthand for the map responsible for matching ROS message identifiers
-        //! relevant for GPSFix to a uint32_t
-        typedef std::map<std::string, uint32_t> GPSFixMap;
+        //! Decodes and publishes on worker threads, shared since the getHandlers()
+        //! method of the Comm_IO class hands out copies
+        boost::shared_ptr<DecodePipeline> pipeline_;
 
-        //! All instances of the CallbackHandlers class shall have access to the map
-        //! without reinitializing it, hence static
-        static GPSFixMap gpsfix_map;
+        //! The command script whose replies are awaited, if any, accessed
+        //! atomically since it is set and read by different threads
+        boost::shared_ptr<CommandBatch> command_batch_;
 
-        //! Shorthand for the map responsible for matching ROS message identifiers
-        //! relevant for NavSatFix to a uint32_t
-        typedef std::map<std::string, uint32_t> NavSatFixMap;
+        //! The "static" keyword resolves construct-by-copying issues related to this
+        //! mutex by making it available throughout the code unit. The mutex
+        //! constructor list contains "mutex (const mutex&) = delete", hence
+        //! construct-by-copying a mutex is explicitly prohibited. The get_handlers()
+        //! method of the Comm_IO class hence forces us to make this mutex static.
+        //! It only guards the insertion of handlers, decoding takes place on the
+        //! lanes of pipeline_, each key being served by a single lane.
+        static boost::mutex callback_mutex_;
 
-        //! All instances of the CallbackHandlers class shall have access to the map
-        //! without reinitializing it, hence static
-        static NavSatFixMap navsatfix_map;
+        //! Calls all handlers registered for "key"
+        void dispatch(RxMessage& rx_message, RxID_Enum key);
+
+        //! Whether the message of "key" is to be decoded: topics nobody listens to
+        //! are skipped if so configured, keys without a topic, e.g.
+        //! ReceiverSetup, merely retain state and are never skipped
+        bool wanted(RxID_Enum key) const
+        {
+            return !context_->lazy_decoding || !publishers_.isAdvertised(key) ||
+                   publishers_.hasSubscribers(key);
+        }
 
-        //! Shorthand for the map responsible for matching ROS message identifiers
-        //! relevant for PoseWithCovarianceStamped to a uint32_t
-        typedef std::map<std::string, uint32_t> PoseWithCovarianceStampedMap;
+        //! Hands the message over to the lane of "key", unless "key" has no handler
+        //! or is not wanted()
+        void submit(RxID_Enum key, const uint8_t* data, std::size_t size,
+                    const BlockArena* epoch);
 
-        //! All instances of the CallbackHandlers class shall have access to the map
-        //! without reinitializing it, hence static
-        static PoseWithCovarianceStampedMap pose_map;
+        //! Decodes the message and calls the handlers of "key", on the lane of "key"
+        void decode(RxID_Enum key, const uint8_t* data, std::size_t size,
+                    const BlockArena* epoch);
 
-        //! Shorthand for the map responsible for matching ROS message identifiers
-        //! relevant for DiagnosticArray to a uint32_t
-        typedef std::map<std::string, uint32_t> DiagnosticArrayMap;
+        //! Bitmask of the composite ROS messages to be published, in the format of
+        //! EpochAssembler::compositeBit()
+        uint32_t enabledComposites() const;
 
-        //! All instances of the CallbackHandlers class shall have access to the map
-        //! without reinitializing it, hence static
-        static DiagnosticArrayMap diagnosticarray_map;
+        //! Builds and publishes the composite ROS messages that are due
+        void emitComposites(uint32_t enabled);
     };
 
 } // namespace io_comm_rx
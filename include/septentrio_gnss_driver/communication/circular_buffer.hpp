@@ -33,50 +33,116 @@
 
 // C++ library includes
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 
 #ifndef CIRCULAR_BUFFER_HPP
 #define CIRCULAR_BUFFER_HPP
 
 /**
  * @file circular_buffer.hpp
- * @brief Declares a class for creating, writing to and reading from a circular
- * bufffer
+ * @brief Declares a class for creating, writing to and reading from a lock-free
+ * single-producer/single-consumer circular buffer
  * @date 25/09/20
  */
 
 /**
  * @class CircularBuffer
- * @brief Class for creating, writing to and reading from a circular buffer
+ * @brief Wait-free single-producer/single-consumer byte ring
+ *
+ * Exactly one thread (the ASIO reader) may call the producer methods
+ * (writeSpan(), commitWrite(), write()) and exactly one thread (the parser) may
+ * call the consumer methods (readSpan(), consume(), read()). Neither side ever
+ * takes a lock: head_ is only stored by the producer, tail_ only by the consumer,
+ * and each publishes its index with release semantics. The capacity is rounded up
+ * to a power of two such that indices can be masked instead of wrapped.
  */
 class CircularBuffer
 {
 public:
-    //! Constructor of CircularBuffer
+    //! Constructor of CircularBuffer, capacity is rounded up to a power of two
     explicit CircularBuffer(std::size_t capacity);
     //! Destructor of CircularBuffer
     ~CircularBuffer();
-    //! Returns size_
-    std::size_t size() const { return size_; }
+    //! Returns number of bytes that have been written but not yet read
+    std::size_t size() const
+    {
+        return head_.load(std::memory_order_acquire) -
+               tail_.load(std::memory_order_acquire);
+    }
     //! Returns capacity_
     std::size_t capacity() const { return capacity_; }
-    //! Returns number of bytes written.
+    //! Whether or not there is anything to read
+    bool empty() const { return size() == 0; }
+
+    //! Producer: returns pointer to the largest contiguous free region and its
+    //! length in "bytes" (0 if full)
+    uint8_t* writeSpan(std::size_t& bytes);
+    //! Producer: returns pointer to the free region up to the end of the storage
+    //! and its length in "bytes", as well as via "wrapped" the free region at the
+    //! start of the storage that follows it and its length in "wrapped_bytes", such
+    //! that both can be filled in one scattered read
+    uint8_t* writeSpans(std::size_t& bytes, uint8_t*& wrapped,
+                        std::size_t& wrapped_bytes);
+    //! Producer: publishes "bytes" bytes previously filled via writeSpan() or
+    //! writeSpans()
+    void commitWrite(std::size_t bytes);
+    //! Producer: copies data in, returns number of bytes written. Bytes that do
+    //! not fit are dropped and accounted for in the overflow counters.
     std::size_t write(const uint8_t* data, std::size_t bytes);
-    //! Returns number of bytes read.
+
+    //! Consumer: returns pointer to the largest contiguous readable region and its
+    //! length in "bytes" (0 if empty)
+    const uint8_t* readSpan(std::size_t& bytes) const;
+    //! Consumer: releases "bytes" bytes previously obtained via readSpan()
+    void consume(std::size_t bytes);
+    //! Consumer: copies up to "bytes" bytes out, returns number of bytes read.
     std::size_t read(uint8_t* data, std::size_t bytes);
 
+    //! Largest fill level observed since construction, in bytes
+    std::size_t highWaterMark() const
+    {
+        return high_water_mark_.load(std::memory_order_relaxed);
+    }
+    //! Number of write() calls that could not be stored entirely
+    std::size_t overflowCount() const
+    {
+        return overflow_count_.load(std::memory_order_relaxed);
+    }
+    //! Number of bytes dropped by write() since construction
+    std::size_t droppedBytes() const
+    {
+        return dropped_bytes_.load(std::memory_order_relaxed);
+    }
+    //! Lets the producer account for bytes it had to discard itself
+    void recordDrop(std::size_t bytes);
+
 private:
-    //! Specifies where we start writing
-    std::size_t head_;
-    //! Specifies where we start reading
-    std::size_t tail_;
-    //! Number of bytes that have been written but not yet read
-    std::size_t size_;
-    //! Capacity of the circular buffer
-    std::size_t capacity_;
-    //! Pointer that always points to the same memory address, hence could be const
-    //! pointer
-    uint8_t* data_;
+    //! Assumed size of a cache line in bytes
+    static const std::size_t CACHE_LINE_SIZE = 64;
+    //! Total number of bytes ever written, only stored by the producer
+    std::atomic<std::size_t> head_;
+    //! Keeps head_ and tail_ on different cache lines to avoid false sharing.
+    //! Padding rather than alignas, since the owning AsyncManager is allocated via
+    //! new, which only honors extended alignment from C++17 onwards.
+    uint8_t head_padding_[CACHE_LINE_SIZE];
+    //! Total number of bytes ever read, only stored by the consumer
+    std::atomic<std::size_t> tail_;
+    //! Keeps tail_ off the cache line of the read-mostly members below
+    uint8_t tail_padding_[CACHE_LINE_SIZE];
+    //! Capacity of the circular buffer, a power of two
+    const std::size_t capacity_;
+    //! capacity_ - 1, used to map head_ and tail_ onto data_
+    const std::size_t mask_;
+    //! Pointer that always points to the same memory address
+    uint8_t* const data_;
+    //! Largest value of size() seen by the producer
+    std::atomic<std::size_t> high_water_mark_;
+    //! Number of truncated write() calls
+    std::atomic<std::size_t> overflow_count_;
+    //! Number of bytes that were dropped since the buffer was full
+    std::atomic<std::size_t> dropped_bytes_;
 };
 
 #endif // for CIRCULAR_BUFFER_HPP
\ No newline at end of file
@@ -0,0 +1,128 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstddef>
+#include <string>
+#include <vector>
+// Boost includes
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#ifndef COMMAND_BATCH_HPP
+#define COMMAND_BATCH_HPP
+
+/**
+ * @file command_batch.hpp
+ * @date 14/10/26
+ * @brief Declares a configuration script sent to the Rx in one go
+ */
+
+namespace io_comm_rx {
+
+    //! Enum for the state of a command within a CommandBatch
+    enum CommandState_Enum
+    {
+        evCommandPending,
+        evCommandAccepted,
+        evCommandRejected,
+        evCommandUnanswered
+    };
+
+    /**
+     * @class CommandBatch
+     * @brief A script of Rx commands, written out at once and matched against the
+     * replies as they come in
+     *
+     * The Rx processes commands one after the other and answers each of them
+     * with "$R: " (or "$R? " if rejected) followed by the echo of the command.
+     * Replies are hence matched in order, by echo, so that a command the Rx
+     * never answered is told apart from the one answered next.
+     */
+    class CommandBatch
+    {
+    public:
+        CommandBatch();
+
+        /**
+         * @brief Appends a command to the script
+         * @param[in] command The command, including its terminating carriage return
+         */
+        void add(const std::string& command);
+
+        //! The commands in the order they are sent
+        const std::vector<std::string>& commands() const { return commands_; }
+
+        //! Whether or not the script holds any command
+        bool empty() const { return commands_.empty(); }
+
+        /**
+         * @brief Attributes a reply of the Rx to the earliest pending command whose
+         * echo it carries, the pending commands before it being left unanswered
+         * @param[in] reply The reply, starting with "$R"
+         * @param[in] size The size of the reply in bytes
+         * @return False if the reply echoes none of the pending commands
+         */
+        bool match(const char* reply, std::size_t size);
+
+        /**
+         * @brief Blocks until every command has been answered, then marks those
+         * still pending as unanswered
+         * @param[in] timeout_ms Maximum time to wait in milliseconds
+         * @return True if every command was answered in time
+         */
+        bool waitForReplies(uint32_t timeout_ms);
+
+        /**
+         * @brief Logs every command that was rejected or not answered, with the
+         * reply of the Rx if any
+         * @return Number of commands that failed
+         */
+        std::size_t report() const;
+
+    private:
+        //! The commands as written to the Rx
+        std::vector<std::string> commands_;
+        //! The commands stripped of blanks and lower-cased, for matching echoes
+        std::vector<std::string> echoes_;
+        //! State of each command
+        std::vector<CommandState_Enum> states_;
+        //! First line of the reply to each command
+        std::vector<std::string> replies_;
+        //! Index of the earliest command not answered yet
+        std::size_t next_;
+        //! Guards the members above once the script has been sent
+        mutable boost::mutex mutex_;
+        //! Notified once every command has been answered
+        boost::condition_variable condition_;
+    };
+} // namespace io_comm_rx
+
+#endif // COMMAND_BATCH_HPP
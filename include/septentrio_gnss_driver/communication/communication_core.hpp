@@ -71,6 +71,8 @@
 #include <boost/exception/diagnostic_information.hpp> // dealing with bad file descriptor error
 #include <boost/function.hpp>
 // C++ library includes
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <sstream>
@@ -78,6 +80,9 @@
 // ROSaic includes
 #include <septentrio_gnss_driver/communication/async_manager.hpp>
 #include <septentrio_gnss_driver/communication/callback_handlers.hpp>
+#include <septentrio_gnss_driver/communication/io_service_pool.hpp>
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+#include <septentrio_gnss_driver/communication/stream_recorder.hpp>
 
 /**
  * @file communication_core.hpp
@@ -98,6 +103,57 @@ namespace io_comm_rx {
         115200,  230400,  460800,  500000,  576000,  921600,  1000000,
         1152000, 1500000, 2000000, 2500000, 3000000, 3500000, 4000000};
 
+    /**
+     * @struct StreamSettings
+     * @brief Sizing and tuning of the stream to the Rx, the latter being applied
+     * whenever the stream is (re-)opened
+     */
+    struct StreamSettings
+    {
+        StreamSettings() :
+            read_buffer_size(65536), tcp_receive_buffer_size(0),
+            tcp_no_delay(true), serial_low_latency(true)
+        {
+        }
+        //! Size in bytes of the AsyncManager's scratch buffer, its circular buffer
+        //! being four times as large
+        std::size_t read_buffer_size;
+        //! SO_RCVBUF of the TCP socket in bytes, 0 to keep the OS default
+        int tcp_receive_buffer_size;
+        //! Whether or not to disable Nagle's algorithm, such that commands are
+        //! sent without delay
+        bool tcp_no_delay;
+        //! Whether or not to ask the serial driver for low latency, e.g. for a
+        //! 1 ms instead of 16 ms latency timer on FTDI adapters (Linux only)
+        bool serial_low_latency;
+    };
+
+    /**
+     * @struct ReplaySettings
+     * @brief Which part of an SBF log is replayed
+     *
+     * Times are found via the log's BlockIndex, hence are as precise as its
+     * interval: replay starts at most index_interval blocks ahead of start_time
+     * and stops at most index_interval blocks behind end_time.
+     */
+    struct ReplaySettings
+    {
+        ReplaySettings() :
+            start_time(0.0), end_time(0.0), start_offset(0), index_interval(100)
+        {
+        }
+        //! Unix Epoch time in seconds of the first epoch to be replayed, 0 to
+        //! start at the beginning of the log
+        double start_time;
+        //! Unix Epoch time in seconds of the last epoch to be replayed, 0 to
+        //! replay until the end of the log
+        double end_time;
+        //! Byte offset at which to start replaying, if later than start_time
+        uint64_t start_offset;
+        //! Number of SBF blocks between two entries of the log's index
+        uint32_t index_interval;
+    };
+
     /**
      * @class Comm_IO
      * @brief Handles communication with and configuration of the mosaic (and beyond)
@@ -123,7 +179,9 @@ namespace io_comm_rx {
          * @param[in] flowcontrol Default is "None", set variable (not yet checked)
          * to "RTS|CTS" to activate hardware flow control (only for serial ports
          * COM1, COM2 and COM3 (for mosaic))
-         * @return True if connection could be established, false otherwise
+         * @return True unless an I/O manager is set already, the port itself being
+         * opened by the latter, asynchronously and anew whenever the connection is
+         * lost
          */
         bool initializeSerial(std::string port, uint32_t baudrate = 115200,
                               std::string flowcontrol = "None");
@@ -132,23 +190,34 @@ namespace io_comm_rx {
          * @brief Initializes the TCP I/O
          * @param[in] host The TCP host
          * @param[in] port The TCP port
-         * @return True if connection could be established, false otherwise
+         * @return True unless an I/O manager is set already, the connection itself
+         * being established by the latter, asynchronously and anew whenever it is
+         * lost
          */
         bool initializeTCP(std::string host, std::string port);
 
         /**
-         * @brief Initializes SBF file reading and reads SBF file by repeatedly
-         * calling read_callback_()
+         * @brief Initializes SBF file reading and reads SBF file by calling
+         * read_callback_()
+         *
+         * The file is memory-mapped and framed in place, so neither startup time
+         * nor memory use depend on its size. If it cannot be mapped, it is read in
+         * bounded chunks instead. Only the part given by setReplaySettings() is
+         * replayed; seeking to a time builds the file's BlockIndex on first use.
          * @param[in] file_name The name of (or path to) the SBF file, e.g. "xyz.sbf"
          */
         void initializeSBFFileReading(std::string file_name);
 
         /**
-         * @brief Initializes PCAP file reading and reads PCAP file by repeatedly
-         * calling read_callback_()
+         * @brief Initializes PCAP file reading and reads PCAP file by calling
+         * read_callback_()
+         *
+         * The TCP stream selected by "filter" is reassembled and parsed while the
+         * capture is being read.
          * @param[in] file_name The name of (or path to) the PCAP file, e.g. "/tmp/capture.pcap"
+         * @param[in] filter BPF expression selecting the packets of the stream
          */
-        void initializePCAPFileReading(std::string file_name);
+        void initializePCAPFileReading(std::string file_name, std::string filter);
 
         /**
          * @brief Set the I/O manager
@@ -156,6 +225,81 @@ namespace io_comm_rx {
          */
         void setManager(const boost::shared_ptr<Manager>& manager);
 
+        /**
+         * @brief Sets how the I/O manager re-establishes lost connections, to be
+         * called before initializeSerial() or initializeTCP()
+         * @param[in] policy The reconnection policy
+         */
+        void setReconnectPolicy(const ReconnectPolicy& policy)
+        {
+            reconnect_policy_ = policy;
+        }
+
+        /**
+         * @brief Sets the sizing and tuning of the stream, to be called before
+         * initializeSerial() or initializeTCP()
+         * @param[in] settings The stream settings
+         */
+        void setStreamSettings(const StreamSettings& settings)
+        {
+            stream_settings_ = settings;
+        }
+
+        /**
+         * @brief Sets which part of SBF logs is replayed, to be called before
+         * initializeSBFFileReading()
+         * @param[in] settings The replay settings
+         */
+        void setReplaySettings(const ReplaySettings& settings)
+        {
+            replay_settings_ = settings;
+        }
+
+        /**
+         * @brief Sets the threads the I/O manager performs its I/O on, to be
+         * called before initializeSerial() or initializeTCP() if they are to be
+         * shared with other Rxs
+         *
+         * Unless set, the I/O manager gets a pool of one thread of its own.
+         * @param[in] pool The I/O threads
+         */
+        void setIoServicePool(const boost::shared_ptr<IoServicePool>& pool)
+        {
+            pool_ = pool;
+        }
+
+        /**
+         * @brief Sets where the raw stream from the Rx is recorded to, to be
+         * called before initializeSerial() or initializeTCP()
+         *
+         * Starts the recorder right away unless settings.directory is empty.
+         * @param[in] settings The recording settings
+         */
+        void setRecordingSettings(const RecordingSettings& settings);
+
+        /**
+         * @brief Returns the recorder of the raw stream
+         * @return The recorder, nullptr if not recording
+         */
+        const StreamRecorder* recorder() const { return recorder_.get(); }
+
+        /**
+         * @brief Sets the function called (on an I/O thread) whenever the
+         * connection has been (re-)established, to be called before
+         * initializeSerial() or initializeTCP()
+         * @param[in] callback The function to be called
+         */
+        void setConnectionCallback(const Manager::ConnectionCallback& callback)
+        {
+            connection_callback_ = callback;
+        }
+
+        /**
+         * @brief Returns the reconnection and downtime counters of the I/O manager
+         * @return The counters, all zero if there is no I/O manager
+         */
+        ConnectionStatistics connectionStatistics() const;
+
         /**
          * @brief Reset the Serial I/O port, e.g. after a Rx reset
          * @param[in] port The device's port address
@@ -174,17 +318,81 @@ namespace io_comm_rx {
          */
         void send(std::string cmd);
 
+        /**
+         * @brief Sends all commands of "batch" with a single write, the replies of
+         * the Rx being matched to them by handlers_ from then on
+         * @param batch The command script
+         */
+        void send(const boost::shared_ptr<CommandBatch>& batch);
+
         //! Callback handlers for the inwards streaming messages
         CallbackHandlers handlers_;
 
     private:
+        //! Hands the (remainder of an) SBF/PCAP file over to the readCallback()
+        //! method of handlers_
+        void parseFileBuffer(const std::vector<uint8_t>& vec_buf);
+
+        //! Connector of the TCP AsyncManager: Resolves host_ and connects "socket"
+        //! to port_, then calls "handler", both steps completing on "strand"
+        void connectTCP(boost::asio::ip::tcp::socket& socket,
+                        boost::asio::io_service::strand& strand,
+                        const ConnectHandler& handler);
+
+        //! Handler of the host resolution of connectTCP()
+        void tcpResolved(boost::shared_ptr<boost::asio::ip::tcp::resolver> resolver,
+                         boost::asio::ip::tcp::socket& socket,
+                         boost::asio::io_service::strand& strand,
+                         const ConnectHandler& handler,
+                         const boost::system::error_code& error,
+                         boost::asio::ip::tcp::resolver::iterator endpoint);
+
+        //! Handler of the connection attempt of tcpResolved(), tunes "socket" as
+        //! given by stream_settings_
+        void tcpConnected(boost::asio::ip::tcp::socket& socket,
+                          const ConnectHandler& handler,
+                          const boost::system::error_code& error,
+                          boost::asio::ip::tcp::resolver::iterator endpoint);
+
+        //! Connector of the serial AsyncManager: Opens serial_port_, gradually
+        //! sets its baudrate to baudrate_ and tunes it as given by
+        //! stream_settings_, then calls "handler". Runs synchronously, hence
+        //! occupies an I/O thread while stepping through the baudrates.
+        void openSerial(boost::asio::serial_port& serial,
+                        const ConnectHandler& handler);
+
+        //! Fallback of initializeSBFFileReading() for files that cannot be mapped:
+        //! reads the file REPLAY_CHUNK_SIZE_ bytes at a time from "start_offset"
+        void streamSBFFile(const std::string& file_name, std::size_t start_offset);
+
+        //! Returns the range [begin, end) of bytes of the mapped log "file" to be
+        //! replayed as given by replay_settings_
+        void replayRange(const std::string& file_name, const MappedFile& file,
+                         std::size_t& begin, std::size_t& end) const;
+
         //! Saves the port description
         std::string serial_port_;
+        //! Threads the I/O manager performs its I/O on, declared ahead of
+        //! manager_ such that they outlive the latter
+        boost::shared_ptr<IoServicePool> pool_;
+        //! Records the raw stream, if set. Declared ahead of manager_ such that it
+        //! outlives the latter, which copies into it on the I/O thread.
+        boost::shared_ptr<StreamRecorder> recorder_;
         //! Processes I/O stream data
         //! This declaration is deliberately stream-independent (Serial or TCP).
         boost::shared_ptr<Manager> manager_;
         //! Baudrate at the moment, unless InitializeSerial or ResetSerial fail
         uint32_t baudrate_;
+        //! Hardware flow control of the serial port, "None" or "RTS|CTS"
+        std::string flowcontrol_;
+        //! How the I/O manager re-establishes lost connections
+        ReconnectPolicy reconnect_policy_;
+        //! Sizing and tuning of the stream
+        StreamSettings stream_settings_;
+        //! Part of SBF logs that is replayed
+        ReplaySettings replay_settings_;
+        //! Handed over to the I/O manager, called whenever it (re-)connected
+        Manager::ConnectionCallback connection_callback_;
 
         friend class CallbackHandlers;
         friend class RxMessage;
@@ -197,6 +405,13 @@ namespace io_comm_rx {
         //! after setting the baudrate to certain value (important between
         //! increments)
         const static unsigned int SET_BAUDRATE_SLEEP_ = 500000;
+
+        //! Number of bytes handed to readCallback() at once during SBF file replay,
+        //! larger than the longest possible message
+        const static std::size_t REPLAY_CHUNK_SIZE_ = 1 << 20;
+
+        //! Number of reassembled PCAP stream bytes collected before they are parsed
+        const static std::size_t PCAP_PARSE_CHUNK_SIZE_ = 1 << 16;
     };
 } // namespace io_comm_rx
 
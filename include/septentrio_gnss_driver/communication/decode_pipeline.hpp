@@ -0,0 +1,183 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+// Boost includes
+#include <boost/function.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/pipeline_statistics.hpp>
+#include <septentrio_gnss_driver/communication/rx_message.hpp>
+#include <septentrio_gnss_driver/packed_structs/block_view.hpp>
+
+#ifndef DECODE_PIPELINE_HPP
+#define DECODE_PIPELINE_HPP
+
+/**
+ * @file decode_pipeline.hpp
+ * @date 14/10/26
+ * @brief Declares the worker stages that decode and publish framed messages
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @struct DecodeJob
+     * @brief A message handed from the framing thread to a decode worker, owning
+     * copies of all bytes it is decoded from
+     */
+    struct DecodeJob
+    {
+        //! Dispatch key, e.g. evPVTGeodetic or evGPSFix
+        RxID_Enum key;
+        //! The message itself, for composites their primary block
+        std::vector<uint8_t> bytes;
+        //! The blocks of the epoch, for composite ROS messages only
+        BlockArena epoch;
+        //! Whether "epoch" is to be handed to the decoder
+        bool has_epoch;
+        //! When the bytes were read and when the job was queued, only set while
+        //! latencies are sampled
+        PipelineStatistics::Clock::time_point received;
+        PipelineStatistics::Clock::time_point submitted;
+    };
+
+    /**
+     * @class DecodePipeline
+     * @brief Decodes and publishes messages on worker threads, one lane per thread
+     *
+     * Every dispatch key is served by exactly one lane, hence messages of one topic
+     * are published in the order they were framed. Lane 0 serves the low-latency
+     * topics (PVT, covariances, attitude, GPST, NavSatFix, pose, GGA, RMC), the
+     * other lanes share the heavy ones (GPSFix, DiagnosticArray, GSA and GSV), such
+     * that the latter never hold up the former. Each lane is fed through a bounded
+     * single-producer single-consumer lock-free queue, and hands its jobs back
+     * through a second one for reuse, so that no allocation takes place once the
+     * buffers of the jobs have grown. The framing thread is the only producer. With
+     * 0 threads, messages are decoded on the framing thread itself.
+     */
+    class DecodePipeline
+    {
+    public:
+        //! Jobs per lane, further messages are dropped (live) or waited for (replay)
+        static const std::size_t QUEUE_CAPACITY = 256;
+
+        //! Decodes and publishes one message: key, data, size and the epoch's
+        //! blocks for composites (nullptr otherwise)
+        typedef boost::function<void(RxID_Enum, const uint8_t*, std::size_t,
+                                     const BlockArena*)>
+            Decoder;
+
+        /**
+         * @param[in] threads Number of worker threads, i.e. lanes, 0 for none
+         * @param[in] decoder Called for each message, on the thread of its lane
+         * @param[in] statistics Receives drops and queueing, decoding and
+         * end-to-end latencies, must outlive the pipeline; nullptr for none
+         */
+        DecodePipeline(uint32_t threads, const Decoder& decoder,
+                       PipelineStatistics* statistics = nullptr);
+
+        //! Stops the workers once they have run out of jobs
+        ~DecodePipeline();
+
+        //! Lane that serves "key", 0 for the low-latency ones
+        std::size_t laneOf(RxID_Enum key) const;
+
+        /**
+         * @brief Hands a message over to the lane of its key
+         * @param[in] key Dispatch key of the message
+         * @param[in] data Start of the message
+         * @param[in] size Size of the message
+         * @param[in] epoch Blocks of the epoch for composites, nullptr otherwise
+         * @param[in] wait Whether to wait for a free job if the lane is full rather
+         * than dropping the message, e.g. when replaying files
+         */
+        void submit(RxID_Enum key, const uint8_t* data, std::size_t size,
+                    const BlockArena* epoch, bool wait);
+
+        //! Waits until all jobs submitted so far are published
+        void drain();
+
+        //! Number of messages dropped since the lanes were full
+        uint64_t dropped() const { return dropped_.load(); }
+
+    private:
+        //! Queue of job pointers, bounded at QUEUE_CAPACITY
+        typedef boost::lockfree::spsc_queue<
+            DecodeJob*, boost::lockfree::capacity<QUEUE_CAPACITY>>
+            JobQueue;
+
+        /**
+         * @struct Lane
+         * @brief One worker thread with its queues
+         */
+        struct Lane
+        {
+            //! Storage of all jobs of the lane
+            std::vector<DecodeJob> jobs;
+            //! Jobs to be decoded, filled by the framing thread
+            JobQueue pending;
+            //! Jobs decoded, to be reused by the framing thread
+            JobQueue done;
+            //! Whether the worker waits for jobs
+            std::atomic<bool> idle;
+            //! Guards the wake-up of the worker only, never the queues
+            boost::mutex mutex;
+            boost::condition_variable condition;
+            boost::thread thread;
+        };
+
+        //! Body of the worker thread of "lane"
+        void work(Lane& lane);
+
+        //! Decodes "job", recording its latencies if they are sampled
+        void decode(const DecodeJob& job);
+
+        //! Called for each message
+        Decoder decoder_;
+        PipelineStatistics* statistics_;
+        //! One per thread
+        std::vector<boost::shared_ptr<Lane>> lanes_;
+        //! Whether the workers keep running
+        std::atomic<bool> running_;
+        //! Messages dropped since the lanes were full
+        std::atomic<uint64_t> dropped_;
+    };
+} // namespace io_comm_rx
+
+#endif // DECODE_PIPELINE_HPP
@@ -0,0 +1,174 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/rx_message.hpp>
+#include <septentrio_gnss_driver/packed_structs/block_view.hpp>
+
+#ifndef EPOCH_ASSEMBLER_HPP
+#define EPOCH_ASSEMBLER_HPP
+
+/**
+ * @file epoch_assembler.hpp
+ * @date 14/10/26
+ * @brief Declares the collection of SBF blocks into epochs for composite ROS
+ * messages
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @class EpochAssembler
+     * @brief Collects the SBF blocks that composite ROS messages (GPSFix,
+     * NavSatFix, PoseWithCovarianceStamped, DiagnosticArray) are built from, per
+     * epoch
+     *
+     * Blocks are keyed on their WNc and TOW, so blocks of different epochs are
+     * never mixed, even if they arrive out of order. Each slot records the arrived
+     * blocks and the composites already emitted as bitmasks. A composite is due
+     * once, either when all its blocks have arrived, or when its slot expires
+     * (timeout or eviction by a newer epoch) and at least its primary block, i.e.
+     * PVTGeodetic or ReceiverStatus, has arrived. Since a slot holds copies of its
+     * blocks in an arena, composites can be built from it independently of the I/O
+     * buffers.
+     */
+    class EpochAssembler
+    {
+    public:
+        //! Number of epochs that are collected concurrently
+        static const std::size_t EPOCH_SLOTS = 4;
+        //! Slots are expired this long after their first block arrived
+        static const int64_t EPOCH_TIMEOUT_MS = 1000;
+        //! Number of SBF blocks that composites are built from
+        static const std::size_t COMPONENT_COUNT = 10;
+        //! The SBF blocks that composites are built from, by bit position
+        static const RxID_Enum COMPONENTS[COMPONENT_COUNT];
+
+        /**
+         * @struct Slot
+         * @brief The blocks collected for one epoch
+         */
+        struct Slot
+        {
+            //! Whether the slot currently collects an epoch
+            bool open;
+            //! Whether the slot is not to be waited for any longer
+            bool expired;
+            //! WNc and TOW merged into milliseconds since the GPS epoch
+            uint64_t epoch;
+            //! Bitmask of the arrived blocks, bit positions as in COMPONENTS
+            uint32_t arrived;
+            //! Bitmask of the emitted composites, bit positions as in
+            //! compositeBit()
+            uint32_t emitted;
+            //! Arrival time of the first block of the epoch
+            std::chrono::steady_clock::time_point opened;
+            //! Copies of the arrived blocks, the arena keeps its capacity across
+            //! epochs
+            BlockArena blocks;
+
+            //! Whether block "id" has arrived for this epoch
+            bool has(RxID_Enum id) const;
+        };
+
+        /**
+         * @struct Due
+         * @brief A composite ROS message that is due, with the slot to build it from
+         */
+        struct Due
+        {
+            //! Dispatch key of the composite, e.g. evGPSFix
+            RxID_Enum composite;
+            //! Copy of the block whose header time stamps the composite
+            const uint8_t* primary;
+            //! Length of the primary block
+            std::size_t primary_size;
+            const Slot* slot;
+        };
+
+        EpochAssembler();
+
+        //! Bit of composite "composite" (e.g. evGPSFix) in the masks passed as
+        //! "enabled", 0 if it is not a composite
+        static uint32_t compositeBit(RxID_Enum composite);
+
+        /**
+         * @brief Files a copy of the SBF block in the slot of its epoch
+         *
+         * Blocks that no enabled composite needs are ignored, as are stragglers of
+         * epochs that have been closed already.
+         * @param[in] data Start of the SBF block
+         * @param[in] size Size of the SBF block
+         * @param[in] id Dispatch key of the SBF block
+         * @param[in] enabled Bitmask of the composites to be published
+         * @return False if all slots are in use by older epochs, in which case the
+         * oldest one has been expired; fetch the due composites via next() and file
+         * the block anew
+         */
+        bool add(const uint8_t* data, std::size_t size, RxID_Enum id,
+                 uint32_t enabled);
+
+        /**
+         * @brief Fetches the next composite that is due and marks it as emitted
+         *
+         * Oldest epochs come first. Slots that cannot emit anything anymore are
+         * closed on the fly.
+         * @param[in] enabled Bitmask of the composites to be published
+         * @param[out] due The composite that is due, valid if true is returned
+         * @return False if no composite is due
+         */
+        bool next(uint32_t enabled, Due& due);
+
+        //! Expires all slots, e.g. at the end of a file, such that next() hands out
+        //! everything that can still be emitted
+        void expireAll();
+
+    private:
+        //! Returns the slot collecting "epoch", nullptr if there is none
+        Slot* find(uint64_t epoch);
+
+        //! Closes "slot", remembering its epoch
+        void close(Slot& slot);
+
+        //! The epoch slots
+        std::array<Slot, EPOCH_SLOTS> slots_;
+        //! Whether any slot has been closed already
+        bool closed_any_;
+        //! Newest epoch closed so far, stragglers up to it are ignored
+        uint64_t newest_closed_;
+    };
+} // namespace io_comm_rx
+
+#endif // EPOCH_ASSEMBLER_HPP
@@ -0,0 +1,162 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstddef>
+#include <cstdint>
+
+#ifndef FRAMER_HPP
+#define FRAMER_HPP
+
+/**
+ * @file framer.hpp
+ * @date 14/10/26
+ * @brief Declares an incremental framer that cuts SBF blocks, NMEA sentences,
+ * command replies and connection descriptors out of the incoming byte stream
+ */
+
+namespace io_comm_rx {
+
+    class PipelineStatistics;
+    struct ReceiverContext;
+
+    //! Outcome of a single Framer::next() call
+    enum FramerResult_Enum
+    {
+        //! A complete (and, if SBF, CRC-checked) frame has been found
+        evFrameComplete,
+        //! The frame starting at Frame::offset has not been fully received yet
+        evFrameNeedMore,
+        //! The header at Frame::offset turned out to be bogus, skip one byte
+        evFrameResync
+    };
+
+    //! Kind of frame found by the Framer
+    enum FrameType_Enum
+    {
+        evSBFFrame,
+        evNMEAFrame,
+        evResponseFrame,
+        evConnectionDescriptorFrame
+    };
+
+    /**
+     * @struct Frame
+     * @brief Location of a frame within the buffer handed over to Framer::next()
+     */
+    struct Frame
+    {
+        //! What kind of message the frame holds
+        FrameType_Enum type;
+        //! Position of the first sync byte with respect to the scanned buffer
+        std::size_t offset;
+        //! Length of the frame in bytes, without trailing CR/LF for ASCII frames
+        std::size_t size;
+    };
+
+    /**
+     * @class Framer
+     * @brief Splits the byte stream into frames without throwing
+     *
+     * The Framer never consumes anything itself: next() tells the caller whether
+     * the buffer starts with (after possibly skipping garbage) a complete frame,
+     * the beginning of one that is yet to arrive completely, or a corrupted
+     * header. SBF blocks are checked for a sane length and a valid CRC, such that
+     * the decoders do not need to repeat that check.
+     */
+    class Framer
+    {
+    public:
+        Framer() :
+            crc_failures_(0), resyncs_(0), statistics_(nullptr), context_(nullptr)
+        {
+        }
+
+        //! Reports CRC failures, resyncs and CRC check latencies to "statistics",
+        //! which must outlive the Framer, nullptr to stop reporting
+        void setStatistics(PipelineStatistics* statistics)
+        {
+            statistics_ = statistics;
+        }
+
+        //! Frames connection descriptors as long as context->read_cd is set,
+        //! "context" must outlive the Framer; without one, they are never framed
+        void setContext(const ReceiverContext* context) { context_ = context; }
+
+        /**
+         * @brief Looks for the next frame in the buffer
+         * @param[in] data Start of the bytes to be scanned
+         * @param[in] size Number of bytes available from data onwards
+         * @param[out] frame Filled in for every outcome; for evFrameNeedMore,
+         * frame.offset is the number of leading bytes that may be discarded
+         * @return Whether a frame is complete, incomplete or corrupted
+         */
+        FramerResult_Enum next(const uint8_t* data, std::size_t size, Frame& frame);
+
+        //! Number of SBF blocks that failed the CRC check
+        std::size_t crcFailures() const { return crc_failures_; }
+        //! Number of headers that had to be skipped (CRC failures included)
+        std::size_t resyncs() const { return resyncs_; }
+
+        //! Maximum length of an SBF block before its header is taken to be
+        //! corrupted, above a MeasEpoch block of all channels and signals
+        static const std::size_t SBF_MAX_LENGTH = 24576;
+        //! Maximum length of an NMEA sentence before "$G"/"$P" is taken to be
+        //! garbage, generously including proprietary sentences
+        static const std::size_t NMEA_MAX_LENGTH = 1024;
+        //! Maximum length of a command reply before it is passed on as it is
+        static const std::size_t RESPONSE_MAX_LENGTH = 4096;
+        //! Length of a connection descriptor such as "IP10"
+        static const std::size_t CONNECTION_DESCRIPTOR_LENGTH = 4;
+
+    private:
+        //! Frames the SBF block at "data", headers are 8 bytes long
+        FramerResult_Enum frameSBF(const uint8_t* data, std::size_t size,
+                                   Frame& frame);
+        //! Frames a CR/LF terminated NMEA sentence
+        FramerResult_Enum frameNMEA(const uint8_t* data, std::size_t size,
+                                    Frame& frame);
+        //! Frames a (possibly multi-line) command reply
+        FramerResult_Enum frameResponse(const uint8_t* data, std::size_t size,
+                                        Frame& frame);
+        //! Counts a skipped header
+        FramerResult_Enum resync();
+
+        //! Counts CRC failures since construction
+        std::size_t crc_failures_;
+        //! Counts skipped headers since construction
+        std::size_t resyncs_;
+        PipelineStatistics* statistics_;
+        //! Tells whether connection descriptors are expected, if set
+        const ReceiverContext* context_;
+    };
+} // namespace io_comm_rx
+
+#endif // FRAMER_HPP
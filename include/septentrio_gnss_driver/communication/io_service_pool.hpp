@@ -0,0 +1,105 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstddef>
+#include <vector>
+
+// Boost includes
+#include <boost/asio.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#ifndef IO_SERVICE_POOL_HPP
+#define IO_SERVICE_POOL_HPP
+
+/**
+ * @file io_service_pool.hpp
+ * @date 14/10/26
+ * @brief Declares a pool of threads running one io_service, shared by the I/O
+ * managers of several Rxs
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @class IoServicePool
+     * @brief Runs one io_service on a fixed number of threads, on which the
+     * AsyncManagers of all Rxs handed the pool perform their I/O
+     *
+     * Every AsyncManager serializes its own handlers via a strand, hence any
+     * number of Rxs can share any number of threads. The threads keep running
+     * while no operation is pending, until stop() is called.
+     */
+    class IoServicePool
+    {
+    public:
+        /**
+         * @brief Starts "threads" threads running the io_service
+         * @param[in] threads Number of threads, at least one is started
+         */
+        explicit IoServicePool(std::size_t threads);
+
+        //! Calls stop()
+        ~IoServicePool();
+
+        //! Returns the io_service the I/O objects of the Rxs are bound to
+        boost::asio::io_service& ioService() { return io_service_; }
+
+        //! Returns the number of threads running the io_service
+        std::size_t size() const { return threads_.size(); }
+
+        /**
+         * @brief Stops the io_service and joins its threads, may be called more
+         * than once and from within a handler, which merely skips joining the
+         * calling thread
+         *
+         * Handlers still pending are abandoned, hence the I/O objects bound to the
+         * io_service may be destroyed afterwards.
+         */
+        void stop();
+
+    private:
+        //! The io_context object shared by all Rxs
+        boost::asio::io_service io_service_;
+
+        //! Keeps run() from returning while no operation is pending
+        boost::scoped_ptr<boost::asio::io_service::work> work_;
+
+        //! Threads running io_service_
+        std::vector<boost::shared_ptr<boost::thread>> threads_;
+
+        //! Serializes stop()
+        boost::mutex stop_mutex_;
+    };
+} // namespace io_comm_rx
+
+#endif // IO_SERVICE_POOL_HPP
@@ -0,0 +1,110 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+/**
+ * @file mapped_file.hpp
+ * @date 14/10/26
+ * @brief Declares a read-only memory mapping of a log file, used for SBF replay
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @class MappedFile
+     * @brief Maps a whole file read-only into memory so that it can be framed in
+     * place
+     *
+     * The mapping is followed by MAPPING_GUARD_SIZE readable zero bytes, such that
+     * RxMessage::messageSize() looking for the CR/LF ending an NMEA sentence or a
+     * command reply does not fault on the last one of the file. Pages that have
+     * been parsed can be handed back with release(), which keeps the resident set
+     * bounded for logs of any size.
+     */
+    class MappedFile
+    {
+    public:
+        //! Zero padding mapped behind the end of the file, well above the 4 bytes
+        //! that RxMessage::messageSize() looks ahead. SBF blocks are read through
+        //! BlockView, which never reads past their length.
+        static const std::size_t MAPPING_GUARD_SIZE = 64;
+
+        MappedFile();
+
+        ~MappedFile();
+
+        /**
+         * @brief Maps the file "file_name"
+         * @param[in] file_name The name of (or path to) the file
+         * @return True if the file is mapped, false if it cannot be opened or the
+         * platform or file system does not support mapping it
+         */
+        bool open(const std::string& file_name);
+
+        //! Unmaps the file, if mapped
+        void close();
+
+        //! Start of the mapped file content
+        const uint8_t* data() const { return data_; }
+
+        //! Size of the file in bytes
+        std::size_t size() const { return size_; }
+
+        /**
+         * @brief Tells the kernel that the bytes before "offset" will not be read
+         * again, so that their pages can be dropped
+         * @param[in] offset Number of bytes from the start of the file that have
+         * been parsed
+         */
+        void release(std::size_t offset);
+
+    private:
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        //! Start of the mapping, nullptr if nothing is mapped
+        uint8_t* data_;
+        //! Size of the file
+        std::size_t size_;
+        //! Size of the whole mapping including the guard
+        std::size_t mapped_size_;
+        //! Everything before this offset has already been released
+        std::size_t released_;
+    };
+} // namespace io_comm_rx
+
+#endif // MAPPED_FILE_HPP
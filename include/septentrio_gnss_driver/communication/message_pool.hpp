@@ -0,0 +1,115 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+// Boost includes
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#ifndef MESSAGE_POOL_HPP
+#define MESSAGE_POOL_HPP
+
+/**
+ * @file message_pool.hpp
+ * @date 14/10/26
+ * @brief Declares a pool recycling the published ROS messages of one type
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @class MessagePool
+     * @brief Hands out ROS messages of type M, recycling those nobody holds anymore,
+     * so that publishing at a steady rate performs no heap allocation once warm
+     *
+     * A message is handed out again as soon as the pool holds its only reference,
+     * i.e. once roscpp and all in-process subscribers have released it. Recycled
+     * messages keep their previous contents: The caller has to overwrite every
+     * field it fills, and should clear() or resize() vector fields rather than
+     * assigning new ones, so that they keep their capacity.
+     */
+    template <typename M>
+    class MessagePool
+    {
+    public:
+        //! Default number of messages recycled per type, enough for a subscriber
+        //! queue of a few messages plus the one being filled
+        static const std::size_t DEFAULT_CAPACITY = 16;
+
+        explicit MessagePool(std::size_t capacity = DEFAULT_CAPACITY) :
+            capacity_(capacity), next_(0), allocations_(0)
+        {
+            messages_.reserve(capacity_);
+        }
+
+        /**
+         * @brief Returns a message held by nobody else, allocating one only while
+         * the pool is still filling up or if all of its messages are in use
+         */
+        boost::shared_ptr<M> acquire()
+        {
+            boost::mutex::scoped_lock lock(mutex_);
+            for (std::size_t i = 0; i != messages_.size(); ++i)
+            {
+                const boost::shared_ptr<M>& message = messages_[next_];
+                next_ = (next_ + 1) % messages_.size();
+                if (message.use_count() == 1)
+                    return message;
+            }
+            ++allocations_;
+            boost::shared_ptr<M> message = boost::make_shared<M>();
+            if (messages_.size() < capacity_)
+                messages_.push_back(message);
+            return message;
+        }
+
+        //! Number of messages allocated so far, constant once the pool is warm
+        uint64_t allocations() const { return allocations_.load(); }
+
+    private:
+        //! Maximum number of messages recycled
+        std::size_t capacity_;
+        //! Recycled messages, at most capacity_
+        std::vector<boost::shared_ptr<M>> messages_;
+        //! Position in messages_ at which the next search starts
+        std::size_t next_;
+        //! Number of messages allocated by acquire()
+        std::atomic<uint64_t> allocations_;
+        //! Serializes acquire() calls from different threads
+        boost::mutex mutex_;
+    };
+} // namespace io_comm_rx
+
+#endif // MESSAGE_POOL_HPP
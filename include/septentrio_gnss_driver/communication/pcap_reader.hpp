@@ -31,8 +31,10 @@
 #ifndef PCAP_READER_H
 #define PCAP_READER_H
 
+#include <map>
 #include <pcap/pcap.h>
 #include <stdint.h>
+#include <string>
 #include <vector>
 
 /**
@@ -61,27 +63,40 @@ namespace pcapReader {
 
     };
 
+    //! Filter applied if none is specified, selects the stream sent to the Rx on
+    //! its default port
+    const std::string DEFAULT_FILTER = "tcp dst port 3001";
+
     /**
      * @class PcapDevice
      * @brief Class for handling a pcap file
+     *
+     * Reassembles the payload of the first TCP stream that passes the filter.
+     * Segments are put back into sequence order, retransmitted and overlapping
+     * bytes are dropped, and only contiguous payload is appended to the buffer.
      */
     class PcapDevice
     {
     public:
         static const size_t BUFFSIZE = 100;
 
+        //! Number of out-of-order segments kept while waiting for a missing one,
+        //! beyond that the gap is skipped
+        static const size_t MAX_PENDING_SEGMENTS = 256;
+
         /**
          * @brief Constructor for PcapDevice
-         * @param[out] buffer Buffer to write read raw data to
+         * @param[out] buffer Buffer to append the reassembled stream to
          */
         explicit PcapDevice(buffer_t& buffer);
 
         /**
          * @brief Try to open a pcap file
          * @param[in] device Path to pcap file
+         * @param[in] filter BPF expression selecting the packets to reassemble
          * @return True if success, false otherwise
          */
-        bool connect(const char* device);
+        bool connect(const char* device, const std::string& filter = DEFAULT_FILTER);
 
         /**
          * @brief Close connected file
@@ -95,7 +110,8 @@ namespace pcapReader {
         bool isConnected() const;
 
         /**
-         * @brief Attempt to read a packet and store data to buffer
+         * @brief Attempt to read a packet and append whatever stream data it makes
+         * available to the buffer
          * @return Result of read operation
          */
         ReadResult read();
@@ -104,14 +120,60 @@ namespace pcapReader {
         ~PcapDevice();
 
     private:
+        //! Identifies the TCP stream being reassembled
+        struct FlowKey
+        {
+            uint32_t saddr;
+            uint32_t daddr;
+            uint16_t source;
+            uint16_t dest;
+
+            bool operator==(const FlowKey& other) const
+            {
+                return saddr == other.saddr && daddr == other.daddr &&
+                       source == other.source && dest == other.dest;
+            }
+        };
+
+        /**
+         * @brief Feeds one TCP segment into the reassembly
+         * @param[in] seq Sequence number of the first payload byte
+         * @param[in] payload Start of the segment payload
+         * @param[in] length Number of payload bytes
+         */
+        void reassemble(uint32_t seq, const uint8_t* payload, size_t length);
+
+        /**
+         * @brief Appends the part of a segment that lies at or after m_nextSeq
+         * @return False if the segment starts after m_nextSeq and has to wait
+         */
+        bool append(uint32_t seq, const uint8_t* payload, size_t length);
+
+        //! Appends all pending segments that have become contiguous
+        void drainPending();
+
+        //! Continues with the earliest pending segment, giving up on the gap
+        void skipGap();
+
         //! Reference to raw data buffer to write to
         buffer_t& m_dataBuff;
         //! File handle to pcap file
         pcap_t* m_device{nullptr};
         bpf_program m_pktFilter{};
+        bool m_filterCompiled{false};
         char m_errBuff[BUFFSIZE]{};
-        char* m_deviceName;
-        buffer_t m_lastPkt;
+        std::string m_deviceName;
+        //! Bytes preceding the IP header, depending on the capture's link type
+        size_t m_linkHeaderLength{0};
+        //! Whether the stream to reassemble has been chosen yet
+        bool m_streamStarted{false};
+        FlowKey m_flow{};
+        //! Sequence number of the next byte expected
+        uint32_t m_nextSeq{0};
+        //! Segments received ahead of m_nextSeq, by sequence number
+        std::map<uint32_t, buffer_t> m_pending;
+        //! Packets of other TCP streams that passed the filter
+        size_t m_foreignPackets{0};
     };
 } // namespace pcapReader
 
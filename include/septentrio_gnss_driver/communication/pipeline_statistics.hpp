@@ -0,0 +1,278 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+// ROS includes
+#include <diagnostic_msgs/DiagnosticStatus.h>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/rx_message.hpp>
+
+#ifndef PIPELINE_STATISTICS_HPP
+#define PIPELINE_STATISTICS_HPP
+
+/**
+ * @file pipeline_statistics.hpp
+ * @date 14/10/26
+ * @brief Declares lock-free counters and latency histograms of the stages that
+ * bytes pass from the socket to the publisher
+ */
+
+namespace io_comm_rx {
+
+    //! Stages whose latencies are recorded
+    enum PipelineStage_Enum
+    {
+        //! The read handler, from the completion of the read until the bytes are
+        //! handed to the parser
+        evStageRead,
+        //! Time the bytes wait in the circular buffer for the parser
+        evStageBuffer,
+        //! Framing of one message, the CRC check included
+        evStageFrame,
+        //! CRC check of one SBF block
+        evStageCRC,
+        //! Time a message waits for its decode worker
+        evStageQueue,
+        //! Decoding of one message, publishing included
+        evStageDecode,
+        //! The publish() call of one ROS message
+        evStagePublish,
+        //! From the completion of the read until the message is published
+        evStageEndToEnd,
+        //! Number of entries above, not a stage itself
+        evStageCount
+    };
+
+    /**
+     * @class LatencyHistogram
+     * @brief Lock-free histogram of latencies in nanoseconds, with buckets of
+     * logarithmically growing width as in HdrHistogram
+     *
+     * Each power of two is split into SUB_BUCKETS buckets, so every latency is
+     * known to within 1 / SUB_BUCKETS (12.5 %) of its value. Recording is a single
+     * relaxed increment and may happen on any thread.
+     */
+    class LatencyHistogram
+    {
+    public:
+        //! Number of buckets each power of two is split into
+        static const std::size_t SUB_BUCKETS = 8;
+        //! Number of buckets covering all 64-bit latencies
+        static const std::size_t BUCKET_COUNT = (64 - 2) * SUB_BUCKETS;
+
+        /**
+         * @struct Snapshot
+         * @brief Counts taken from the histogram at once
+         */
+        struct Snapshot
+        {
+            //! Number of latencies recorded
+            uint64_t count;
+            //! Largest latency recorded in nanoseconds
+            uint64_t max_ns;
+            std::array<uint64_t, BUCKET_COUNT> buckets;
+
+            //! Upper bound in nanoseconds of the "quantile" (e.g. 0.99) of the
+            //! recorded latencies, 0 if there are none
+            uint64_t quantile(double quantile) const;
+        };
+
+        LatencyHistogram();
+
+        //! Records a latency of "ns" nanoseconds
+        void record(uint64_t ns)
+        {
+            buckets_[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+            uint64_t max = max_ns_.load(std::memory_order_relaxed);
+            while (ns > max && !max_ns_.compare_exchange_weak(
+                                   max, ns, std::memory_order_relaxed))
+                ;
+        }
+
+        //! Moves the counts recorded so far into "snapshot", such that each
+        //! snapshot covers the interval since the previous one
+        void drain(Snapshot& snapshot);
+
+        //! Bucket of latency "ns"
+        static std::size_t bucketOf(uint64_t ns);
+
+        //! Largest latency in nanoseconds that falls into "bucket"
+        static uint64_t upperBound(std::size_t bucket);
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_;
+        std::atomic<uint64_t> max_ns_;
+    };
+
+    /**
+     * @class PipelineStatistics
+     * @brief Counters per dispatch key and latency histograms per stage, recorded
+     * by the I/O, framing and decode threads without locking
+     *
+     * Counters are always kept. Latencies are only sampled once setTiming() has
+     * enabled them, as the clock is read a few times per message then. report()
+     * summarizes both into a DiagnosticStatus, rates and latencies covering the
+     * interval since the previous report.
+     */
+    class PipelineStatistics
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        PipelineStatistics();
+
+        //! Name of the SBF block, NMEA sentence or ROS message of "key", e.g.
+        //! "PVTGeodetic"
+        static const char* keyName(RxID_Enum key);
+
+        //! Enables or disables the sampling of latencies
+        void setTiming(bool timing) { timing_.store(timing); }
+
+        //! Whether latencies are to be sampled
+        bool timing() const { return timing_.load(std::memory_order_relaxed); }
+
+        //! Records that "stage" took from "start" until "end"
+        void recordStage(PipelineStage_Enum stage, Clock::time_point start,
+                         Clock::time_point end)
+        {
+            histograms_[stage].record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                    .count()));
+        }
+
+        /**
+         * @brief Sets the time at which the bytes now being parsed were read from
+         * the socket, the epoch of the clock for bytes read from files
+         *
+         * Only called by the framing thread, which passes it on with each message.
+         */
+        void setReceiveTime(Clock::time_point received) { received_ = received; }
+
+        //! Time at which the bytes now being parsed were read
+        Clock::time_point receiveTime() const { return received_; }
+
+        //! Counts a framed message of "key" with "bytes" bytes
+        void recordFrame(RxID_Enum key, std::size_t bytes)
+        {
+            add(keys_[key].frames, 1);
+            add(keys_[key].bytes, bytes);
+        }
+
+        //! Counts an SBF block of "key" that failed the CRC check
+        void recordCRCFailure(RxID_Enum key) { add(keys_[key].crc_failures, 1); }
+
+        //! Counts a message of "key" dropped since its decode worker was busy
+        void recordDrop(RxID_Enum key) { add(keys_[key].dropped, 1); }
+
+        //! Counts a header that had to be skipped
+        void recordResync() { add(resyncs_, 1); }
+
+        //! Counts "bytes" bytes dropped since the circular buffer was full
+        void recordBufferOverflow(std::size_t bytes)
+        {
+            add(buffer_overflows_, 1);
+            add(dropped_bytes_, bytes);
+        }
+
+        //! Raises the fill level high-water mark of the circular buffer to
+        //! "bytes", if that is more
+        void recordBufferFill(std::size_t bytes)
+        {
+            uint64_t high = buffer_high_water_mark_.load(std::memory_order_relaxed);
+            while (bytes > high &&
+                   !buffer_high_water_mark_.compare_exchange_weak(
+                       high, bytes, std::memory_order_relaxed))
+                ;
+        }
+
+        /**
+         * @brief Summarizes the counters and latencies into "status"
+         *
+         * Rates and latencies cover the interval since the previous call, calls
+         * must not overlap. The level is raised to WARN
+         * if anything was dropped or failed the CRC check in that interval.
+         * @param[out] status Its values are replaced, its name left as it is
+         */
+        void report(diagnostic_msgs::DiagnosticStatus& status);
+
+    private:
+        /**
+         * @struct KeyCounters
+         * @brief Counters of one dispatch key
+         */
+        struct KeyCounters
+        {
+            std::atomic<uint64_t> frames;
+            std::atomic<uint64_t> bytes;
+            std::atomic<uint64_t> crc_failures;
+            std::atomic<uint64_t> dropped;
+        };
+
+        //! Counters of a KeyCounters taken at the previous report
+        struct KeyTotals
+        {
+            uint64_t frames;
+            uint64_t bytes;
+            uint64_t crc_failures;
+            uint64_t dropped;
+        };
+
+        //! Each counter is written by a single thread, hence no read-modify-write
+        //! instruction is needed
+        static void add(std::atomic<uint64_t>& counter, uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value,
+                          std::memory_order_relaxed);
+        }
+
+        std::atomic<bool> timing_;
+        Clock::time_point received_;
+        std::array<LatencyHistogram, evStageCount> histograms_;
+        std::array<KeyCounters, evRxIDCount> keys_;
+        std::atomic<uint64_t> resyncs_;
+        std::atomic<uint64_t> buffer_overflows_;
+        std::atomic<uint64_t> dropped_bytes_;
+        std::atomic<uint64_t> buffer_high_water_mark_;
+
+        //! State of the previous report, only accessed by report()
+        std::array<KeyTotals, evRxIDCount> reported_;
+        uint64_t reported_overflows_;
+        Clock::time_point reported_at_;
+        //! Reused by report() for every stage
+        LatencyHistogram::Snapshot snapshot_;
+    };
+} // namespace io_comm_rx
+
+#endif // PIPELINE_STATISTICS_HPP
@@ -0,0 +1,258 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <atomic>
+#include <string>
+#include <vector>
+// Boost includes
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+// ROS includes
+#include <ros/message_traits.h>
+#include <ros/serialization.h>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/pipeline_statistics.hpp>
+#include <septentrio_gnss_driver/communication/rx_message.hpp>
+
+#ifndef PUBLISHER_REGISTRY_HPP
+#define PUBLISHER_REGISTRY_HPP
+
+/**
+ * @file publisher_registry.hpp
+ * @date 14/10/26
+ * @brief Declares the table of ROS publishers, one per output topic
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @struct MessageType
+     * @brief The ROS type of a serialized message, as a bag file records it
+     */
+    struct MessageType
+    {
+        const char* datatype;
+        const char* md5sum;
+        const char* definition;
+
+        //! Type of ROS message M
+        template <typename M>
+        static const MessageType& of()
+        {
+            static const MessageType type = {
+                ros::message_traits::DataType<M>::value(),
+                ros::message_traits::MD5Sum<M>::value(),
+                ros::message_traits::Definition<M>::value()};
+            return type;
+        }
+    };
+
+    /**
+     * @class MessageSink
+     * @brief Takes the messages of a PublisherRegistry in serialized form instead
+     * of roscpp, e.g. to write them to a bag file without a ROS master
+     */
+    class MessageSink
+    {
+    public:
+        virtual ~MessageSink() {}
+
+        /**
+         * @param[in] message_key The key the message is published under
+         * @param[in] stamp Time stamp of the message's header
+         * @param[in] type ROS type of the message
+         * @param[in] data Serialized message, without length prefix
+         * @param[in] size Number of bytes at "data"
+         */
+        virtual void write(RxID_Enum message_key, const ros::Time& stamp,
+                           const MessageType& type, const uint8_t* data,
+                           std::size_t size) = 0;
+    };
+
+    /**
+     * @class PublisherRegistry
+     * @brief Holds the ROS publisher of every output topic, indexed by the RxID_Enum
+     * of the message published on it
+     *
+     * Filled by ROSaicNode::defineMessages() before any data comes in, so the first
+     * message of a kind does not pay for advertise() in the middle of the stream.
+     * Whether a topic has subscribers is cached from roscpp's connect and
+     * disconnect callbacks, such that checking it costs no more than a load.
+     */
+    class PublisherRegistry
+    {
+    public:
+        PublisherRegistry() :
+            topics_(evRxIDCount), statistics_(nullptr), sink_(nullptr)
+        {
+        }
+
+        //! Reports the latency of each publish() call to "statistics", which must
+        //! outlive the registry, nullptr to stop reporting
+        void setStatistics(PipelineStatistics* statistics)
+        {
+            statistics_ = statistics;
+        }
+
+        //! Hands every message over to "sink", which must outlive the registry,
+        //! instead of publishing it, whether its topic is advertised or not;
+        //! nullptr to publish again
+        void setSink(MessageSink* sink) { sink_ = sink; }
+
+        /**
+         * @brief Advertises "topic" for messages of type M under "message_key",
+         * replacing any publisher advertised there before
+         * @param[in] message_key The key the decoder publishes under, e.g.
+         * evPVTGeodetic
+         * @param[in] topic The topic name, e.g. "/pvtgeodetic"
+         * @param[in] queue_size Outgoing message queue size of the topic
+         */
+        template <typename M>
+        void advertise(RxID_Enum message_key, const std::string& topic,
+                       uint32_t queue_size)
+        {
+            boost::shared_ptr<Topic> entry(new Topic);
+            const ros::SubscriberStatusCallback refresh = boost::bind(
+                &PublisherRegistry::refresh, boost::weak_ptr<Topic>(entry));
+            const ros::Publisher publisher =
+                g_nh->advertise<M>(topic, queue_size, refresh, refresh);
+            {
+                // Subscribers in our process may have connected meanwhile, their
+                // callbacks not finding the publisher yet
+                boost::mutex::scoped_lock lock(entry->mutex);
+                entry->publisher = publisher;
+                entry->subscribed = publisher.getNumSubscribers() > 0;
+            }
+            topics_[message_key] = entry;
+        }
+
+        /**
+         * @brief Publishes "msg" on the topic advertised under "message_key", if
+         * any, or hands it over to the sink
+         *
+         * Handing over the shared pointer lets roscpp deliver it as is to
+         * subscribers in the same process, e.g. nodelets in our manager, and
+         * serialize it only for the others. The message must therefore not be
+         * modified once published.
+         * @param[in] message_key The key the topic was advertised under
+         * @param[in] msg The ROS message, must be of the advertised type
+         */
+        template <typename M>
+        void publish(RxID_Enum message_key, const boost::shared_ptr<M>& msg) const
+        {
+            if (sink_)
+            {
+                const ros::SerializedMessage serialized =
+                    ros::serialization::serializeMessage(*msg);
+                sink_->write(message_key, msg->header.stamp, MessageType::of<M>(),
+                             serialized.message_start,
+                             serialized.num_bytes -
+                                 (serialized.message_start - serialized.buf.get()));
+                return;
+            }
+            const Topic* topic = topics_[message_key].get();
+            if (!topic)
+                return;
+            const ros::Publisher& publisher = topic->publisher;
+            if (statistics_ && statistics_->timing())
+            {
+                const PipelineStatistics::Clock::time_point start =
+                    PipelineStatistics::Clock::now();
+                publisher.publish(msg);
+                statistics_->recordStage(evStagePublish, start,
+                                         PipelineStatistics::Clock::now());
+            } else
+                publisher.publish(msg);
+        }
+
+        //! Whether a topic has been advertised under "message_key"
+        bool isAdvertised(RxID_Enum message_key) const
+        {
+            return static_cast<bool>(topics_[message_key]);
+        }
+
+        //! Whether the topic advertised under "message_key" has subscribers, be
+        //! they in our process or not
+        bool hasSubscribers(RxID_Enum message_key) const
+        {
+            const Topic* topic = topics_[message_key].get();
+            return topic && topic->subscribed.load(std::memory_order_relaxed);
+        }
+
+        //! Unadvertises all topics
+        void shutdown()
+        {
+            for (const boost::shared_ptr<Topic>& topic : topics_)
+            {
+                if (topic)
+                    topic->publisher.shutdown();
+            }
+            topics_.assign(evRxIDCount, boost::shared_ptr<Topic>());
+        }
+
+    private:
+        /**
+         * @struct Topic
+         * @brief The publisher of one topic, shared by all copies of the registry
+         */
+        struct Topic
+        {
+            Topic() : subscribed(false) {}
+
+            ros::Publisher publisher;
+            //! Whether "publisher" has subscribers, as of the last connect or
+            //! disconnect
+            std::atomic<bool> subscribed;
+            //! Guards "publisher" against the callbacks while it is filed
+            boost::mutex mutex;
+        };
+
+        //! Updates the cached subscriber state of "topic", called back by roscpp
+        //! on the queue of g_nh whenever a subscriber connects or disconnects
+        static void refresh(const boost::weak_ptr<Topic>& topic)
+        {
+            const boost::shared_ptr<Topic> entry = topic.lock();
+            if (!entry)
+                return;
+            boost::mutex::scoped_lock lock(entry->mutex);
+            entry->subscribed = entry->publisher.getNumSubscribers() > 0;
+        }
+
+        //! Topics indexed by RxID_Enum, null where nothing is advertised
+        std::vector<boost::shared_ptr<Topic>> topics_;
+        PipelineStatistics* statistics_;
+        MessageSink* sink_;
+    };
+} // namespace io_comm_rx
+
+#endif // PUBLISHER_REGISTRY_HPP
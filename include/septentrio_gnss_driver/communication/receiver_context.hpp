@@ -0,0 +1,167 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Boost includes
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+// ROS includes
+#include <diagnostic_msgs/DiagnosticStatus.h>
+#include <ros/time.h>
+
+#ifndef RECEIVER_CONTEXT_HPP
+#define RECEIVER_CONTEXT_HPP
+
+/**
+ * @file receiver_context.hpp
+ * @date 14/10/26
+ * @brief Declares the state kept per Rx, such that several Rxs can be served by
+ * one process
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @struct DiagnosticsCache
+     * @brief The diagnostic_msgs::DiagnosticStatus of one Rx as last published,
+     * updated in place from the QualityInd, ReceiverStatus and ReceiverSetup blocks
+     *
+     * Only touched on the decode lane serving DiagnosticArray and ReceiverSetup,
+     * hence not guarded.
+     */
+    struct DiagnosticsCache
+    {
+        DiagnosticsCache() : setup_changed(false), published(false) {}
+
+        //! Level, name, message and hardware ID (the Rx serial number)
+        diagnostic_msgs::DiagnosticStatus status;
+        //! Raw QualityInd indicators other than the overall one, in block order
+        std::vector<uint16_t> indicators;
+        //! The indicators as published, rewritten only where they changed
+        std::vector<diagnostic_msgs::KeyValue> values;
+        //! Firmware version and antenna type, published behind the indicators
+        std::vector<diagnostic_msgs::KeyValue> setup_values;
+        //! Whether a ReceiverSetup block with new content has been retained since
+        //! hardware ID and setup_values were last filled in
+        bool setup_changed;
+        //! Whether a DiagnosticArray has been published yet
+        bool published;
+        //! Time stamp of the last DiagnosticArray published
+        ros::Time last_published;
+    };
+
+    /**
+     * @struct ReceiverContext
+     * @brief Settings and parser state of one Rx, shared by its CallbackHandlers
+     * (and all copies thereof), its Framer and the RxMessages it decodes
+     *
+     * The settings are set by the node before the connection is established, the
+     * rest is updated by the parser and decode threads of the Rx and waited on by
+     * the thread configuring it.
+     */
+    struct ReceiverContext
+    {
+        ReceiverContext() :
+            frame_id("gnss"), publish_gpst(true), publish_navsatfix(true),
+            publish_gpsfix(true), publish_pose(true), publish_diagnostics(true),
+            diagnostics_period_s(0.0), diagnostics_on_change(false),
+            lazy_decoding(false), response_received(false), cd_received(false),
+            read_cd(true), cd_count(0),
+            // Do-not-use values until the first PVTGeodetic block arrived
+            last_pvt_time((static_cast<uint64_t>(65535) << 32) | 4294967295u),
+            count_gpsfix(0)
+        {
+        }
+
+        //! The frame ID used in the header of every published ROS message
+        std::string frame_id;
+        //! Whether or not to publish the sensor_msgs::TimeReference message with
+        //! GPST
+        bool publish_gpst;
+        //! Whether or not to publish the sensor_msgs::NavSatFix message
+        bool publish_navsatfix;
+        //! Whether or not to publish the gps_common::GPSFix message
+        bool publish_gpsfix;
+        //! Whether or not to publish the geometry_msgs::PoseWithCovarianceStamped
+        //! message
+        bool publish_pose;
+        //! Whether or not to publish the diagnostic_msgs::DiagnosticArray message
+        bool publish_diagnostics;
+        //! Minimum period in seconds of receiver time between two DiagnosticArray
+        //! messages, 0 to publish one per epoch
+        double diagnostics_period_s;
+        //! Whether or not to publish DiagnosticArray messages only if the status
+        //! changed since the last one
+        bool diagnostics_on_change;
+        //! Whether or not to skip decoding, and assembling composites, for topics
+        //! without subscribers
+        bool lazy_decoding;
+
+        //! Mutex to control changes of "response_received"
+        boost::mutex response_mutex;
+        //! Whether the Rx replied to a command sent outside of a command script
+        bool response_received;
+        //! Condition variable complementing "response_mutex"
+        boost::condition_variable response_condition;
+        //! Mutex to control changes of "cd_received"
+        boost::mutex cd_mutex;
+        //! Whether the connection descriptor of a TCP connection was received
+        bool cd_received;
+        //! Condition variable complementing "cd_mutex"
+        boost::condition_variable cd_condition;
+        //! Whether or not connection descriptors are still expected, i.e. framed
+        //! rather than discarded
+        std::atomic<bool> read_cd;
+        //! Number of connection descriptors received on the current connection,
+        //! at most 3
+        std::atomic<uint32_t> cd_count;
+        //! Rx TCP port, e.g. IP10 or IP11, to which ROSaic is connected
+        std::string rx_tcp_port;
+
+        //! WNc (upper 32 bits) and TOW (lower 32 bits) of the latest PVTGeodetic
+        //! block, time stamps the NMEA GSA and GSV messages. Set as the block is
+        //! framed, since it may be decoded on another lane or not at all.
+        std::atomic<uint64_t> last_pvt_time;
+        //! Since DiagnosticArray needs ReceiverSetup, which is not sent every
+        //! epoch, the latest ReceiverSetup block is retained, exactly its length
+        std::vector<uint8_t> last_receiversetup;
+        //! The DiagnosticArray content last published
+        DiagnosticsCache diagnostics;
+        //! Number of times the gps_common::GPSFix message has been published
+        uint32_t count_gpsfix;
+    };
+} // namespace io_comm_rx
+
+#endif // RECEIVER_CONTEXT_HPP
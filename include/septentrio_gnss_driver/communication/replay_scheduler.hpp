@@ -0,0 +1,107 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/framer.hpp>
+
+#ifndef REPLAY_SCHEDULER_HPP
+#define REPLAY_SCHEDULER_HPP
+
+/**
+ * @file replay_scheduler.hpp
+ * @date 14/10/26
+ * @brief Declares the pacing of SBF/PCAP file replay
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @class ReplayScheduler
+     * @brief Holds back frames read from a file until they are due, according to the
+     * receiver time they carry and the replay rate
+     *
+     * Frames are scheduled against a steady clock relative to the first time stamp
+     * of the replay, so rounding errors and processing time do not accumulate. SBF
+     * blocks are paced by their TOW and week number; GGA sentences by their UTC
+     * time of day, but only as long as no SBF block has been seen. Jumps back in
+     * time or gaps longer than MAX_GAP_MS restart the schedule.
+     */
+    class ReplayScheduler
+    {
+    public:
+        //! Gaps in receiver time longer than this are not waited for
+        static const int64_t MAX_GAP_MS = 60000;
+
+        ReplayScheduler();
+
+        /**
+         * @brief Starts the schedule of a new file
+         * @param[in] rate Replay speed relative to receiver time, e.g. 1.0 for real
+         * time or 10.0 for ten times as fast; 0 (or less) replays as fast as
+         * possible
+         */
+        void start(double rate);
+
+        /**
+         * @brief Sleeps until the frame is due, returns immediately for frames that
+         * carry no usable time
+         * @param[in] data Start of the frame
+         * @param[in] frame The frame as found by the Framer
+         */
+        void pace(const uint8_t* data, const Frame& frame);
+
+    private:
+        /**
+         * @brief Sleeps until receiver time "time_ms" is due
+         * @param[in] time_ms Receiver time in milliseconds, on the time scale of the
+         * frames at hand
+         */
+        void paceTo(int64_t time_ms);
+
+        //! Replay speed, 0 for as fast as possible
+        double rate_;
+        //! Whether the anchors below are valid
+        bool started_;
+        //! Whether an SBF block has been seen, from then on SBF alone sets the pace
+        bool sbf_seen_;
+        //! Receiver time the schedule is anchored at
+        int64_t anchor_time_ms_;
+        //! Receiver time of the previous frame
+        int64_t last_time_ms_;
+        //! Wall-clock time at which anchor_time_ms_ was replayed
+        std::chrono::steady_clock::time_point anchor_wall_;
+    };
+} // namespace io_comm_rx
+
+#endif // REPLAY_SCHEDULER_HPP
@@ -109,10 +109,12 @@
 #endif
 
 // C++ libraries
+#include <atomic>
 #include <cassert> // for assert
 #include <cstddef>
 #include <map>
 #include <sstream>
+#include <vector>
 // Boost includes
 #include <boost/call_traits.hpp>
 #include <boost/format.hpp>
@@ -132,7 +134,11 @@
 #include <septentrio_gnss_driver/PVTGeodetic.h>
 #include <septentrio_gnss_driver/PosCovCartesian.h>
 #include <septentrio_gnss_driver/PosCovGeodetic.h>
+#include <septentrio_gnss_driver/communication/message_pool.hpp>
+#include <septentrio_gnss_driver/communication/receiver_context.hpp>
 #include <septentrio_gnss_driver/crc/crc.h>
+#include <septentrio_gnss_driver/packed_structs/block_view.hpp>
+#include <septentrio_gnss_driver/packed_structs/sbf_descriptors.hpp>
 #include <septentrio_gnss_driver/parsers/nmea_parsers/gpgga.hpp>
 #include <septentrio_gnss_driver/parsers/nmea_parsers/gpgsa.hpp>
 #include <septentrio_gnss_driver/parsers/nmea_parsers/gpgsv.hpp>
@@ -149,28 +155,9 @@
  */
 
 extern bool g_use_gnss_time;
-extern bool g_read_cd;
-extern uint32_t g_cd_count;
 extern uint32_t g_leap_seconds;
-extern bool g_channelstatus_has_arrived_gpsfix;
-extern bool g_measepoch_has_arrived_gpsfix;
-extern bool g_dop_has_arrived_gpsfix;
-extern bool g_pvtgeodetic_has_arrived_gpsfix;
-extern bool g_pvtgeodetic_has_arrived_navsatfix;
-extern bool g_pvtgeodetic_has_arrived_pose;
-extern bool g_poscovgeodetic_has_arrived_gpsfix;
-extern bool g_poscovgeodetic_has_arrived_navsatfix;
-extern bool g_poscovgeodetic_has_arrived_pose;
-extern bool g_velcovgeodetic_has_arrived_gpsfix;
-extern bool g_atteuler_has_arrived_gpsfix;
-extern bool g_atteuler_has_arrived_pose;
-extern bool g_attcoveuler_has_arrived_gpsfix;
-extern bool g_attcoveuler_has_arrived_pose;
-extern bool g_receiverstatus_has_arrived_diagnostics;
-extern bool g_qualityind_has_arrived_diagnostics;
 extern boost::shared_ptr<ros::NodeHandle> g_nh;
-extern const uint32_t g_ROS_QUEUE_SIZE;
-extern ros::Time g_unix_time;
+extern double g_replay_rate;
 extern bool g_read_from_sbf_log;
 extern bool g_read_from_pcap;
 
@@ -190,9 +177,11 @@ enum TypeOfPVT_Enum
     evPPP
 };
 
-//! Since switch only works with int (yet NMEA message IDs are strings), we need
-//! enum. Note drawbacks: No variable can have a name which is already in some
-//! enumeration, enums are not type safe etc..
+//! Numeric dispatch key for every SBF block, NMEA sentence (talker and sentence
+//! type) and composite ROS message handled by the driver. RxMessage resolves it
+//! once per message, CallbackHandlers indexes its handler table with it. Note
+//! drawbacks: No variable can have a name which is already in some enumeration,
+//! enums are not type safe etc..
 enum RxID_Enum
 {
     evNavSatFix,
@@ -204,6 +193,7 @@ enum RxID_Enum
     evGPGSV,
     evGLGSV,
     evGAGSV,
+    evGBGSV,
     evPVTCartesian,
     evPVTGeodetic,
     evPosCovCartesian,
@@ -218,9 +208,16 @@ enum RxID_Enum
     evDiagnosticArray,
     evReceiverStatus,
     evQualityInd,
-    evReceiverSetup
+    evReceiverSetup,
+    //! Any message without handler, e.g. an SBF block the driver does not decode
+    evUnknownMessage,
+    //! Number of entries above, not an identifier itself
+    evRxIDCount
 };
 
+//! Number of distinct SBF block numbers (13 bits)
+static const uint16_t SBF_BLOCK_NUMBER_COUNT = 8192;
+
 namespace io_comm_rx {
     /**
      * @brief Calculates the timestamp, in the Unix Epoch time format
@@ -228,11 +225,15 @@ namespace io_comm_rx {
      * "use_gnss" is true), or using the current time.
      * @param[in] tow (Time of Week) Number of milliseconds that elapsed since the
      * beginning of the current GPS week as transmitted by the SBF block
+     * @param[in] wnc The GPS week number as transmitted by the SBF block
      * @param[in] use_gnss If true, the TOW as transmitted with the SBF block is
-     * used, otherwise the current time
+     * used, otherwise the current time. The current time is also used if TOW or
+     * WNc hold their do-not-use values.
      * @return ros::Time object containing seconds and nanoseconds since last epoch
      */
-    ros::Time timestampSBF(uint32_t tow, bool use_gnss);
+    ros::Time timestampSBF(uint32_t tow, uint16_t wnc, bool use_gnss);
+
+    class PublisherRegistry;
 
     /**
      * @class RxMessage
@@ -250,12 +251,22 @@ namespace io_comm_rx {
          * no other C++ cast is capable of removing it (not even reinterpret_cast)
          * @param[in] data Pointer to the buffer that is about to be analyzed
          * @param[in] size Size of the buffer (as handed over by async_read_some)
-         */
-        RxMessage(const uint8_t* data, std::size_t& size) : data_(data), count_(size)
+         * @param[in] publishers The publishers decoded messages are sent out with
+         * @param[in] context The settings and parser state of the Rx the message
+         * stems from
+         * @param[in] epoch The blocks of the epoch that composite ROS messages
+         * such as GPSFix are built from, nullptr if none are to be built
+         */
+        RxMessage(const uint8_t* data, std::size_t& size,
+                  const PublisherRegistry& publishers, ReceiverContext& context,
+                  const BlockArena* epoch = nullptr) :
+            data_(data), count_(size), publishers_(&publishers),
+            context_(&context), epoch_(epoch)
         {
             found_ = false;
             crc_check_ = false;
             message_size_ = 0;
+            rx_id_ = identify();
         }
 
         //! Determines whether data_ points to the SBF block with ID "ID", e.g. 5003
@@ -279,8 +290,26 @@ namespace io_comm_rx {
         //! currently pointing at
         std::size_t messageSize();
         //! Returns the message ID of the message where data_ is pointing at at the
-        //! moment, SBF identifiers embellished with inverted commas, e.g. "5003"
+        //! moment, SBF identifiers embellished with inverted commas, e.g. "5003".
+        //! Meant for logging, dispatching relies on rxID().
         std::string messageID();
+        //! Returns a view of the ID of the NMEA message where data_ is pointing at,
+        //! e.g. "$GPGGA", without copying it
+        boost::string_view nmeaID();
+        //! Returns the 13-bit SBF block number, 0 if data_ does not point to SBF
+        uint16_t blockNumber();
+        //! Returns the dispatch key of the message as resolved at construction
+        RxID_Enum rxID() const { return rx_id_; }
+        //! Returns the number of SBF-derived ROS messages allocated so far by the
+        //! message pools, which stops growing once they are warm
+        static uint64_t messageAllocations();
+        //! Returns the dispatch key of SBF block "number", evUnknownMessage for
+        //! blocks the driver does not handle
+        static RxID_Enum sbfKey(uint16_t number)
+        {
+            return static_cast<RxID_Enum>(
+                sbf_id_table_[number & (SBF_BLOCK_NUMBER_COUNT - 1)]);
+        }
 
         /**
          * @brief Returns the count_ variable
@@ -330,10 +359,13 @@ namespace io_comm_rx {
         void next();
 
         /**
-         * @brief Performs the CRC check (if SBF) and publishes ROS messages
+         * @brief Decodes the message (the Framer already checked the CRC if SBF)
+         * and publishes ROS messages
+         * @param[in] message_key The handler's key, either rxID() or a composite
+         * ROS message such as evNavSatFix
          * @return True if read was successful, false otherwise
          */
-        bool read(std::string message_key, bool search = false);
+        bool read(RxID_Enum message_key, bool search = false);
 
         /**
          * @brief Whether or not a message has been found
@@ -352,86 +384,58 @@ namespace io_comm_rx {
         std::size_t count_;
 
         /**
-         * @brief Whether the CRC check as evaluated in the read() method was
-         * successful or not is stored here
+         * @brief Publishers of the output topics, owned by CallbackHandlers
          */
-        bool crc_check_;
+        const PublisherRegistry* publishers_;
 
         /**
-         * @brief Helps to determine size of response message / NMEA message / SBF
-         * block
+         * @brief Settings and parser state of the Rx, owned by CallbackHandlers
          */
-        std::size_t message_size_;
+        ReceiverContext* context_;
 
         /**
-         * @brief Number of times the gps_common::GPSFix message has been published
+         * @brief Blocks of the epoch composite ROS messages are built from, owned
+         * by the EpochAssembler of CallbackHandlers
          */
-        static uint32_t count_gpsfix_;
+        const BlockArena* epoch_;
 
         /**
-         * @brief Since NavSatFix etc. need PVTGeodetic, incoming PVTGeodetic blocks
-         * need to be stored
-         */
-        static PVTGeodetic last_pvtgeodetic_;
-
-        /**
-         * @brief Since NavSatFix etc. need PosCovGeodetic, incoming PosCovGeodetic
-         * blocks need to be stored
-         */
-        static PosCovGeodetic last_poscovgeodetic_;
-
-        /**
-         * @brief Since GPSFix etc. need AttEuler, incoming AttEuler blocks need to
-         * be stored
-         */
-        static AttEuler last_atteuler_;
-
-        /**
-         * @brief Since GPSFix etc. need AttCovEuler, incoming AttCovEuler blocks
-         * need to be stored
-         */
-        static AttCovEuler last_attcoveuler_;
-
-        /**
-         * @brief Since GPSFix needs ChannelStatus, incoming ChannelStatus blocks
-         * need to be stored
-         */
-        static ChannelStatus last_channelstatus_;
-
-        /**
-         * @brief Since GPSFix needs MeasEpoch (for SNRs), incoming MeasEpoch blocks
-         * need to be stored
-         */
-        static MeasEpoch last_measepoch_;
-
-        /**
-         * @brief Since GPSFix needs DOP, incoming DOP blocks need to be stored
+         * @brief Whether the CRC check as evaluated in the read() method was
+         * successful or not is stored here
          */
-        static DOP last_dop_;
+        bool crc_check_;
 
         /**
-         * @brief Since GPSFix needs VelCovGeodetic, incoming VelCovGeodetic blocks
-         * need to be stored
+         * @brief Helps to determine size of response message / NMEA message / SBF
+         * block
          */
-        static VelCovGeodetic last_velcovgeodetic_;
+        std::size_t message_size_;
 
         /**
-         * @brief Since DiagnosticArray needs ReceiverStatus, incoming ReceiverStatus
-         * blocks need to be stored
+         * @brief Dispatch key of the message data_ points to
          */
-        static ReceiverStatus last_receiverstatus_;
+        RxID_Enum rx_id_;
 
         /**
-         * @brief Since DiagnosticArray needs QualityInd, incoming QualityInd blocks
-         * need to be stored
+         * @brief Resolves the dispatch key: one table load for SBF blocks, a few
+         * byte comparisons of talker and sentence type for NMEA
          */
-        static QualityInd last_qualityind_;
+        RxID_Enum identify();
 
-        /**
-         * @brief Since DiagnosticArray needs ReceiverSetup, incoming ReceiverSetup
-         * blocks need to be stored
-         */
-        static ReceiverSetup last_receiversetup_;
+        //! Pools recycling the published messages, one per message type
+        static MessagePool<septentrio_gnss_driver::PVTCartesian> pvtcartesian_pool_;
+        static MessagePool<septentrio_gnss_driver::PVTGeodetic> pvtgeodetic_pool_;
+        static MessagePool<septentrio_gnss_driver::PosCovCartesian>
+            poscovcartesian_pool_;
+        static MessagePool<septentrio_gnss_driver::PosCovGeodetic>
+            poscovgeodetic_pool_;
+        static MessagePool<septentrio_gnss_driver::AttEuler> atteuler_pool_;
+        static MessagePool<septentrio_gnss_driver::AttCovEuler> attcoveuler_pool_;
+        static MessagePool<sensor_msgs::TimeReference> timereference_pool_;
+        static MessagePool<sensor_msgs::NavSatFix> navsatfix_pool_;
+        static MessagePool<gps_common::GPSFix> gpsfix_pool_;
+        static MessagePool<geometry_msgs::PoseWithCovarianceStamped> pose_pool_;
+        static MessagePool<diagnostic_msgs::DiagnosticArray> diagnosticarray_pool_;
 
         //! Shorthand for the map responsible for matching PVTGeodetic's Mode field
         //! to an enum value
@@ -443,72 +447,77 @@ namespace io_comm_rx {
          */
         static TypeOfPVTMap type_of_pvt_map;
 
-        //! Shorthand for the map responsible for matching ROS message identifiers to
-        //! an enum value
-        typedef std::map<std::string, RxID_Enum> RxIDMap;
+        /**
+         * @brief Looks up the type of PVT without modifying the map, which the
+         * decode lanes of all Rxs read concurrently
+         * @param[in] mode Mode field of PVTGeodetic, of which the first four bits
+         * tell the type
+         * @return The type of PVT, evNoPVT for modes not listed
+         */
+        static TypeOfPVT_Enum typeOfPVT(uint8_t mode);
 
         /**
-         * @brief All instances of the RxMessage class shall have access to the map
-         * without reinitializing it, hence static
+         * @brief Flat table from SBF block number to dispatch key, shared by all
+         * instances of the RxMessage class, hence static
          *
-         * This map is for mapping ROS message, SBF and NMEA identifiers to an
-         * enumeration and makes the switch-case formalism in rx_message.hpp more
-         * explicit.
+         * Stored as uint8_t to keep it within 8 KB, entries not decoded by the
+         * driver hold evUnknownMessage.
          */
-        static RxIDMap rx_id_map;
+        static const uint8_t* sbf_id_table_;
 
         /**
          * @brief Callback function when reading PVTCartesian blocks
-         * @param[in] data The (packed and aligned) struct instance used to populate
-         * the ROS message PVTCartesian
+         * @param[in] data View of the block, decoded into the ROS message
+         * PVTCartesian
          * @return A smart pointer to the ROS message PVTCartesian just created
          */
         septentrio_gnss_driver::PVTCartesianPtr
-        PVTCartesianCallback(PVTCartesian& data);
+        PVTCartesianCallback(const BlockView<PVTCartesian>& data);
 
         /**
          * @brief Callback function when reading PVTGeodetic blocks
-         * @param[in] data The (packed and aligned) struct instance used to populate
-         * the ROS message PVTGeodetic
+         * @param[in] data View of the block, decoded into the ROS message
+         * PVTGeodetic
          * @return A smart pointer to the ROS message PVTGeodetic just created
          */
         septentrio_gnss_driver::PVTGeodeticPtr
-        PVTGeodeticCallback(PVTGeodetic& data);
+        PVTGeodeticCallback(const BlockView<PVTGeodetic>& data);
 
         /**
          * @brief Callback function when reading PosCovCartesian blocks
-         * @param[in] data The (packed and aligned) struct instance used to populate
-         * the ROS message PosCovCartesian
+         * @param[in] data View of the block, decoded into the ROS message
+         * PosCovCartesian
          * @return A smart pointer to the ROS message PosCovCartesian just created
          */
         septentrio_gnss_driver::PosCovCartesianPtr
-        PosCovCartesianCallback(PosCovCartesian& data);
+        PosCovCartesianCallback(const BlockView<PosCovCartesian>& data);
 
         /**
          * @brief Callback function when reading PosCovGeodetic blocks
-         * @param[in] data The (packed and aligned) struct instance used to populate
-         * the ROS message PosCovGeodetic
+         * @param[in] data View of the block, decoded into the ROS message
+         * PosCovGeodetic
          * @return A smart pointer to the ROS message PosCovGeodetic just created
          */
         septentrio_gnss_driver::PosCovGeodeticPtr
-        PosCovGeodeticCallback(PosCovGeodetic& data);
+        PosCovGeodeticCallback(const BlockView<PosCovGeodetic>& data);
 
         /**
          * @brief Callback function when reading AttEuler blocks
-         * @param[in] data The (packed and aligned) struct instance used to populate
-         * the ROS message AttEuler
+         * @param[in] data View of the block, decoded into the ROS message
+         * AttEuler
          * @return A smart pointer to the ROS message AttEuler just created
          */
-        septentrio_gnss_driver::AttEulerPtr AttEulerCallback(AttEuler& data);
+        septentrio_gnss_driver::AttEulerPtr
+        AttEulerCallback(const BlockView<AttEuler>& data);
 
         /**
          * @brief Callback function when reading AttCovEuler blocks
-         * @param[in] data The (packed and aligned) struct instance used to populate
-         * the ROS message AttCovEuler
+         * @param[in] data View of the block, decoded into the ROS message
+         * AttCovEuler
          * @return A smart pointer to the ROS message AttCovEuler just created
          */
         septentrio_gnss_driver::AttCovEulerPtr
-        AttCovEulerCallback(AttCovEuler& data);
+        AttCovEulerCallback(const BlockView<AttCovEuler>& data);
 
         /**
          * @brief "Callback" function when constructing NavSatFix messages
@@ -534,10 +543,13 @@ namespace io_comm_rx {
         /**
          * @brief "Callback" function when constructing
          * diagnostic_msgs::DiagnosticArray messages
+         * @param[in] stamp Time stamp of the epoch
          * @return A smart pointer to the ROS message
-         * diagnostic_msgs::DiagnosticArray just created
+         * diagnostic_msgs::DiagnosticArray just created, nullptr if none is to
+         * be published yet as per diagnostics_period_s and diagnostics_on_change
          */
-        diagnostic_msgs::DiagnosticArrayPtr DiagnosticArrayCallback();
+        diagnostic_msgs::DiagnosticArrayPtr
+        DiagnosticArrayCallback(const ros::Time& stamp);
     };
 } // namespace io_comm_rx
 #endif // for RX_MESSAGE_HPP
@@ -0,0 +1,195 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/circular_buffer.hpp>
+
+#ifndef STREAM_RECORDER_HPP
+#define STREAM_RECORDER_HPP
+
+/**
+ * @file stream_recorder.hpp
+ * @date 14/10/26
+ * @brief Declares a tap that records the raw byte stream from the Rx into
+ * rotating files, off the I/O thread
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @struct RecordingSettings
+     * @brief Where and how the raw stream from the Rx is recorded
+     */
+    struct RecordingSettings
+    {
+        RecordingSettings() :
+            max_file_size(1024 * 1024 * 1024), max_file_duration_s(3600.0),
+            direct_io(false)
+        {
+        }
+        //! Directory the files are created in, recording is disabled if empty
+        std::string directory;
+        //! Name of the Rx, such that the files of several Rxs sharing a directory
+        //! can be told apart, empty for a single Rx
+        std::string name;
+        //! Size in bytes after which a new file is started, 0 for no limit
+        std::size_t max_file_size;
+        //! Seconds after which a new file is started, 0 for no limit
+        double max_file_duration_s;
+        //! Whether or not to bypass the page cache via O_DIRECT, such that
+        //! recording does not evict the pages of other processes. A trailing
+        //! partial block of ALIGNMENT bytes is then only written once completed or
+        //! when the recording stops.
+        bool direct_io;
+    };
+
+    /**
+     * @class StreamRecorder
+     * @brief Copies every chunk read from the Rx into files of the form
+     * <directory>/rx_[<name>_]YYYYMMDD_HHMMSS.sbf (UTC), starting a new one once the
+     * current one is too large or too old
+     *
+     * The I/O thread only copies the chunk into a lock-free queue, or drops and
+     * counts it if the queue is full, hence is never held up by the disk. A writer
+     * thread of its own drains the queue into a staging buffer and writes the
+     * latter in WRITE_SIZE blocks, or every FLUSH_PERIOD_MS when the stream is
+     * slow. Files are byte-exact copies of the stream, concatenating them in order
+     * yields a log that replays just like the live connection, given that nothing
+     * was dropped.
+     */
+    class StreamRecorder
+    {
+    public:
+        //! Bytes the queue between the I/O thread and the writer can hold
+        static const std::size_t QUEUE_CAPACITY = 1 << 24;
+        //! Bytes gathered before they are written, a multiple of ALIGNMENT
+        static const std::size_t WRITE_SIZE = 1 << 20;
+        //! Alignment of buffer, offsets and sizes of writes via O_DIRECT
+        static const std::size_t ALIGNMENT = 4096;
+        //! Milliseconds after which staged bytes are written even if fewer than
+        //! WRITE_SIZE
+        static const int64_t FLUSH_PERIOD_MS = 1000;
+
+        //! Starts the writer thread, files are created as data comes in
+        explicit StreamRecorder(const RecordingSettings& settings);
+
+        //! Writes whatever is still queued and staged, then closes the file
+        ~StreamRecorder();
+
+        /**
+         * @brief Queues a copy of "size" bytes at "data", followed by
+         * "wrapped_size" bytes at "wrapped", to be called by a single thread only
+         *
+         * The chunk is either queued as a whole or dropped, such that the files
+         * never contain a partial chunk.
+         */
+        void record(const uint8_t* data, std::size_t size,
+                    const uint8_t* wrapped = nullptr, std::size_t wrapped_size = 0)
+        {
+            if (queue_.capacity() - queue_.size() < size + wrapped_size)
+            {
+                queue_.recordDrop(size + wrapped_size);
+                return;
+            }
+            queue_.write(data, size);
+            if (wrapped_size > 0)
+                queue_.write(wrapped, wrapped_size);
+        }
+
+        //! Bytes written to files so far
+        uint64_t recordedBytes() const
+        {
+            return recorded_bytes_.load(std::memory_order_relaxed);
+        }
+
+        //! Bytes dropped so far since the queue was full or no file could be
+        //! written
+        uint64_t droppedBytes() const
+        {
+            return queue_.droppedBytes() +
+                   lost_bytes_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        //! Body of the writer thread
+        void run();
+
+        //! Writes the bytes staged in buffer_ to the current file, opening or
+        //! rotating the latter as needed. Via O_DIRECT, a trailing partial
+        //! ALIGNMENT block is kept back for the next call unless "all" is set.
+        void flush(bool all);
+
+        //! Creates a new file, true if successful
+        bool open();
+
+        //! Closes the current file
+        void close();
+
+        //! Appends the first "bytes" bytes of buffer_ to the current file, true if
+        //! successful
+        bool writeOut(std::size_t bytes);
+
+        const RecordingSettings settings_;
+        //! Chunks copied by record(), drained by the writer thread
+        CircularBuffer queue_;
+        //! Staging buffer of WRITE_SIZE bytes, aligned to ALIGNMENT
+        uint8_t* buffer_;
+        //! Number of bytes in buffer_
+        std::size_t staged_;
+        //! File descriptor of the current file, -1 if none
+        int fd_;
+        //! Whether or not fd_ was opened with O_DIRECT
+        bool direct_;
+        std::string file_name_;
+        //! Bytes written to the current file
+        std::size_t file_size_;
+        //! When the current file was created
+        std::chrono::steady_clock::time_point opened_at_;
+        //! Bytes written so far, over all files
+        std::atomic<uint64_t> recorded_bytes_;
+        //! Bytes that were dequeued but could not be written
+        std::atomic<uint64_t> lost_bytes_;
+        std::atomic<bool> stopping_;
+        boost::shared_ptr<boost::thread> writer_thread_;
+    };
+} // namespace io_comm_rx
+
+#endif // STREAM_RECORDER_HPP
@@ -0,0 +1,94 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstddef>
+#include <cstdint>
+
+#ifndef SYNC_SCANNER_HPP
+#define SYNC_SCANNER_HPP
+
+/**
+ * @file sync_scanner.hpp
+ * @date 14/10/26
+ * @brief Declares a vectorized search for the first byte of message headers
+ */
+
+namespace io_comm_rx {
+
+    //! Kind of header that a '$' starts, depending on the byte that follows it
+    enum SyncKind_Enum
+    {
+        //! No header, e.g. a '$' within the payload of an SBF block
+        evNoSync,
+        //! "$@", an SBF block
+        evSBFSync,
+        //! "$G" or "$P", an NMEA sentence
+        evNMEASync,
+        //! "$R", a command reply
+        evResponseSync
+    };
+
+    /**
+     * @class SyncScanner
+     * @brief Finds candidate headers 16 (SSE2, NEON) or 32 (AVX2) bytes at a time
+     *
+     * All headers start with '$', connection descriptors with 'I'. find() skips
+     * the bytes that cannot start a header, classify() then tells from the
+     * second byte whether a '$' actually does, by a table lookup rather than a
+     * chain of comparisons. Without any of these instruction sets, find() falls
+     * back to memchr().
+     */
+    class SyncScanner
+    {
+    public:
+        /**
+         * @brief Looks for the first byte that may start a header
+         * @param[in] data Start of the bytes to be scanned
+         * @param[in] size Number of bytes available from data onwards
+         * @param[in] connection_descriptors Whether 'I' may start a header, too
+         * @return Offset of that byte with respect to data, size if there is none
+         */
+        static std::size_t find(const uint8_t* data, std::size_t size,
+                                bool connection_descriptors);
+
+        //! Kind of header that a '$' followed by "second" starts
+        static SyncKind_Enum classify(uint8_t second)
+        {
+            return static_cast<SyncKind_Enum>(kinds_[second]);
+        }
+
+    private:
+        //! SyncKind_Enum of each second byte, built once at startup
+        static const uint8_t* kinds_;
+    };
+} // namespace io_comm_rx
+
+#endif // SYNC_SCANNER_HPP
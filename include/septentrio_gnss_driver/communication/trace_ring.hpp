@@ -0,0 +1,196 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef TRACE_RING_HPP
+#define TRACE_RING_HPP
+
+/**
+ * @file trace_ring.hpp
+ * @date 14/10/26
+ * @brief Declares per-thread rings of fixed-size binary trace records, which
+ * replace the debug logging of the data path
+ */
+
+//! Set to 0 (CMake option ROSAIC_TRACE=OFF) to compile all trace points out
+#ifndef ROSAIC_TRACE
+#define ROSAIC_TRACE 1
+#endif
+
+#if ROSAIC_TRACE
+//! Records a trace event, if tracing is enabled at runtime
+#define ROSAIC_TRACE_EVENT(event, block, offset, size)                            \
+    io_comm_rx::TraceRing::record(event, block, offset, size)
+#else
+#define ROSAIC_TRACE_EVENT(event, block, offset, size) static_cast<void>(0)
+#endif
+
+namespace io_comm_rx {
+
+    //! Events recorded on the data path, the meaning of block, offset and size
+    //! given for each
+    enum TraceEvent_Enum
+    {
+        //! The read handler committed bytes to the circular buffer: -, bytes
+        //! buffered, bytes read
+        evTraceRead,
+        //! The circular buffer was full: -, -, bytes dropped
+        evTraceOverflow,
+        //! The parser is handed the parse window: -, -, bytes to be parsed
+        evTraceParse,
+        //! A message was framed: dispatch key, offset in the window, size
+        evTraceFrame,
+        //! A header had to be skipped: -, offset in the window, -
+        evTraceResync,
+        //! A command reply was framed: -, offset in the window, size
+        evTraceResponse,
+        //! A message failed to decode: dispatch key, -, size
+        evTraceDecodeError,
+        //! A message was dropped since its decode worker was busy: dispatch key,
+        //! -, size
+        evTraceDrop,
+        //! The replay waited for a frame to become due: -, nanoseconds waited, size
+        evTraceReplayWait,
+        //! Commands were sent to the Rx: -, number of commands, bytes
+        evTraceWrite,
+        //! Number of entries above, not an event itself
+        evTraceEventCount
+    };
+
+    /**
+     * @struct TraceRecord
+     * @brief One trace event, 24 bytes
+     */
+    struct TraceRecord
+    {
+        //! Steady clock time in nanoseconds
+        uint64_t time_ns;
+        //! TraceEvent_Enum
+        uint16_t event;
+        //! Dispatch key (RxID_Enum) of the message concerned, if any
+        uint16_t block;
+        uint32_t size;
+        uint64_t offset;
+    };
+
+    /**
+     * @class TraceRing
+     * @brief Keeps the last CAPACITY trace records of every thread
+     *
+     * Each thread writes into a ring of its own, allocated at its first record,
+     * such that recording takes neither a lock nor a read-modify-write
+     * instruction and never formats any text. Records are only turned into text
+     * by dump(), on demand or when the process crashes. As the rings keep being
+     * written meanwhile, the records of a thread that is busy while being dumped
+     * may be torn.
+     */
+    class TraceRing
+    {
+    public:
+        //! Records kept per thread, a power of two
+        static const std::size_t CAPACITY = 4096;
+        //! Threads beyond this number are not traced
+        static const std::size_t MAX_THREADS = 32;
+
+        //! Enables or disables recording at runtime, enabled by default
+        static void setEnabled(bool enabled) { enabled_.store(enabled); }
+
+        static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+        //! Appends an event to the ring of the calling thread
+        static void record(TraceEvent_Enum event, uint16_t block, uint64_t offset,
+                           uint32_t size)
+        {
+            if (!enabled())
+                return;
+            Ring* ring = ring_;
+            if (!ring && !(ring = attach()))
+                return;
+            const uint64_t head = ring->head.load(std::memory_order_relaxed);
+            TraceRecord& entry = ring->records[head & (CAPACITY - 1)];
+            entry.time_ns = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count());
+            entry.event = static_cast<uint16_t>(event);
+            entry.block = block;
+            entry.size = size;
+            entry.offset = offset;
+            ring->head.store(head + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Writes the records of all threads as text to "fd", one line per
+         * record and the oldest first within each thread
+         *
+         * Only calls async-signal-safe functions, hence may be called from a
+         * signal handler.
+         */
+        static void dump(int fd);
+
+        /**
+         * @brief Dumps the records to "path" upon SIGUSR1 and when the process
+         * is about to crash, i.e. upon SIGSEGV, SIGBUS, SIGFPE, SIGILL or SIGABRT
+         * @param[in] path File to be (re)created, at most 255 characters
+         */
+        static void installSignalHandlers(const std::string& path);
+
+    private:
+        /**
+         * @struct Ring
+         * @brief The records of one thread
+         */
+        struct Ring
+        {
+            //! Number of records written so far, only stored by the owning thread
+            std::atomic<uint64_t> head;
+            TraceRecord records[CAPACITY];
+        };
+
+        //! Allocates and registers the ring of the calling thread, nullptr if
+        //! MAX_THREADS rings exist already
+        static Ring* attach();
+
+        //! Ring of the calling thread, nullptr until its first record
+        static thread_local Ring* ring_;
+        //! All rings, never freed such that their threads may end any time
+        static std::atomic<Ring*> rings_[MAX_THREADS];
+        static std::atomic<std::size_t> ring_count_;
+        static std::atomic<bool> enabled_;
+    };
+} // namespace io_comm_rx
+
+#endif // TRACE_RING_HPP
@@ -75,6 +75,43 @@ extern "C" {
  */
 uint16_t FW_EXPORT compute16CCITT(const void* buf, size_t buf_length);
 
+//! Buffers at least this long are handed to the carry-less multiplication path by
+//! compute16CCITT(), if the CPU supports it, shorter ones to the slice-by-8 path
+#define CRC_CLMUL_MIN_LENGTH 64
+
+/**
+ * @brief Reference implementation of compute16CCITT(), one table lookup per byte
+ * @param[in] buf The buffer at hand
+ * @param[in] buf_length Number of bytes in "buf"
+ * @return The calculated CRC
+ */
+uint16_t FW_EXPORT compute16CCITTBytewise(const void* buf, size_t buf_length);
+
+/**
+ * @brief Slice-by-8 implementation of compute16CCITT(), 8 table lookups per 8 bytes
+ * without a dependency between them
+ * @param[in] buf The buffer at hand
+ * @param[in] buf_length Number of bytes in "buf"
+ * @return The calculated CRC
+ */
+uint16_t FW_EXPORT compute16CCITTSlice8(const void* buf, size_t buf_length);
+
+/**
+ * @brief Carry-less multiplication (PCLMULQDQ) implementation of compute16CCITT(),
+ * falls back to compute16CCITTSlice8() if the CPU lacks support or "buf" is shorter
+ * than 64 bytes
+ * @param[in] buf The buffer at hand
+ * @param[in] buf_length Number of bytes in "buf"
+ * @return The calculated CRC
+ */
+uint16_t FW_EXPORT compute16CCITTClmul(const void* buf, size_t buf_length);
+
+/**
+ * @brief Checks at runtime whether compute16CCITTClmul() can use PCLMULQDQ
+ * @return True if the carry-less multiplication path is available, false otherwise
+ */
+bool FW_EXPORT crc16ClmulAvailable(void);
+
 /**
  * @brief Validates whether the calculated CRC of the SBF block at hand matches the
  * CRC field of the streamed SBF block
@@ -79,8 +79,6 @@ extern bool g_publish_poscovgeodetic;
 extern bool g_publish_poscovcartesian;
 extern bool g_publish_atteuler;
 extern bool g_publish_attcoveuler;
-extern bool g_publish_gpst;
-extern bool g_publish_navsatfix;
 extern ros::Timer g_reconnect_timer_;
 extern boost::shared_ptr<ros::NodeHandle> g_nh;
 extern const uint32_t g_ROS_QUEUE_SIZE;
@@ -91,8 +89,6 @@ extern const uint32_t g_ROS_QUEUE_SIZE;
  * ROS parameters, ROS message publishing etc.
  */
 namespace rosaic_node {
-    //! Handles communication with the Rx
-    io_comm_rx::Comm_IO IO;
 
     /**
      * @brief Checks whether the parameter is in the given range
@@ -135,16 +131,17 @@ namespace rosaic_node {
 
     /**
      * @brief Gets an integer or unsigned integer value from the parameter server
+     * @param[in] nh The node handle the key is resolved in
      * @param[in] key The key to be used in the parameter server's dictionary
      * @param[out] u Storage for the retrieved value, of type U, which can be either
      * unsigned int or int
      * @return True if found, false if not found
      */
     template <typename U>
-    bool getROSInt(const std::string& key, U& u)
+    bool getROSInt(const ros::NodeHandle& nh, const std::string& key, U& u)
     {
         int param;
-        if (!g_nh->getParam(key, param))
+        if (!nh.getParam(key, param))
             return false;
         U min = std::numeric_limits<U>::lowest();
         U max = std::numeric_limits<U>::max();
@@ -161,6 +158,20 @@ namespace rosaic_node {
         return true;
     }
 
+    /**
+     * @brief Gets an integer or unsigned integer value from the parameter server,
+     * resolving the key in the private namespace of the node
+     * @param[in] key The key to be used in the parameter server's dictionary
+     * @param[out] u Storage for the retrieved value, of type U, which can be either
+     * unsigned int or int
+     * @return True if found, false if not found
+     */
+    template <typename U>
+    bool getROSInt(const std::string& key, U& u)
+    {
+        return getROSInt(*g_nh, key, u);
+    }
+
     /**
      * @brief Gets an integer or unsigned integer value from the parameter server
      * @param[in] key The key to be used in the parameter server's dictionary
@@ -177,17 +188,54 @@ namespace rosaic_node {
             u = default_val;
     }
 
+    /**
+     * @brief Reads the parameters kept in global variables from the parameter
+     * server, via g_nh, and sets up the trace rings
+     *
+     * Called once by both the executable and the nodelet before constructing
+     * ROSaicNode.
+     * @param[in] nodelet Whether we run as a nodelet, which leaves the signal
+     * handlers of the manager's process alone
+     */
+    void initializeGlobals(bool nodelet);
+
+    class ROSaicNode;
+
+    /**
+     * @brief Constructs one ROSaicNode per Rx named in the parameter "receivers",
+     * all of them sharing a pool of "io_threads" I/O threads, or a single unnamed
+     * one if that parameter is not set
+     * @return The nodes, serving their Rxs until destroyed
+     */
+    std::vector<boost::shared_ptr<ROSaicNode>> createNodes();
+
     /**
      * @class ROSaicNode
      * @brief This class represents the ROsaic node, to be extended..
+     *
+     * Every instance serves one Rx. Named instances publish their topics beneath
+     * /<name> and look up their parameters in the private namespace ~<name>
+     * first, falling back to the private namespace itself for those not set
+     * there.
      */
     class ROSaicNode
     {
     public:
         //! The constructor initializes and runs the ROSaic node, if everything works
         //! fine. It loads the user-defined ROS parameters, subscribes to Rx
-        //! messages, and publishes requested ROS messages...
-        ROSaicNode();
+        //! messages, and publishes requested ROS messages... It returns right
+        //! away, the Rx being configured on reconfiguration_thread_ once it is
+        //! connected, and anew whenever the connection is re-established.
+        //! @param[in] name The name of the Rx, empty if it is the only one
+        //! @param[in] pool The I/O threads, possibly shared with other Rxs, or
+        //! nullptr for a thread of its own
+        explicit ROSaicNode(
+            const std::string& name = std::string(),
+            const boost::shared_ptr<io_comm_rx::IoServicePool>& pool =
+                boost::shared_ptr<io_comm_rx::IoServicePool>());
+
+        //! Stops reconfiguration_thread_
+        ~ROSaicNode();
 
         /**
          * @brief Gets the node parameters from the ROS Parameter Server, parts of
@@ -226,16 +274,98 @@ namespace rosaic_node {
         void preparePCAPFileReading(std::string file_name);
 
         /**
-         * @brief Attempts to (re)connect every reconnect_delay_s_ seconds
+         * @brief Hands the Rx over to the AsyncManager of io_, which connects to it
+         * and reconnects whenever the connection is lost, backing off
+         * exponentially from reconnect_delay_s_ up to reconnect_delay_max_s_
+         */
+        void connect();
+
+    private:
+        //! Called by the AsyncManager of io_ whenever the connection has been
+        //! (re-)established, wakes up waitForConnection()
+        void connectionEstablished();
+
+        //! Publishes the counters and latencies of the pipeline together with the
+        //! state of the connection on /diagnostics, called by statistics_timer_
+        void publishStatistics(const ros::TimerEvent& event);
+
+        /**
+         * @brief Blocks until the connection has been established more often than
+         * "configured" times
+         * @param[in] configured Number of connections waited for so far
+         * @return The number of connections established so far
          */
-        void reconnect(const ros::TimerEvent& event);
+        uint32_t waitForConnection(uint32_t configured);
 
         /**
-         * @brief Calls the reconnect() method
+         * @brief Calls configureRx() after every (re)connection, run by
+         * reconfiguration_thread_
+         * @param[in] configured Number of connections configured so far
          */
-        void connect();
+        void reconfigure(uint32_t configured);
+
+        /**
+         * @brief Gets a parameter from the private namespace of the Rx, or from
+         * the private namespace of the node if it is not set there
+         * @param[in] key The key to be used in the parameter server's dictionary
+         * @param[out] value Storage for the retrieved value
+         * @param[in] default_value Value to use if neither namespace contains
+         * the parameter
+         * @return True if found, false if not found
+         */
+        template <typename T>
+        bool param(const std::string& key, T& value, const T& default_value)
+        {
+            if (nh_ != g_nh && nh_->getParam(key, value))
+                return true;
+            return g_nh->param(key, value, default_value);
+        }
+
+        /**
+         * @brief Gets an integer or unsigned integer value like param() does
+         * @param[in] key The key to be used in the parameter server's dictionary
+         * @param[out] u Storage for the retrieved value, of type U, which can be
+         * either unsigned int or int
+         * @param[in] default_val Value to use if neither namespace contains the
+         * parameter
+         */
+        template <typename U>
+        void getROSInt(const std::string& key, U& u, U default_val)
+        {
+            if (nh_ != g_nh && rosaic_node::getROSInt(*nh_, key, u))
+                return;
+            if (!rosaic_node::getROSInt(key, u))
+                u = default_val;
+        }
+
+        /**
+         * @brief Advertises "topic" for ROS messages of type M, with the queue size
+         * given by the parameter queue_size/<topic>, g_ROS_QUEUE_SIZE by default
+         *
+         * The topic is moved beneath /<name> for named Rxs, except for
+         * /diagnostics, which is aggregated across all of them.
+         * @param[in] message_key The key the decoder publishes under
+         * @param[in] topic The topic name, e.g. "/pvtgeodetic"
+         */
+        template <typename M>
+        void advertise(RxID_Enum message_key, const std::string& topic)
+        {
+            uint32_t queue_size;
+            getROSInt("queue_size" + topic, queue_size, g_ROS_QUEUE_SIZE);
+            io_.handlers_.publishers_.advertise<M>(
+                message_key, topic == "/diagnostics" ? topic : topic_prefix_ + topic,
+                queue_size);
+        }
+
+        //! Name of the Rx, empty if it is the only one
+        std::string name_;
+        //! Private namespace of the Rx, g_nh itself if it is the only one
+        boost::shared_ptr<ros::NodeHandle> nh_;
+        //! Prepended to the topics of the Rx, "/<name>" or empty
+        std::string topic_prefix_;
+        //! Handles communication with the Rx
+        io_comm_rx::Comm_IO io_;
 
-    private:
         //! Device port
         std::string device_;
         //! Baudrate
@@ -245,17 +375,41 @@ namespace rosaic_node {
         //! In case of serial communication to Rx, rx_serial_port_ specifies Rx's
         //! serial port connected to, e.g. USB1 or COM1
         std::string rx_serial_port_;
-        //! Whether connecting to Rx was successful
-        bool connected_;
+        //! Number of times the connection to the Rx has been established
+        uint32_t connections_;
         //! Datum to be used
         std::string datum_;
         //! Polling period for PVT-related SBF blocks
         uint32_t polling_period_pvt_;
         //! Polling period for all other SBF blocks and NMEA messages
         uint32_t polling_period_rest_;
-        //! Delay in seconds between reconnection attempts to the connection type
-        //! specified in the parameter connection_type
+        //! Delay in seconds before the first reconnection attempt to the connection
+        //! type specified in the parameter connection_type, doubled after each
+        //! failed attempt
         float reconnect_delay_s_;
+        //! Upper bound in seconds of the delay between reconnection attempts
+        float reconnect_delay_max_s_;
+        //! Sizing and tuning of the stream to the Rx
+        io_comm_rx::StreamSettings stream_settings_;
+        //! Where and how the raw stream from the Rx is recorded
+        io_comm_rx::RecordingSettings recording_settings_;
+        //! Part of SBF logs that is replayed
+        io_comm_rx::ReplaySettings replay_settings_;
+        //! Seconds without incoming data after which the connection is deemed lost
+        //! and re-established, 0 to disable this watchdog
+        float watchdog_timeout_s_;
+        //! Period in seconds at which the pipeline statistics are published, 0 to
+        //! neither publish them nor sample latencies
+        float statistics_period_s_;
+        //! Publishes the pipeline statistics, see publishStatistics()
+        ros::Publisher statistics_publisher_;
+        //! Calls publishStatistics() every statistics_period_s_
+        ros::Timer statistics_timer_;
+        //! TCP port the Rx stream was sent to in PCAP captures
+        uint32_t pcap_port_;
+        //! BPF expression selecting the Rx stream in PCAP captures, overrides
+        //! pcap_port_ if not empty
+        std::string pcap_filter_;
         //! Marker-to-ARP offset in the eastward direction
         float delta_e_;
         //! Marker-to-ARP offset in the northward direction
@@ -291,8 +445,6 @@ namespace rosaic_node {
         //! Rx serial port, e.g. USB2, on which Rx receives the corrections (can't be
         //! the same as main connection unless localhost concept is used)
         std::string rx_input_corrections_serial_;
-        //! Our ROS timer governing the reconnection
-        ros::Timer reconnect_timer_;
         //! Whether (and at which rate) or not to send GGA to the NTRIP caster
         std::string send_gga_;
         //! Whether or not to publish the GGA message
@@ -318,6 +470,8 @@ namespace rosaic_node {
         bool publish_atteuler_;
         //! Whether or not to publish the septentrio_gnss_driver::AttCovEuler message
         bool publish_attcoveuler_;
+        //! Thread configuring the Rx anew whenever the connection was re-established
+        boost::thread reconfiguration_thread_;
         //! Since the configureRx() method should only be called once the connection
         //! was established, we need the threads to communicate this to each other.
         //! Associated mutex..
@@ -332,6 +486,9 @@ namespace rosaic_node {
         std::string tcp_port_;
         //! Whether yet-to-be-established connection to Rx will be serial or TCP
         bool serial_;
+        //! Time in milliseconds the Rx is given to answer the whole configuration
+        //! script sent by configureRx()
+        const static uint32_t COMMAND_TIMEOUT_MS_ = 10000;
     };
 } // namespace rosaic_node
 
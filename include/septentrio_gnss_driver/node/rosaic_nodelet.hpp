@@ -0,0 +1,69 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// ROS includes
+#include <nodelet/nodelet.h>
+// Boost includes
+#include <boost/shared_ptr.hpp>
+// ROSaic includes
+#include <septentrio_gnss_driver/node/rosaic_node.hpp>
+
+#ifndef ROSAIC_NODELET_HPP
+#define ROSAIC_NODELET_HPP
+
+/**
+ * @file rosaic_nodelet.hpp
+ * @date 14/10/26
+ * @brief Declares the nodelet wrapping the ROSaic node
+ */
+
+namespace rosaic_node {
+
+    /**
+     * @class ROSaicNodelet
+     * @brief Runs ROSaicNode inside a nodelet manager, so that consumers loaded into
+     * the same manager receive the published messages without serialization
+     *
+     * One nodelet serves all Rxs listed in its "receivers" parameter. The remaining
+     * driver state is global, hence a manager can host one ROSaicNodelet only.
+     */
+    class ROSaicNodelet : public nodelet::Nodelet
+    {
+    private:
+        //! Reads the parameters from the nodelet's private namespace and constructs
+        //! the nodes, whose constructors return without waiting for the Rxs
+        void onInit() override;
+
+        //! The ROSaic nodes, one per Rx
+        std::vector<boost::shared_ptr<ROSaicNode>> nodes_;
+    };
+} // namespace rosaic_node
+
+#endif // ROSAIC_NODELET_HPP
@@ -0,0 +1,375 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+// ROSaic includes
+#include <septentrio_gnss_driver/packed_structs/sbf_structs.hpp>
+
+#ifndef BLOCK_VIEW_HPP
+#define BLOCK_VIEW_HPP
+
+/**
+ * @file block_view.hpp
+ * @date 14/10/26
+ * @brief Declares length-aware views of SBF blocks and the arena that retains
+ * blocks of one epoch
+ */
+
+namespace io_comm_rx {
+
+    /**
+     * @struct BlockTraits
+     * @brief SBF block number of struct T and the number of its bytes that are
+     * accessed as struct fields
+     *
+     * Blocks made up of sub-blocks end in an array sized for the largest block
+     * possible, only their fixed part is accessed as fields, the sub-blocks via
+     * BlockView::subBlocks(). Fields appended by later revisions of a block are
+     * listed in BlockRevisions.
+     */
+    template <typename T>
+    struct BlockTraits;
+
+#define ROSAIC_BLOCK_TRAITS(T, ID, FIXED)                                           \
+    template <>                                                                     \
+    struct BlockTraits<T>                                                           \
+    {                                                                               \
+        static const uint16_t NUMBER = ID;                                          \
+        static const std::size_t FIXED_SIZE = FIXED;                                \
+    }
+
+    ROSAIC_BLOCK_TRAITS(PVTCartesian, 4006, sizeof(PVTCartesian));
+    ROSAIC_BLOCK_TRAITS(PVTGeodetic, 4007, sizeof(PVTGeodetic));
+    ROSAIC_BLOCK_TRAITS(PosCovCartesian, 5905, sizeof(PosCovCartesian));
+    ROSAIC_BLOCK_TRAITS(PosCovGeodetic, 5906, sizeof(PosCovGeodetic));
+    ROSAIC_BLOCK_TRAITS(AttEuler, 5938, sizeof(AttEuler));
+    ROSAIC_BLOCK_TRAITS(AttCovEuler, 5939, sizeof(AttCovEuler));
+    ROSAIC_BLOCK_TRAITS(ChannelStatus, 4013, offsetof(ChannelStatus, data));
+    ROSAIC_BLOCK_TRAITS(MeasEpoch, 4027, offsetof(MeasEpoch, data));
+    ROSAIC_BLOCK_TRAITS(DOP, 4001, sizeof(DOP));
+    ROSAIC_BLOCK_TRAITS(VelCovGeodetic, 5908, sizeof(VelCovGeodetic));
+    ROSAIC_BLOCK_TRAITS(ReceiverStatus, 4014, sizeof(ReceiverStatus));
+    ROSAIC_BLOCK_TRAITS(QualityInd, 4082, sizeof(QualityInd));
+    ROSAIC_BLOCK_TRAITS(ReceiverSetup, 5902, sizeof(ReceiverSetup));
+
+#undef ROSAIC_BLOCK_TRAITS
+
+    /**
+     * @struct BlockRevisions
+     * @brief Number of bytes of the fixed part of struct T that revision "rev" of
+     * the block defines
+     *
+     * By default every revision defines the whole fixed part. The revision is the
+     * upper three bits of the block ID, which RxMessage::blockNumber() masks off.
+     */
+    template <typename T>
+    struct BlockRevisions
+    {
+        static std::size_t size(uint8_t /* rev */)
+        {
+            return BlockTraits<T>::FIXED_SIZE;
+        }
+    };
+
+//! Revision 0 ends at field R0_END, revision 1 at R1_END, later ones define all
+#define ROSAIC_BLOCK_REVISIONS(T, R0_END, R1_END)                                   \
+    template <>                                                                     \
+    struct BlockRevisions<T>                                                        \
+    {                                                                               \
+        static std::size_t size(uint8_t rev)                                        \
+        {                                                                           \
+            static const std::size_t sizes[] = {offsetof(T, R0_END),                \
+                                                offsetof(T, R1_END)};               \
+            return rev < 2 ? sizes[rev] : BlockTraits<T>::FIXED_SIZE;               \
+        }                                                                           \
+    }
+
+    // NrBases and PPPInfo came with revision 1, Latency, HAccuracy, VAccuracy and
+    // Misc with revision 2
+    ROSAIC_BLOCK_REVISIONS(PVTCartesian, nr_bases, latency);
+    ROSAIC_BLOCK_REVISIONS(PVTGeodetic, nr_bases, latency);
+    // MarkerType came with revision 1, GNSSFWVersion with revision 2
+    ROSAIC_BLOCK_REVISIONS(ReceiverSetup, marker_type, gnss_fw_version);
+
+#undef ROSAIC_BLOCK_REVISIONS
+
+    //! Length of the SBF block at "data" according to its header, bounded by the
+    //! "size" bytes available
+    inline std::size_t blockLength(const uint8_t* data, std::size_t size)
+    {
+        if (size < sizeof(BlockHeader_t))
+            return size;
+        uint16_t length;
+        memcpy(&length, data + offsetof(BlockHeader_t, length), sizeof(length));
+        return std::min(size, static_cast<std::size_t>(length));
+    }
+
+    //! Revision of the SBF block at "data", 0 if its header is incomplete
+    inline uint8_t blockRevision(const uint8_t* data, std::size_t size)
+    {
+        if (size < sizeof(BlockHeader_t))
+            return 0;
+        uint16_t id;
+        memcpy(&id, data + offsetof(BlockHeader_t, id), sizeof(id));
+        return static_cast<uint8_t>(id >> 13);
+    }
+
+    /**
+     * @class SubBlockCursor
+     * @brief Walks the sub-blocks of an SBF block, never beyond its length
+     *
+     * Sub-blocks are as long as the block says, e.g. SB1Length, which may exceed
+     * the struct of an older firmware or fall short of it for a newer one. Each is
+     * copied into the struct, zero-padded if need be, so its fields are read
+     * without any further check or alignment concern.
+     */
+    class SubBlockCursor
+    {
+    public:
+        /**
+         * @param[in] data Start of the SBF block
+         * @param[in] length Length of the block, at most the bytes available
+         * @param[in] offset Offset of the first sub-block from the start of the
+         * block
+         */
+        SubBlockCursor(const uint8_t* data, std::size_t length, std::size_t offset) :
+            data_(data), length_(length), offset_(offset)
+        {
+        }
+
+        /**
+         * @brief Reads the sub-block of "size" bytes at the cursor into "sub_block"
+         * and advances past it
+         * @return False, leaving the cursor in place, if the sub-block is not part
+         * of the block
+         */
+        template <typename S>
+        bool read(std::size_t size, S& sub_block)
+        {
+            if (size == 0 || offset_ + size > length_)
+                return false;
+            if (size < sizeof(S))
+            {
+                memset(&sub_block, 0, sizeof(S));
+                memcpy(&sub_block, data_ + offset_, size);
+            } else
+                memcpy(&sub_block, data_ + offset_, sizeof(S));
+            offset_ += size;
+            return true;
+        }
+
+        //! Advances past "size" bytes, e.g. sub-blocks that are of no interest
+        void skip(std::size_t size) { offset_ += size; }
+
+    private:
+        const uint8_t* data_;
+        std::size_t length_;
+        //! Offset of the next sub-block from the start of the block
+        std::size_t offset_;
+    };
+
+    /**
+     * @class BlockView
+     * @brief Read-only view of an SBF block in place, e.g. in the I/O buffer
+     *
+     * Nothing beyond the block's length, as given by its header, is ever read. If
+     * the block is shorter than the fixed part of T, or its revision defines fewer
+     * fields, e.g. since it was sent by an older firmware, or if it is missing
+     * altogether, the fields it defines are copied and the rest padded with zeros
+     * instead. The viewed bytes have to outlive the view.
+     */
+    template <typename T>
+    class BlockView
+    {
+    public:
+        static const std::size_t FIXED_SIZE = BlockTraits<T>::FIXED_SIZE;
+
+        //! A missing block, all fields read zero
+        BlockView() : data_(nullptr), length_(0), revision_(0), padded_(true)
+        {
+            padding_.fill(0);
+        }
+
+        /**
+         * @param[in] data Start of the SBF block
+         * @param[in] size Number of bytes available at "data"
+         */
+        BlockView(const uint8_t* data, std::size_t size) :
+            data_(data), length_(data ? blockLength(data, size) : 0),
+            revision_(data ? blockRevision(data, size) : 0)
+        {
+            const std::size_t defined =
+                std::min(length_, BlockRevisions<T>::size(revision_));
+            padded_ = defined < FIXED_SIZE;
+            if (padded_)
+            {
+                padding_.fill(0);
+                if (defined > 0)
+                    memcpy(padding_.data(), data_, defined);
+            }
+        }
+
+        //! Whether the block is missing
+        bool empty() const { return length_ == 0; }
+
+        //! Length of the block in bytes, header included
+        std::size_t length() const { return length_; }
+
+        //! Revision of the block, 0 if it is missing
+        uint8_t revision() const { return revision_; }
+
+        //! The fixed part as raw bytes, e.g. to load fields at their offsets
+        const uint8_t* bytes() const { return padded_ ? padding_.data() : data_; }
+
+        const T* operator->() const { return reinterpret_cast<const T*>(bytes()); }
+
+        const T& operator*() const { return *operator->(); }
+
+        //! Cursor over the sub-blocks following the fixed part
+        SubBlockCursor subBlocks() const
+        {
+            return SubBlockCursor(data_, length_, FIXED_SIZE);
+        }
+
+        /**
+         * @brief Number of the "n" elements of "size" bytes, starting at "offset",
+         * that lie within the block, e.g. of an array with a count field
+         */
+        std::size_t fits(std::size_t offset, std::size_t size, std::size_t n) const
+        {
+            const std::size_t end = std::max(length_, padded_ ? FIXED_SIZE : 0);
+            if (offset >= end)
+                return 0;
+            return std::min(n, (end - offset) / size);
+        }
+
+    private:
+        //! Start of the block
+        const uint8_t* data_;
+        //! Length of the block, at most the number of bytes available
+        std::size_t length_;
+        //! Revision of the block
+        uint8_t revision_;
+        //! Whether the fixed part is read from padding_ rather than data_
+        bool padded_;
+        //! Zero-padded copy of a block too short for the fixed part of T
+        alignas(4) std::array<uint8_t, FIXED_SIZE> padding_;
+    };
+
+    /**
+     * @class BlockArena
+     * @brief Retains copies of the SBF blocks of one epoch in contiguous storage
+     *
+     * Only the length of each block is copied. The storage is reused, keeping its
+     * capacity, once the arena is cleared for the next epoch.
+     */
+    class BlockArena
+    {
+    public:
+        //! Drops all blocks, keeping the capacity
+        void clear()
+        {
+            bytes_.clear();
+            entries_.clear();
+        }
+
+        //! Copies the SBF block, replacing an earlier block with the same number
+        void store(const uint8_t* data, std::size_t size)
+        {
+            const std::size_t length = blockLength(data, size);
+            if (length < sizeof(BlockHeader_t))
+                return;
+            uint16_t number;
+            memcpy(&number, data + offsetof(BlockHeader_t, id), sizeof(number));
+            number &= 8191;
+            Entry entry = {number, bytes_.size(), length};
+            bytes_.insert(bytes_.end(), data, data + length);
+            for (std::size_t i = 0; i < entries_.size(); ++i)
+            {
+                if (entries_[i].number == number)
+                {
+                    entries_[i] = entry;
+                    return;
+                }
+            }
+            entries_.push_back(entry);
+        }
+
+        /**
+         * @brief Looks up the copy of SBF block "number"
+         * @param[out] length Length of the block, 0 if it is missing
+         * @return Start of the block, nullptr if it is missing
+         */
+        const uint8_t* find(uint16_t number, std::size_t& length) const
+        {
+            for (std::size_t i = 0; i < entries_.size(); ++i)
+            {
+                if (entries_[i].number == number)
+                {
+                    length = entries_[i].length;
+                    return bytes_.data() + entries_[i].offset;
+                }
+            }
+            length = 0;
+            return nullptr;
+        }
+
+        //! View of the copy of the block of type T, empty if it is missing
+        template <typename T>
+        BlockView<T> view() const
+        {
+            std::size_t length;
+            const uint8_t* data = find(BlockTraits<T>::NUMBER, length);
+            return BlockView<T>(data, length);
+        }
+
+    private:
+        //! Location of one block in bytes_
+        struct Entry
+        {
+            uint16_t number;
+            std::size_t offset;
+            std::size_t length;
+        };
+
+        //! The copied blocks, back to back
+        std::vector<uint8_t> bytes_;
+        //! One entry per block number, in order of arrival
+        std::vector<Entry> entries_;
+    };
+} // namespace io_comm_rx
+
+#endif // BLOCK_VIEW_HPP
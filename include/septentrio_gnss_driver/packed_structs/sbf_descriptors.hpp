@@ -0,0 +1,159 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+// ROSaic includes
+#include <septentrio_gnss_driver/packed_structs/block_view.hpp>
+
+#ifndef SBF_DESCRIPTORS_HPP
+#define SBF_DESCRIPTORS_HPP
+
+/**
+ * @file sbf_descriptors.hpp
+ * @date 15/10/26
+ * @brief Declares the field tables of the SBF blocks published as they are, from
+ * which their decoders are generated
+ *
+ * Each table lists the fields of the block's struct that are copied to the
+ * equally named fields of its ROS message, after the block and time header.
+ * Publishing a new block, e.g. INSNavGeod, takes its struct and BlockTraits, a
+ * table and one ROSAIC_BLOCK_DECODER line.
+ */
+
+#define ROSAIC_PVTCARTESIAN_FIELDS(FIELD, T)                                        \
+    FIELD(T, mode) FIELD(T, error) FIELD(T, x) FIELD(T, y) FIELD(T, z)              \
+    FIELD(T, undulation) FIELD(T, vx) FIELD(T, vy) FIELD(T, vz) FIELD(T, cog)      \
+    FIELD(T, rx_clk_bias) FIELD(T, rx_clk_drift) FIELD(T, time_system)             \
+    FIELD(T, datum) FIELD(T, nr_sv) FIELD(T, wa_corr_info) FIELD(T, reference_id)  \
+    FIELD(T, mean_corr_age) FIELD(T, signal_info) FIELD(T, alert_flag)             \
+    FIELD(T, nr_bases) FIELD(T, ppp_info) FIELD(T, latency) FIELD(T, h_accuracy)   \
+    FIELD(T, v_accuracy) FIELD(T, misc)
+
+#define ROSAIC_PVTGEODETIC_FIELDS(FIELD, T)                                         \
+    FIELD(T, mode) FIELD(T, error) FIELD(T, latitude) FIELD(T, longitude)          \
+    FIELD(T, height) FIELD(T, undulation) FIELD(T, vn) FIELD(T, ve) FIELD(T, vu)   \
+    FIELD(T, cog) FIELD(T, rx_clk_bias) FIELD(T, rx_clk_drift)                     \
+    FIELD(T, time_system) FIELD(T, datum) FIELD(T, nr_sv) FIELD(T, wa_corr_info)   \
+    FIELD(T, reference_id) FIELD(T, mean_corr_age) FIELD(T, signal_info)           \
+    FIELD(T, alert_flag) FIELD(T, nr_bases) FIELD(T, ppp_info) FIELD(T, latency)   \
+    FIELD(T, h_accuracy) FIELD(T, v_accuracy) FIELD(T, misc)
+
+#define ROSAIC_POSCOVCARTESIAN_FIELDS(FIELD, T)                                     \
+    FIELD(T, mode) FIELD(T, error) FIELD(T, cov_xx) FIELD(T, cov_yy)               \
+    FIELD(T, cov_zz) FIELD(T, cov_bb) FIELD(T, cov_xy) FIELD(T, cov_xz)            \
+    FIELD(T, cov_xb) FIELD(T, cov_yz) FIELD(T, cov_yb) FIELD(T, cov_zb)
+
+#define ROSAIC_POSCOVGEODETIC_FIELDS(FIELD, T)                                      \
+    FIELD(T, mode) FIELD(T, error) FIELD(T, cov_latlat) FIELD(T, cov_lonlon)       \
+    FIELD(T, cov_hgthgt) FIELD(T, cov_bb) FIELD(T, cov_latlon)                     \
+    FIELD(T, cov_lathgt) FIELD(T, cov_latb) FIELD(T, cov_lonhgt)                   \
+    FIELD(T, cov_lonb) FIELD(T, cov_hb)
+
+#define ROSAIC_ATTEULER_FIELDS(FIELD, T)                                            \
+    FIELD(T, nr_sv) FIELD(T, error) FIELD(T, mode) FIELD(T, heading)               \
+    FIELD(T, pitch) FIELD(T, roll) FIELD(T, pitch_dot) FIELD(T, roll_dot)          \
+    FIELD(T, heading_dot)
+
+#define ROSAIC_ATTCOVEULER_FIELDS(FIELD, T)                                         \
+    FIELD(T, error) FIELD(T, cov_headhead) FIELD(T, cov_pitchpitch)                \
+    FIELD(T, cov_rollroll) FIELD(T, cov_headpitch) FIELD(T, cov_headroll)          \
+    FIELD(T, cov_pitchroll)
+
+namespace io_comm_rx {
+
+    //! Loads the field of type F at "offset" of the raw block, whatever its
+    //! alignment
+    template <typename F>
+    inline F loadField(const uint8_t* block, std::size_t offset)
+    {
+        F value;
+        memcpy(&value, block + offset, sizeof(F));
+        return value;
+    }
+
+    /**
+     * @struct BlockDecoder
+     * @brief Copies the fields of SBF block T listed in its table to ROS message M
+     *
+     * The decoder is straight-line code, one load per field from the block's bytes
+     * as given by BlockView, which already zeroed what the block's length and
+     * revision leave undefined.
+     */
+    template <typename T>
+    struct BlockDecoder;
+
+#define ROSAIC_LOAD_FIELD(T, NAME)                                                  \
+    msg.NAME = loadField<decltype(T::NAME)>(data, offsetof(T, NAME));
+
+#define ROSAIC_LOAD_HEADER(T, NAME)                                                 \
+    msg.block_header.NAME = loadField<decltype(T::NAME)>(data, offsetof(T, NAME));
+
+#define ROSAIC_BLOCK_DECODER(T, FIELDS)                                             \
+    template <>                                                                     \
+    struct BlockDecoder<T>                                                          \
+    {                                                                               \
+        template <typename M>                                                       \
+        static void decode(const BlockView<T>& view, M& msg)                        \
+        {                                                                           \
+            const uint8_t* data = view.bytes();                                     \
+            ROSAIC_LOAD_HEADER(BlockHeader_t, sync_1)                               \
+            ROSAIC_LOAD_HEADER(BlockHeader_t, sync_2)                               \
+            ROSAIC_LOAD_HEADER(BlockHeader_t, crc)                                  \
+            ROSAIC_LOAD_HEADER(BlockHeader_t, id)                                   \
+            ROSAIC_LOAD_HEADER(BlockHeader_t, length)                               \
+            ROSAIC_LOAD_HEADER(T, tow)                                              \
+            ROSAIC_LOAD_HEADER(T, wnc)                                              \
+            FIELDS(ROSAIC_LOAD_FIELD, T)                                            \
+        }                                                                           \
+    }
+
+    ROSAIC_BLOCK_DECODER(PVTCartesian, ROSAIC_PVTCARTESIAN_FIELDS);
+    ROSAIC_BLOCK_DECODER(PVTGeodetic, ROSAIC_PVTGEODETIC_FIELDS);
+    ROSAIC_BLOCK_DECODER(PosCovCartesian, ROSAIC_POSCOVCARTESIAN_FIELDS);
+    ROSAIC_BLOCK_DECODER(PosCovGeodetic, ROSAIC_POSCOVGEODETIC_FIELDS);
+    ROSAIC_BLOCK_DECODER(AttEuler, ROSAIC_ATTEULER_FIELDS);
+    ROSAIC_BLOCK_DECODER(AttCovEuler, ROSAIC_ATTCOVEULER_FIELDS);
+
+#undef ROSAIC_BLOCK_DECODER
+#undef ROSAIC_LOAD_HEADER
+#undef ROSAIC_LOAD_FIELD
+
+    //! Fills ROS message "msg" with the SBF block viewed by "view"
+    template <typename T, typename M>
+    inline void decodeBlock(const BlockView<T>& view, M& msg)
+    {
+        BlockDecoder<T>::decode(view, msg);
+    }
+} // namespace io_comm_rx
+
+#endif // SBF_DESCRIPTORS_HPP
@@ -66,8 +66,6 @@
 #include <boost/make_shared.hpp>
 #include <septentrio_gnss_driver/Gpgsv.h>
 
-extern std::string g_frame_id;
-
 /**
  * @file gpgsv.hpp
  * @brief Derived class for parsing GSV messages
@@ -96,10 +94,12 @@ public:
     /**
      * @brief Parses one GSV message
      * @param[in] sentence The GSV message to be parsed
+     * @param[in] frame_id The frame ID of the message header
      * @return A ROS message pointer of ROS type nmea_msgs::GpgsvPtr
      */
     septentrio_gnss_driver::GpgsvPtr
-    parseASCII(const NMEASentence& sentence) noexcept(false) override;
+    parseASCII(const NMEASentence& sentence,
+               const std::string& frame_id) noexcept(false) override;
 
     /**
      * @brief Declares the string MESSAGE_ID
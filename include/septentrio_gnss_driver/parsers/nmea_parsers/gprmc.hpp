@@ -66,7 +66,6 @@
 #include <boost/make_shared.hpp>
 #include <septentrio_gnss_driver/Gprmc.h>
 
-extern std::string g_frame_id;
 extern bool g_use_gnss_time;
 
 /**
@@ -100,10 +99,12 @@ public:
     /**
      * @brief Parses one RMC message
      * @param[in] sentence The RMC message to be parsed
+     * @param[in] frame_id The frame ID of the message header
      * @return A ROS message pointer of ROS type septentrio_gnss_driver::GprmcPtr
      */
     septentrio_gnss_driver::GprmcPtr
-    parseASCII(const NMEASentence& sentence) noexcept(false) override;
+    parseASCII(const NMEASentence& sentence,
+               const std::string& frame_id) noexcept(false) override;
 
     /**
      * @brief Tells us whether the last RMC message was valid/usable or not
@@ -32,8 +32,10 @@
 #define NMEA_SENTENCE_HPP
 
 // C++ library includes
-#include <string>
-#include <vector>
+#include <array>
+#include <cstddef>
+// Boost includes
+#include <boost/utility/string_view.hpp>
 
 /**
  * @file nmea_sentence.hpp
@@ -44,27 +46,88 @@
 
 /**
  * @brief Struct to split an NMEA sentence into its ID and its body, the latter
- * tokenized into a vector of strings.
+ * tokenized into views of its comma-separated fields.
  *
  * By ID, we mean either a standardized ID, e.g. "$GPGGA", or proprietary ID such as
- * "$PSSN,HRP". The STL Container Vector can be used to dynamically allocate arrays
- * (C++ feature). Also note that the ID of !all! (not just those defined by
- * Septentrio) proprietary NMEA messages starts with "$P". The body_ member variable
- * shall exclude the NMEA checksum (also hinted at in files that implement the
+ * "$PSSN,HRP". Also note that the ID of !all! (not just those defined by
+ * Septentrio) proprietary NMEA messages starts with "$P". The sentence is split
+ * exactly once, at construction, without copying: ID and fields are
+ * boost::string_views into the caller's buffer, which hence has to outlive the
+ * NMEASentence. The body_ member variable includes the NMEA checksum as its last
+ * field, though it is not parsed (also hinted at in files that implement the
  * parsing).
  */
 class NMEASentence
 {
 public:
-    NMEASentence(std::string id, std::vector<std::string> body) :
-        id_(id), body_(body)
+    //! NMEA 0183 limits sentences to 82 characters, hence to fewer fields than this.
+    //! Surplus fields of overlong sentences are dropped.
+    static const std::size_t MAX_FIELDS = 64;
+
+    /**
+     * @class Body
+     * @brief Fixed-capacity sequence of the fields of an NMEA sentence
+     */
+    class Body
+    {
+    public:
+        typedef const boost::string_view* const_iterator;
+
+        Body() : size_(0) {}
+        std::size_t size() const { return size_; }
+        const boost::string_view& operator[](std::size_t index) const
+        {
+            return fields_[index];
+        }
+        const_iterator begin() const { return fields_.data(); }
+        const_iterator end() const { return fields_.data() + size_; }
+        //! Appends a field, returns false if the capacity is exhausted
+        bool push_back(boost::string_view field)
+        {
+            if (size_ == MAX_FIELDS)
+                return false;
+            fields_[size_++] = field;
+            return true;
+        }
+
+    private:
+        std::array<boost::string_view, MAX_FIELDS> fields_;
+        std::size_t size_;
+    };
+
+    /**
+     * @brief Splits the sentence at "data" into its ID and its fields
+     *
+     * The sentence ends at the first carriage return or line feed, or after "size"
+     * bytes. Fields are delimited by ',' and '*', and empty fields are kept.
+     * @param[in] data Pointer to the first character, i.e. '$', of the sentence
+     * @param[in] size Number of bytes that may be inspected
+     */
+    NMEASentence(const char* data, std::size_t size)
     {
+        std::size_t end = 0;
+        while (end < size && data[end] != '\r' && data[end] != '\n')
+            ++end;
+        std::size_t start = 0;
+        for (std::size_t pos = 0; pos <= end; ++pos)
+        {
+            if (pos == end || data[pos] == ',' || data[pos] == '*')
+            {
+                boost::string_view field(data + start, pos - start);
+                if (body_.size() == 0)
+                    id_ = field;
+                if (!body_.push_back(field))
+                    break;
+                start = pos + 1;
+            }
+        }
     }
-    std::vector<std::string> get_body() const { return body_; }
+    boost::string_view get_id() const { return id_; }
+    const Body& get_body() const { return body_; }
 
 protected:
-    std::string id_;
-    std::vector<std::string> body_;
+    boost::string_view id_;
+    Body body_;
 };
 
 #endif // NMEA_SENTENCE_HPP
@@ -121,9 +121,12 @@ public:
      * if there are any issues parsing the message.
      * @param[in] sentence The standardized NMEA sentence to convert, of type
      * NMEASentence
+     * @param[in] frame_id The frame ID of the message header, that of the Rx the
+     * sentence stems from
      * @return A valid ROS message pointer
      */
-    virtual T parseASCII(const NMEASentence& sentence) noexcept(false)
+    virtual T parseASCII(const NMEASentence& sentence,
+                         const std::string& frame_id) noexcept(false)
     {
         throw ParseException("ParseASCII not implemented.");
     };
@@ -36,6 +36,8 @@
 #include <cstdint> // C++ header, corresponds to <stdint.h> in C
 #include <ctime>   // C++ header, corresponds to <time.h> in C
 #include <string>  // C++ header, corresponds to <string.h> in C
+// Boost includes
+#include <boost/utility/string_view.hpp>
 // ROS includes
 #include <geometry_msgs/Quaternion.h>
 #include <ros/ros.h>
@@ -67,7 +69,7 @@ namespace parsing_utilities {
      * floating point number found in "string"
      * @return True if all went fine, false if not
      */
-    bool parseDouble(const std::string& string, double& value);
+    bool parseDouble(boost::string_view string, double& value);
 
     /**
      * @brief Converts a 4-byte-buffer into a float
@@ -88,7 +90,7 @@ namespace parsing_utilities {
      * floating point number found in "string"
      * @return True if all went fine, false if not
      */
-    bool parseFloat(const std::string& string, float& value);
+    bool parseFloat(boost::string_view string, float& value);
 
     /**
      * @brief Converts a 2-byte-buffer into a signed 16-bit integer
@@ -111,7 +113,7 @@ namespace parsing_utilities {
      * 10
      * @return True if all went fine, false if not
      */
-    bool parseInt16(const std::string& string, int16_t& value, int32_t base = 10);
+    bool parseInt16(boost::string_view string, int16_t& value, int32_t base = 10);
 
     /**
      * @brief Converts a 4-byte-buffer into a signed 32-bit integer
@@ -134,7 +136,7 @@ namespace parsing_utilities {
      * 10
      * @return True if all went fine, false if not
      */
-    bool parseInt32(const std::string& string, int32_t& value, int32_t base = 10);
+    bool parseInt32(boost::string_view string, int32_t& value, int32_t base = 10);
 
     /**
      * @brief Interprets the contents of "string" as a unsigned integer number of
@@ -150,7 +152,7 @@ namespace parsing_utilities {
      * 10
      * @return True if all went fine, false if not
      */
-    bool parseUInt8(const std::string& string, uint8_t& value, int32_t base = 10);
+    bool parseUInt8(boost::string_view string, uint8_t& value, int32_t base = 10);
 
     /**
      * @brief Converts a 2-byte-buffer into an unsigned 16-bit integer
@@ -173,7 +175,7 @@ namespace parsing_utilities {
      * 10
      * @return True if all went fine, false if not
      */
-    bool parseUInt16(const std::string& string, uint16_t& value, int32_t base = 10);
+    bool parseUInt16(boost::string_view string, uint16_t& value, int32_t base = 10);
 
     /**
      * @brief Converts a 4-byte-buffer into an unsigned 32-bit integer
@@ -196,7 +198,7 @@ namespace parsing_utilities {
      * 10
      * @return True if all went fine, false if not
      */
-    bool parseUInt32(const std::string& string, uint32_t& value, int32_t base = 10);
+    bool parseUInt32(boost::string_view string, uint32_t& value, int32_t base = 10);
 
     /**
      * @brief Converts UTC time from the without-colon-delimiter format to the
@@ -219,6 +221,46 @@ namespace parsing_utilities {
      */
     std::time_t convertUTCtoUnix(double utc_double);
 
+    //! Unix Epoch time of the GPS epoch 1980/01/06 00:00:00 UTC, in seconds
+    const int64_t GPS_EPOCH_UNIX_SECONDS = 315964800;
+    //! Milliseconds in a GPS week
+    const int64_t MS_PER_WEEK = 604800000;
+    //! Milliseconds in a day
+    const int64_t MS_PER_DAY = 86400000;
+
+    /**
+     * @brief Converts GPS week number and time of week to Unix Epoch time
+     *
+     * The conversion is carried out in integer nanoseconds, i.e. it is exact and
+     * neither allocates nor formats any strings.
+     * @param[in] wnc GPS week number, counted from the GPS epoch 1980/01/06
+     * @param[in] tow Time of week in milliseconds
+     * @param[in] leap_seconds Number of leap seconds GPS time is ahead of UTC time
+     * @return ros::Time object representing Unix Epoch time
+     */
+    ros::Time convertGPSWeekTOWToUnix(uint16_t wnc, uint32_t tow,
+                                      uint32_t leap_seconds);
+
+    /**
+     * @brief Converts UTC time from the without-colon-delimiter format to
+     * milliseconds since midnight
+     * @param[in] utc_double Represents UTC time in the without-colon-delimiter
+     * format, i.e. hhmmss.sss
+     * @return Milliseconds since midnight, rounded to the nearest millisecond
+     */
+    int64_t convertUTCDoubleToMilliseconds(double utc_double);
+
+    /**
+     * @brief Converts UTC time of day to Unix Epoch time, taking the date from the
+     * host computer
+     *
+     * The date ambiguity is resolved in the same way as in convertUTCtoUnix(), yet
+     * only via integer arithmetic and keeping the sub-second part.
+     * @param[in] ms_of_day UTC time in milliseconds since midnight
+     * @return ros::Time object representing Unix Epoch time
+     */
+    ros::Time convertUTCTimeOfDayToUnix(int64_t ms_of_day);
+
     /**
      * @brief Converts latitude or longitude from the DMS notation (in the
      * without-colon-delimiter format), to the pure degree notation
@@ -35,6 +35,8 @@
 #include <locale> // Merely for "isdigit()" function, also available in <cctype.h> C header..
 #include <stdint.h>
 #include <string>
+// Boost includes
+#include <boost/utility/string_view.hpp>
 
 /**
  * @file string_utilities.h
@@ -56,13 +58,16 @@ namespace string_utilities {
      * @brief Interprets the contents of "string" as a floating point number of type
      * double It stores the "string"'s value in "value" and returns whether or not
      * all went well.
+     *
+     * "string" need not be null-terminated, hence fields of an NMEA sentence can be
+     * converted in place.
      * @param[in] string The string whose content should be interpreted as a floating
      * point number
      * @param[out] value The double variable that should be overwritten by the
      * floating point number found in "string"
      * @return True if all went fine, false if not
      */
-    bool toDouble(const std::string& string, double& value);
+    bool toDouble(boost::string_view string, double& value);
 
     /**
      * @brief Interprets the contents of "string" as a floating point number of type
@@ -76,7 +81,7 @@ namespace string_utilities {
      * floating point number found in "string"
      * @return True if all went fine, false if not
      */
-    bool toFloat(const std::string& string, float& value);
+    bool toFloat(boost::string_view string, float& value);
 
     /**
      * @brief Interprets the contents of "string" as a floating point number of
@@ -91,7 +96,7 @@ namespace string_utilities {
      * @param[in] base The conversion assumes this base, here: decimal
      * @return True if all went fine, false if not
      */
-    bool toInt32(const std::string& string, int32_t& value, int32_t base = 10);
+    bool toInt32(boost::string_view string, int32_t& value, int32_t base = 10);
 
     /**
      * @brief Interprets the contents of "string" as a floating point number of
@@ -106,7 +111,7 @@ namespace string_utilities {
      * @param[in] base The conversion assumes this base, here: decimal
      * @return True if all went fine, false if not
      */
-    bool toUInt32(const std::string& string, uint32_t& value, int32_t base = 10);
+    bool toUInt32(boost::string_view string, uint32_t& value, int32_t base = 10);
 
     /**
      * @brief Interprets the contents of "string" as a floating point number of
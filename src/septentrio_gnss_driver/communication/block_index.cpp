@@ -0,0 +1,277 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+// Boost includes
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+// ROS includes
+#include <ros/ros.h>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/block_index.hpp>
+#include <septentrio_gnss_driver/communication/framer.hpp>
+
+/**
+ * @file block_index.cpp
+ * @date 15/10/26
+ * @brief Builds, stores and searches the sidecar index of SBF logs
+ */
+
+namespace io_comm_rx {
+
+    namespace {
+        //! Layout of the start of a sidecar file, followed by "count" entries
+        struct IndexHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint64_t log_size;
+            int64_t log_mtime;
+            uint32_t interval;
+            uint32_t count;
+        };
+
+        const char INDEX_MAGIC[4] = {'S', 'B', 'F', 'X'};
+        //! To be incremented whenever IndexHeader or Entry change
+        const uint32_t INDEX_VERSION = 1;
+        //! Below this size per thread, building on several threads does not pay
+        const std::size_t MIN_RANGE_SIZE = 1 << 22;
+        //! Do-not-use values of TOW and WNc
+        const uint32_t TOW_DO_NOT_USE = 4294967295U;
+        const uint16_t WNC_DO_NOT_USE = 65535;
+    } // namespace
+
+    bool BlockIndex::open(const std::string& file_name, const uint8_t* data,
+                          std::size_t size, uint32_t interval, std::size_t threads)
+    {
+        struct stat file_stat;
+        int64_t mtime = 0;
+        if (stat(file_name.c_str(), &file_stat) == 0)
+            mtime = static_cast<int64_t>(file_stat.st_mtime);
+        const std::string index_name = sidecarName(file_name);
+        const bool loaded = load(index_name, size, mtime, interval);
+        if (loaded)
+        {
+            ROS_DEBUG("Loaded %li entries from %s", entries_.size(),
+                      index_name.c_str());
+        } else
+        {
+            build(data, size, interval, threads);
+            ROS_DEBUG("Built the index of %s, %li entries", file_name.c_str(),
+                      entries_.size());
+            if (!save(index_name, size, mtime))
+            {
+                ROS_WARN("Could not write the index %s, it will be built again on "
+                         "the next replay",
+                         index_name.c_str());
+            }
+        }
+        if (!ordered_)
+        {
+            ROS_WARN("The time of %s jumps backwards, e.g. after a reset of the Rx, "
+                     "such that replaying by time may include more than asked for",
+                     file_name.c_str());
+        }
+        return loaded;
+    }
+
+    void BlockIndex::build(const uint8_t* data, std::size_t size, uint32_t interval,
+                           std::size_t threads)
+    {
+        interval_ = std::max(interval, static_cast<uint32_t>(1));
+        entries_.clear();
+        std::size_t ranges = std::max(
+            std::min(threads, size / MIN_RANGE_SIZE), static_cast<std::size_t>(1));
+        // Each range is framed on its own from its first sync onwards. Since a
+        // range only takes the blocks starting before its end, and the next one
+        // resyncs to the block straddling that end, every block is taken once.
+        std::vector<std::vector<Entry>> range_entries(ranges);
+        boost::thread_group workers;
+        for (std::size_t i = 0; i < ranges; ++i)
+        {
+            workers.create_thread(boost::bind(
+                &BlockIndex::buildRange, data, size, size / ranges * i,
+                (i + 1 == ranges) ? size : size / ranges * (i + 1), interval_,
+                &range_entries[i]));
+        }
+        workers.join_all();
+        for (const std::vector<Entry>& entries : range_entries)
+            entries_.insert(entries_.end(), entries.begin(), entries.end());
+        ordered_ = isOrdered(entries_);
+    }
+
+    void BlockIndex::buildRange(const uint8_t* data, std::size_t size,
+                                std::size_t begin, std::size_t end,
+                                uint32_t interval, std::vector<Entry>* entries)
+    {
+        Framer framer;
+        Frame frame;
+        std::size_t pos = begin;
+        uint32_t count = 0;
+        while (pos < end)
+        {
+            const FramerResult_Enum result =
+                framer.next(data + pos, size - pos, frame);
+            if (result == evFrameNeedMore)
+                break;
+            if (result == evFrameResync)
+            {
+                pos += frame.offset + 1;
+                continue;
+            }
+            const std::size_t start = pos + frame.offset;
+            if (start >= end)
+                break;
+            pos = start + frame.size;
+            if (frame.type != evSBFFrame)
+                continue;
+            // Blocks without a valid time stamp cannot be sought to, the entry is
+            // then taken at the next block that has one
+            Entry entry;
+            memcpy(&entry.block_number, data + start + 4, sizeof(uint16_t));
+            memcpy(&entry.tow, data + start + 8, sizeof(entry.tow));
+            memcpy(&entry.wnc, data + start + 12, sizeof(entry.wnc));
+            const bool due = entries->empty() || count >= interval;
+            if (!due || entry.tow == TOW_DO_NOT_USE || entry.wnc == WNC_DO_NOT_USE)
+            {
+                ++count;
+                continue;
+            }
+            entry.offset = start;
+            entry.block_number &= 8191;
+            entries->push_back(entry);
+            count = 1;
+        }
+    }
+
+    std::size_t BlockIndex::startOffset(uint64_t gps_time) const
+    {
+        const auto before = [gps_time](const Entry& entry) {
+            return gpsTime(entry) < gps_time;
+        };
+        // Without order, the first entry in the log reaching gps_time is taken
+        std::vector<Entry>::const_iterator it =
+            ordered_ ? std::partition_point(entries_.begin(), entries_.end(), before)
+                     : std::find_if_not(entries_.begin(), entries_.end(), before);
+        if (it == entries_.begin())
+            return 0;
+        return static_cast<std::size_t>((it - 1)->offset);
+    }
+
+    std::size_t BlockIndex::endOffset(uint64_t gps_time, std::size_t size) const
+    {
+        const auto within = [gps_time](const Entry& entry) {
+            return gpsTime(entry) <= gps_time;
+        };
+        std::vector<Entry>::const_iterator it;
+        if (ordered_)
+            it = std::partition_point(entries_.begin(), entries_.end(), within);
+        else
+        {
+            // Without order, the replay stops at the first entry past gps_time
+            // that follows one within it, such that no block is missed
+            it = std::find_if(entries_.begin(), entries_.end(), within);
+            it = std::find_if_not(it, entries_.end(), within);
+        }
+        if (it == entries_.end())
+            return size;
+        return static_cast<std::size_t>(it->offset);
+    }
+
+    bool BlockIndex::load(const std::string& index_name, uint64_t log_size,
+                          int64_t log_mtime, uint32_t interval)
+    {
+        std::ifstream file(index_name, std::ios::binary);
+        IndexHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return false;
+        if (memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+            header.version != INDEX_VERSION || header.log_size != log_size ||
+            header.log_mtime != log_mtime || header.interval != interval)
+            return false;
+        // A damaged or foreign sidecar must not make us allocate whatever its
+        // count claims
+        const std::streampos start = file.tellg();
+        if (!file.seekg(0, std::ios::end))
+            return false;
+        const std::streamoff available = file.tellg() - start;
+        if (available < 0 || static_cast<uint64_t>(available) !=
+                                 static_cast<uint64_t>(header.count) * sizeof(Entry))
+            return false;
+        file.seekg(start);
+        std::vector<Entry> entries(header.count);
+        if (!file.read(reinterpret_cast<char*>(entries.data()),
+                       entries.size() * sizeof(Entry)))
+            return false;
+        interval_ = interval;
+        entries_.swap(entries);
+        ordered_ = isOrdered(entries_);
+        return true;
+    }
+
+    bool BlockIndex::isOrdered(const std::vector<Entry>& entries)
+    {
+        return std::is_sorted(entries.begin(), entries.end(),
+                              [](const Entry& lhs, const Entry& rhs) {
+                                  return gpsTime(lhs) < gpsTime(rhs);
+                              });
+    }
+
+    bool BlockIndex::save(const std::string& index_name, uint64_t log_size,
+                          int64_t log_mtime) const
+    {
+        IndexHeader header;
+        memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header.version = INDEX_VERSION;
+        header.log_size = log_size;
+        header.log_mtime = log_mtime;
+        header.interval = interval_;
+        header.count = static_cast<uint32_t>(entries_.size());
+        const std::string temp_name = index_name + ".tmp";
+        {
+            std::ofstream file(temp_name, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(entries_.data()),
+                       entries_.size() * sizeof(Entry));
+            if (!file.good())
+            {
+                file.close();
+                std::remove(temp_name.c_str());
+                return false;
+            }
+        }
+        return std::rename(temp_name.c_str(), index_name.c_str()) == 0;
+    }
+} // namespace io_comm_rx
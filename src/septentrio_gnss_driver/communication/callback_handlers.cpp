@@ -36,379 +36,218 @@
  * @brief Handles callbacks when reading NMEA/SBF messages
  */
 
-std::pair<std::string, uint32_t> gpsfix_pairs[] = {
-    std::make_pair("4013", 0), std::make_pair("4027", 1), std::make_pair("4001", 2),
-    std::make_pair("4007", 3), std::make_pair("5906", 4), std::make_pair("5908", 5),
-    std::make_pair("5938", 6), std::make_pair("5939", 7)};
-
-std::pair<std::string, uint32_t> navsatfix_pairs[] = {std::make_pair("4007", 0),
-                                                      std::make_pair("5906", 1)};
-
-std::pair<std::string, uint32_t> pose_pairs[] = {
-    std::make_pair("4007", 0), std::make_pair("5906", 1), std::make_pair("5938", 2),
-    std::make_pair("5939", 3)};
-
-std::pair<std::string, uint32_t> diagnosticarray_pairs[] = {
-    std::make_pair("4014", 0), std::make_pair("4082", 1)};
-
 namespace io_comm_rx {
     boost::mutex CallbackHandlers::callback_mutex_;
 
-    CallbackHandlers::GPSFixMap CallbackHandlers::gpsfix_map(gpsfix_pairs,
-                                                             gpsfix_pairs + 8);
-    CallbackHandlers::NavSatFixMap
-        CallbackHandlers::navsatfix_map(navsatfix_pairs, navsatfix_pairs + 2);
-    CallbackHandlers::PoseWithCovarianceStampedMap
-        CallbackHandlers::pose_map(pose_pairs, pose_pairs + 4);
-    CallbackHandlers::DiagnosticArrayMap
-        CallbackHandlers::diagnosticarray_map(diagnosticarray_pairs,
-                                              diagnosticarray_pairs + 2);
-
-    std::string CallbackHandlers::do_gpsfix_ = "4007";
-    std::string CallbackHandlers::do_navsatfix_ = "4007";
-    std::string CallbackHandlers::do_pose_ = "4007";
-    std::string CallbackHandlers::do_diagnostics_ = "4014";
+    CallbackHandlers::CallbackHandlers() :
+        callbackmap_(evRxIDCount), context_(new ReceiverContext),
+        statistics_(new PipelineStatistics),
+        pipeline_(new DecodePipeline(
+            g_decode_threads,
+            boost::bind(&CallbackHandlers::decode, this, _1, _2, _3, _4),
+            statistics_.get()))
+    {
+        framer_.setStatistics(statistics_.get());
+        framer_.setContext(context_.get());
+        publishers_.setStatistics(statistics_.get());
+    }
 
-    //! The for loop forwards to a ROS message specific handle if the latter was
-    //! added via callbackmap_.insert at some earlier point.
-    void CallbackHandlers::handle(RxMessage& rx_message)
+    void CallbackHandlers::dispatch(RxMessage& rx_message, RxID_Enum key)
     {
-        // Find the ROS message callback handler for the equivalent Rx message
-        // (SBF/NMEA) at hand & call it
-        boost::mutex::scoped_lock lock(callback_mutex_);
-        CallbackMap::key_type key = rx_message.messageID();
-        std::string ID_temp = rx_message.messageID();
-        if (!(ID_temp == "4013" || ID_temp == "4027" || ID_temp == "4001" ||
-              ID_temp == "5908" || ID_temp == "4014" || ID_temp == "4082" ||
-              ID_temp == "5902"))
-        // We only want to handle ChannelStatus, MeasEpoch, DOP, VelCovGeodetic,
-        // ReceiverStatus, QualityInd and ReceiverSetup blocks in case GPSFix and
-        // DiagnosticArray messages are to be published, respectively, see few lines
-        // below.
-        {
-            for (CallbackMap::iterator callback = callbackmap_.lower_bound(key);
-                 callback != callbackmap_.upper_bound(key); ++callback)
-            {
-                try
-                {
-                    callback->second->handle(rx_message, callback->first);
-                } catch (std::runtime_error& e)
-                {
-                    throw std::runtime_error(e.what());
-                }
-            }
-        }
-        // Call NavSatFix callback function if it was added
-        if (g_publish_navsatfix)
+        const CallbackList& callbacks = callbackmap_[key];
+        for (CallbackList::const_iterator callback = callbacks.begin();
+             callback != callbacks.end(); ++callback)
         {
-            CallbackMap::key_type key = "NavSatFix";
-            std::string ID_temp = rx_message.messageID();
-            if (ID_temp == do_navsatfix_)
-            // The last incoming block among PVTGeodetic and PosCovGeodetic triggers
-            // the publishing of NavSatFix.
-            {
-                for (CallbackMap::iterator callback = callbackmap_.lower_bound(key);
-                     callback != callbackmap_.upper_bound(key); ++callback)
-                {
-                    try
-                    {
-                        callback->second->handle(rx_message, callback->first);
-                    } catch (std::runtime_error& e)
-                    {
-                        throw std::runtime_error(e.what());
-                    }
-                }
-                do_navsatfix_ = std::string();
-            }
+            (*callback)->handle(rx_message, key);
         }
-        // Call geometry_msgs::PoseWithCovarianceStamped callback function if it was
-        // added
-        if (g_publish_pose)
+    }
+
+    void CallbackHandlers::submit(RxID_Enum key, const uint8_t* data,
+                                  std::size_t size, const BlockArena* epoch)
+    {
+        if (callbackmap_[key].empty())
+            return;
+        if (!wanted(key))
+            return;
+        // Files are replayed completely, live streams must not be held up
+        pipeline_->submit(key, data, size, epoch,
+                          g_read_from_sbf_log || g_read_from_pcap);
+    }
+
+    void CallbackHandlers::decode(RxID_Enum key, const uint8_t* data,
+                                  std::size_t size, const BlockArena* epoch)
+    {
+        RxMessage rx_message(data, size, publishers_, *context_, epoch);
+        dispatch(rx_message, key);
+    }
+
+    //! ReceiverSetup only has a handler if DiagnosticArray messages are to be
+    //! published, it merely retains the block. The blocks of composite ROS
+    //! messages are retained per epoch by the EpochAssembler instead.
+    void CallbackHandlers::handle(RxMessage& rx_message)
+    {
+        // Hand the Rx message (SBF/NMEA) over to the lane of the equivalent ROS
+        // message callback handler
+        const RxID_Enum id = rx_message.rxID();
+        const uint8_t* data = rx_message.getPosBuffer();
+        const std::size_t size = rx_message.getCount();
+        if (id == evPVTGeodetic)
         {
-            CallbackMap::key_type key = "PoseWithCovarianceStamped";
-            std::string ID_temp = rx_message.messageID();
-            if (ID_temp == do_pose_)
-            // The last incoming block among PVTGeodetic, PosCovGeodetic, AttEuler
-            // and AttCovEuler triggers the publishing of PoseWithCovarianceStamped.
-            {
-                for (CallbackMap::iterator callback = callbackmap_.lower_bound(key);
-                     callback != callbackmap_.upper_bound(key); ++callback)
-                {
-                    try
-                    {
-                        callback->second->handle(rx_message, callback->first);
-                    } catch (std::runtime_error& e)
-                    {
-                        throw std::runtime_error(e.what());
-                    }
-                }
-                do_pose_ = std::string();
-            }
+            const uint32_t tow = *(reinterpret_cast<const uint32_t*>(data + 8));
+            const uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data + 12));
+            context_->last_pvt_time = (static_cast<uint64_t>(wnc) << 32) | tow;
         }
-        // Call diagnostic_msgs::DiagnosticArray callback function if it was added
-        if (g_publish_diagnostics)
+        submit(id, data, size, nullptr);
+        // Call sensor_msgs::TimeReference (with GPST) callback function if it was
+        // added. If no new PVTGeodetic block is coming in, there is no need to
+        // publish sensor_msgs::TimeReference (with GPST) anew.
+        if (context_->publish_gpst && id == evPVTGeodetic)
         {
-            CallbackMap::key_type key1 = rx_message.messageID();
-            std::string ID_temp = rx_message.messageID();
-            if (ID_temp == "4014" || ID_temp == "4082" || ID_temp == "5902")
-            {
-                for (CallbackMap::iterator callback = callbackmap_.lower_bound(key1);
-                     callback != callbackmap_.upper_bound(key1); ++callback)
-                {
-                    try
-                    {
-                        callback->second->handle(rx_message, callback->first);
-                    } catch (std::runtime_error& e)
-                    {
-                        throw std::runtime_error(e.what());
-                    }
-                }
-            }
-            CallbackMap::key_type key2 = "DiagnosticArray";
-            if (ID_temp == do_diagnostics_)
-            // The last incoming block among ReceiverStatus, QualityInd and
-            // ReceiverSetup triggers the publishing of DiagnosticArray.
-            {
-                for (CallbackMap::iterator callback = callbackmap_.lower_bound(key2);
-                     callback != callbackmap_.upper_bound(key2); ++callback)
-                {
-                    try
-                    {
-                        callback->second->handle(rx_message, callback->first);
-                    } catch (std::runtime_error& e)
-                    {
-                        throw std::runtime_error(e.what());
-                    }
-                }
-                do_diagnostics_ = std::string();
-            }
+            submit(evGPST, data, size, nullptr);
         }
-        // Call sensor_msgs::TimeReference (with GPST) callback function if it was
-        // added
-        if (g_publish_gpst)
+    }
+
+    uint32_t CallbackHandlers::enabledComposites() const
+    {
+        uint32_t enabled = 0;
+        if (context_->publish_navsatfix && wanted(evNavSatFix))
+            enabled |= EpochAssembler::compositeBit(evNavSatFix);
+        if (context_->publish_pose && wanted(evPoseWithCovarianceStamped))
+            enabled |= EpochAssembler::compositeBit(evPoseWithCovarianceStamped);
+        if (context_->publish_diagnostics && wanted(evDiagnosticArray))
+            enabled |= EpochAssembler::compositeBit(evDiagnosticArray);
+        if (context_->publish_gpsfix && wanted(evGPSFix))
+            enabled |= EpochAssembler::compositeBit(evGPSFix);
+        return enabled;
+    }
+
+    void CallbackHandlers::flushEpochs()
+    {
+        epoch_assembler_.expireAll();
+        emitComposites(enabledComposites());
+        pipeline_->drain();
+    }
+
+    //! The composite is built from the blocks retained for its epoch, and time
+    //! stamped by its primary block.
+    void CallbackHandlers::emitComposites(uint32_t enabled)
+    {
+        EpochAssembler::Due due;
+        while (epoch_assembler_.next(enabled, due))
         {
-            CallbackMap::key_type key1 = "GPST";
-            std::string ID_temp = rx_message.messageID();
-            // If no new PVTGeodetic block is coming in, there is no need to publish
-            // sensor_msgs::TimeReference (with GPST) anew.
-            if (ID_temp == "4007")
-            {
-                for (CallbackMap::iterator callback = callbackmap_.lower_bound(key1);
-                     callback != callbackmap_.upper_bound(key1); ++callback)
-                {
-                    try
-                    {
-                        callback->second->handle(rx_message, callback->first);
-                    } catch (std::runtime_error& e)
-                    {
-                        throw std::runtime_error(e.what());
-                    }
-                }
-            }
+            submit(due.composite, due.primary, due.primary_size, &due.slot->blocks);
         }
-        // Call GPSFix callback function if it was added
-        if (g_publish_gpsfix)
+    }
+
+    std::size_t CallbackHandlers::readCallback(const uint8_t* data,
+                                               std::size_t size)
+    {
+        std::size_t pos = 0;
+        Frame frame;
+        // Read !all! (there might be many) complete messages in the buffer
+        const bool timing = statistics_->timing();
+        while (pos < size)
         {
-            std::string ID_temp = rx_message.messageID();
-            CallbackMap::key_type key1 = rx_message.messageID();
-            if (ID_temp == "4013" || ID_temp == "4027" || ID_temp == "4001" ||
-                ID_temp == "5908")
-            // Even though we are not interested in publishing ChannelStatus (4013),
-            // MeasEpoch (4027), DOP (4001) and VelCovGeodetic (5908) ROS messages,
-            // we have to save some contents of these incoming blocks in order to
-            // publish the GPSFix message.
+            const PipelineStatistics::Clock::time_point start =
+                timing ? PipelineStatistics::Clock::now()
+                       : PipelineStatistics::Clock::time_point();
+            FramerResult_Enum result = framer_.next(data + pos, size - pos, frame);
+            if (result == evFrameNeedMore)
             {
-                for (CallbackMap::iterator callback = callbackmap_.lower_bound(key1);
-                     callback != callbackmap_.upper_bound(key1); ++callback)
-                {
-                    try
-                    {
-                        callback->second->handle(rx_message, callback->first);
-                    } catch (std::runtime_error& e)
-                    {
-                        throw std::runtime_error(e.what());
-                    }
-                }
+                // Everything before frame.offset is garbage, the rest is handed
+                // over again once more bytes arrived
+                pos += frame.offset;
+                break;
             }
-            CallbackMap::key_type key2 = "GPSFix";
-            if (ID_temp == do_gpsfix_)
-            // The last incoming block among ChannelStatus (4013), MeasEpoch (4027),
-            // DOP (4001) and VelCovGeodetic (5908) triggers the publishing of
-            // GPSFix.
+            if (result == evFrameResync)
             {
-                for (CallbackMap::iterator callback = callbackmap_.lower_bound(key2);
-                     callback != callbackmap_.upper_bound(key2); ++callback)
-                {
-                    try
-                    {
-                        callback->second->handle(rx_message, callback->first);
-                    } catch (std::runtime_error& e)
-                    {
-                        throw std::runtime_error(e.what());
-                    }
-                }
-                do_gpsfix_ = std::string();
+                ROSAIC_TRACE_EVENT(evTraceResync, 0, pos + frame.offset, 0);
+                pos += frame.offset + 1;
+                continue;
             }
-        }
-    }
+            pos += frame.offset;
+            const uint8_t* frame_data = data + pos;
+            pos += frame.size;
+            // Pace file replay here, ahead of any decoding
+            if (timing)
+                statistics_->recordStage(evStageFrame, start,
+                                         PipelineStatistics::Clock::now());
+            if (g_read_from_sbf_log || g_read_from_pcap)
+                replay_scheduler_.pace(frame_data, frame);
+            RxMessage rx_message(frame_data, frame.size, publishers_, *context_);
+            statistics_->recordFrame(rx_message.rxID(), frame.size);
+            ROSAIC_TRACE_EVENT(evTraceFrame, rx_message.rxID(), frame_data - data,
+                               frame.size);
 
-    void CallbackHandlers::readCallback(const uint8_t* data, std::size_t& size)
-    {
-        RxMessage rx_message(data, size);
-        // Read !all! (there might be many) messages in the buffer
-        while (rx_message.search() != rx_message.getEndBuffer() &&
-               rx_message.found())
-        {
-            // Print the found message (if NMEA) or just show messageID (if SBF)..
-            if (rx_message.isSBF())
+            switch (frame.type)
             {
-                std::size_t sbf_block_length;
-                std::string ID_temp = rx_message.messageID();
-                sbf_block_length =
-                    static_cast<std::size_t>(rx_message.getBlockLength());
-                ROS_DEBUG("ROSaic reading SBF block %s made up of %li bytes...",
-                          ID_temp.c_str(), sbf_block_length);
-                // If full message did not yet arrive, throw an error message.
-                if (sbf_block_length > rx_message.getCount())
-                {
-                    ROS_DEBUG(
-                        "Not a valid SBF block, parts of the SBF block are yet to be received. Ignore..");
-                    throw(
-                        static_cast<std::size_t>(rx_message.getPosBuffer() - data));
-                }
-                if (g_publish_gpsfix == true &&
-                    (ID_temp == "4013" || ID_temp == "4027" || ID_temp == "4001" ||
-                     ID_temp == "4007" || ID_temp == "5906" || ID_temp == "5908" ||
-                     ID_temp == "5938" || ID_temp == "5939"))
-                {
-                    std::vector<bool> gpsfix_vec = {
-                        g_channelstatus_has_arrived_gpsfix,
-                        g_measepoch_has_arrived_gpsfix,
-                        g_dop_has_arrived_gpsfix,
-                        g_pvtgeodetic_has_arrived_gpsfix,
-                        g_poscovgeodetic_has_arrived_gpsfix,
-                        g_velcovgeodetic_has_arrived_gpsfix,
-                        g_atteuler_has_arrived_gpsfix,
-                        g_attcoveuler_has_arrived_gpsfix};
-                    gpsfix_vec.erase(gpsfix_vec.begin() + gpsfix_map[ID_temp]);
-                    // Checks whether all entries in gpsfix_vec are true
-                    if (std::all_of(gpsfix_vec.begin(), gpsfix_vec.end(),
-                                    [](bool v) { return v; }) == true)
-                    {
-                        do_gpsfix_ = ID_temp;
-                    }
-                }
-                if (g_publish_navsatfix == true &&
-                    (ID_temp == "4007" || ID_temp == "5906"))
-                {
-                    std::vector<bool> navsatfix_vec = {
-                        g_pvtgeodetic_has_arrived_navsatfix,
-                        g_poscovgeodetic_has_arrived_navsatfix};
-                    navsatfix_vec.erase(navsatfix_vec.begin() +
-                                        navsatfix_map[ID_temp]);
-                    // Checks whether all entries in navsatfix_vec are true
-                    if (std::all_of(navsatfix_vec.begin(), navsatfix_vec.end(),
-                                    [](bool v) { return v; }) == true)
-                    {
-                        do_navsatfix_ = ID_temp;
-                    }
-                }
-                if (g_publish_pose == true &&
-                    (ID_temp == "4007" || ID_temp == "5906" || ID_temp == "5938" ||
-                     ID_temp == "5939"))
-                {
-                    std::vector<bool> pose_vec = {g_pvtgeodetic_has_arrived_pose,
-                                                  g_poscovgeodetic_has_arrived_pose,
-                                                  g_atteuler_has_arrived_pose,
-                                                  g_attcoveuler_has_arrived_pose};
-                    pose_vec.erase(pose_vec.begin() + pose_map[ID_temp]);
-                    // Checks whether all entries in pose_vec are true
-                    if (std::all_of(pose_vec.begin(), pose_vec.end(),
-                                    [](bool v) { return v; }) == true)
-                    {
-                        do_pose_ = ID_temp;
-                    }
-                }
-                if (g_publish_diagnostics == true &&
-                    (ID_temp == "4014" || ID_temp == "4082"))
+            case evSBFFrame:
+            {
+                handle(rx_message);
+                const uint32_t enabled = enabledComposites();
+                if (enabled)
                 {
-                    std::vector<bool> diagnostics_vec = {
-                        g_receiverstatus_has_arrived_diagnostics,
-                        g_qualityind_has_arrived_diagnostics};
-                    diagnostics_vec.erase(diagnostics_vec.begin() +
-                                          diagnosticarray_map[ID_temp]);
-                    // Checks whether all entries in diagnostics_vec are true
-                    if (std::all_of(diagnostics_vec.begin(), diagnostics_vec.end(),
-                                    [](bool v) { return v; }) == true)
-                    {
-                        do_diagnostics_ = ID_temp;
-                    }
+                    while (!epoch_assembler_.add(frame_data, frame.size,
+                                                 rx_message.rxID(), enabled))
+                        emitComposites(enabled);
+                    emitComposites(enabled);
                 }
+                break;
             }
-            if (rx_message.isNMEA())
+            case evNMEAFrame:
             {
-                boost::char_separator<char> sep("\r"); // Carriage Return (CR)
-                typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
-                std::size_t nmea_size = rx_message.messageSize();
-                // Syntax: new_string_name (const char* s, size_t n); size_t is
-                // either 2 or 8 bytes, depending on your system
-                std::string block_in_string(
-                    reinterpret_cast<const char*>(rx_message.getPosBuffer()),
-                    nmea_size);
-                tokenizer tokens(block_in_string, sep);
-                ROS_DEBUG(
-                    "The NMEA message contains %li bytes and is ready to be parsed. It reads: %s",
-                    nmea_size, (*tokens.begin()).c_str());
+                handle(rx_message);
+                break;
             }
-            if (rx_message.isResponse()) // If the response is not sent at once, only
-                                         // first part is ROS_DEBUG-printed
+            case evResponseFrame:
             {
-                std::size_t response_size = rx_message.messageSize();
-                std::string block_in_string(
-                    reinterpret_cast<const char*>(rx_message.getPosBuffer()),
-                    response_size);
-                ROS_DEBUG("The Rx's response contains %li bytes and reads:\n %s",
-                          response_size, block_in_string.c_str());
-                {
-                    boost::mutex::scoped_lock lock(g_response_mutex);
-                    g_response_received = true;
+                ROSAIC_TRACE_EVENT(evTraceResponse, 0, frame_data - data,
+                                   frame.size);
+                ROS_DEBUG("The Rx's response contains %li bytes and reads:\n %.*s",
+                          frame.size, static_cast<int>(frame.size),
+                          reinterpret_cast<const char*>(frame_data));
+                // Replies to a command script are reported by the latter
+                const boost::shared_ptr<CommandBatch> batch =
+                    boost::atomic_load(&command_batch_);
+                if (batch &&
+                    batch->match(reinterpret_cast<const char*>(frame_data),
+                                 frame.size))
+                    break;
+                {
+                    boost::mutex::scoped_lock lock(context_->response_mutex);
+                    context_->response_received = true;
                     lock.unlock();
-                    g_response_condition.notify_one();
+                    context_->response_condition.notify_one();
                 }
                 if (rx_message.isErrorMessage())
                 {
                     ROS_ERROR("Invalid command just sent to the Rx!");
                 }
-                continue;
+                break;
             }
-            if (rx_message.isConnectionDescriptor())
+            case evConnectionDescriptorFrame:
             {
-                std::string cd(
-                    reinterpret_cast<const char*>(rx_message.getPosBuffer()), 4);
-                g_rx_tcp_port = cd;
+                std::string cd(reinterpret_cast<const char*>(frame_data),
+                               frame.size);
                 ROS_INFO_COND(
-                    g_cd_count == 0,
+                    context_->cd_count == 0,
                     "The connection descriptor for the TCP connection is %s",
                     cd.c_str());
-                if (g_cd_count < 3)
-                    ++g_cd_count;
-                if (g_cd_count == 2)
-                {
-                    boost::mutex::scoped_lock lock(g_cd_mutex);
-                    g_cd_received = true;
+                if (context_->cd_count < 3)
+                    ++context_->cd_count;
+                if (context_->cd_count == 2)
+                {
+                    context_->read_cd = false;
+                    boost::mutex::scoped_lock lock(context_->cd_mutex);
+                    context_->rx_tcp_port = cd;
+                    context_->cd_received = true;
                     lock.unlock();
-                    g_cd_condition.notify_one();
+                    context_->cd_condition.notify_one();
                 }
-                continue;
+                break;
             }
-            try
-            {
-                handle(rx_message);
-            } catch (std::runtime_error& e)
-            {
-                ROS_DEBUG("Incomplete message: %s", e.what());
-                throw(static_cast<std::size_t>(rx_message.getPosBuffer() - data));
             }
         }
+        return pos;
     }
-} // namespace io_comm_rx
\ No newline at end of file
+} // namespace io_comm_rx
@@ -32,95 +32,125 @@
 
 /**
  * @file circular_buffer.cpp
- * @brief Defines a class for creating, writing and reading from a circular bufffer
+ * @brief Defines a class for creating, writing and reading from a lock-free
+ * single-producer/single-consumer circular bufffer
  * @date 25/09/20
  */
 
+namespace {
+    //! Smallest power of two that is not smaller than n
+    std::size_t roundUpToPowerOfTwo(std::size_t n)
+    {
+        std::size_t power = 1;
+        while (power < n)
+            power <<= 1;
+        return power;
+    }
+} // namespace
+
 CircularBuffer::CircularBuffer(std::size_t capacity) :
-    head_(0), tail_(0), size_(0), capacity_(capacity)
+    head_(0), tail_(0), capacity_(roundUpToPowerOfTwo(capacity)),
+    mask_(capacity_ - 1), data_(new uint8_t[capacity_]), high_water_mark_(0),
+    overflow_count_(0), dropped_bytes_(0)
+{
+}
+
+CircularBuffer::~CircularBuffer() { delete[] data_; }
+
+uint8_t* CircularBuffer::writeSpan(std::size_t& bytes)
 {
-    data_ = new uint8_t[capacity];
+    // head_ is ours, tail_ may only grow concurrently, which only frees space
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    std::size_t tail = tail_.load(std::memory_order_acquire);
+    std::size_t free_bytes = capacity_ - (head - tail);
+    std::size_t offset = head & mask_;
+    bytes = std::min(free_bytes, capacity_ - offset);
+    return data_ + offset;
 }
 
-//! The destructor frees memory (first line) and points the dangling pointer to NULL
-//! (second line).
-CircularBuffer::~CircularBuffer()
+uint8_t* CircularBuffer::writeSpans(std::size_t& bytes, uint8_t*& wrapped,
+                                    std::size_t& wrapped_bytes)
 {
-    delete[] data_;
-    data_ = NULL;
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    std::size_t tail = tail_.load(std::memory_order_acquire);
+    std::size_t free_bytes = capacity_ - (head - tail);
+    std::size_t offset = head & mask_;
+    bytes = std::min(free_bytes, capacity_ - offset);
+    // Whatever is free beyond the end of data_ continues at its start
+    wrapped = data_;
+    wrapped_bytes = free_bytes - bytes;
+    return data_ + offset;
 }
 
-std::size_t CircularBuffer::write(const uint8_t* data, std::size_t bytes)
+void CircularBuffer::commitWrite(std::size_t bytes)
 {
     if (bytes == 0)
-        return 0;
+        return;
+    std::size_t head = head_.load(std::memory_order_relaxed) + bytes;
+    head_.store(head, std::memory_order_release);
+    std::size_t fill = head - tail_.load(std::memory_order_relaxed);
+    if (fill > high_water_mark_.load(std::memory_order_relaxed))
+        high_water_mark_.store(fill, std::memory_order_relaxed);
+}
 
-    std::size_t capacity = capacity_;
-    std::size_t bytes_to_write = std::min(bytes, capacity - size_);
-    if (bytes_to_write != bytes)
+std::size_t CircularBuffer::write(const uint8_t* data, std::size_t bytes)
+{
+    std::size_t written = 0;
+    // At most two contiguous spans: up to the end of data_ and from its start
+    for (uint8_t i = 0; (i < 2) && (written < bytes); ++i)
     {
-        ROS_ERROR(
-            "You are trying to overwrite parts of the circular buffer that have not yet been read!");
+        std::size_t span_size;
+        uint8_t* span = writeSpan(span_size);
+        if (span_size == 0)
+            break;
+        std::size_t chunk = std::min(span_size, bytes - written);
+        memcpy(span, data + written, chunk);
+        commitWrite(chunk);
+        written += chunk;
     }
+    if (written != bytes)
+        recordDrop(bytes - written);
+    return written;
+}
 
-    // Writes in a single step
-    if (bytes_to_write <= capacity - head_)
-    {
+void CircularBuffer::recordDrop(std::size_t bytes)
+{
+    if (bytes == 0)
+        return;
+    overflow_count_.fetch_add(1, std::memory_order_relaxed);
+    dropped_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
 
-        memcpy(data_ + head_, data, bytes_to_write);
-        head_ += bytes_to_write;
-        if (head_ == capacity)
-            head_ = 0;
-    }
-    // Writes in two steps. Here the circular nature comes to the surface
-    else
-    {
-        std::size_t size_1 = capacity - head_;
-        memcpy(data_ + head_, data, size_1);
-        std::size_t size_2 = bytes_to_write - size_1;
-        memcpy(data_, data + size_1, size_2);
-        head_ =
-            size_2; // Hence setting head_ = 0 three lines above was not necessary.
-    }
-    size_ += bytes_to_write;
-    return bytes_to_write;
+const uint8_t* CircularBuffer::readSpan(std::size_t& bytes) const
+{
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    std::size_t head = head_.load(std::memory_order_acquire);
+    std::size_t offset = tail & mask_;
+    bytes = std::min(head - tail, capacity_ - offset);
+    return data_ + offset;
 }
 
-std::size_t CircularBuffer::read(uint8_t* data, std::size_t bytes)
+void CircularBuffer::consume(std::size_t bytes)
 {
     if (bytes == 0)
-        return 0;
-    std::size_t capacity = capacity_;
-    std::size_t bytes_to_read = std::min(bytes, size_);
-    if (bytes_to_read != bytes)
-    {
-        ROS_ERROR(
-            "You are trying to read parts of the circular buffer that have not yet been written!");
-    }
-
-    // Read in a single step
-    if (bytes_to_read <=
-        capacity - tail_) // Note that it is not size_ - tail_:
-                          // If write() hasn't written something into all of capacity
-                          // yet (first round of writing), we would still read those
-                          // unknown bytes..
-    {
-        memcpy(data, data_ + tail_, bytes_to_read);
-        tail_ += bytes_to_read;
-        if (tail_ == capacity)
-            tail_ = 0; // Same here?
-    }
+        return;
+    tail_.store(tail_.load(std::memory_order_relaxed) + bytes,
+                std::memory_order_release);
+}
 
-    // Read in two steps
-    else
+std::size_t CircularBuffer::read(uint8_t* data, std::size_t bytes)
+{
+    std::size_t bytes_read = 0;
+    for (uint8_t i = 0; (i < 2) && (bytes_read < bytes); ++i)
     {
-        std::size_t size_1 = capacity - tail_;
-        memcpy(data, data_ + tail_, size_1);
-        std::size_t size_2 = bytes_to_read - size_1;
-        memcpy(data + size_1, data_, size_2);
-        tail_ = size_2;
+        std::size_t span_size;
+        const uint8_t* span = readSpan(span_size);
+        if (span_size == 0)
+            break;
+        std::size_t chunk = std::min(span_size, bytes - bytes_read);
+        memcpy(data + bytes_read, span, chunk);
+        consume(chunk);
+        bytes_read += chunk;
     }
-
-    size_ -= bytes_to_read;
-    return bytes_to_read;
-}
\ No newline at end of file
+    return bytes_read;
+}
@@ -0,0 +1,150 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+#include <algorithm>
+#include <ros/console.h>
+#include <septentrio_gnss_driver/communication/command_batch.hpp>
+
+/**
+ * @file command_batch.cpp
+ * @date 14/10/26
+ * @brief Writes a configuration script to the Rx and matches the replies to it
+ */
+
+namespace {
+    //! Size of "$R: " and "$R? ", which precede the echo of the command
+    const std::size_t REPLY_PREFIX_SIZE = 4;
+
+    //! Strips blanks and control characters and lower-cases the rest, since the
+    //! echo need not be typed like the command
+    std::string normalize(const std::string& text)
+    {
+        std::string normalized;
+        normalized.reserve(text.size());
+        for (char c : text)
+        {
+            if (c <= ' ')
+                continue;
+            normalized += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a')
+                                                 : c;
+        }
+        return normalized;
+    }
+
+    //! The command without its trailing blanks and carriage return, for logging
+    std::string printable(const std::string& command)
+    {
+        std::size_t end = command.size();
+        while (end > 0 && command[end - 1] <= ' ')
+            --end;
+        return command.substr(0, end);
+    }
+} // namespace
+
+namespace io_comm_rx {
+
+    CommandBatch::CommandBatch() : next_(0) {}
+
+    void CommandBatch::add(const std::string& command)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        commands_.push_back(command);
+        echoes_.push_back(normalize(command));
+        states_.push_back(evCommandPending);
+        replies_.push_back(std::string());
+    }
+
+    bool CommandBatch::match(const char* reply, std::size_t size)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (next_ == commands_.size())
+            return false;
+        std::size_t begin = std::min(REPLY_PREFIX_SIZE, size);
+        std::size_t end = begin;
+        while (end < size && reply[end] != '\r' && reply[end] != '\n')
+            ++end;
+        std::string line(reply + begin, end - begin);
+        const std::string echo = normalize(line);
+
+        std::size_t index = next_;
+        while (index != commands_.size() &&
+               echo.compare(0, echoes_[index].size(), echoes_[index]) != 0)
+            ++index;
+        // E.g. a late reply to a command sent before the script
+        if (index == commands_.size())
+            return false;
+        // The Rx answers in order, hence commands it skipped won't be answered
+        for (std::size_t i = next_; i != index; ++i)
+            states_[i] = evCommandUnanswered;
+        states_[index] =
+            (size > 2 && reply[2] == '?') ? evCommandRejected : evCommandAccepted;
+        replies_[index] = line;
+        next_ = index + 1;
+        if (next_ == commands_.size())
+        {
+            lock.unlock();
+            condition_.notify_all();
+        }
+        return true;
+    }
+
+    bool CommandBatch::waitForReplies(uint32_t timeout_ms)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        bool answered =
+            condition_.wait_for(lock, boost::chrono::milliseconds(timeout_ms),
+                                [this]() { return next_ == commands_.size(); });
+        for (std::size_t i = next_; i != commands_.size(); ++i)
+            states_[i] = evCommandUnanswered;
+        next_ = commands_.size();
+        return answered;
+    }
+
+    std::size_t CommandBatch::report() const
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        std::size_t failures = 0;
+        for (std::size_t i = 0; i != commands_.size(); ++i)
+        {
+            if (states_[i] == evCommandRejected)
+            {
+                ROS_ERROR("The Rx rejected the command \"%s\": %s",
+                          printable(commands_[i]).c_str(), replies_[i].c_str());
+                ++failures;
+            } else if (states_[i] == evCommandUnanswered)
+            {
+                ROS_ERROR("The Rx did not answer the command \"%s\"",
+                          printable(commands_[i]).c_str());
+                ++failures;
+            }
+        }
+        return failures;
+    }
+} // namespace io_comm_rx
@@ -28,8 +28,19 @@
 //
 // *****************************************************************************
 
+// C++ library includes
+#ifdef __linux__
+#include <linux/serial.h> // for ASYNC_LOW_LATENCY
+#include <sys/ioctl.h>
+#endif
+
+// Boost includes
+#include <boost/thread.hpp>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/block_index.hpp>
 #include <septentrio_gnss_driver/communication/communication_core.hpp>
 #include <septentrio_gnss_driver/communication/pcap_reader.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
 
 /**
  * @file communication_core.cpp
@@ -37,6 +48,18 @@
  * @brief Highest-Level view on communication services
  */
 
+namespace {
+    //! Converts Unix Epoch time in seconds to milliseconds since the GPS epoch,
+    //! undoing parsing_utilities::convertGPSWeekTOWToUnix()
+    uint64_t unixToGPSTime(double unix_time)
+    {
+        const double gps_time =
+            unix_time - parsing_utilities::GPS_EPOCH_UNIX_SECONDS + g_leap_seconds;
+        return (gps_time > 0.0) ? static_cast<uint64_t>(gps_time * 1000.0 + 0.5)
+                                : 0;
+    }
+} // namespace
+
 io_comm_rx::Comm_IO::Comm_IO() : handlers_() {}
 
 void io_comm_rx::Comm_IO::send(std::string cmd)
@@ -45,197 +68,343 @@ void io_comm_rx::Comm_IO::send(std::string cmd)
     manager_.get()->send(cmd, cmd.size());
 }
 
+void io_comm_rx::Comm_IO::send(const boost::shared_ptr<CommandBatch>& batch)
+{
+    handlers_.setCommandBatch(batch);
+    manager_.get()->send(batch->commands());
+}
+
 bool io_comm_rx::Comm_IO::initializeTCP(std::string host, std::string port)
 {
     ROS_DEBUG("Calling initializeTCP() method..");
-    host_ = host;
-    port_ = port;
-    // The io_context, of which io_service is a typedef of; it represents your
-    // program's link to the operating system's I/O services.
-    boost::shared_ptr<boost::asio::io_service> io_service(
-        new boost::asio::io_service);
-    boost::asio::ip::tcp::resolver::iterator endpoint;
-
-    try
-    {
-        boost::asio::ip::tcp::resolver resolver(*io_service);
-        // Note that tcp::resolver::query takes the host to resolve or the IP as the
-        // first parameter and the name of the service (as defined e.g. in
-        // /etc/services on Unix hosts) as second parameter. For the latter, one can
-        // also use a numeric service identifier (aka port number). In any case, it
-        // returns a list of possible endpoints, as there might be several entries
-        // for a single host.
-        endpoint = resolver.resolve(boost::asio::ip::tcp::resolver::query(
-            host, port)); // Resolves query object..
-    } catch (std::runtime_error& e)
+    if (manager_)
     {
-        throw std::runtime_error("Could not resolve " + host + " on port " + port +
-                                 ": " + e.what());
+        ROS_ERROR(
+            "You have called the InitializeTCP() method though an AsyncManager object is already available! Start all anew..");
         return false;
     }
-
+    host_ = host;
+    port_ = port;
+    // The io_context, of which io_service is a typedef of, represents your
+    // program's link to the operating system's I/O services. It is run by the
+    // pool, which might be shared with other Rxs.
+    if (!pool_)
+        pool_.reset(new IoServicePool(1));
     boost::shared_ptr<boost::asio::ip::tcp::socket> socket(
-        new boost::asio::ip::tcp::socket(*io_service));
+        new boost::asio::ip::tcp::socket(pool_->ioService()));
 
-    try
-    {
-        // The list of endpoints obtained above may contain both IPv4 and IPv6
-        // endpoints, so we need to try each of them until we find one that works.
-        // This keeps the client program independent of a specific IP version. The
-        // boost::asio::connect() function does this for us automatically.
-        socket->connect(*endpoint);
-    } catch (std::runtime_error& e)
+    // The AsyncManager connects the socket via connectTCP(), and does so anew
+    // whenever the connection is lost.
+    setManager(boost::shared_ptr<Manager>(
+        new AsyncManager<boost::asio::ip::tcp::socket>(
+            socket, pool_, boost::bind(&Comm_IO::connectTCP, this, _1, _2, _3),
+            reconnect_policy_, stream_settings_.read_buffer_size)));
+    ROS_DEBUG("Leaving initializeTCP() method..");
+    return true;
+}
+
+void io_comm_rx::Comm_IO::connectTCP(boost::asio::ip::tcp::socket& socket,
+                                     boost::asio::io_service::strand& strand,
+                                     const ConnectHandler& handler)
+{
+    ROS_INFO("Connecting to tcp://%s:%s ...", host_.c_str(), port_.c_str());
+    boost::shared_ptr<boost::asio::ip::tcp::resolver> resolver(
+        new boost::asio::ip::tcp::resolver(pool_->ioService()));
+    // Note that tcp::resolver::query takes the host to resolve or the IP as the
+    // first parameter and the name of the service (as defined e.g. in
+    // /etc/services on Unix hosts) as second parameter. For the latter, one can
+    // also use a numeric service identifier (aka port number). In any case, it
+    // returns a list of possible endpoints, as there might be several entries
+    // for a single host.
+    resolver->async_resolve(
+        boost::asio::ip::tcp::resolver::query(host_, port_),
+        strand.wrap(boost::bind(&Comm_IO::tcpResolved, this, resolver,
+                                boost::ref(socket), boost::ref(strand), handler,
+                                boost::asio::placeholders::error,
+                                boost::asio::placeholders::iterator)));
+}
+
+void io_comm_rx::Comm_IO::tcpResolved(
+    boost::shared_ptr<boost::asio::ip::tcp::resolver> resolver,
+    boost::asio::ip::tcp::socket& socket, boost::asio::io_service::strand& strand,
+    const ConnectHandler& handler, const boost::system::error_code& error,
+    boost::asio::ip::tcp::resolver::iterator endpoint)
+{
+    if (error)
     {
-        throw std::runtime_error("Could not connect to " + endpoint->host_name() +
-                                 ": " + endpoint->service_name() + ": " + e.what());
-        return false;
+        ROS_ERROR("Could not resolve %s on port %s", host_.c_str(), port_.c_str());
+        handler(error);
+        return;
     }
+    // The list of endpoints obtained above may contain both IPv4 and IPv6
+    // endpoints, so we need to try each of them until we find one that works.
+    // This keeps the client program independent of a specific IP version. The
+    // boost::asio::async_connect() function does this for us automatically.
+    boost::asio::async_connect(
+        socket, endpoint,
+        strand.wrap(boost::bind(&Comm_IO::tcpConnected, this, boost::ref(socket),
+                                handler, boost::asio::placeholders::error,
+                                boost::asio::placeholders::iterator)));
+}
 
+void io_comm_rx::Comm_IO::tcpConnected(
+    boost::asio::ip::tcp::socket& socket, const ConnectHandler& handler,
+    const boost::system::error_code& error,
+    boost::asio::ip::tcp::resolver::iterator endpoint)
+{
+    if (error)
+    {
+        handler(error);
+        return;
+    }
     ROS_INFO("Connected to %s: %s.", endpoint->host_name().c_str(),
              endpoint->service_name().c_str());
 
-    if (manager_)
+    // Socket options do not survive reconnecting, since async_connect() opens
+    // the socket anew. Failing to set them is not worth dropping the connection.
+    boost::system::error_code option_error;
+    socket.set_option(boost::asio::ip::tcp::no_delay(stream_settings_.tcp_no_delay),
+                      option_error);
+    if (option_error)
     {
-        ROS_ERROR(
-            "You have called the InitializeTCP() method though an AsyncManager object is already available! Start all anew..");
-        return false;
+        ROS_WARN("Could not set TCP_NODELAY: %s", option_error.message().c_str());
     }
-    setManager(boost::shared_ptr<Manager>(
-        new AsyncManager<boost::asio::ip::tcp::socket>(socket, io_service)));
-    ROS_DEBUG("Leaving initializeTCP() method..");
-    return true;
+    if (stream_settings_.tcp_receive_buffer_size > 0)
+    {
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(
+                              stream_settings_.tcp_receive_buffer_size),
+                          option_error);
+        if (option_error)
+        {
+            ROS_WARN("Could not set the TCP receive buffer size to %i bytes: %s",
+                     stream_settings_.tcp_receive_buffer_size,
+                     option_error.message().c_str());
+        }
+    }
+    handler(error);
 }
 
 void io_comm_rx::Comm_IO::initializeSBFFileReading(std::string file_name)
 {
     ROS_DEBUG("Calling initializeSBFFileReading() method..");
-    std::size_t buffer_size = 8192;
-    uint8_t* to_be_parsed;
-    to_be_parsed = new uint8_t[buffer_size];
-    std::ifstream bin_file(file_name, std::ios::binary);
-    std::vector<uint8_t> vec_buf;
-    if (bin_file.good())
+    handlers_.startReplay(g_replay_rate);
+    MappedFile file;
+    if (!file.open(file_name))
     {
-        /* Reads binary data using streambuffer iterators.
-        Copies all SBF file content into bin_data. */
-        std::vector<uint8_t> v_buf((std::istreambuf_iterator<char>(bin_file)),
-                                   (std::istreambuf_iterator<char>()));
-        vec_buf = v_buf;
-        bin_file.close();
-    } else
-    {
-        throw std::runtime_error("I could not find your file. Or it is corrupted.");
+        ROS_DEBUG("Could not map %s, reading it in chunks instead", file_name.c_str());
+        streamSBFFile(file_name,
+                      static_cast<std::size_t>(replay_settings_.start_offset));
+        handlers_.flushEpochs();
+        ROS_DEBUG("Leaving initializeSBFFileReading() method..");
+        return;
     }
-    // The spec now guarantees that vectors store their elements contiguously.
-    to_be_parsed = &vec_buf[0];
-    std::stringstream ss;
-    ss << "Opened and copied over from " << file_name;
-    ROS_DEBUG("%s", ss.str().c_str());
-
-    while (1) // Loop will stop if we are done reading the SBF file
+    ROS_DEBUG("Mapped %s, %li bytes", file_name.c_str(), file.size());
+
+    std::size_t offset;
+    std::size_t end;
+    replayRange(file_name, file, offset, end);
+    file.release(offset);
+    // The framer works on the mapping itself. It is fed in windows so that parsed
+    // pages can be released as we go and memory use does not grow with the log.
+    std::size_t window = REPLAY_CHUNK_SIZE_;
+    while (offset < end)
     {
-        try
+        std::size_t remaining = end - offset;
+        std::size_t available = std::min(window, remaining);
+        std::size_t consumed =
+            handlers_.readCallback(file.data() + offset, available);
+        if (consumed == 0)
         {
-            ROS_DEBUG(
-                "Calling read_callback_() method, with number of bytes to be parsed being %li",
-                buffer_size);
-            handlers_.readCallback(to_be_parsed, buffer_size);
-        } catch (std::size_t& parsing_failed_here)
-        {
-            if (to_be_parsed - &vec_buf[0] >= vec_buf.size() * sizeof(uint8_t))
-            {
+            if (available == remaining)
                 break;
-            }
-            to_be_parsed = to_be_parsed + parsing_failed_here;
-            ROS_DEBUG("Parsing_failed_here is %li", parsing_failed_here);
+            // Not even one message in the window, widen it
+            window *= 2;
             continue;
         }
-        if (to_be_parsed - &vec_buf[0] >= vec_buf.size() * sizeof(uint8_t))
-        {
+        offset += consumed;
+        file.release(offset);
+    }
+    if (offset < end)
+    {
+        ROS_DEBUG("Ignoring the last %li bytes, which form an incomplete message",
+                  end - offset);
+    }
+    handlers_.flushEpochs();
+    ROS_DEBUG("Leaving initializeSBFFileReading() method..");
+}
+
+void io_comm_rx::Comm_IO::replayRange(const std::string& file_name,
+                                      const MappedFile& file, std::size_t& begin,
+                                      std::size_t& end) const
+{
+    begin = 0;
+    end = file.size();
+    const bool seek_time =
+        replay_settings_.start_time > 0.0 || replay_settings_.end_time > 0.0;
+    if (seek_time && replay_settings_.index_interval > 0)
+    {
+        BlockIndex index;
+        index.open(file_name, file.data(), file.size(),
+                   replay_settings_.index_interval,
+                   std::max(boost::thread::hardware_concurrency(), 1U));
+        if (replay_settings_.start_time > 0.0)
+            begin = index.startOffset(unixToGPSTime(replay_settings_.start_time));
+        if (replay_settings_.end_time > 0.0)
+            end = index.endOffset(unixToGPSTime(replay_settings_.end_time),
+                                  file.size());
+    } else if (seek_time)
+    {
+        ROS_WARN("Cannot seek to a time with replay/index_interval set to 0, "
+                 "replaying the whole file instead");
+    }
+    // Starting in the middle of a block is harmless, the framer resyncs
+    begin = std::max(begin, static_cast<std::size_t>(std::min(
+                                replay_settings_.start_offset,
+                                static_cast<uint64_t>(file.size()))));
+    end = std::max(begin, end);
+    ROS_DEBUG("Replaying bytes %li to %li of %s", begin, end, file_name.c_str());
+}
+
+void io_comm_rx::Comm_IO::streamSBFFile(const std::string& file_name,
+                                        std::size_t start_offset)
+{
+    std::ifstream bin_file(file_name, std::ios::binary);
+    if (!bin_file.good())
+    {
+        throw std::runtime_error("I could not find your file. Or it is corrupted.");
+    }
+    if (replay_settings_.start_time > 0.0 || replay_settings_.end_time > 0.0)
+    {
+        ROS_WARN("Cannot seek to a time in files that cannot be mapped, replaying "
+                 "from replay/start_offset instead");
+    }
+    bin_file.seekg(static_cast<std::streamoff>(start_offset));
+    // The spare room behind the read-ahead window plays the role of the mapping
+    // guard, see MappedFile::MAPPING_GUARD_SIZE.
+    std::vector<uint8_t> buffer(REPLAY_CHUNK_SIZE_ + MappedFile::MAPPING_GUARD_SIZE);
+    std::size_t fill = 0;
+    while (true)
+    {
+        bin_file.read(reinterpret_cast<char*>(buffer.data()) + fill,
+                      REPLAY_CHUNK_SIZE_ - fill);
+        std::size_t bytes_read = static_cast<std::size_t>(bin_file.gcount());
+        fill += bytes_read;
+        if (fill == 0)
             break;
+        std::size_t consumed = handlers_.readCallback(buffer.data(), fill);
+        if (consumed == 0 && fill == REPLAY_CHUNK_SIZE_)
+        {
+            // Cannot happen with well-formed input since every message is shorter
+            // than the window, but never stall on garbage.
+            consumed = fill;
         }
-        to_be_parsed = to_be_parsed + buffer_size;
+        std::memmove(buffer.data(), buffer.data() + consumed, fill - consumed);
+        fill -= consumed;
+        if (bytes_read == 0)
+            break;
+    }
+    if (fill > 0)
+    {
+        ROS_DEBUG("Ignoring the last %li bytes, which form an incomplete message",
+                  fill);
     }
-    delete[] to_be_parsed; // Freeing memory
-    ROS_DEBUG("Leaving initializeSBFFileReading() method..");
 }
 
-void io_comm_rx::Comm_IO::initializePCAPFileReading(std::string file_name)
+void io_comm_rx::Comm_IO::initializePCAPFileReading(std::string file_name,
+                                                     std::string filter)
 {
     ROS_DEBUG("Calling initializePCAPFileReading() method..");
+    handlers_.startReplay(g_replay_rate);
     pcapReader::buffer_t vec_buf;
+    // Room for a TCP segment of up to 64 KiB appended beyond the chunk size and
+    // for the mapping guard behind it, see MappedFile::MAPPING_GUARD_SIZE
+    vec_buf.reserve(PCAP_PARSE_CHUNK_SIZE_ + (1 << 16) +
+                    MappedFile::MAPPING_GUARD_SIZE);
     pcapReader::PcapDevice device(vec_buf);
 
-    if (!device.connect(file_name.c_str()))
+    if (!device.connect(file_name.c_str(), filter))
     {
         ROS_ERROR("Unable to find file or either it is corrupted");
         return;
     }
 
     ROS_INFO("Reading ...");
+    // The reassembled stream is parsed as it grows instead of after the whole
+    // capture has been read.
     while (device.isConnected() && device.read() == pcapReader::READ_SUCCESS)
-        ;
+    {
+        if (vec_buf.size() < PCAP_PARSE_CHUNK_SIZE_)
+            continue;
+        std::size_t consumed = handlers_.readCallback(vec_buf.data(), vec_buf.size());
+        vec_buf.erase(vec_buf.begin(), vec_buf.begin() + consumed);
+    }
     device.disconnect();
 
-    std::size_t buffer_size = pcapReader::PcapDevice::BUFFSIZE;
-    uint8_t* to_be_parsed = new uint8_t[buffer_size];
-    to_be_parsed = &vec_buf[0];
+    parseFileBuffer(vec_buf);
+    handlers_.flushEpochs();
+    ROS_DEBUG("Leaving initializePCAPFileReading() method..");
+}
 
-    while (1) // Loop will stop if we are done reading the SBF file
+void io_comm_rx::Comm_IO::parseFileBuffer(const std::vector<uint8_t>& vec_buf)
+{
+    ROS_DEBUG(
+        "Calling read_callback_() method, with number of bytes to be parsed being %li",
+        vec_buf.size());
+    std::size_t consumed = handlers_.readCallback(vec_buf.data(), vec_buf.size());
+    if (consumed < vec_buf.size())
     {
-        try
-        {
-            ROS_DEBUG(
-                "Calling read_callback_() method, with number of bytes to be parsed being %li",
-                buffer_size);
-            handlers_.readCallback(to_be_parsed, buffer_size);
-        } catch (std::size_t& parsing_failed_here)
-        {
-            if (to_be_parsed - &vec_buf[0] >= vec_buf.size() * sizeof(uint8_t))
-            {
-                break;
-            }
-            if (!parsing_failed_here)
-                parsing_failed_here = 1;
-
-            to_be_parsed = to_be_parsed + parsing_failed_here;
-            ROS_DEBUG("Parsing_failed_here is %li", parsing_failed_here);
-            continue;
-        }
-        if (to_be_parsed - &vec_buf[0] >= vec_buf.size() * sizeof(uint8_t))
-        {
-            break;
-        }
-        to_be_parsed = to_be_parsed + buffer_size;
+        ROS_DEBUG("Ignoring the last %li bytes, which form an incomplete message",
+                  vec_buf.size() - consumed);
     }
-    delete[] to_be_parsed;
-    ROS_DEBUG("Leaving initializePCAPFileReading() method..");
 }
 
 bool io_comm_rx::Comm_IO::initializeSerial(std::string port, uint32_t baudrate,
                                            std::string flowcontrol)
 {
     ROS_DEBUG("Calling initializeSerial() method..");
+    // Set the I/O manager
+    if (manager_)
+    {
+        ROS_ERROR(
+            "You have called the initializeSerial() method though an AsyncManager object is already available! Start all anew..");
+        return false;
+    }
     serial_port_ = port;
     baudrate_ = baudrate;
-    // The io_context, of which io_service is a typedef of; it represents your
-    // program's link to the operating system's I/O services.
-    boost::shared_ptr<boost::asio::io_service> io_service(
-        new boost::asio::io_service);
+    flowcontrol_ = flowcontrol;
+    // The io_context, of which io_service is a typedef of, represents your
+    // program's link to the operating system's I/O services. It is run by the
+    // pool, which might be shared with other Rxs.
+    if (!pool_)
+        pool_.reset(new IoServicePool(1));
     // To perform I/O operations the program needs an I/O object, here "serial".
     boost::shared_ptr<boost::asio::serial_port> serial(
-        new boost::asio::serial_port(*io_service));
+        new boost::asio::serial_port(pool_->ioService()));
 
+    ROS_DEBUG("Creating new Async-Manager object..");
+    // The AsyncManager opens the port via openSerial(), and does so anew whenever
+    // the connection is lost.
+    setManager(boost::shared_ptr<Manager>(new AsyncManager<boost::asio::serial_port>(
+        serial, pool_, boost::bind(&Comm_IO::openSerial, this, _1, _3),
+        reconnect_policy_, stream_settings_.read_buffer_size)));
+    ROS_DEBUG("Leaving initializeSerial() method..");
+    return true;
+}
+
+void io_comm_rx::Comm_IO::openSerial(boost::asio::serial_port& serial,
+                                     const ConnectHandler& handler)
+{
+    ROS_INFO("Connecting serially to device %s, targeted baudrate: %u",
+             serial_port_.c_str(), baudrate_);
     // We attempt the opening of the serial port..
-    try
+    boost::system::error_code error;
+    serial.open(serial_port_, error);
+    if (error)
     {
-        serial->open(serial_port_);
-    } catch (std::runtime_error& e)
-    {
-        // and return an error message in case it fails.
-        throw std::runtime_error("Could not open serial port : " + serial_port_ +
-                                 ": " + e.what());
-        return false;
+        // and report the error in case it fails.
+        ROS_ERROR("Could not open serial port : %s", serial_port_.c_str());
+        handler(error);
+        return;
     }
 
     ROS_INFO("Opened serial port %s", serial_port_.c_str());
@@ -248,14 +417,14 @@ bool io_comm_rx::Comm_IO::initializeSerial(std::string port, uint32_t baudrate,
         // This function native_handle() may be used to obtain
         // the underlying representation of the serial port.
         // Conversion from type native_handle_type to int is done implicitly.
-        int fd = serial->native_handle();
+        int fd = serial.native_handle();
         termios tio;
         // Get terminal attribute, follows the syntax
         // int tcgetattr(int fd, struct termios *termios_p);
         tcgetattr(fd, &tio);
 
         // Hardware flow control settings..
-        if (flowcontrol == "RTS|CTS")
+        if (flowcontrol_ == "RTS|CTS")
         {
             tio.c_iflag &= ~(IXOFF | IXON);
             tio.c_cflag |= CRTSCTS;
@@ -273,24 +442,13 @@ bool io_comm_rx::Comm_IO::initializeSerial(std::string port, uint32_t baudrate,
         tcsetattr(fd, TCSANOW, &tio);
     }
 
-    // Set the I/O manager
-    if (manager_)
-    {
-        ROS_ERROR(
-            "You have called the initializeSerial() method though an AsyncManager object is already available! Start all anew..");
-        return false;
-    }
-    ROS_DEBUG("Creating new Async-Manager object..");
-    setManager(boost::shared_ptr<Manager>(
-        new AsyncManager<boost::asio::serial_port>(serial, io_service)));
-
     // Setting the baudrate, incrementally..
     ROS_DEBUG("Gradually increasing the baudrate to the desired value...");
     boost::asio::serial_port_base::baud_rate current_baudrate;
     ROS_DEBUG("Initiated current_baudrate object...");
     try
     {
-        serial->get_option(
+        serial.get_option(
             current_baudrate); // Note that this sets current_baudrate.value() often
                                // to 115200, since by default, all Rx COM ports,
         // at least for mosaic Rxs, are set to a baudrate of 115200 baud, using 8
@@ -305,10 +463,11 @@ bool io_comm_rx::Comm_IO::initializeSerial(std::string port, uint32_t baudrate,
         boost::system::error_code e_loop;
         do // Caution: Might cause infinite loop..
         {
-            serial->get_option(current_baudrate, e_loop);
+            serial.get_option(current_baudrate, e_loop);
         } while(e_loop);
         */
-        return false;
+        handler(e.code());
+        return;
     }
     // Gradually increase the baudrate to the desired value
     // The desired baudrate can be lower or larger than the
@@ -327,7 +486,7 @@ bool io_comm_rx::Comm_IO::initializeSerial(std::string port, uint32_t baudrate,
         // Increment until Baudrate[i] matches current_baudrate.
         try
         {
-            serial->set_option(
+            serial.set_option(
                 boost::asio::serial_port_base::baud_rate(BAUDRATES[i]));
         } catch (boost::system::system_error& e)
         {
@@ -335,7 +494,8 @@ bool io_comm_rx::Comm_IO::initializeSerial(std::string port, uint32_t baudrate,
             ROS_ERROR("set_option failed due to %s", e.what());
             ROS_INFO("Additional info about error is %s",
                      boost::diagnostic_information(e).c_str());
-            return false;
+            handler(e.code());
+            return;
         }
         usleep(SET_BAUDRATE_SLEEP_);
         // boost::this_thread::sleep(boost::posix_time::milliseconds(SET_BAUDRATE_SLEEP_*1000));
@@ -343,7 +503,7 @@ bool io_comm_rx::Comm_IO::initializeSerial(std::string port, uint32_t baudrate,
         // time it is called, hence we use sleep() or usleep().
         try
         {
-            serial->get_option(current_baudrate);
+            serial.get_option(current_baudrate);
         } catch (boost::system::system_error& e)
         {
 
@@ -354,16 +514,38 @@ bool io_comm_rx::Comm_IO::initializeSerial(std::string port, uint32_t baudrate,
             boost::system::error_code e_loop;
             do // Caution: Might cause infinite loop..
             {
-                serial->get_option(current_baudrate, e_loop);
+                serial.get_option(current_baudrate, e_loop);
             } while(e_loop);
             */
-            return false;
+            handler(e.code());
+            return;
         }
         ROS_DEBUG("Set ASIO baudrate to %u", current_baudrate.value());
     }
-    ROS_INFO("Set ASIO baudrate to %u, leaving InitializeSerial() method",
-             current_baudrate.value());
-    return true;
+    ROS_INFO("Set ASIO baudrate to %u", current_baudrate.value());
+#ifdef __linux__
+    if (stream_settings_.serial_low_latency)
+    {
+        // The USB serial drivers otherwise buffer incoming bytes for up to 16 ms
+        int fd = serial.native_handle();
+        struct serial_struct serial_info;
+        bool low_latency = (ioctl(fd, TIOCGSERIAL, &serial_info) == 0);
+        if (low_latency)
+        {
+            serial_info.flags |= ASYNC_LOW_LATENCY;
+            low_latency = (ioctl(fd, TIOCSSERIAL, &serial_info) == 0);
+        }
+        if (low_latency)
+        {
+            ROS_DEBUG("Set serial port %s to low latency", serial_port_.c_str());
+        } else
+        {
+            ROS_WARN("The driver of serial port %s does not support low latency",
+                     serial_port_.c_str());
+        }
+    }
+#endif
+    handler(boost::system::error_code());
 }
 
 void io_comm_rx::Comm_IO::setManager(const boost::shared_ptr<Manager>& manager)
@@ -374,35 +556,30 @@ void io_comm_rx::Comm_IO::setManager(const boost::shared_ptr<Manager>& manager)
     manager_ = manager;
     manager_->setCallback(
         boost::bind(&CallbackHandlers::readCallback, &handlers_, _1, _2));
+    manager_->setConnectionCallback(connection_callback_);
+    manager_->setPipelineStatistics(&handlers_.statistics());
+    manager_->setRecorder(recorder_.get());
+    manager_->start();
     ROS_DEBUG("Leaving setManager() method");
 }
 
-void io_comm_rx::Comm_IO::resetSerial(std::string port)
+void io_comm_rx::Comm_IO::setRecordingSettings(const RecordingSettings& settings)
 {
-    serial_port_ = port;
-    boost::shared_ptr<boost::asio::io_service> io_service(
-        new boost::asio::io_service);
-    boost::shared_ptr<boost::asio::serial_port> serial(
-        new boost::asio::serial_port(*io_service));
-
-    // Try to open serial port
-    try
-    {
-        serial->open(serial_port_);
-    } catch (std::runtime_error& e)
-    {
-        throw std::runtime_error("Could not open serial port :" + serial_port_ +
-                                 " " + e.what());
-    }
-
-    ROS_INFO("Reset serial port %s", serial_port_.c_str());
-
-    // Sets the I/O worker
-    if (manager_)
+    if (manager_ || recorder_ || settings.directory.empty())
         return;
-    setManager(boost::shared_ptr<Manager>(
-        new AsyncManager<boost::asio::serial_port>(serial, io_service)));
+    recorder_.reset(new StreamRecorder(settings));
+}
 
-    // Set the baudrate
-    serial->set_option(boost::asio::serial_port_base::baud_rate(baudrate_));
+void io_comm_rx::Comm_IO::resetSerial(std::string port)
+{
+    ROS_INFO("Reset serial port %s", port.c_str());
+    // Opening the port and setting the baudrate is up to openSerial()
+    initializeSerial(port, baudrate_, flowcontrol_);
+}
+
+io_comm_rx::ConnectionStatistics io_comm_rx::Comm_IO::connectionStatistics() const
+{
+    if (!manager_)
+        return ConnectionStatistics();
+    return manager_->statistics();
 }
@@ -0,0 +1,239 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <atomic>
+#include <chrono>
+#include <thread>
+// Boost includes
+#include <boost/bind.hpp>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/decode_pipeline.hpp>
+#include <septentrio_gnss_driver/communication/trace_ring.hpp>
+
+/**
+ * @file decode_pipeline.cpp
+ * @date 14/10/26
+ * @brief Decodes and publishes framed messages on worker threads
+ */
+
+namespace {
+    //! Idle workers look for jobs at least this often, should a wake-up be missed
+    const int64_t IDLE_WAIT_MS = 10;
+    //! Polling period of the framing thread while it waits for a free job
+    const int64_t FULL_WAIT_US = 100;
+
+    //! Groups of heavy keys, -1 for the low-latency ones. Keys that share state are
+    //! grouped, such that they are served by one lane: DiagnosticArray reads the
+    //! retained ReceiverSetup block.
+    int32_t heavyGroup(RxID_Enum key)
+    {
+        switch (key)
+        {
+        case evGPSFix:
+            return 0;
+        case evDiagnosticArray:
+        case evReceiverSetup:
+            return 1;
+        case evGPGSA:
+        case evGPGSV:
+        case evGLGSV:
+        case evGAGSV:
+        case evGBGSV:
+            return 2;
+        default:
+            return -1;
+        }
+    }
+} // namespace
+
+namespace io_comm_rx {
+
+    DecodePipeline::DecodePipeline(uint32_t threads, const Decoder& decoder,
+                                   PipelineStatistics* statistics) :
+        decoder_(decoder),
+        statistics_(statistics), running_(true), dropped_(0)
+    {
+        for (uint32_t i = 0; i < threads; ++i)
+        {
+            boost::shared_ptr<Lane> lane(new Lane);
+            lane->jobs.resize(QUEUE_CAPACITY);
+            for (std::size_t j = 0; j < QUEUE_CAPACITY; ++j)
+                lane->done.push(&lane->jobs[j]);
+            lane->idle = false;
+            lanes_.push_back(lane);
+        }
+        for (std::size_t i = 0; i < lanes_.size(); ++i)
+        {
+            lanes_[i]->thread = boost::thread(
+                boost::bind(&DecodePipeline::work, this, boost::ref(*lanes_[i])));
+        }
+    }
+
+    DecodePipeline::~DecodePipeline()
+    {
+        running_ = false;
+        for (std::size_t i = 0; i < lanes_.size(); ++i)
+        {
+            {
+                boost::mutex::scoped_lock lock(lanes_[i]->mutex);
+                lanes_[i]->condition.notify_one();
+            }
+            lanes_[i]->thread.join();
+        }
+    }
+
+    std::size_t DecodePipeline::laneOf(RxID_Enum key) const
+    {
+        const int32_t group = heavyGroup(key);
+        if (lanes_.size() < 2 || group < 0)
+            return 0;
+        return 1 + static_cast<std::size_t>(group) % (lanes_.size() - 1);
+    }
+
+    void DecodePipeline::submit(RxID_Enum key, const uint8_t* data,
+                                std::size_t size, const BlockArena* epoch,
+                                bool wait)
+    {
+        const bool timing = statistics_ && statistics_->timing();
+        if (lanes_.empty())
+        {
+            if (!timing)
+            {
+                decoder_(key, data, size, epoch);
+                return;
+            }
+            const PipelineStatistics::Clock::time_point start =
+                PipelineStatistics::Clock::now();
+            decoder_(key, data, size, epoch);
+            const PipelineStatistics::Clock::time_point end =
+                PipelineStatistics::Clock::now();
+            statistics_->recordStage(evStageDecode, start, end);
+            const PipelineStatistics::Clock::time_point received =
+                statistics_->receiveTime();
+            if (received != PipelineStatistics::Clock::time_point())
+                statistics_->recordStage(evStageEndToEnd, received, end);
+            return;
+        }
+        Lane& lane = *lanes_[laneOf(key)];
+        DecodeJob* job;
+        while (!lane.done.pop(job))
+        {
+            if (!wait)
+            {
+                ++dropped_;
+                ROSAIC_TRACE_EVENT(evTraceDrop, key, 0, size);
+                if (statistics_)
+                    statistics_->recordDrop(key);
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(FULL_WAIT_US));
+        }
+        // The buffers of the job keep their capacity, so this copies without
+        // allocating once they have grown
+        job->key = key;
+        job->bytes.assign(data, data + size);
+        job->has_epoch = (epoch != nullptr);
+        if (epoch)
+            job->epoch = *epoch;
+        if (timing)
+        {
+            job->received = statistics_->receiveTime();
+            job->submitted = PipelineStatistics::Clock::now();
+        } else
+            job->submitted = PipelineStatistics::Clock::time_point();
+        lane.pending.push(job);
+        // Pairs with the fence in work(): either the worker sees the job or we see
+        // it idle, never neither
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (lane.idle.load())
+        {
+            boost::mutex::scoped_lock lock(lane.mutex);
+            lane.condition.notify_one();
+        }
+    }
+
+    void DecodePipeline::drain()
+    {
+        for (std::size_t i = 0; i < lanes_.size(); ++i)
+        {
+            // All jobs are back once the lane is done with them
+            while (lanes_[i]->done.read_available() < QUEUE_CAPACITY)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(FULL_WAIT_US));
+            }
+        }
+    }
+
+    void DecodePipeline::work(Lane& lane)
+    {
+        DecodeJob* job;
+        while (true)
+        {
+            if (lane.pending.pop(job))
+            {
+                decode(*job);
+                lane.done.push(job);
+                continue;
+            }
+            if (!running_)
+                break;
+            boost::mutex::scoped_lock lock(lane.mutex);
+            lane.idle = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (lane.pending.read_available() == 0 && running_)
+            {
+                lane.condition.timed_wait(
+                    lock, boost::posix_time::milliseconds(IDLE_WAIT_MS));
+            }
+            lane.idle = false;
+        }
+    }
+
+    void DecodePipeline::decode(const DecodeJob& job)
+    {
+        const BlockArena* epoch = job.has_epoch ? &job.epoch : nullptr;
+        // Jobs submitted while latencies were not sampled carry no time stamp
+        if (job.submitted == PipelineStatistics::Clock::time_point())
+        {
+            decoder_(job.key, job.bytes.data(), job.bytes.size(), epoch);
+            return;
+        }
+        const PipelineStatistics::Clock::time_point start =
+            PipelineStatistics::Clock::now();
+        decoder_(job.key, job.bytes.data(), job.bytes.size(), epoch);
+        const PipelineStatistics::Clock::time_point end =
+            PipelineStatistics::Clock::now();
+        statistics_->recordStage(evStageQueue, job.submitted, start);
+        statistics_->recordStage(evStageDecode, start, end);
+        if (job.received != PipelineStatistics::Clock::time_point())
+            statistics_->recordStage(evStageEndToEnd, job.received, end);
+    }
+} // namespace io_comm_rx
@@ -0,0 +1,243 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <cstring>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/epoch_assembler.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+/**
+ * @file epoch_assembler.cpp
+ * @date 14/10/26
+ * @brief Collects SBF blocks into epochs for composite ROS messages
+ */
+
+namespace {
+    //! Composite ROS message and the blocks it is built from
+    struct CompositeSpec
+    {
+        //! Dispatch key of the composite
+        RxID_Enum composite;
+        //! The block without which the composite is never emitted
+        RxID_Enum primary;
+        //! SBF block number of the primary block
+        uint16_t primary_number;
+        //! Bitmask of the blocks it is built from, bit positions as in COMPONENTS
+        uint32_t mask;
+    };
+
+    //! In the order in which the composites of one epoch are emitted
+    const CompositeSpec COMPOSITES[] = {
+        {evNavSatFix, evPVTGeodetic, io_comm_rx::BlockTraits<PVTGeodetic>::NUMBER,
+         0x018},
+        {evPoseWithCovarianceStamped, evPVTGeodetic,
+         io_comm_rx::BlockTraits<PVTGeodetic>::NUMBER, 0x0D8},
+        {evDiagnosticArray, evReceiverStatus,
+         io_comm_rx::BlockTraits<ReceiverStatus>::NUMBER, 0x300},
+        {evGPSFix, evPVTGeodetic, io_comm_rx::BlockTraits<PVTGeodetic>::NUMBER,
+         0x0FF}};
+
+    const std::size_t COMPOSITE_COUNT = sizeof(COMPOSITES) / sizeof(COMPOSITES[0]);
+} // namespace
+
+namespace io_comm_rx {
+
+    const RxID_Enum EpochAssembler::COMPONENTS[EpochAssembler::COMPONENT_COUNT] = {
+        evChannelStatus,  evMeasEpoch,      evDOP,      evPVTGeodetic,
+        evPosCovGeodetic, evVelCovGeodetic, evAttEuler, evAttCovEuler,
+        evReceiverStatus, evQualityInd};
+
+    //! Bit position of "id" in the arrived masks, -1 if it is not a component
+    static int32_t componentIndex(RxID_Enum id)
+    {
+        for (std::size_t i = 0; i < EpochAssembler::COMPONENT_COUNT; ++i)
+        {
+            if (EpochAssembler::COMPONENTS[i] == id)
+                return static_cast<int32_t>(i);
+        }
+        return -1;
+    }
+
+    bool EpochAssembler::Slot::has(RxID_Enum id) const
+    {
+        int32_t index = componentIndex(id);
+        return index >= 0 && (arrived & (1u << index));
+    }
+
+    EpochAssembler::EpochAssembler() : closed_any_(false), newest_closed_(0)
+    {
+        for (std::size_t i = 0; i < EPOCH_SLOTS; ++i)
+        {
+            slots_[i].open = false;
+            slots_[i].expired = false;
+            slots_[i].epoch = 0;
+            slots_[i].arrived = 0;
+            slots_[i].emitted = 0;
+        }
+    }
+
+    uint32_t EpochAssembler::compositeBit(RxID_Enum composite)
+    {
+        for (std::size_t i = 0; i < COMPOSITE_COUNT; ++i)
+        {
+            if (COMPOSITES[i].composite == composite)
+                return 1u << i;
+        }
+        return 0;
+    }
+
+    bool EpochAssembler::add(const uint8_t* data, std::size_t size, RxID_Enum id,
+                             uint32_t enabled)
+    {
+        int32_t index = componentIndex(id);
+        // TOW at offset 8 and WNc at offset 12 of the SBF header
+        if (index < 0 || size < 14)
+            return true;
+        const uint32_t bit = 1u << index;
+        bool needed = false;
+        for (std::size_t i = 0; i < COMPOSITE_COUNT; ++i)
+        {
+            if ((enabled & (1u << i)) && (COMPOSITES[i].mask & bit))
+                needed = true;
+        }
+        if (!needed)
+            return true;
+
+        uint32_t tow;
+        uint16_t wnc;
+        memcpy(&tow, data + 8, sizeof(tow));
+        memcpy(&wnc, data + 12, sizeof(wnc));
+        const uint64_t epoch =
+            static_cast<uint64_t>(wnc) * parsing_utilities::MS_PER_WEEK + tow;
+
+        Slot* slot = find(epoch);
+        if (!slot)
+        {
+            if (closed_any_ && epoch <= newest_closed_)
+                return true;
+            Slot* oldest = nullptr;
+            for (std::size_t i = 0; i < EPOCH_SLOTS && !slot; ++i)
+            {
+                if (!slots_[i].open)
+                    slot = &slots_[i];
+                else if (!oldest || slots_[i].epoch < oldest->epoch)
+                    oldest = &slots_[i];
+            }
+            if (!slot)
+            {
+                // Blocks older than all epochs being collected are dropped
+                if (epoch < oldest->epoch)
+                    return true;
+                oldest->expired = true;
+                return false;
+            }
+            slot->open = true;
+            slot->expired = false;
+            slot->epoch = epoch;
+            slot->arrived = 0;
+            slot->emitted = 0;
+            slot->opened = std::chrono::steady_clock::now();
+            slot->blocks.clear();
+        }
+        slot->blocks.store(data, size);
+        slot->arrived |= bit;
+        return true;
+    }
+
+    bool EpochAssembler::next(uint32_t enabled, Due& due)
+    {
+        const std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        std::array<Slot*, EPOCH_SLOTS> order;
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < EPOCH_SLOTS; ++i)
+        {
+            if (slots_[i].open)
+                order[count++] = &slots_[i];
+        }
+        std::sort(order.begin(), order.begin() + count,
+                  [](const Slot* a, const Slot* b) { return a->epoch < b->epoch; });
+
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            Slot& slot = *order[k];
+            if (now - slot.opened >= std::chrono::milliseconds(EPOCH_TIMEOUT_MS))
+                slot.expired = true;
+            bool pending = false;
+            for (std::size_t i = 0; i < COMPOSITE_COUNT; ++i)
+            {
+                const uint32_t bit = 1u << i;
+                if (!(enabled & bit) || (slot.emitted & bit))
+                    continue;
+                const CompositeSpec& spec = COMPOSITES[i];
+                if ((slot.arrived & spec.mask) == spec.mask ||
+                    (slot.expired && slot.has(spec.primary)))
+                {
+                    slot.emitted |= bit;
+                    due.composite = spec.composite;
+                    due.primary =
+                        slot.blocks.find(spec.primary_number, due.primary_size);
+                    due.slot = &slot;
+                    return true;
+                }
+                pending = true;
+            }
+            if (!pending || slot.expired)
+                close(slot);
+        }
+        return false;
+    }
+
+    void EpochAssembler::expireAll()
+    {
+        for (std::size_t i = 0; i < EPOCH_SLOTS; ++i)
+            slots_[i].expired = true;
+    }
+
+    EpochAssembler::Slot* EpochAssembler::find(uint64_t epoch)
+    {
+        for (std::size_t i = 0; i < EPOCH_SLOTS; ++i)
+        {
+            if (slots_[i].open && slots_[i].epoch == epoch)
+                return &slots_[i];
+        }
+        return nullptr;
+    }
+
+    void EpochAssembler::close(Slot& slot)
+    {
+        slot.open = false;
+        if (!closed_any_ || slot.epoch > newest_closed_)
+            newest_closed_ = slot.epoch;
+        closed_any_ = true;
+    }
+} // namespace io_comm_rx
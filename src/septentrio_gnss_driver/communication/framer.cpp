@@ -0,0 +1,219 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <septentrio_gnss_driver/communication/framer.hpp>
+#include <septentrio_gnss_driver/communication/pipeline_statistics.hpp>
+#include <septentrio_gnss_driver/communication/receiver_context.hpp>
+#include <septentrio_gnss_driver/communication/rx_message.hpp>
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+
+/**
+ * @file framer.cpp
+ * @date 14/10/26
+ * @brief Defines an incremental framer for the incoming byte stream
+ */
+
+namespace io_comm_rx {
+
+    const std::size_t Framer::SBF_MAX_LENGTH;
+    const std::size_t Framer::NMEA_MAX_LENGTH;
+    const std::size_t Framer::RESPONSE_MAX_LENGTH;
+    const std::size_t Framer::CONNECTION_DESCRIPTOR_LENGTH;
+
+    static_assert(sizeof(MeasEpoch) <= Framer::SBF_MAX_LENGTH,
+                  "SBF_MAX_LENGTH must hold the largest SBF block");
+
+    FramerResult_Enum Framer::next(const uint8_t* data, std::size_t size,
+                                   Frame& frame)
+    {
+        // Read once per call, since the thread configuring the Rx sets it anew
+        // for every TCP connection
+        const bool read_cd = context_ && context_->read_cd;
+        // Garbage is skipped by the SyncScanner, which stops at every byte
+        // that might start a header
+        for (std::size_t pos = SyncScanner::find(data, size, read_cd);
+             pos + 1 < size;
+             pos += 1 + SyncScanner::find(data + pos + 1, size - pos - 1, read_cd))
+        {
+            const uint8_t first = data[pos];
+            const uint8_t second = data[pos + 1];
+            frame.offset = pos;
+            if (first == SBF_SYNC_BYTE_1)
+            {
+                switch (SyncScanner::classify(second))
+                {
+                case evSBFSync:
+                    return frameSBF(data + pos, size - pos, frame);
+                case evNMEASync:
+                    return frameNMEA(data + pos, size - pos, frame);
+                case evResponseSync:
+                    return frameResponse(data + pos, size - pos, frame);
+                default:
+                    break;
+                }
+            } else if (first == CONNECTION_DESCRIPTOR_BYTE_1 &&
+                       second == CONNECTION_DESCRIPTOR_BYTE_2)
+            {
+                frame.type = evConnectionDescriptorFrame;
+                frame.size = CONNECTION_DESCRIPTOR_LENGTH;
+                return (size - pos < CONNECTION_DESCRIPTOR_LENGTH)
+                           ? evFrameNeedMore
+                           : evFrameComplete;
+            }
+        }
+        // No header found: everything may go except for a trailing first sync
+        // byte, whose second byte is yet to come
+        frame.offset = size;
+        if (size > 0 &&
+            (data[size - 1] == SBF_SYNC_BYTE_1 ||
+             (read_cd && data[size - 1] == CONNECTION_DESCRIPTOR_BYTE_1)))
+        {
+            frame.offset = size - 1;
+        }
+        frame.size = 0;
+        return evFrameNeedMore;
+    }
+
+    FramerResult_Enum Framer::frameSBF(const uint8_t* data, std::size_t size,
+                                       Frame& frame)
+    {
+        frame.type = evSBFFrame;
+        frame.size = 0;
+        if (size < sizeof(BlockHeader_t))
+            return evFrameNeedMore;
+        uint16_t length;
+        memcpy(&length, data + 6, sizeof(length));
+        // SBF block lengths are always a multiple of 4 and include the header.
+        // A corrupted length would otherwise hold back all output until up to 64
+        // KiB arrived, which takes minutes on slow serial links.
+        if (length < sizeof(BlockHeader_t) || (length % 4) != 0 ||
+            length > SBF_MAX_LENGTH)
+            return resync();
+        if (size < length)
+            return evFrameNeedMore;
+        bool valid;
+        if (statistics_ && statistics_->timing())
+        {
+            const PipelineStatistics::Clock::time_point start =
+                PipelineStatistics::Clock::now();
+            valid = isValid(data);
+            statistics_->recordStage(evStageCRC, start,
+                                     PipelineStatistics::Clock::now());
+        } else
+            valid = isValid(data);
+        if (!valid)
+        {
+            ++crc_failures_;
+            if (statistics_)
+            {
+                uint16_t id;
+                memcpy(&id, data + 4, sizeof(id));
+                statistics_->recordCRCFailure(RxMessage::sbfKey(id));
+            }
+            return resync();
+        }
+        frame.size = length;
+        return evFrameComplete;
+    }
+
+    FramerResult_Enum Framer::frameNMEA(const uint8_t* data, std::size_t size,
+                                        Frame& frame)
+    {
+        frame.type = evNMEAFrame;
+        frame.size = 0;
+        std::size_t limit = std::min(size, NMEA_MAX_LENGTH);
+        for (std::size_t pos = 2; pos < limit; ++pos)
+        {
+            if (data[pos] == CARRIAGE_RETURN || data[pos] == LINE_FEED)
+            {
+                frame.size = pos;
+                return evFrameComplete;
+            }
+            // A new message starts before this one was terminated
+            if (data[pos] == NMEA_SYNC_BYTE_1)
+                return resync();
+        }
+        if (size < NMEA_MAX_LENGTH)
+            return evFrameNeedMore;
+        return resync();
+    }
+
+    FramerResult_Enum Framer::frameResponse(const uint8_t* data, std::size_t size,
+                                            Frame& frame)
+    {
+        frame.type = evResponseFrame;
+        std::size_t limit = std::min(size, RESPONSE_MAX_LENGTH);
+        for (std::size_t pos = 2; pos + 1 < limit; ++pos)
+        {
+            if (!(data[pos] == CARRIAGE_RETURN && data[pos + 1] == LINE_FEED))
+                continue;
+            // Multi-line replies continue with two spaces and N, S or R after CR LF
+            static const uint8_t continuation[] = {0x20, 0x20};
+            std::size_t available = size - (pos + 2);
+            bool continues = true;
+            for (std::size_t i = 0; i < 3 && i < available; ++i)
+            {
+                const uint8_t c = data[pos + 2 + i];
+                if ((i < 2 && c != continuation[i]) ||
+                    (i == 2 && c != 0x4E && c != 0x53 && c != 0x52))
+                {
+                    continues = false;
+                    break;
+                }
+            }
+            if (!continues)
+            {
+                frame.size = pos;
+                return evFrameComplete;
+            }
+            if (available < 3)
+            {
+                frame.size = 0;
+                return evFrameNeedMore;
+            }
+        }
+        if (size < RESPONSE_MAX_LENGTH)
+        {
+            frame.size = 0;
+            return evFrameNeedMore;
+        }
+        // Overly long reply, pass on what we have
+        frame.size = RESPONSE_MAX_LENGTH;
+        return evFrameComplete;
+    }
+
+    FramerResult_Enum Framer::resync()
+    {
+        ++resyncs_;
+        if (statistics_)
+            statistics_->recordResync();
+        return evFrameResync;
+    }
+} // namespace io_comm_rx
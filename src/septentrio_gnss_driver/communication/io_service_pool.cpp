@@ -0,0 +1,79 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+// Boost includes
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+// ROS includes
+#include <ros/ros.h>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/io_service_pool.hpp>
+
+/**
+ * @file io_service_pool.cpp
+ * @date 14/10/26
+ * @brief Runs one io_service on a pool of threads
+ */
+
+namespace io_comm_rx {
+
+    IoServicePool::IoServicePool(std::size_t threads) :
+        work_(new boost::asio::io_service::work(io_service_))
+    {
+        threads = std::max<std::size_t>(threads, 1);
+        threads_.reserve(threads);
+        for (std::size_t i = 0; i != threads; ++i)
+        {
+            // The cast picks the overload of run() that throws on error
+            threads_.push_back(boost::make_shared<boost::thread>(boost::bind(
+                static_cast<std::size_t (boost::asio::io_service::*)()>(
+                    &boost::asio::io_service::run),
+                &io_service_)));
+        }
+        ROS_DEBUG("Started %li I/O threads", threads_.size());
+    }
+
+    IoServicePool::~IoServicePool() { stop(); }
+
+    void IoServicePool::stop()
+    {
+        boost::mutex::scoped_lock lock(stop_mutex_);
+        work_.reset();
+        io_service_.stop();
+        for (const boost::shared_ptr<boost::thread>& thread : threads_)
+        {
+            if (thread->get_id() != boost::this_thread::get_id() &&
+                thread->joinable())
+                thread->join();
+        }
+    }
+} // namespace io_comm_rx
@@ -0,0 +1,131 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+
+/**
+ * @file mapped_file.cpp
+ * @date 14/10/26
+ * @brief Maps log files into memory for SBF replay
+ */
+
+namespace io_comm_rx {
+
+    const std::size_t MappedFile::MAPPING_GUARD_SIZE;
+
+    MappedFile::MappedFile() :
+        data_(nullptr), size_(0), mapped_size_(0), released_(0)
+    {
+    }
+
+    MappedFile::~MappedFile() { close(); }
+
+    bool MappedFile::open(const std::string& file_name)
+    {
+        close();
+        // Pipes and devices cannot be mapped. Check before opening them, as opening
+        // and closing a FIFO would cut off its writer.
+        struct stat file_stat;
+        if (stat(file_name.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode))
+            return false;
+        int fd = ::open(file_name.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        if (fstat(fd, &file_stat) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+        std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::size_t mapped_size =
+            (file_size + page_size - 1) / page_size * page_size + MAPPING_GUARD_SIZE;
+
+        // Reserve zeroed memory for file and guard, then lay the file over the
+        // front of it. Touching file pages past the end of the file would raise
+        // SIGBUS, touching the anonymous guard pages is harmless.
+        void* base = mmap(nullptr, mapped_size, PROT_READ,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED)
+        {
+            ::close(fd);
+            return false;
+        }
+        if (file_size > 0 &&
+            mmap(base, file_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) ==
+                MAP_FAILED)
+        {
+            munmap(base, mapped_size);
+            ::close(fd);
+            return false;
+        }
+        // The mapping keeps its own reference to the file.
+        ::close(fd);
+        if (file_size > 0)
+            madvise(base, file_size, MADV_SEQUENTIAL);
+
+        data_ = static_cast<uint8_t*>(base);
+        size_ = file_size;
+        mapped_size_ = mapped_size;
+        released_ = 0;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (!data_)
+            return;
+        munmap(data_, mapped_size_);
+        data_ = nullptr;
+        size_ = 0;
+        mapped_size_ = 0;
+        released_ = 0;
+    }
+
+    void MappedFile::release(std::size_t offset)
+    {
+        if (!data_)
+            return;
+        std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        // Only whole pages can be dropped, keep the one "offset" points into.
+        std::size_t end = std::min(offset, size_) / page_size * page_size;
+        if (end <= released_)
+            return;
+        madvise(data_ + released_, end - released_, MADV_DONTNEED);
+        released_ = end;
+    }
+} // namespace io_comm_rx
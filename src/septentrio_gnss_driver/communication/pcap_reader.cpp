@@ -30,12 +30,12 @@
 
 #include "septentrio_gnss_driver/communication/pcap_reader.hpp"
 
-#include <chrono>
+#include <algorithm>
 #include <net/ethernet.h>
+#include <netinet/in.h>
 #include <netinet/ip.h>
 #include <netinet/tcp.h>
 #include <ros/ros.h>
-#include <thread>
 
 /**
  * @file pcap_reader.cpp
@@ -44,17 +44,19 @@
  *
  * @brief Implements auxiliary reader object for handling pcap files.
  *
- * Functions include connecting to the file, reading the contents to the
+ * Functions include connecting to the file, reassembling the TCP stream into the
  * specified data buffer and graceful exit.
  */
 
 namespace pcapReader {
 
+    const size_t PcapDevice::MAX_PENDING_SEGMENTS;
+
     PcapDevice::PcapDevice(buffer_t& buffer) : m_dataBuff{buffer} {}
 
     PcapDevice::~PcapDevice() { disconnect(); }
 
-    bool PcapDevice::connect(const char* device)
+    bool PcapDevice::connect(const char* device, const std::string& filter)
     {
         if (isConnected())
             return true;
@@ -62,13 +64,51 @@ namespace pcapReader {
         if ((m_device = pcap_open_offline(device, m_errBuff)) == nullptr)
             return false;
 
-        m_deviceName = (char*)device;
-        // Try to compile filter program
-        if (pcap_compile(m_device, &m_pktFilter, "tcp dst port 3001", 1,
+        m_deviceName = device;
+        switch (pcap_datalink(m_device))
+        {
+        case DLT_EN10MB:
+            m_linkHeaderLength = sizeof(struct ethhdr);
+            break;
+        case DLT_LINUX_SLL:
+            m_linkHeaderLength = 16;
+            break;
+        case DLT_NULL:
+            m_linkHeaderLength = 4;
+            break;
+        case DLT_RAW:
+            m_linkHeaderLength = 0;
+            break;
+        default:
+            ROS_ERROR("Unsupported link type %d in %s", pcap_datalink(m_device),
+                      m_deviceName.c_str());
+            disconnect();
+            return false;
+        }
+
+        // Try to compile and apply filter program
+        if (pcap_compile(m_device, &m_pktFilter, filter.c_str(), 1,
                          PCAP_NETMASK_UNKNOWN) != 0)
+        {
+            ROS_ERROR("Invalid filter \"%s\": %s", filter.c_str(),
+                      pcap_geterr(m_device));
+            disconnect();
             return false;
+        }
+        m_filterCompiled = true;
+        if (pcap_setfilter(m_device, &m_pktFilter) != 0)
+        {
+            ROS_ERROR("Could not apply filter \"%s\": %s", filter.c_str(),
+                      pcap_geterr(m_device));
+            disconnect();
+            return false;
+        }
 
-        ROS_INFO("Connected to %s", m_deviceName);
+        m_streamStarted = false;
+        m_pending.clear();
+        m_foreignPackets = 0;
+        ROS_INFO("Connected to %s, filter \"%s\"", m_deviceName.c_str(),
+                 filter.c_str());
         return true;
     }
 
@@ -77,9 +117,14 @@ namespace pcapReader {
         if (!isConnected())
             return;
 
+        if (m_filterCompiled)
+        {
+            pcap_freecode(&m_pktFilter);
+            m_filterCompiled = false;
+        }
         pcap_close(m_device);
         m_device = nullptr;
-        ROS_INFO("Disconnected from %s", m_deviceName);
+        ROS_INFO("Disconnected from %s", m_deviceName.c_str());
     }
 
     bool PcapDevice::isConnected() const { return m_device; }
@@ -95,93 +140,131 @@ namespace pcapReader {
 
         result = pcap_next_ex(m_device, &header, &pktData);
 
-        if (result >= 0)
+        if (result == -2)
         {
-            auto ipHdr =
-                reinterpret_cast<const iphdr*>(pktData + sizeof(struct ethhdr));
-            uint32_t ipHdrLen = ipHdr->ihl * 4u;
-
-            switch (ipHdr->protocol)
-            {
-            case 6:
+            ROS_INFO("Done reading from %s", m_deviceName.c_str());
+            // Whatever is still held back will not be completed anymore.
+            while (!m_pending.empty())
+                skipGap();
+            if (m_foreignPackets > 0)
             {
-                if (header->len == 54)
-                {
-                    return READ_SUCCESS;
-                }
-                bool storePkt = true;
-
-                if (!m_lastPkt.empty())
-                {
-                    auto tcpHdr = reinterpret_cast<const tcphdr*>(
-                        pktData + ipHdrLen + sizeof(struct ethhdr));
-
-                    auto lastIpHdr = reinterpret_cast<const iphdr*>(&(m_lastPkt[0]));
-                    uint32_t lastIpHdrLen = lastIpHdr->ihl * 4u;
-                    auto lastTcpHdr = reinterpret_cast<const tcphdr*>(
-                        &(m_lastPkt[0]) + lastIpHdrLen);
-                    uint16_t lastLen =
-                        ntohs(static_cast<uint16_t>(lastIpHdr->tot_len));
-                    uint16_t newLen = ntohs(static_cast<uint16_t>(ipHdr->tot_len));
-                    uint32_t lastSeq = ntohl(lastTcpHdr->seq);
-                    uint32_t newSeq = ntohl(tcpHdr->seq);
-
-                    if (newSeq != lastSeq)
-                    {
-                        uint32_t dataOffset = lastTcpHdr->doff * 4;
-                        m_dataBuff.insert(m_dataBuff.end(),
-                                          m_lastPkt.begin() + lastIpHdrLen +
-                                              dataOffset,
-                                          m_lastPkt.end());
-                    } else if (newLen <= lastLen)
-                    {
-                        storePkt = false;
-                    }
-                }
-
-                if (storePkt)
-                {
-                    m_lastPkt.clear();
-                    m_lastPkt.insert(m_lastPkt.end(),
-                                     pktData + sizeof(struct ethhdr),
-                                     pktData + header->len);
-                }
-                break;
+                ROS_WARN("Ignored %zu packets of other TCP streams in %s",
+                         m_foreignPackets, m_deviceName.c_str());
             }
+            disconnect();
+            return READ_SUCCESS;
+        } else if (result < 0)
+        {
+            ROS_ERROR("Error reading data: %s", pcap_geterr(m_device));
+            return READ_ERROR;
+        } else if (result == 0)
+        {
+            return READ_TIMEOUT;
+        }
 
-            default:
-            {
-                ROS_ERROR("Skipping protocol: %d", result);
-                return READ_ERROR;
-            }
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
+        // Packets that are not (complete enough) IPv4/TCP are skipped.
+        size_t capLen = header->caplen;
+        if (capLen < m_linkHeaderLength + sizeof(struct iphdr))
+            return READ_SUCCESS;
+        auto ipHdr = reinterpret_cast<const iphdr*>(pktData + m_linkHeaderLength);
+        if (ipHdr->version != 4 || ipHdr->protocol != IPPROTO_TCP)
+            return READ_SUCCESS;
+        size_t ipHdrLen = ipHdr->ihl * 4u;
+        // Ethernet pads short frames, so the IP length marks the end of the segment.
+        size_t ipEnd = std::min(capLen, m_linkHeaderLength + ntohs(ipHdr->tot_len));
+        if (ipEnd < m_linkHeaderLength + ipHdrLen + sizeof(struct tcphdr))
             return READ_SUCCESS;
-        } else if (result == -2)
+        auto tcpHdr =
+            reinterpret_cast<const tcphdr*>(pktData + m_linkHeaderLength + ipHdrLen);
+        size_t payloadStart = m_linkHeaderLength + ipHdrLen + tcpHdr->doff * 4u;
+        if (payloadStart > ipEnd)
+            return READ_SUCCESS;
+
+        FlowKey flow{ipHdr->saddr, ipHdr->daddr, tcpHdr->source, tcpHdr->dest};
+        uint32_t seq = ntohl(tcpHdr->seq);
+        if (!m_streamStarted)
         {
-            ROS_INFO("Done reading from %s", m_deviceName);
-            if (!m_lastPkt.empty())
-            {
-                auto lastIpHdr = reinterpret_cast<const iphdr*>(&(m_lastPkt[0]));
-                uint32_t ipHdrLength = lastIpHdr->ihl * 4u;
+            // Pure ACKs do not tell where the stream starts.
+            if (!tcpHdr->syn && payloadStart == ipEnd)
+                return READ_SUCCESS;
+            m_flow = flow;
+            m_streamStarted = true;
+            m_nextSeq = tcpHdr->syn ? seq + 1 : seq;
+        } else if (!(flow == m_flow))
+        {
+            ++m_foreignPackets;
+            return READ_SUCCESS;
+        }
+        // The SYN flag occupies one sequence number ahead of any payload.
+        if (tcpHdr->syn)
+            ++seq;
+        reassemble(seq, pktData + payloadStart, ipEnd - payloadStart);
+        return READ_SUCCESS;
+    }
 
-                auto lastTcpHdr =
-                    reinterpret_cast<const tcphdr*>(&(m_lastPkt[0]) + ipHdrLength);
-                uint32_t dataOffset = lastTcpHdr->doff * 4u;
+    void PcapDevice::reassemble(uint32_t seq, const uint8_t* payload, size_t length)
+    {
+        if (length == 0)
+            return;
+        if (append(seq, payload, length))
+        {
+            drainPending();
+            return;
+        }
+        // Keep the longest copy if a held-back segment is retransmitted.
+        buffer_t& pending = m_pending[seq];
+        if (pending.size() < length)
+            pending.assign(payload, payload + length);
+        if (m_pending.size() > MAX_PENDING_SEGMENTS)
+            skipGap();
+    }
 
-                m_dataBuff.insert(m_dataBuff.end(),
-                                  m_lastPkt.begin() + ipHdrLength + dataOffset,
-                                  m_lastPkt.end());
+    bool PcapDevice::append(uint32_t seq, const uint8_t* payload, size_t length)
+    {
+        // Signed distance, so that comparisons survive sequence number wrap-around
+        int32_t ahead = static_cast<int32_t>(seq - m_nextSeq);
+        if (ahead > 0)
+            return false;
+        size_t overlap = static_cast<size_t>(-static_cast<int64_t>(ahead));
+        if (overlap < length)
+        {
+            m_dataBuff.insert(m_dataBuff.end(), payload + overlap, payload + length);
+            m_nextSeq += static_cast<uint32_t>(length - overlap);
+        }
+        return true;
+    }
 
-                m_lastPkt.clear();
+    void PcapDevice::drainPending()
+    {
+        bool progress = true;
+        while (progress && !m_pending.empty())
+        {
+            progress = false;
+            for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
+            {
+                if (static_cast<int32_t>(it->first - m_nextSeq) <= 0)
+                {
+                    append(it->first, it->second.data(), it->second.size());
+                    m_pending.erase(it);
+                    progress = true;
+                    break;
+                }
             }
-            disconnect();
-            return READ_SUCCESS;
-        } else
+        }
+    }
+
+    void PcapDevice::skipGap()
+    {
+        auto earliest = m_pending.begin();
+        for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
         {
-            ROS_ERROR("Error reading data");
-            return READ_ERROR;
+            if (static_cast<int32_t>(it->first - m_nextSeq) <
+                static_cast<int32_t>(earliest->first - m_nextSeq))
+                earliest = it;
         }
+        ROS_WARN("%u bytes of the TCP stream are missing in %s, skipping them",
+                 earliest->first - m_nextSeq, m_deviceName.c_str());
+        m_nextSeq = earliest->first;
+        drainPending();
     }
-} // namespace pcapReader
\ No newline at end of file
+} // namespace pcapReader
@@ -0,0 +1,257 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/pipeline_statistics.hpp>
+
+/**
+ * @file pipeline_statistics.cpp
+ * @date 14/10/26
+ * @brief Defines the counters and latency histograms of the pipeline stages
+ */
+
+namespace {
+    //! Names of the stages, in the order of PipelineStage_Enum
+    const char* const STAGE_NAMES[io_comm_rx::evStageCount] = {
+        "Read",  "Buffer", "Frame",   "CRC",
+        "Queue", "Decode", "Publish", "End-to-end"};
+
+    //! Names of the dispatch keys, in the order of RxID_Enum
+    const char* const KEY_NAMES[evRxIDCount] = {
+        "NavSatFix",       "GPSFix",         "PoseWithCovarianceStamped",
+        "GPGGA",           "GPRMC",          "GPGSA",
+        "GPGSV",           "GLGSV",          "GAGSV",
+        "GBGSV",           "PVTCartesian",   "PVTGeodetic",
+        "PosCovCartesian", "PosCovGeodetic", "AttEuler",
+        "AttCovEuler",     "GPST",           "ChannelStatus",
+        "MeasEpoch",       "DOP",            "VelCovGeodetic",
+        "DiagnosticArray", "ReceiverStatus", "QualityInd",
+        "ReceiverSetup",   "Unknown"};
+
+    void addValue(diagnostic_msgs::DiagnosticStatus& status, const std::string& key,
+                  const std::string& value)
+    {
+        diagnostic_msgs::KeyValue key_value;
+        key_value.key = key;
+        key_value.value = value;
+        status.values.push_back(key_value);
+    }
+
+    std::string formatRate(double value)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.1f", value);
+        return text;
+    }
+
+    //! Formats "ns" nanoseconds in microseconds
+    std::string formatMicroseconds(uint64_t ns)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.1f", static_cast<double>(ns) * 1e-3);
+        return text;
+    }
+} // namespace
+
+namespace io_comm_rx {
+
+    const std::size_t LatencyHistogram::SUB_BUCKETS;
+    const std::size_t LatencyHistogram::BUCKET_COUNT;
+
+    LatencyHistogram::LatencyHistogram() : max_ns_(0)
+    {
+        for (std::atomic<uint64_t>& bucket : buckets_)
+            bucket.store(0);
+    }
+
+    //! Latencies below SUB_BUCKETS get a bucket each, the others are classified by
+    //! their most significant bit and the three bits that follow it.
+    std::size_t LatencyHistogram::bucketOf(uint64_t ns)
+    {
+        if (ns < SUB_BUCKETS)
+            return static_cast<std::size_t>(ns);
+        const std::size_t exponent = 63 - __builtin_clzll(ns);
+        const std::size_t sub_bucket = (ns >> (exponent - 3)) & (SUB_BUCKETS - 1);
+        return (exponent - 2) * SUB_BUCKETS + sub_bucket;
+    }
+
+    uint64_t LatencyHistogram::upperBound(std::size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+        const std::size_t shift = bucket / SUB_BUCKETS - 1;
+        const uint64_t lower =
+            static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+        return lower + ((static_cast<uint64_t>(1) << shift) - 1);
+    }
+
+    void LatencyHistogram::drain(Snapshot& snapshot)
+    {
+        snapshot.count = 0;
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            snapshot.buckets[i] =
+                buckets_[i].exchange(0, std::memory_order_relaxed);
+            snapshot.count += snapshot.buckets[i];
+        }
+        snapshot.max_ns = max_ns_.exchange(0, std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::Snapshot::quantile(double quantile) const
+    {
+        if (count == 0)
+            return 0;
+        const uint64_t rank = std::max<uint64_t>(
+            1, static_cast<uint64_t>(
+                   std::ceil(quantile * static_cast<double>(count))));
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+                return std::min(upperBound(i), max_ns);
+        }
+        return max_ns;
+    }
+
+    PipelineStatistics::PipelineStatistics() :
+        timing_(false), resyncs_(0), buffer_overflows_(0), dropped_bytes_(0),
+        buffer_high_water_mark_(0), reported_overflows_(0),
+        reported_at_(Clock::now())
+    {
+        for (KeyCounters& counters : keys_)
+        {
+            counters.frames.store(0);
+            counters.bytes.store(0);
+            counters.crc_failures.store(0);
+            counters.dropped.store(0);
+        }
+        for (KeyTotals& totals : reported_)
+            totals = KeyTotals();
+    }
+
+    const char* PipelineStatistics::keyName(RxID_Enum key)
+    {
+        return KEY_NAMES[key < evRxIDCount ? key : evUnknownMessage];
+    }
+
+    void PipelineStatistics::report(diagnostic_msgs::DiagnosticStatus& status)
+    {
+        const Clock::time_point now = Clock::now();
+        const double period_s = std::max(
+            std::chrono::duration<double>(now - reported_at_).count(), 1e-3);
+        reported_at_ = now;
+        status.values.clear();
+
+        // Per key: the rate over the interval, failures and drops so far
+        KeyTotals interval = KeyTotals();
+        KeyTotals total = KeyTotals();
+        for (std::size_t key = 0; key < evRxIDCount; ++key)
+        {
+            KeyTotals current;
+            current.frames = keys_[key].frames.load(std::memory_order_relaxed);
+            current.bytes = keys_[key].bytes.load(std::memory_order_relaxed);
+            current.crc_failures =
+                keys_[key].crc_failures.load(std::memory_order_relaxed);
+            current.dropped = keys_[key].dropped.load(std::memory_order_relaxed);
+            KeyTotals& previous = reported_[key];
+            interval.frames += current.frames - previous.frames;
+            interval.bytes += current.bytes - previous.bytes;
+            interval.crc_failures += current.crc_failures - previous.crc_failures;
+            interval.dropped += current.dropped - previous.dropped;
+            total.crc_failures += current.crc_failures;
+            total.dropped += current.dropped;
+            if (current.frames > 0 || current.crc_failures > 0)
+            {
+                const std::string name = KEY_NAMES[key];
+                addValue(status, name + " blocks/s",
+                         formatRate((current.frames - previous.frames) / period_s));
+                addValue(status, name + " CRC failures",
+                         std::to_string(current.crc_failures));
+                addValue(status, name + " dropped", std::to_string(current.dropped));
+            }
+            previous = current;
+        }
+
+        addValue(status, "Messages/s", formatRate(interval.frames / period_s));
+        addValue(status, "Bytes/s", formatRate(interval.bytes / period_s));
+        addValue(status, "CRC failures", std::to_string(total.crc_failures));
+        addValue(status, "Resyncs",
+                 std::to_string(resyncs_.load(std::memory_order_relaxed)));
+        addValue(status, "Decode queue drops", std::to_string(total.dropped));
+        const uint64_t overflows = buffer_overflows_.load(std::memory_order_relaxed);
+        addValue(status, "Buffer overflows", std::to_string(overflows));
+        addValue(status, "Dropped bytes",
+                 std::to_string(dropped_bytes_.load(std::memory_order_relaxed)));
+        addValue(status, "Buffer high-water mark [bytes]",
+                 std::to_string(
+                     buffer_high_water_mark_.load(std::memory_order_relaxed)));
+        addValue(status, "Message allocations",
+                 std::to_string(RxMessage::messageAllocations()));
+
+        if (timing())
+        {
+            for (std::size_t stage = 0; stage < evStageCount; ++stage)
+            {
+                histograms_[stage].drain(snapshot_);
+                if (snapshot_.count == 0)
+                    continue;
+                addValue(status,
+                         std::string(STAGE_NAMES[stage]) +
+                             " latency p50/p99/p99.9/max [us]",
+                         formatMicroseconds(snapshot_.quantile(0.5)) + " / " +
+                             formatMicroseconds(snapshot_.quantile(0.99)) + " / " +
+                             formatMicroseconds(snapshot_.quantile(0.999)) + " / " +
+                             formatMicroseconds(snapshot_.max_ns));
+            }
+        }
+
+        const bool overflowed = overflows != reported_overflows_;
+        reported_overflows_ = overflows;
+        if (interval.crc_failures > 0 || interval.dropped > 0 || overflowed)
+        {
+            status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+            status.message = std::to_string(interval.crc_failures) +
+                             " CRC failures, " + std::to_string(interval.dropped) +
+                             " messages dropped" +
+                             (overflowed ? ", circular buffer overflowed" : "") +
+                             " in the last " + formatRate(period_s) + " s";
+        } else
+        {
+            status.level = diagnostic_msgs::DiagnosticStatus::OK;
+            status.message = formatRate(interval.frames / period_s) + " messages/s";
+        }
+    }
+} // namespace io_comm_rx
@@ -0,0 +1,166 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstring>
+#include <thread>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/replay_scheduler.hpp>
+#include <septentrio_gnss_driver/communication/trace_ring.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+/**
+ * @file replay_scheduler.cpp
+ * @date 14/10/26
+ * @brief Paces SBF/PCAP file replay by the receiver time stamps of the frames
+ */
+
+namespace {
+    using parsing_utilities::MS_PER_DAY;
+    using parsing_utilities::MS_PER_WEEK;
+    //! Do-not-use values of the SBF TOW and WNc fields
+    const uint32_t TOW_DO_NOT_USE = 4294967295u;
+    const uint16_t WNC_DO_NOT_USE = 65535;
+
+    //! Reads "hhmmss[.ss]" at "pos" into milliseconds of the day, returns false if the
+    //! field is empty or malformed
+    bool parseTimeOfDay(const uint8_t* data, std::size_t size, std::size_t pos,
+                        int64_t& ms)
+    {
+        if (pos + 6 > size)
+            return false;
+        int64_t digits[6];
+        for (std::size_t i = 0; i < 6; ++i)
+        {
+            if (data[pos + i] < '0' || data[pos + i] > '9')
+                return false;
+            digits[i] = data[pos + i] - '0';
+        }
+        ms = ((digits[0] * 10 + digits[1]) * 3600 + (digits[2] * 10 + digits[3]) * 60 +
+              digits[4] * 10 + digits[5]) *
+             1000;
+        pos += 6;
+        if (pos < size && data[pos] == '.')
+        {
+            int64_t scale = 100;
+            for (++pos; pos < size && data[pos] >= '0' && data[pos] <= '9'; ++pos)
+            {
+                ms += (data[pos] - '0') * scale;
+                scale /= 10;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+namespace io_comm_rx {
+
+    const int64_t ReplayScheduler::MAX_GAP_MS;
+
+    ReplayScheduler::ReplayScheduler() :
+        rate_(1.0), started_(false), sbf_seen_(false), anchor_time_ms_(0),
+        last_time_ms_(0)
+    {
+    }
+
+    void ReplayScheduler::start(double rate)
+    {
+        rate_ = rate;
+        started_ = false;
+        sbf_seen_ = false;
+    }
+
+    void ReplayScheduler::pace(const uint8_t* data, const Frame& frame)
+    {
+        if (rate_ <= 0.0)
+            return;
+        if (frame.type == evSBFFrame)
+        {
+            uint32_t tow;
+            uint16_t wnc;
+            memcpy(&tow, data + 8, sizeof(tow));
+            memcpy(&wnc, data + 12, sizeof(wnc));
+            if (tow == TOW_DO_NOT_USE || wnc == WNC_DO_NOT_USE)
+                return;
+            if (!sbf_seen_)
+            {
+                // Different time scale than GGA, start over
+                sbf_seen_ = true;
+                started_ = false;
+            }
+            paceTo(static_cast<int64_t>(wnc) * MS_PER_WEEK + tow);
+        } else if (frame.type == evNMEAFrame && !sbf_seen_)
+        {
+            // $xxGGA,hhmmss.ss,...
+            if (frame.size < 7 || memcmp(data + 3, "GGA,", 4) != 0)
+                return;
+            int64_t time_ms;
+            if (!parseTimeOfDay(data, frame.size, 7, time_ms))
+                return;
+            // Carry the day over at midnight
+            if (started_)
+            {
+                int64_t day = last_time_ms_ / MS_PER_DAY * MS_PER_DAY;
+                time_ms += day;
+                if (time_ms < last_time_ms_ - MS_PER_DAY / 2)
+                    time_ms += MS_PER_DAY;
+            }
+            paceTo(time_ms);
+        }
+    }
+
+    void ReplayScheduler::paceTo(int64_t time_ms)
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!started_ || time_ms < last_time_ms_ ||
+            time_ms - last_time_ms_ > MAX_GAP_MS)
+        {
+            started_ = true;
+            anchor_time_ms_ = time_ms;
+            anchor_wall_ = now;
+            last_time_ms_ = time_ms;
+            return;
+        }
+        last_time_ms_ = time_ms;
+        std::chrono::steady_clock::time_point due =
+            anchor_wall_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                               std::chrono::duration<double, std::milli>(
+                                   (time_ms - anchor_time_ms_) / rate_));
+        if (due > now)
+        {
+            ROSAIC_TRACE_EVENT(
+                evTraceReplayWait, 0,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(due - now)
+                    .count(),
+                0);
+            std::this_thread::sleep_until(due);
+        }
+    }
+} // namespace io_comm_rx
@@ -28,7 +28,13 @@
 //
 // *****************************************************************************
 
+// C++ library includes
+#include <algorithm>
+#include <array>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/publisher_registry.hpp>
 #include <septentrio_gnss_driver/communication/rx_message.hpp>
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
 
 /**
  * @file rx_message.cpp
@@ -36,18 +42,32 @@
  * @brief Defines a class that reads messages handed over from the circular buffer
  */
 
-uint32_t io_comm_rx::RxMessage::count_gpsfix_ = 0;
-PVTGeodetic io_comm_rx::RxMessage::last_pvtgeodetic_ = PVTGeodetic();
-PosCovGeodetic io_comm_rx::RxMessage::last_poscovgeodetic_ = PosCovGeodetic();
-AttEuler io_comm_rx::RxMessage::last_atteuler_ = AttEuler();
-AttCovEuler io_comm_rx::RxMessage::last_attcoveuler_ = AttCovEuler();
-ChannelStatus io_comm_rx::RxMessage::last_channelstatus_ = ChannelStatus();
-MeasEpoch io_comm_rx::RxMessage::last_measepoch_ = MeasEpoch();
-DOP io_comm_rx::RxMessage::last_dop_ = DOP();
-VelCovGeodetic io_comm_rx::RxMessage::last_velcovgeodetic_ = VelCovGeodetic();
-ReceiverStatus io_comm_rx::RxMessage::last_receiverstatus_ = ReceiverStatus();
-QualityInd io_comm_rx::RxMessage::last_qualityind_ = QualityInd();
-ReceiverSetup io_comm_rx::RxMessage::last_receiversetup_ = ReceiverSetup();
+io_comm_rx::MessagePool<septentrio_gnss_driver::PVTCartesian>
+    io_comm_rx::RxMessage::pvtcartesian_pool_;
+io_comm_rx::MessagePool<septentrio_gnss_driver::PVTGeodetic>
+    io_comm_rx::RxMessage::pvtgeodetic_pool_;
+io_comm_rx::MessagePool<septentrio_gnss_driver::PosCovCartesian>
+    io_comm_rx::RxMessage::poscovcartesian_pool_;
+io_comm_rx::MessagePool<septentrio_gnss_driver::PosCovGeodetic>
+    io_comm_rx::RxMessage::poscovgeodetic_pool_;
+io_comm_rx::MessagePool<septentrio_gnss_driver::AttEuler>
+    io_comm_rx::RxMessage::atteuler_pool_;
+io_comm_rx::MessagePool<septentrio_gnss_driver::AttCovEuler>
+    io_comm_rx::RxMessage::attcoveuler_pool_;
+io_comm_rx::MessagePool<sensor_msgs::TimeReference>
+    io_comm_rx::RxMessage::timereference_pool_;
+io_comm_rx::MessagePool<sensor_msgs::NavSatFix>
+    io_comm_rx::RxMessage::navsatfix_pool_;
+io_comm_rx::MessagePool<gps_common::GPSFix> io_comm_rx::RxMessage::gpsfix_pool_;
+io_comm_rx::MessagePool<geometry_msgs::PoseWithCovarianceStamped>
+    io_comm_rx::RxMessage::pose_pool_;
+io_comm_rx::MessagePool<diagnostic_msgs::DiagnosticArray>
+    io_comm_rx::RxMessage::diagnosticarray_pool_;
+
+//! Number of distinct SVIDs, which are 8-bit in the SBF sub-blocks
+static const std::size_t SVID_COUNT = 256;
+//! Marks SVIDs without MeasEpoch sub-block in the SVID-indexed C/N0 table
+static const int32_t SVID_NOT_IN_SYNC = -1;
 
 //! Pair of iterators to facilitate initialization of the map
 std::pair<uint16_t, TypeOfPVT_Enum> type_of_pvt_pairs[] = {
@@ -66,217 +86,108 @@ io_comm_rx::RxMessage::TypeOfPVTMap
     io_comm_rx::RxMessage::type_of_pvt_map(type_of_pvt_pairs,
                                            type_of_pvt_pairs + evPPP + 1);
 
-//! Pair of iterators to facilitate initialization of the map
-std::pair<std::string, RxID_Enum> rx_id_pairs[] = {
-    std::make_pair("NavSatFix", evNavSatFix),
-    std::make_pair("GPSFix", evGPSFix),
-    std::make_pair("PoseWithCovarianceStamped", evPoseWithCovarianceStamped),
-    std::make_pair("$GPGGA", evGPGGA),
-    std::make_pair("$GPRMC", evGPRMC),
-    std::make_pair("$GPGSA", evGPGSA),
-    std::make_pair("$GPGSV", evGPGSV),
-    std::make_pair("$GLGSV", evGLGSV),
-    std::make_pair("$GAGSV", evGAGSV),
-    std::make_pair("4006", evPVTCartesian),
-    std::make_pair("4007", evPVTGeodetic),
-    std::make_pair("5905", evPosCovCartesian),
-    std::make_pair("5906", evPosCovGeodetic),
-    std::make_pair("5938", evAttEuler),
-    std::make_pair("5939", evAttCovEuler),
-    std::make_pair("GPST", evGPST),
-    std::make_pair("4013", evChannelStatus),
-    std::make_pair("4027", evMeasEpoch),
-    std::make_pair("4001", evDOP),
-    std::make_pair("5908", evVelCovGeodetic),
-    std::make_pair("DiagnosticArray", evDiagnosticArray),
-    std::make_pair("4014", evReceiverStatus),
-    std::make_pair("4082", evQualityInd),
-    std::make_pair("5902", evReceiverSetup)};
+TypeOfPVT_Enum io_comm_rx::RxMessage::typeOfPVT(uint8_t mode)
+{
+    // find() rather than operator[], which would insert unknown modes
+    const TypeOfPVTMap::const_iterator it = type_of_pvt_map.find(mode & 15);
+    return (it == type_of_pvt_map.end()) ? evNoPVT : it->second;
+}
+
+//! SBF block numbers handled by the driver together with their dispatch keys
+std::pair<uint16_t, RxID_Enum> sbf_id_pairs[] = {
+    std::make_pair(static_cast<uint16_t>(4006), evPVTCartesian),
+    std::make_pair(static_cast<uint16_t>(4007), evPVTGeodetic),
+    std::make_pair(static_cast<uint16_t>(5905), evPosCovCartesian),
+    std::make_pair(static_cast<uint16_t>(5906), evPosCovGeodetic),
+    std::make_pair(static_cast<uint16_t>(5938), evAttEuler),
+    std::make_pair(static_cast<uint16_t>(5939), evAttCovEuler),
+    std::make_pair(static_cast<uint16_t>(4013), evChannelStatus),
+    std::make_pair(static_cast<uint16_t>(4027), evMeasEpoch),
+    std::make_pair(static_cast<uint16_t>(4001), evDOP),
+    std::make_pair(static_cast<uint16_t>(5908), evVelCovGeodetic),
+    std::make_pair(static_cast<uint16_t>(4014), evReceiverStatus),
+    std::make_pair(static_cast<uint16_t>(4082), evQualityInd),
+    std::make_pair(static_cast<uint16_t>(5902), evReceiverSetup)};
+
+//! Builds the flat SBF block number to RxID_Enum table once at startup
+static const uint8_t* buildSBFIDTable()
+{
+    static uint8_t table[SBF_BLOCK_NUMBER_COUNT];
+    std::fill(table, table + SBF_BLOCK_NUMBER_COUNT,
+              static_cast<uint8_t>(evUnknownMessage));
+    for (const auto& pair : sbf_id_pairs)
+        table[pair.first] = static_cast<uint8_t>(pair.second);
+    return table;
+}
+
+const uint8_t* io_comm_rx::RxMessage::sbf_id_table_ = buildSBFIDTable();
 
-io_comm_rx::RxMessage::RxIDMap
-    io_comm_rx::RxMessage::rx_id_map(rx_id_pairs, rx_id_pairs + evReceiverSetup + 1);
+uint64_t io_comm_rx::RxMessage::messageAllocations()
+{
+    return pvtcartesian_pool_.allocations() + pvtgeodetic_pool_.allocations() +
+           poscovcartesian_pool_.allocations() +
+           poscovgeodetic_pool_.allocations() + atteuler_pool_.allocations() +
+           attcoveuler_pool_.allocations() + timereference_pool_.allocations() +
+           navsatfix_pool_.allocations() + gpsfix_pool_.allocations() +
+           pose_pool_.allocations() + diagnosticarray_pool_.allocations();
+}
+
+//! View of the block of type T retained for the epoch, empty if it did not arrive
+template <typename T>
+static io_comm_rx::BlockView<T> epochBlock(const io_comm_rx::BlockArena* epoch)
+{
+    return epoch ? epoch->view<T>() : io_comm_rx::BlockView<T>();
+}
 
 septentrio_gnss_driver::PVTGeodeticPtr
-io_comm_rx::RxMessage::PVTGeodeticCallback(PVTGeodetic& data)
+io_comm_rx::RxMessage::PVTGeodeticCallback(const BlockView<PVTGeodetic>& data)
 {
-    septentrio_gnss_driver::PVTGeodeticPtr msg =
-        boost::make_shared<septentrio_gnss_driver::PVTGeodetic>();
-    msg->block_header.sync_1 = data.block_header.sync_1;
-    msg->block_header.sync_2 = data.block_header.sync_2;
-    msg->block_header.crc = data.block_header.crc;
-    msg->block_header.id = data.block_header.id;
-    msg->block_header.length = data.block_header.length;
-    msg->block_header.tow = data.tow;
-    msg->block_header.wnc = data.wnc;
-    msg->mode = data.mode;
-    msg->error = data.error;
-    msg->latitude = data.latitude;
-    msg->longitude = data.longitude;
-    msg->height = data.height;
-    msg->undulation = data.undulation;
-    msg->vn = data.vn;
-    msg->ve = data.ve;
-    msg->vu = data.vu;
-    msg->cog = data.cog;
-    msg->rx_clk_bias = data.rx_clk_bias;
-    msg->rx_clk_drift = data.rx_clk_drift;
-    msg->time_system = data.time_system;
-    msg->datum = data.datum;
-    msg->nr_sv = data.nr_sv;
-    msg->wa_corr_info = data.wa_corr_info;
-    msg->reference_id = data.reference_id;
-    msg->mean_corr_age = data.mean_corr_age;
-    msg->signal_info = data.signal_info;
-    msg->alert_flag = data.alert_flag;
-    msg->nr_bases = data.nr_bases;
-    msg->ppp_info = data.ppp_info;
-    msg->latency = data.latency;
-    msg->h_accuracy = data.h_accuracy;
-    msg->v_accuracy = data.v_accuracy;
-    msg->misc = data.misc;
+    septentrio_gnss_driver::PVTGeodeticPtr msg = pvtgeodetic_pool_.acquire();
+    decodeBlock(data, *msg);
     return msg;
 }
 
 septentrio_gnss_driver::PVTCartesianPtr
-io_comm_rx::RxMessage::PVTCartesianCallback(PVTCartesian& data)
+io_comm_rx::RxMessage::PVTCartesianCallback(const BlockView<PVTCartesian>& data)
 {
-    septentrio_gnss_driver::PVTCartesianPtr msg =
-        boost::make_shared<septentrio_gnss_driver::PVTCartesian>();
-    msg->block_header.sync_1 = data.block_header.sync_1;
-    msg->block_header.sync_2 = data.block_header.sync_2;
-    msg->block_header.crc = data.block_header.crc;
-    msg->block_header.id = data.block_header.id;
-    msg->block_header.length = data.block_header.length;
-    msg->block_header.tow = data.tow;
-    msg->block_header.wnc = data.wnc;
-    msg->mode = data.mode;
-    msg->error = data.error;
-    msg->x = data.x;
-    msg->y = data.y;
-    msg->z = data.z;
-    msg->undulation = data.undulation;
-    msg->vx = data.vx;
-    msg->vy = data.vy;
-    msg->vz = data.vz;
-    msg->cog = data.cog;
-    msg->rx_clk_bias = data.rx_clk_bias;
-    msg->rx_clk_drift = data.rx_clk_drift;
-    msg->time_system = data.time_system;
-    msg->datum = data.datum;
-    msg->nr_sv = data.nr_sv;
-    msg->wa_corr_info = data.wa_corr_info;
-    msg->reference_id = data.reference_id;
-    msg->mean_corr_age = data.mean_corr_age;
-    msg->signal_info = data.signal_info;
-    msg->alert_flag = data.alert_flag;
-    msg->nr_bases = data.nr_bases;
-    msg->ppp_info = data.ppp_info;
-    msg->latency = data.latency;
-    msg->h_accuracy = data.h_accuracy;
-    msg->v_accuracy = data.v_accuracy;
-    msg->misc = data.misc;
+    septentrio_gnss_driver::PVTCartesianPtr msg = pvtcartesian_pool_.acquire();
+    decodeBlock(data, *msg);
     return msg;
 }
 
 septentrio_gnss_driver::PosCovCartesianPtr
-io_comm_rx::RxMessage::PosCovCartesianCallback(PosCovCartesian& data)
+io_comm_rx::RxMessage::PosCovCartesianCallback(
+    const BlockView<PosCovCartesian>& data)
 {
-    septentrio_gnss_driver::PosCovCartesianPtr msg =
-        boost::make_shared<septentrio_gnss_driver::PosCovCartesian>();
-    msg->block_header.sync_1 = data.block_header.sync_1;
-    msg->block_header.sync_2 = data.block_header.sync_2;
-    msg->block_header.crc = data.block_header.crc;
-    msg->block_header.id = data.block_header.id;
-    msg->block_header.length = data.block_header.length;
-    msg->block_header.tow = data.tow;
-    msg->block_header.wnc = data.wnc;
-    msg->mode = data.mode;
-    msg->error = data.error;
-    msg->cov_xx = data.cov_xx;
-    msg->cov_yy = data.cov_yy;
-    msg->cov_zz = data.cov_zz;
-    msg->cov_bb = data.cov_bb;
-    msg->cov_xy = data.cov_xy;
-    msg->cov_xz = data.cov_xz;
-    msg->cov_xb = data.cov_xb;
-    msg->cov_yz = data.cov_yz;
-    msg->cov_yb = data.cov_yb;
-    msg->cov_zb = data.cov_zb;
+    septentrio_gnss_driver::PosCovCartesianPtr msg = poscovcartesian_pool_.acquire();
+    decodeBlock(data, *msg);
     return msg;
 }
 
 septentrio_gnss_driver::PosCovGeodeticPtr
-io_comm_rx::RxMessage::PosCovGeodeticCallback(PosCovGeodetic& data)
+io_comm_rx::RxMessage::PosCovGeodeticCallback(
+    const BlockView<PosCovGeodetic>& data)
 {
-    septentrio_gnss_driver::PosCovGeodeticPtr msg =
-        boost::make_shared<septentrio_gnss_driver::PosCovGeodetic>();
-    msg->block_header.sync_1 = data.block_header.sync_1;
-    msg->block_header.sync_2 = data.block_header.sync_2;
-    msg->block_header.crc = data.block_header.crc;
-    msg->block_header.id = data.block_header.id;
-    msg->block_header.length = data.block_header.length;
-    msg->block_header.tow = data.tow;
-    msg->block_header.wnc = data.wnc;
-    msg->mode = data.mode;
-    msg->error = data.error;
-    msg->cov_latlat = data.cov_latlat;
-    msg->cov_lonlon = data.cov_lonlon;
-    msg->cov_hgthgt = data.cov_hgthgt;
-    msg->cov_bb = data.cov_bb;
-    msg->cov_latlon = data.cov_latlon;
-    msg->cov_lathgt = data.cov_lathgt;
-    msg->cov_latb = data.cov_latb;
-    msg->cov_lonhgt = data.cov_lonhgt;
-    msg->cov_lonb = data.cov_lonb;
-    msg->cov_hb = data.cov_hb;
+    septentrio_gnss_driver::PosCovGeodeticPtr msg = poscovgeodetic_pool_.acquire();
+    decodeBlock(data, *msg);
     return msg;
 }
 
 septentrio_gnss_driver::AttEulerPtr
-io_comm_rx::RxMessage::AttEulerCallback(AttEuler& data)
+io_comm_rx::RxMessage::AttEulerCallback(const BlockView<AttEuler>& data)
 {
-    septentrio_gnss_driver::AttEulerPtr msg =
-        boost::make_shared<septentrio_gnss_driver::AttEuler>();
-    msg->block_header.sync_1 = data.block_header.sync_1;
-    msg->block_header.sync_2 = data.block_header.sync_2;
-    msg->block_header.crc = data.block_header.crc;
-    msg->block_header.id = data.block_header.id;
-    msg->block_header.length = data.block_header.length;
-    msg->block_header.tow = data.tow;
-    msg->block_header.wnc = data.wnc;
-    msg->nr_sv = data.nr_sv;
-    msg->error = data.error;
-    msg->mode = data.mode;
-    msg->heading = data.heading;
-    msg->pitch = data.pitch;
-    msg->roll = data.roll;
-    msg->pitch_dot = data.pitch_dot;
-    msg->roll_dot = data.roll_dot;
-    msg->heading_dot = data.heading_dot;
+    septentrio_gnss_driver::AttEulerPtr msg = atteuler_pool_.acquire();
+    decodeBlock(data, *msg);
     return msg;
-};
+}
 
 septentrio_gnss_driver::AttCovEulerPtr
-io_comm_rx::RxMessage::AttCovEulerCallback(AttCovEuler& data)
+io_comm_rx::RxMessage::AttCovEulerCallback(const BlockView<AttCovEuler>& data)
 {
-    septentrio_gnss_driver::AttCovEulerPtr msg =
-        boost::make_shared<septentrio_gnss_driver::AttCovEuler>();
-    msg->block_header.sync_1 = data.block_header.sync_1;
-    msg->block_header.sync_2 = data.block_header.sync_2;
-    msg->block_header.crc = data.block_header.crc;
-    msg->block_header.id = data.block_header.id;
-    msg->block_header.length = data.block_header.length;
-    msg->block_header.tow = data.tow;
-    msg->block_header.wnc = data.wnc;
-    msg->error = data.error;
-    msg->cov_headhead = data.cov_headhead;
-    msg->cov_pitchpitch = data.cov_pitchpitch;
-    msg->cov_rollroll = data.cov_rollroll;
-    msg->cov_headpitch = data.cov_headpitch;
-    msg->cov_headroll = data.cov_headroll;
-    msg->cov_pitchroll = data.cov_pitchroll;
+    septentrio_gnss_driver::AttCovEulerPtr msg = attcoveuler_pool_.acquire();
+    decodeBlock(data, *msg);
     return msg;
-};
+}
 
 /**
  * The position_covariance array is populated in row-major order, where the basis of
@@ -293,164 +204,228 @@ io_comm_rx::RxMessage::AttCovEulerCallback(AttCovEuler& data)
 geometry_msgs::PoseWithCovarianceStampedPtr
 io_comm_rx::RxMessage::PoseWithCovarianceStampedCallback()
 {
-    geometry_msgs::PoseWithCovarianceStampedPtr msg =
-        boost::make_shared<geometry_msgs::PoseWithCovarianceStamped>();
+    const BlockView<PVTGeodetic> pvtgeodetic = epochBlock<PVTGeodetic>(epoch_);
+    const BlockView<PosCovGeodetic> poscovgeodetic =
+        epochBlock<PosCovGeodetic>(epoch_);
+    const BlockView<AttEuler> atteuler = epochBlock<AttEuler>(epoch_);
+    const BlockView<AttCovEuler> attcoveuler = epochBlock<AttCovEuler>(epoch_);
+    geometry_msgs::PoseWithCovarianceStampedPtr msg = pose_pool_.acquire();
     // Filling in the pose data
     msg->pose.pose.orientation = parsing_utilities::convertEulerToQuaternion(
-        static_cast<double>(last_atteuler_.heading),
-        static_cast<double>(last_atteuler_.pitch),
-        static_cast<double>(last_atteuler_.roll));
-    msg->pose.pose.position.x = static_cast<double>(last_pvtgeodetic_.longitude) *
+        static_cast<double>(atteuler->heading),
+        static_cast<double>(atteuler->pitch),
+        static_cast<double>(atteuler->roll));
+    msg->pose.pose.position.x = static_cast<double>(pvtgeodetic->longitude) *
                                 360 / (2 * boost::math::constants::pi<double>());
-    msg->pose.pose.position.y = static_cast<double>(last_pvtgeodetic_.latitude) *
+    msg->pose.pose.position.y = static_cast<double>(pvtgeodetic->latitude) *
                                 360 / (2 * boost::math::constants::pi<double>());
-    msg->pose.pose.position.z = static_cast<double>(last_pvtgeodetic_.height);
+    msg->pose.pose.position.z = static_cast<double>(pvtgeodetic->height);
     // Filling in the covariance data in row-major order
-    msg->pose.covariance[0] = static_cast<double>(last_poscovgeodetic_.cov_lonlon);
-    msg->pose.covariance[1] = static_cast<double>(last_poscovgeodetic_.cov_latlon);
-    msg->pose.covariance[2] = static_cast<double>(last_poscovgeodetic_.cov_lonhgt);
+    msg->pose.covariance[0] = static_cast<double>(poscovgeodetic->cov_lonlon);
+    msg->pose.covariance[1] = static_cast<double>(poscovgeodetic->cov_latlon);
+    msg->pose.covariance[2] = static_cast<double>(poscovgeodetic->cov_lonhgt);
     msg->pose.covariance[3] = 0;
     msg->pose.covariance[4] = 0;
     msg->pose.covariance[5] = 0;
-    msg->pose.covariance[6] = static_cast<double>(last_poscovgeodetic_.cov_latlon);
-    msg->pose.covariance[7] = static_cast<double>(last_poscovgeodetic_.cov_latlat);
-    msg->pose.covariance[8] = static_cast<double>(last_poscovgeodetic_.cov_lathgt);
+    msg->pose.covariance[6] = static_cast<double>(poscovgeodetic->cov_latlon);
+    msg->pose.covariance[7] = static_cast<double>(poscovgeodetic->cov_latlat);
+    msg->pose.covariance[8] = static_cast<double>(poscovgeodetic->cov_lathgt);
     msg->pose.covariance[9] = 0;
     msg->pose.covariance[10] = 0;
     msg->pose.covariance[11] = 0;
-    msg->pose.covariance[12] = static_cast<double>(last_poscovgeodetic_.cov_lonhgt);
-    msg->pose.covariance[13] = static_cast<double>(last_poscovgeodetic_.cov_lathgt);
-    msg->pose.covariance[14] = static_cast<double>(last_poscovgeodetic_.cov_hgthgt);
+    msg->pose.covariance[12] = static_cast<double>(poscovgeodetic->cov_lonhgt);
+    msg->pose.covariance[13] = static_cast<double>(poscovgeodetic->cov_lathgt);
+    msg->pose.covariance[14] = static_cast<double>(poscovgeodetic->cov_hgthgt);
     msg->pose.covariance[15] = 0;
     msg->pose.covariance[16] = 0;
     msg->pose.covariance[17] = 0;
     msg->pose.covariance[18] = 0;
     msg->pose.covariance[19] = 0;
     msg->pose.covariance[20] = 0;
-    msg->pose.covariance[21] = static_cast<double>(last_attcoveuler_.cov_rollroll);
-    msg->pose.covariance[22] = static_cast<double>(last_attcoveuler_.cov_pitchroll);
-    msg->pose.covariance[23] = static_cast<double>(last_attcoveuler_.cov_headroll);
+    msg->pose.covariance[21] = static_cast<double>(attcoveuler->cov_rollroll);
+    msg->pose.covariance[22] = static_cast<double>(attcoveuler->cov_pitchroll);
+    msg->pose.covariance[23] = static_cast<double>(attcoveuler->cov_headroll);
     msg->pose.covariance[24] = 0;
     msg->pose.covariance[25] = 0;
     msg->pose.covariance[26] = 0;
-    msg->pose.covariance[27] = static_cast<double>(last_attcoveuler_.cov_pitchroll);
-    msg->pose.covariance[28] = static_cast<double>(last_attcoveuler_.cov_pitchpitch);
-    msg->pose.covariance[29] = static_cast<double>(last_attcoveuler_.cov_headpitch);
+    msg->pose.covariance[27] = static_cast<double>(attcoveuler->cov_pitchroll);
+    msg->pose.covariance[28] = static_cast<double>(attcoveuler->cov_pitchpitch);
+    msg->pose.covariance[29] = static_cast<double>(attcoveuler->cov_headpitch);
     msg->pose.covariance[30] = 0;
     msg->pose.covariance[31] = 0;
     msg->pose.covariance[32] = 0;
-    msg->pose.covariance[33] = static_cast<double>(last_attcoveuler_.cov_headroll);
-    msg->pose.covariance[34] = static_cast<double>(last_attcoveuler_.cov_pitchroll);
-    msg->pose.covariance[35] = static_cast<double>(last_attcoveuler_.cov_headhead);
+    msg->pose.covariance[33] = static_cast<double>(attcoveuler->cov_headroll);
+    msg->pose.covariance[34] = static_cast<double>(attcoveuler->cov_pitchroll);
+    msg->pose.covariance[35] = static_cast<double>(attcoveuler->cov_headhead);
 
     return msg;
 }
 
-diagnostic_msgs::DiagnosticArrayPtr io_comm_rx::RxMessage::DiagnosticArrayCallback()
+//! Value of a QualityInd indicator, i.e. bits 8-11
+static uint16_t indicatorValue(uint16_t indicator)
 {
-    diagnostic_msgs::DiagnosticArrayPtr msg =
-        boost::make_shared<diagnostic_msgs::DiagnosticArray>();
-    std::string serialnumber(last_receiversetup_.rx_serial_number);
-    diagnostic_msgs::DiagnosticStatusPtr gnss_status =
-        boost::make_shared<diagnostic_msgs::DiagnosticStatus>();
-    // Constructing the "level of operation" field
-    uint16_t indicators_type_mask = static_cast<uint16_t>(255);
-    uint16_t indicators_value_mask = static_cast<uint16_t>(3840);
-    uint16_t qualityind_pos;
-    for (uint16_t i = static_cast<uint16_t>(0); i != last_qualityind_.n; ++i)
-    {
-        if ((last_qualityind_.indicators[i] & indicators_type_mask) ==
-            static_cast<uint16_t>(0))
+    return static_cast<uint16_t>((indicator & 3840) >> 8);
+}
+
+//! Key of a QualityInd indicator other than the overall one, by its type (bits 0-7)
+static const char* indicatorKey(uint16_t indicator)
+{
+    switch (indicator & 255)
+    {
+    case 1:
+        return "GNSS Signals, Main Antenna";
+    case 2:
+        return "GNSS Signals, Aux1 Antenna";
+    case 11:
+        return "RF Power, Main Antenna";
+    case 12:
+        return "RF Power, Aux1 Antenna";
+    case 21:
+        return "CPU Headroom";
+    case 25:
+        return "OCXO Stability";
+    case 30:
+        return "Base Station Measurements";
+    default:
+        assert((indicator & 255) == 31);
+        return "RTK Post-Processing";
+    }
+}
+
+//! Indicator values as strings, such that they need not be formatted every epoch
+static const char* const INDICATOR_VALUE_STRINGS[16] = {
+    "0", "1", "2",  "3",  "4",  "5",  "6",  "7",
+    "8", "9", "10", "11", "12", "13", "14", "15"};
+
+//! Fills "value" with the key and the zero-terminated string "text" of at most
+//! "size" characters
+static void assignSetupValue(diagnostic_msgs::KeyValue& value, const char* key,
+                             const char* text, std::size_t size)
+{
+    value.key = key;
+    value.value.assign(text, strnlen(text, size));
+}
+
+/**
+ * The status is kept in the context and only rewritten where the blocks changed:
+ * the hardware ID and the setup values when a different ReceiverSetup block was
+ * retained, the value of an indicator when its QualityInd bits changed. The message
+ * handed out is a copy thereof, which reuses the string capacity of the recycled
+ * message.
+ */
+diagnostic_msgs::DiagnosticArrayPtr
+io_comm_rx::RxMessage::DiagnosticArrayCallback(const ros::Time& stamp)
+{
+    DiagnosticsCache& cache = context_->diagnostics;
+    if (cache.published)
+    {
+        // Replay may jump back in time, the period then starts anew
+        const double elapsed = (stamp - cache.last_published).toSec();
+        if (elapsed >= 0.0 && elapsed < context_->diagnostics_period_s)
+            return diagnostic_msgs::DiagnosticArrayPtr();
+    }
+    const BlockView<ReceiverStatus> receiverstatus =
+        epochBlock<ReceiverStatus>(epoch_);
+    const BlockView<QualityInd> qualityind = epochBlock<QualityInd>(epoch_);
+    diagnostic_msgs::DiagnosticStatus& status = cache.status;
+    bool changed = !cache.published;
+    if (cache.setup_changed)
+    {
+        const std::vector<uint8_t>& last_receiversetup =
+            context_->last_receiversetup;
+        const BlockView<ReceiverSetup> receiversetup(last_receiversetup.data(),
+                                                     last_receiversetup.size());
+        status.hardware_id.assign(
+            receiversetup->rx_serial_number,
+            strnlen(receiversetup->rx_serial_number,
+                    sizeof(receiversetup->rx_serial_number)));
+        cache.setup_values.resize(2);
+        assignSetupValue(cache.setup_values[0], "Firmware Version",
+                         receiversetup->rx_version,
+                         sizeof(receiversetup->rx_version));
+        assignSetupValue(cache.setup_values[1], "Antenna Type",
+                         receiversetup->ant_type, sizeof(receiversetup->ant_type));
+        cache.setup_changed = false;
+        changed = true;
+    }
+    // Only the indicators within the block are read, however large N claims to be
+    const uint16_t indicators = static_cast<uint16_t>(qualityind.fits(
+        offsetof(QualityInd, indicators), sizeof(uint16_t), qualityind->n));
+    // The first indicator of type 0 gives the "level of operation", the others are
+    // listed as values
+    uint8_t level = diagnostic_msgs::DiagnosticStatus::OK;
+    bool overall_found = false;
+    std::size_t value_count = 0;
+    for (uint16_t i = static_cast<uint16_t>(0); i != indicators; ++i)
+    {
+        const uint16_t indicator = qualityind->indicators[i];
+        if (!overall_found && (indicator & 255) == 0)
+        {
+            overall_found = true;
+            const uint16_t value = indicatorValue(indicator);
+            if (value == 0)
+                level = diagnostic_msgs::DiagnosticStatus::STALE;
+            else if (value == 1 || value == 2)
+                level = diagnostic_msgs::DiagnosticStatus::WARN;
+            continue;
+        }
+        if (value_count == cache.indicators.size())
         {
-            qualityind_pos = i;
-            if (((last_qualityind_.indicators[i] & indicators_value_mask) >> 8) ==
-                static_cast<uint16_t>(0))
-            {
-                gnss_status->level = diagnostic_msgs::DiagnosticStatus::STALE;
-            } else if (((last_qualityind_.indicators[i] & indicators_value_mask) >>
-                        8) == static_cast<uint16_t>(1) ||
-                       ((last_qualityind_.indicators[i] & indicators_value_mask) >>
-                        8) == static_cast<uint16_t>(2))
-            {
-                gnss_status->level = diagnostic_msgs::DiagnosticStatus::WARN;
-            } else
-            {
-                gnss_status->level = diagnostic_msgs::DiagnosticStatus::OK;
-            }
-            break;
+            // Differs from "indicator" in its type, hence sets the key below
+            cache.indicators.push_back(static_cast<uint16_t>(~indicator));
+            cache.values.emplace_back();
+        }
+        uint16_t& cached = cache.indicators[value_count];
+        if (cached != indicator)
+        {
+            diagnostic_msgs::KeyValue& value = cache.values[value_count];
+            if ((cached & 255) != (indicator & 255))
+                value.key = indicatorKey(indicator);
+            value.value = INDICATOR_VALUE_STRINGS[indicatorValue(indicator)];
+            cached = indicator;
+            changed = true;
         }
+        ++value_count;
+    }
+    if (value_count != cache.indicators.size())
+    {
+        cache.indicators.resize(value_count);
+        cache.values.resize(value_count);
+        changed = true;
     }
     // If the ReceiverStatus's RxError field is not 0, then at least one error has
     // been detected.
-    if (last_receiverstatus_.rx_error != static_cast<uint32_t>(0))
+    if (receiverstatus->rx_error != static_cast<uint32_t>(0))
     {
-        gnss_status->level = diagnostic_msgs::DiagnosticStatus::ERROR;
+        level = diagnostic_msgs::DiagnosticStatus::ERROR;
     }
-    // Creating an array of values associated with the GNSS status
-    gnss_status->values.resize(static_cast<uint16_t>(last_qualityind_.n - 1));
-    for (uint16_t i = static_cast<uint16_t>(0);
-         i != static_cast<uint16_t>(last_qualityind_.n); ++i)
+    if (status.level != level)
     {
-        if (i == qualityind_pos)
-        {
-            continue;
-        }
-        if ((last_qualityind_.indicators[i] & indicators_type_mask) ==
-            static_cast<uint16_t>(1))
-        {
-            gnss_status->values[i].key = "GNSS Signals, Main Antenna";
-            gnss_status->values[i].value = std::to_string(
-                (last_qualityind_.indicators[i] & indicators_value_mask) >> 8);
-        } else if ((last_qualityind_.indicators[i] & indicators_type_mask) ==
-                   static_cast<uint16_t>(2))
-        {
-            gnss_status->values[i].key = "GNSS Signals, Aux1 Antenna";
-            gnss_status->values[i].value = std::to_string(
-                (last_qualityind_.indicators[i] & indicators_value_mask) >> 8);
-        } else if ((last_qualityind_.indicators[i] & indicators_type_mask) ==
-                   static_cast<uint16_t>(11))
-        {
-            gnss_status->values[i].key = "RF Power, Main Antenna";
-            gnss_status->values[i].value = std::to_string(
-                (last_qualityind_.indicators[i] & indicators_value_mask) >> 8);
-        } else if ((last_qualityind_.indicators[i] & indicators_type_mask) ==
-                   static_cast<uint16_t>(12))
-        {
-            gnss_status->values[i].key = "RF Power, Aux1 Antenna";
-            gnss_status->values[i].value = std::to_string(
-                (last_qualityind_.indicators[i] & indicators_value_mask) >> 8);
-        } else if ((last_qualityind_.indicators[i] & indicators_type_mask) ==
-                   static_cast<uint16_t>(21))
-        {
-            gnss_status->values[i].key = "CPU Headroom";
-            gnss_status->values[i].value = std::to_string(
-                (last_qualityind_.indicators[i] & indicators_value_mask) >> 8);
-        } else if ((last_qualityind_.indicators[i] & indicators_type_mask) ==
-                   static_cast<uint16_t>(25))
-        {
-            gnss_status->values[i].key = "OCXO Stability";
-            gnss_status->values[i].value = std::to_string(
-                (last_qualityind_.indicators[i] & indicators_value_mask) >> 8);
-        } else if ((last_qualityind_.indicators[i] & indicators_type_mask) ==
-                   static_cast<uint16_t>(30))
-        {
-            gnss_status->values[i].key = "Base Station Measurements";
-            gnss_status->values[i].value = std::to_string(
-                (last_qualityind_.indicators[i] & indicators_value_mask) >> 8);
-        } else
-        {
-            assert((last_qualityind_.indicators[i] & indicators_type_mask) ==
-                   static_cast<uint16_t>(31));
-            gnss_status->values[i].key = "RTK Post-Processing";
-            gnss_status->values[i].value = std::to_string(
-                (last_qualityind_.indicators[i] & indicators_value_mask) >> 8);
-        }
+        status.level = level;
+        changed = true;
+    }
+    if (!changed && context_->diagnostics_on_change)
+        return diagnostic_msgs::DiagnosticArrayPtr();
+    if (!cache.published)
+    {
+        status.name = "GNSS";
+        status.message = "Quality Indicators (from 0 for low quality to 10 for "
+                         "high quality, 15 if unknown)";
     }
-    gnss_status->hardware_id = serialnumber;
-    gnss_status->name = "GNSS";
-    gnss_status->message =
-        "Quality Indicators (from 0 for low quality to 10 for high quality, 15 if unknown)";
-    msg->status.push_back(*gnss_status);
+    cache.published = true;
+    cache.last_published = stamp;
+
+    diagnostic_msgs::DiagnosticArrayPtr msg = diagnosticarray_pool_.acquire();
+    msg->status.resize(1);
+    diagnostic_msgs::DiagnosticStatus& gnss_status = msg->status[0];
+    gnss_status.level = status.level;
+    gnss_status.name = status.name;
+    gnss_status.message = status.message;
+    gnss_status.hardware_id = status.hardware_id;
+    gnss_status.values.resize(cache.values.size() + cache.setup_values.size());
+    std::copy(cache.setup_values.begin(), cache.setup_values.end(),
+              std::copy(cache.values.begin(), cache.values.end(),
+                        gnss_status.values.begin()));
     return msg;
 }
 
@@ -463,10 +438,11 @@ diagnostic_msgs::DiagnosticArrayPtr io_comm_rx::RxMessage::DiagnosticArrayCallba
  */
 sensor_msgs::NavSatFixPtr io_comm_rx::RxMessage::NavSatFixCallback()
 {
-    sensor_msgs::NavSatFixPtr msg = boost::make_shared<sensor_msgs::NavSatFix>();
-    uint16_t mask = 15; // We extract the first four bits using this mask.
-    uint16_t type_of_pvt = ((uint16_t)(last_pvtgeodetic_.mode)) & mask;
-    switch (type_of_pvt_map[type_of_pvt])
+    const BlockView<PVTGeodetic> pvtgeodetic = epochBlock<PVTGeodetic>(epoch_);
+    const BlockView<PosCovGeodetic> poscovgeodetic =
+        epochBlock<PosCovGeodetic>(epoch_);
+    sensor_msgs::NavSatFixPtr msg = navsatfix_pool_.acquire();
+    switch (typeOfPVT(pvtgeodetic->mode))
     {
     case evNoPVT:
     {
@@ -507,7 +483,7 @@ sensor_msgs::NavSatFixPtr io_comm_rx::RxMessage::NavSatFixCallback()
     uint32_t mask_2 = 1;
     for (int bit = 0; bit != 31; ++bit)
     {
-        bool in_use = last_pvtgeodetic_.signal_info & mask_2;
+        bool in_use = pvtgeodetic->signal_info & mask_2;
         if (bit <= 5 && in_use)
         {
             gps_in_pvt = true;
@@ -524,29 +500,29 @@ sensor_msgs::NavSatFixPtr io_comm_rx::RxMessage::NavSatFixCallback()
     uint16_t service =
         gps_in_pvt * 1 + glo_in_pvt * 2 + com_in_pvt * 4 + gal_in_pvt * 8;
     msg->status.service = service;
-    msg->latitude = last_pvtgeodetic_.latitude * 360 /
+    msg->latitude = pvtgeodetic->latitude * 360 /
                     (2 * boost::math::constants::pi<double>());
-    msg->longitude = last_pvtgeodetic_.longitude * 360 /
+    msg->longitude = pvtgeodetic->longitude * 360 /
                      (2 * boost::math::constants::pi<double>());
-    msg->altitude = last_pvtgeodetic_.height;
+    msg->altitude = pvtgeodetic->height;
     msg->position_covariance[0] =
-        static_cast<double>(last_poscovgeodetic_.cov_lonlon);
+        static_cast<double>(poscovgeodetic->cov_lonlon);
     msg->position_covariance[1] =
-        static_cast<double>(last_poscovgeodetic_.cov_latlon);
+        static_cast<double>(poscovgeodetic->cov_latlon);
     msg->position_covariance[2] =
-        static_cast<double>(last_poscovgeodetic_.cov_lonhgt);
+        static_cast<double>(poscovgeodetic->cov_lonhgt);
     msg->position_covariance[3] =
-        static_cast<double>(last_poscovgeodetic_.cov_latlon);
+        static_cast<double>(poscovgeodetic->cov_latlon);
     msg->position_covariance[4] =
-        static_cast<double>(last_poscovgeodetic_.cov_latlat);
+        static_cast<double>(poscovgeodetic->cov_latlat);
     msg->position_covariance[5] =
-        static_cast<double>(last_poscovgeodetic_.cov_lathgt);
+        static_cast<double>(poscovgeodetic->cov_lathgt);
     msg->position_covariance[6] =
-        static_cast<double>(last_poscovgeodetic_.cov_lonhgt);
+        static_cast<double>(poscovgeodetic->cov_lonhgt);
     msg->position_covariance[7] =
-        static_cast<double>(last_poscovgeodetic_.cov_lathgt);
+        static_cast<double>(poscovgeodetic->cov_lathgt);
     msg->position_covariance[8] =
-        static_cast<double>(last_poscovgeodetic_.cov_hgthgt);
+        static_cast<double>(poscovgeodetic->cov_hgthgt);
     msg->position_covariance_type = sensor_msgs::NavSatFix::COVARIANCE_TYPE_KNOWN;
     return msg;
 }
@@ -561,7 +537,7 @@ sensor_msgs::NavSatFixPtr io_comm_rx::RxMessage::NavSatFixCallback()
  * receivers. We assume that for the ROS field "err_time", we are requested to
  * provide the 2 sigma uncertainty on the clock bias estimate in square meters, not
  * the clock drift estimate (latter would be
- * "2*std::sqrt(static_cast<double>(last_velcovgeodetic_.Cov_DtDt))").
+ * "2*std::sqrt(static_cast<double>(velcovgeodetic->cov_dtdt))").
  * The "err_track" entry is calculated via the Gaussian error propagation formula
  * from the eastward and the northward velocities. For the formula's usage we have to
  * assume that the eastward and the northward velocities are independent variables.
@@ -570,152 +546,130 @@ sensor_msgs::NavSatFixPtr io_comm_rx::RxMessage::NavSatFixCallback()
  * block could provide hundredths of degrees precision. Change if imperative for your
  * application... Definition of "visible satellite" adopted here: We define a visible
  * satellite as being !up to! "in sync" mode with the receiver, which corresponds to
- * last_measepoch_.N (signal-to-noise ratios are thereby available for these), though
- * not last_channelstatus_.N, which also includes those "in search". In case certain
+ * MeasEpoch's N (signal-to-noise ratios are thereby available for these), though
+ * not ChannelStatus's N, which also includes those "in search". In case certain
  * values appear unphysical, please consult the firmware, since those most likely
  * refer to Do-Not-Use values.
  */
 gps_common::GPSFixPtr io_comm_rx::RxMessage::GPSFixCallback()
 {
-    gps_common::GPSFixPtr msg = boost::make_shared<gps_common::GPSFix>();
+    const BlockView<PVTGeodetic> pvtgeodetic = epochBlock<PVTGeodetic>(epoch_);
+    const BlockView<PosCovGeodetic> poscovgeodetic =
+        epochBlock<PosCovGeodetic>(epoch_);
+    const BlockView<AttEuler> atteuler = epochBlock<AttEuler>(epoch_);
+    const BlockView<AttCovEuler> attcoveuler = epochBlock<AttCovEuler>(epoch_);
+    const BlockView<DOP> dop = epochBlock<DOP>(epoch_);
+    const BlockView<VelCovGeodetic> velcovgeodetic =
+        epochBlock<VelCovGeodetic>(epoch_);
+    const BlockView<MeasEpoch> measepoch = epochBlock<MeasEpoch>(epoch_);
+    const BlockView<ChannelStatus> channelstatus = epochBlock<ChannelStatus>(epoch_);
+    gps_common::GPSFixPtr msg = gpsfix_pool_.acquire();
 
-    msg->status.satellites_used = static_cast<uint16_t>(last_pvtgeodetic_.nr_sv);
+    msg->status.satellites_used = static_cast<uint16_t>(pvtgeodetic->nr_sv);
 
-    // MeasEpoch Processing
-    std::vector<int32_t> cno_tracked;
-    std::vector<int32_t> svid_in_sync;
-    {
-        uint8_t sb1_size = last_measepoch_.sb1_size;
-        uint8_t sb2_size = last_measepoch_.sb2_size;
-        uint8_t* sb_start = &last_measepoch_.data[0];
-        int32_t index = sb_start - &last_measepoch_.block_header.sync_1;
-        for (int32_t i = 0; i < static_cast<int32_t>(last_measepoch_.n); ++i)
-        {
-            // Define MeasEpochChannelType1 struct for the corresponding sub-block
-            MeasEpochChannelType1* measepoch_channel_type1 =
-                reinterpret_cast<MeasEpochChannelType1*>(
-                    &last_measepoch_.block_header.sync_1 + index);
-            svid_in_sync.push_back(
-                static_cast<int32_t>(measepoch_channel_type1->sv_id));
+    // MeasEpoch Processing: one pass filling the SVID-indexed table with the C/N0
+    // of each satellite in sync
+    std::array<int32_t, SVID_COUNT> cno_by_svid;
+    cno_by_svid.fill(SVID_NOT_IN_SYNC);
+    uint16_t satellites_in_sync = 0;
+    {
+        const std::size_t sb1_size = measepoch->sb1_size;
+        const std::size_t sb2_size = measepoch->sb2_size;
+        // Sub-blocks follow the fixed part, and are read as far as the block goes
+        SubBlockCursor sub_blocks = measepoch.subBlocks();
+        MeasEpochChannelType1 measepoch_channel_type1;
+        for (int32_t i = 0; i < static_cast<int32_t>(measepoch->n); ++i)
+        {
+            if (!sub_blocks.read(sb1_size, measepoch_channel_type1))
+                break;
+            ++satellites_in_sync;
             uint8_t type_mask =
                 15; // We extract the first four bits using this mask.
-            if (((measepoch_channel_type1->type & type_mask) ==
-                 static_cast<uint8_t>(1)) ||
-                ((measepoch_channel_type1->type & type_mask) ==
+            int32_t cno = static_cast<int32_t>(measepoch_channel_type1.cn0) / 4;
+            if (((measepoch_channel_type1.type & type_mask) !=
+                 static_cast<uint8_t>(1)) &&
+                ((measepoch_channel_type1.type & type_mask) !=
                  static_cast<uint8_t>(2)))
             {
-                cno_tracked.push_back(
-                    static_cast<int32_t>(measepoch_channel_type1->cn0) / 4);
-            } else
-            {
-                cno_tracked.push_back(
-                    static_cast<int32_t>(measepoch_channel_type1->cn0) / 4 +
-                    static_cast<int32_t>(10));
-            }
-            index += sb1_size;
-            for (int32_t j = 0;
-                 j < static_cast<int32_t>(measepoch_channel_type1->n_type2); j++)
-            {
-                index += sb2_size;
+                cno += static_cast<int32_t>(10);
             }
+            // The first sub-block of a satellite counts, as for all other arrays
+            int32_t& entry = cno_by_svid[measepoch_channel_type1.sv_id];
+            if (entry == SVID_NOT_IN_SYNC)
+                entry = cno;
+            sub_blocks.skip(static_cast<std::size_t>(
+                                measepoch_channel_type1.n_type2) *
+                            sb2_size);
         }
     }
 
-    // ChannelStatus Processing
-    std::vector<int32_t> svid_in_sync_2;
-    std::vector<int32_t> elevation_tracked;
-    std::vector<int32_t> azimuth_tracked;
-    std::vector<int32_t> svid_pvt;
-    svid_pvt.clear();
-    std::vector<int32_t> ordering;
-    {
-        uint8_t sb1_size = last_channelstatus_.sb1_size;
-        uint8_t sb2_size = last_channelstatus_.sb2_size;
-        uint8_t* sb_start = &last_channelstatus_.data[0];
-        int32_t index = sb_start - &last_channelstatus_.block_header.sync_1;
-        // ROS_DEBUG("index is %i", index); // yields 20, as expected
+    // ChannelStatus Processing: one pass, looking up each satellite in the table,
+    // and appending to the message's arrays, which are sized once for all channels
+    // and keep their capacity when the message is recycled
+    const std::size_t channels = channelstatus->n;
+    msg->status.satellite_used_prn.clear();
+    msg->status.satellite_visible_prn.clear();
+    msg->status.satellite_visible_z.clear();
+    msg->status.satellite_visible_azimuth.clear();
+    msg->status.satellite_visible_snr.clear();
+    msg->status.satellite_used_prn.reserve(channels);
+    msg->status.satellite_visible_prn.reserve(channels);
+    msg->status.satellite_visible_z.reserve(channels);
+    msg->status.satellite_visible_azimuth.reserve(channels);
+    msg->status.satellite_visible_snr.reserve(channels);
+    {
+        const std::size_t sb1_size = channelstatus->sb1_size;
+        const std::size_t sb2_size = channelstatus->sb2_size;
+        // Sub-blocks follow the fixed part (20 bytes), and are read as far as the
+        // block goes
+        SubBlockCursor sub_blocks = channelstatus.subBlocks();
+        ChannelSatInfo channel_sat_info;
+        ChannelStateInfo channel_state_info;
 
         uint16_t azimuth_mask = 511;
-        for (int32_t i = 0; i < static_cast<int32_t>(last_channelstatus_.n); i++)
+        for (int32_t i = 0; i < static_cast<int32_t>(channelstatus->n); i++)
         {
-            // Define ChannelSatInfo struct for the corresponding sub-block
-            ChannelSatInfo* channel_sat_info = reinterpret_cast<ChannelSatInfo*>(
-                &last_channelstatus_.block_header.sync_1 + index);
-            bool to_be_added = false;
-            for (int32_t j = 0; j < static_cast<int32_t>(svid_in_sync.size()); ++j)
-            {
-                if (svid_in_sync[j] == static_cast<int32_t>(channel_sat_info->sv_id))
-                {
-                    ordering.push_back(j);
-                    to_be_added = true;
-                    break;
-                }
-            }
-            if (to_be_added)
+            if (!sub_blocks.read(sb1_size, channel_sat_info))
+                break;
+            const int32_t cno = cno_by_svid[channel_sat_info.sv_id];
+            if (cno != SVID_NOT_IN_SYNC)
             {
-                svid_in_sync_2.push_back(
-                    static_cast<int32_t>(channel_sat_info->sv_id));
-                elevation_tracked.push_back(
-                    static_cast<int32_t>(channel_sat_info->elev));
-                azimuth_tracked.push_back(static_cast<int32_t>(
-                    (channel_sat_info->az_rise_set & azimuth_mask)));
+                msg->status.satellite_visible_prn.push_back(
+                    static_cast<int32_t>(channel_sat_info.sv_id));
+                msg->status.satellite_visible_z.push_back(
+                    static_cast<int32_t>(channel_sat_info.elev));
+                msg->status.satellite_visible_azimuth.push_back(static_cast<int32_t>(
+                    (channel_sat_info.az_rise_set & azimuth_mask)));
+                msg->status.satellite_visible_snr.push_back(cno);
             }
-            index += sb1_size;
-            for (int32_t j = 0; j < static_cast<int32_t>(channel_sat_info->n2); j++)
+            for (int32_t j = 0; j < static_cast<int32_t>(channel_sat_info.n2); j++)
             {
-                // Define ChannelStateInfo struct for the corresponding sub-block
-                ChannelStateInfo* channel_state_info =
-                    reinterpret_cast<ChannelStateInfo*>(
-                        &last_channelstatus_.block_header.sync_1 + index);
+                if (!sub_blocks.read(sb2_size, channel_state_info))
+                    break;
+                // PVTStatus holds one 2-bit field per signal type, 2 meaning the
+                // signal is used in the PVT
                 bool pvt_status = false;
-                uint16_t pvt_status_mask = std::pow(2, 15) + std::pow(2, 14);
-                for (int k = 15; k != -1; k -= 2)
+                for (int k = 0; k != 16; k += 2)
                 {
-                    uint16_t pvt_status_value =
-                        (channel_state_info->pvt_status & pvt_status_mask) >> k - 1;
-                    if (pvt_status_value == 2)
+                    if (((channel_state_info.pvt_status >> k) & 3) == 2)
                     {
                         pvt_status = true;
                     }
-                    if (k > 1)
-                    {
-                        pvt_status_mask = pvt_status_mask - std::pow(2, k) -
-                                          std::pow(2, k - 1) + std::pow(2, k - 2) +
-                                          std::pow(2, k - 3);
-                    }
                 }
                 if (pvt_status)
                 {
-                    svid_pvt.push_back(
-                        static_cast<int32_t>(channel_sat_info->sv_id));
+                    // Entries such as int32[] in ROS messages are to be treated as
+                    // std::vectors.
+                    msg->status.satellite_used_prn.push_back(
+                        static_cast<int32_t>(channel_sat_info.sv_id));
                 }
-                index += sb2_size;
             }
         }
     }
-    msg->status.satellite_used_prn =
-        svid_pvt; // Entries such as int32[] in ROS messages are to be treated as
-                  // std::vectors.
-    msg->status.satellites_visible = static_cast<uint16_t>(svid_in_sync.size());
-    msg->status.satellite_visible_prn = svid_in_sync_2;
-    msg->status.satellite_visible_z = elevation_tracked;
-    msg->status.satellite_visible_azimuth = azimuth_tracked;
-
-    // Reordering CNO vector to that of all previous arrays
-    std::vector<int32_t> cno_tracked_reordered;
-    if (static_cast<int32_t>(last_channelstatus_.n) != 0)
-    {
-        for (int32_t k = 0; k < static_cast<int32_t>(ordering.size()); ++k)
-        {
-            cno_tracked_reordered.push_back(cno_tracked[ordering[k]]);
-        }
-    }
-    msg->status.satellite_visible_snr = cno_tracked_reordered;
+    msg->status.satellites_visible = satellites_in_sync;
 
     // PVT Status Analysis
-    uint16_t status_mask = 15; // We extract the first four bits using this mask.
-    uint16_t type_of_pvt = ((uint16_t)(last_pvtgeodetic_.mode)) & status_mask;
-    switch (type_of_pvt_map[type_of_pvt])
+    switch (typeOfPVT(pvtgeodetic->mode))
     {
     case evNoPVT:
     {
@@ -740,7 +694,7 @@ gps_common::GPSFixPtr io_comm_rx::RxMessage::GPSFixCallback()
     }
     case evSBAS:
     {
-        uint16_t reference_id = last_pvtgeodetic_.reference_id;
+        uint16_t reference_id = pvtgeodetic->reference_id;
         // Here come the PRNs of the 4 WAAS satellites..
         if (reference_id == 131 || reference_id == 133 || reference_id == 135 ||
             reference_id == 135)
@@ -764,168 +718,124 @@ gps_common::GPSFixPtr io_comm_rx::RxMessage::GPSFixCallback()
     // hence:
     msg->status.orientation_source = gps_common::GPSStatus::SOURCE_POINTS;
     msg->status.position_source = gps_common::GPSStatus::SOURCE_GPS;
-    msg->latitude = static_cast<double>(last_pvtgeodetic_.latitude) * 360 /
+    msg->latitude = static_cast<double>(pvtgeodetic->latitude) * 360 /
                     (2 * boost::math::constants::pi<double>());
-    msg->longitude = static_cast<double>(last_pvtgeodetic_.longitude) * 360 /
+    msg->longitude = static_cast<double>(pvtgeodetic->longitude) * 360 /
                      (2 * boost::math::constants::pi<double>());
-    msg->altitude = static_cast<double>(last_pvtgeodetic_.height);
+    msg->altitude = static_cast<double>(pvtgeodetic->height);
     // Note that cog is of type float32 while track is of type float64.
-    msg->track = static_cast<double>(last_pvtgeodetic_.cog);
-    msg->speed = std::sqrt(std::pow(static_cast<double>(last_pvtgeodetic_.vn), 2) +
-                           std::pow(static_cast<double>(last_pvtgeodetic_.ve), 2));
-    msg->climb = static_cast<double>(last_pvtgeodetic_.vu);
-    msg->pitch = static_cast<double>(last_atteuler_.pitch);
-    msg->roll = static_cast<double>(last_atteuler_.roll);
-    if (last_dop_.pdop == static_cast<uint16_t>(0) ||
-        last_dop_.tdop == static_cast<uint16_t>(0))
+    msg->track = static_cast<double>(pvtgeodetic->cog);
+    msg->speed = std::sqrt(std::pow(static_cast<double>(pvtgeodetic->vn), 2) +
+                           std::pow(static_cast<double>(pvtgeodetic->ve), 2));
+    msg->climb = static_cast<double>(pvtgeodetic->vu);
+    msg->pitch = static_cast<double>(atteuler->pitch);
+    msg->roll = static_cast<double>(atteuler->roll);
+    if (dop->pdop == static_cast<uint16_t>(0) ||
+        dop->tdop == static_cast<uint16_t>(0))
     {
         msg->gdop = static_cast<double>(-1);
     } else
     {
         msg->gdop =
-            std::sqrt(std::pow(static_cast<double>(last_dop_.pdop) / 100, 2) +
-                      std::pow(static_cast<double>(last_dop_.tdop) / 100, 2));
+            std::sqrt(std::pow(static_cast<double>(dop->pdop) / 100, 2) +
+                      std::pow(static_cast<double>(dop->tdop) / 100, 2));
     }
-    if (last_dop_.pdop == static_cast<uint16_t>(0))
+    if (dop->pdop == static_cast<uint16_t>(0))
     {
         msg->pdop = static_cast<double>(-1);
     } else
     {
-        msg->pdop = static_cast<double>(last_dop_.pdop) / 100;
+        msg->pdop = static_cast<double>(dop->pdop) / 100;
     }
-    if (last_dop_.hdop == static_cast<uint16_t>(0))
+    if (dop->hdop == static_cast<uint16_t>(0))
     {
         msg->hdop = static_cast<double>(-1);
     } else
     {
-        msg->hdop = static_cast<double>(last_dop_.hdop) / 100;
+        msg->hdop = static_cast<double>(dop->hdop) / 100;
     }
-    if (last_dop_.vdop == static_cast<uint16_t>(0))
+    if (dop->vdop == static_cast<uint16_t>(0))
     {
         msg->vdop = static_cast<double>(-1);
     } else
     {
-        msg->vdop = static_cast<double>(last_dop_.vdop) / 100;
+        msg->vdop = static_cast<double>(dop->vdop) / 100;
     }
-    if (last_dop_.tdop == static_cast<uint16_t>(0))
+    if (dop->tdop == static_cast<uint16_t>(0))
     {
         msg->tdop = static_cast<double>(-1);
     } else
     {
-        msg->tdop = static_cast<double>(last_dop_.tdop) / 100;
+        msg->tdop = static_cast<double>(dop->tdop) / 100;
     }
-    msg->time = static_cast<double>(last_pvtgeodetic_.tow) / 1000 +
-                static_cast<double>(last_pvtgeodetic_.wnc * 7 * 24 * 60 * 60);
-    msg->err = 2 * (std::sqrt(static_cast<double>(last_poscovgeodetic_.cov_latlat) +
-                              static_cast<double>(last_poscovgeodetic_.cov_lonlon) +
-                              static_cast<double>(last_poscovgeodetic_.cov_hgthgt)));
+    msg->time = static_cast<double>(pvtgeodetic->tow) / 1000 +
+                static_cast<double>(pvtgeodetic->wnc * 7 * 24 * 60 * 60);
+    msg->err = 2 * (std::sqrt(static_cast<double>(poscovgeodetic->cov_latlat) +
+                              static_cast<double>(poscovgeodetic->cov_lonlon) +
+                              static_cast<double>(poscovgeodetic->cov_hgthgt)));
     msg->err_horz =
-        2 * (std::sqrt(static_cast<double>(last_poscovgeodetic_.cov_latlat) +
-                       static_cast<double>(last_poscovgeodetic_.cov_lonlon)));
+        2 * (std::sqrt(static_cast<double>(poscovgeodetic->cov_latlat) +
+                       static_cast<double>(poscovgeodetic->cov_lonlon)));
     msg->err_vert =
-        2 * std::sqrt(static_cast<double>(last_poscovgeodetic_.cov_hgthgt));
+        2 * std::sqrt(static_cast<double>(poscovgeodetic->cov_hgthgt));
     msg->err_track =
         2 *
         (std::sqrt(
             std::pow(static_cast<double>(1) /
-                         (static_cast<double>(last_pvtgeodetic_.vn) +
-                          std::pow(static_cast<double>(last_pvtgeodetic_.ve), 2) /
-                              static_cast<double>(last_pvtgeodetic_.vn)),
+                         (static_cast<double>(pvtgeodetic->vn) +
+                          std::pow(static_cast<double>(pvtgeodetic->ve), 2) /
+                              static_cast<double>(pvtgeodetic->vn)),
                      2) *
-                static_cast<double>(last_poscovgeodetic_.cov_lonlon) +
-            std::pow((static_cast<double>(last_pvtgeodetic_.ve)) /
-                         (std::pow(static_cast<double>(last_pvtgeodetic_.vn), 2) +
-                          std::pow(static_cast<double>(last_pvtgeodetic_.ve), 2)),
+                static_cast<double>(poscovgeodetic->cov_lonlon) +
+            std::pow((static_cast<double>(pvtgeodetic->ve)) /
+                         (std::pow(static_cast<double>(pvtgeodetic->vn), 2) +
+                          std::pow(static_cast<double>(pvtgeodetic->ve), 2)),
                      2) *
-                static_cast<double>(last_poscovgeodetic_.cov_latlat)));
+                static_cast<double>(poscovgeodetic->cov_latlat)));
     msg->err_speed =
-        2 * (std::sqrt(static_cast<double>(last_velcovgeodetic_.cov_vnvn) +
-                       static_cast<double>(last_velcovgeodetic_.cov_veve)));
+        2 * (std::sqrt(static_cast<double>(velcovgeodetic->cov_vnvn) +
+                       static_cast<double>(velcovgeodetic->cov_veve)));
     msg->err_climb =
-        2 * std::sqrt(static_cast<double>(last_velcovgeodetic_.cov_vuvu));
-    msg->err_time = 2 * std::sqrt(static_cast<double>(last_poscovgeodetic_.cov_bb));
+        2 * std::sqrt(static_cast<double>(velcovgeodetic->cov_vuvu));
+    msg->err_time = 2 * std::sqrt(static_cast<double>(poscovgeodetic->cov_bb));
     msg->err_pitch =
-        2 * std::sqrt(static_cast<double>(last_attcoveuler_.cov_pitchpitch));
+        2 * std::sqrt(static_cast<double>(attcoveuler->cov_pitchpitch));
     msg->err_roll =
-        2 * std::sqrt(static_cast<double>(last_attcoveuler_.cov_rollroll));
+        2 * std::sqrt(static_cast<double>(attcoveuler->cov_rollroll));
     msg->position_covariance[0] =
-        static_cast<double>(last_poscovgeodetic_.cov_lonlon);
+        static_cast<double>(poscovgeodetic->cov_lonlon);
     msg->position_covariance[1] =
-        static_cast<double>(last_poscovgeodetic_.cov_latlon);
+        static_cast<double>(poscovgeodetic->cov_latlon);
     msg->position_covariance[2] =
-        static_cast<double>(last_poscovgeodetic_.cov_lonhgt);
+        static_cast<double>(poscovgeodetic->cov_lonhgt);
     msg->position_covariance[3] =
-        static_cast<double>(last_poscovgeodetic_.cov_latlon);
+        static_cast<double>(poscovgeodetic->cov_latlon);
     msg->position_covariance[4] =
-        static_cast<double>(last_poscovgeodetic_.cov_latlat);
+        static_cast<double>(poscovgeodetic->cov_latlat);
     msg->position_covariance[5] =
-        static_cast<double>(last_poscovgeodetic_.cov_lathgt);
+        static_cast<double>(poscovgeodetic->cov_lathgt);
     msg->position_covariance[6] =
-        static_cast<double>(last_poscovgeodetic_.cov_lonhgt);
+        static_cast<double>(poscovgeodetic->cov_lonhgt);
     msg->position_covariance[7] =
-        static_cast<double>(last_poscovgeodetic_.cov_lathgt);
+        static_cast<double>(poscovgeodetic->cov_lathgt);
     msg->position_covariance[8] =
-        static_cast<double>(last_poscovgeodetic_.cov_hgthgt);
+        static_cast<double>(poscovgeodetic->cov_hgthgt);
     msg->position_covariance_type = sensor_msgs::NavSatFix::COVARIANCE_TYPE_KNOWN;
 
     return msg;
 }
 
-/// If the current time shall be employed, it is calculated via the time(NULL)
-/// function found in the \<ctime\> library At the time of writing the code (2020),
-/// the GPS time was ahead of UTC time by 18 (leap) seconds. Adapt the g_leap_seconds
-/// ROSaic parameter accordingly as soon as the next leap second is inserted into the
-/// UTC time.
-ros::Time io_comm_rx::timestampSBF(uint32_t tow, bool use_gnss)
+/// The GNSS time stamp is computed in integer nanoseconds from the GPS week and TOW,
+/// hence millisecond-exact and without any string round-trip. At the time of
+/// writing the code (2020), the GPS time was ahead of UTC time by 18 (leap) seconds.
+/// Adapt the g_leap_seconds ROSaic parameter accordingly as soon as the next leap
+/// second is inserted into the UTC time.
+ros::Time io_comm_rx::timestampSBF(uint32_t tow, uint16_t wnc, bool use_gnss)
 {
-    if (use_gnss)
-    {
-        uint16_t hh = (tow % (1000 * 60 * 60 * 24)) / (60 * 60 * 1000);
-        uint16_t mm =
-            ((tow % (1000 * 60 * 60 * 24)) - hh * (60 * 60 * 1000)) / (60 * 1000);
-        uint16_t ss = ((tow % (1000 * 60 * 60 * 24)) - hh * (60 * 60 * 1000) -
-                       mm * (60 * 1000)) /
-                      (1000);
-        uint16_t hs = ((tow % (1000 * 60 * 60 * 24)) - hh * (60 * 60 * 1000) -
-                       mm * (60 * 1000) - ss * 1000) /
-                      10; // hundredths of a second
-        if (ss >= g_leap_seconds)
-        {
-            ss = ss - g_leap_seconds;
-        } else
-        {
-            if (mm >= 1)
-            {
-                --mm;
-                ss = 60 - (g_leap_seconds - ss);
-            } else
-            {
-                if (hh >= 1)
-                {
-                    --hh;
-                    mm = 59;
-                    ss = 60 - (g_leap_seconds - ss);
-                } else
-                {
-                    hh = 23;
-                    mm = 59;
-                    ss = 60 - (g_leap_seconds - ss);
-                }
-            }
-        }
-        boost::format fmt = boost::format("%02u%02u%02u.%02u") % hh % mm % ss % hs;
-        std::string utc_string = fmt.str();
-        // ROS_DEBUG("UTC string is %s", utc_string.c_str());
-        double utc_double;
-        string_utilities::toDouble(utc_string, utc_double);
-        time_t unix_time_seconds = parsing_utilities::convertUTCtoUnix(
-            utc_double); // This only deals with full seconds.
-        // The following works since there are two digits after the decimal point in
-        // the utc_double:
-        uint32_t unix_time_nanoseconds =
-            (static_cast<uint32_t>(utc_double * 100) % 100) * 10000000;
-        ros::Time time_obj(unix_time_seconds, unix_time_nanoseconds);
-        return time_obj;
+    // Do-not-use values, e.g. before the receiver has determined the GPS week
+    if (use_gnss && tow != 4294967295u && wnc != 65535)
+    {
+        return parsing_utilities::convertGPSWeekTOWToUnix(wnc, tow, g_leap_seconds);
     } else
     {
         return ros::Time::now();
@@ -939,7 +849,7 @@ bool io_comm_rx::RxMessage::found()
 
     // Verify header bytes
     if (!this->isSBF() && !this->isNMEA() && !this->isResponse() &&
-        !(g_read_cd && this->isConnectionDescriptor()))
+        !(context_->read_cd && this->isConnectionDescriptor()))
     {
         return false;
     }
@@ -954,14 +864,25 @@ const uint8_t* io_comm_rx::RxMessage::search()
     {
         next();
     }
-    // Search for message or a response header
-    for (; count_ > 0; --count_, ++data_)
+    // Search for message or a response header, skipping the bytes that cannot
+    // start one
+    while (count_ > 0)
     {
-        if (this->isSBF() || this->isNMEA() || this->isResponse() ||
-            (g_read_cd && this->isConnectionDescriptor()))
+        const std::size_t skipped =
+            SyncScanner::find(data_, count_, context_->read_cd);
+        data_ += skipped;
+        count_ -= skipped;
+        if (count_ < 2)
         {
+            data_ += count_;
+            count_ = 0;
             break;
         }
+        if (data_[0] == SBF_SYNC_BYTE_1 ? SyncScanner::classify(data_[1]) != evNoSync
+                                        : data_[1] == CONNECTION_DESCRIPTOR_BYTE_2)
+            break;
+        ++data_;
+        --count_;
     }
     found_ = true;
     return data_;
@@ -1010,9 +931,7 @@ bool io_comm_rx::RxMessage::isMessage(const uint16_t id)
 {
     if (this->isSBF())
     {
-        uint16_t mask = 8191;
-        if (*(reinterpret_cast<const uint16_t*>(data_ + 4)) &
-            mask == static_cast<const uint16_t>(id))
+        if (this->blockNumber() == id)
         // Caution: reinterpret_cast is the most dangerous cast. It's used primarily
         // for particularly weird conversions and bit manipulations, like turning a
         // raw data stream into actual data.
@@ -1032,18 +951,7 @@ bool io_comm_rx::RxMessage::isMessage(std::string id)
 {
     if (this->isNMEA())
     {
-        boost::char_separator<char> sep(",");
-        typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
-        std::size_t nmea_size = this->messageSize();
-        std::string block_in_string(reinterpret_cast<const char*>(data_), nmea_size);
-        tokenizer tokens(block_in_string, sep);
-        if (*tokens.begin() == id)
-        {
-            return true;
-        } else
-        {
-            return false;
-        }
+        return this->nmeaID() == id;
     } else
     {
         return false;
@@ -1142,28 +1050,70 @@ std::string io_comm_rx::RxMessage::messageID()
 {
     if (this->isSBF())
     {
-        // Defines bit mask..
-        // It is not as stated in the firmware: !first! three bits are for revision
-        // (not last 3), and rest for block number
-        uint16_t mask = 8191;
-        // Bitwise AND gives us all but first 3 bits set to zero, rest unchanged
-        uint16_t value = (*(reinterpret_cast<const uint16_t*>(data_ + 4))) & mask;
-        std::stringstream ss;
-        ss << value;
-        return ss.str();
+        return std::to_string(this->blockNumber());
     }
     if (this->isNMEA())
     {
-        boost::char_separator<char> sep(",");
-        typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
-        std::size_t nmea_size = this->messageSize();
-        std::string block_in_string(reinterpret_cast<const char*>(data_), nmea_size);
-        tokenizer tokens(block_in_string, sep);
-        return *tokens.begin();
+        return this->nmeaID().to_string();
     }
     return std::string(); // less CPU work than return "";
 }
 
+boost::string_view io_comm_rx::RxMessage::nmeaID()
+{
+    // The ID extends up to the first field delimiter, never beyond the sentence
+    std::size_t size = 0;
+    while (size < count_ && data_[size] != ',' && data_[size] != '*' &&
+           data_[size] != CARRIAGE_RETURN && data_[size] != LINE_FEED)
+        ++size;
+    return boost::string_view(reinterpret_cast<const char*>(data_), size);
+}
+
+uint16_t io_comm_rx::RxMessage::blockNumber()
+{
+    if (count_ < 6 || !this->isSBF())
+        return 0;
+    // It is not as stated in the firmware: !first! three bits are for revision
+    // (not last 3), and rest for block number
+    uint16_t id;
+    memcpy(&id, data_ + 4, sizeof(id));
+    return id & (SBF_BLOCK_NUMBER_COUNT - 1);
+}
+
+RxID_Enum io_comm_rx::RxMessage::identify()
+{
+    if (count_ >= 6 && this->isSBF())
+        return sbfKey(this->blockNumber());
+    // NMEA sentences handled so far are all of the form $GxSSS with talker x
+    if (count_ < 6 || !this->isNMEA() || data_[1] != NMEA_SYNC_BYTE_2_1)
+        return evUnknownMessage;
+    const uint8_t talker = data_[2];
+    const bool gsv = (data_[3] == 'G' && data_[4] == 'S' && data_[5] == 'V');
+    switch (talker)
+    {
+    case 'P':
+    {
+        if (gsv)
+            return evGPGSV;
+        if (data_[3] == 'G' && data_[4] == 'G' && data_[5] == 'A')
+            return evGPGGA;
+        if (data_[3] == 'R' && data_[4] == 'M' && data_[5] == 'C')
+            return evGPRMC;
+        if (data_[3] == 'G' && data_[4] == 'S' && data_[5] == 'A')
+            return evGPGSA;
+        return evUnknownMessage;
+    }
+    case 'L':
+        return gsv ? evGLGSV : evUnknownMessage;
+    case 'A':
+        return gsv ? evGAGSV : evUnknownMessage;
+    case 'B':
+        return gsv ? evGBGSV : evUnknownMessage;
+    default:
+        return evUnknownMessage;
+    }
+}
+
 const uint8_t* io_comm_rx::RxMessage::getPosBuffer() { return data_; }
 
 const uint8_t* io_comm_rx::RxMessage::getEndBuffer() { return data_ + count_; }
@@ -1194,11 +1144,12 @@ void io_comm_rx::RxMessage::next()
     if (found())
     {
         if (this->isNMEA() || this->isResponse() ||
-            (g_read_cd && this->isConnectionDescriptor()))
+            (context_->read_cd && this->isConnectionDescriptor()))
         {
-            if (g_read_cd && this->isConnectionDescriptor() && g_cd_count == 2)
+            if (context_->read_cd && this->isConnectionDescriptor() &&
+                context_->cd_count == 2)
             {
-                g_read_cd = false;
+                context_->read_cd = false;
             }
             jump_size = static_cast<uint32_t>(1);
         }
@@ -1238,555 +1189,216 @@ void io_comm_rx::RxMessage::next()
  * seems to be 89 on a mosaic-x5. Luckily, when parsing we do not care since we just
  * search for \<LF\>\<CR\>.
  */
-bool io_comm_rx::RxMessage::read(std::string message_key, bool search)
+bool io_comm_rx::RxMessage::read(RxID_Enum message_key, bool search)
 {
     if (search)
         this->search();
     if (!found())
         return false;
+    // SBF blocks only get here once the Framer found them complete with a valid CRC
     if (this->isSBF())
-    {
-        // If the CRC check is unsuccessful, throw an error message.
-        crc_check_ = isValid(data_);
-        if (!crc_check_)
-        {
-            throw std::runtime_error(
-                "CRC Check returned False. Not a valid data block. Retrieving full SBF block..");
-        }
-    }
-    switch (rx_id_map[message_key])
+        crc_check_ = true;
+    switch (message_key)
     {
     case evPVTCartesian: // Position and velocity in XYZ
     { // The curly bracket here is crucial: Declarations inside a block remain
       // inside, and will die at
         // the end of the block. Otherwise variable overloading etc.
+        const BlockView<PVTCartesian> pvtcartesian(data_, count_);
         septentrio_gnss_driver::PVTCartesianPtr msg =
-            boost::make_shared<septentrio_gnss_driver::PVTCartesian>();
-        PVTCartesian pvtcartesian;
-        memcpy(&pvtcartesian, data_, sizeof(pvtcartesian));
-        msg = PVTCartesianCallback(pvtcartesian);
-        msg->header.frame_id = g_frame_id;
+            PVTCartesianCallback(pvtcartesian);
+        msg->header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
         msg->block_header.id = 4006;
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::PVTCartesian>("/pvtcartesian",
-                                                                  g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evPVTCartesian, msg);
         break;
     }
     case evPVTGeodetic: // Position and velocity in geodetic coordinate frame (ENU
                         // frame)
     {
+        const BlockView<PVTGeodetic> pvtgeodetic(data_, count_);
         septentrio_gnss_driver::PVTGeodeticPtr msg =
-            boost::make_shared<septentrio_gnss_driver::PVTGeodetic>();
-        memcpy(&last_pvtgeodetic_, data_, sizeof(last_pvtgeodetic_));
-        msg = PVTGeodeticCallback(last_pvtgeodetic_);
-        msg->header.frame_id = g_frame_id;
+            PVTGeodeticCallback(pvtgeodetic);
+        msg->header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
         msg->block_header.id = 4007;
-        g_pvtgeodetic_has_arrived_gpsfix = true;
-        g_pvtgeodetic_has_arrived_navsatfix = true;
-        g_pvtgeodetic_has_arrived_pose = true;
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::PVTGeodetic>("/pvtgeodetic",
-                                                                 g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evPVTGeodetic, msg);
         break;
     }
     case evPosCovCartesian:
     {
+        const BlockView<PosCovCartesian> poscovcartesian(data_, count_);
         septentrio_gnss_driver::PosCovCartesianPtr msg =
-            boost::make_shared<septentrio_gnss_driver::PosCovCartesian>();
-        PosCovCartesian poscovcartesian;
-        memcpy(&poscovcartesian, data_, sizeof(poscovcartesian));
-        msg = PosCovCartesianCallback(poscovcartesian);
-        msg->header.frame_id = g_frame_id;
+            PosCovCartesianCallback(poscovcartesian);
+        msg->header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
         msg->block_header.id = 5905;
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::PosCovCartesian>(
-                "/poscovcartesian", g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evPosCovCartesian, msg);
         break;
     }
     case evPosCovGeodetic:
     {
+        const BlockView<PosCovGeodetic> poscovgeodetic(data_, count_);
         septentrio_gnss_driver::PosCovGeodeticPtr msg =
-            boost::make_shared<septentrio_gnss_driver::PosCovGeodetic>();
-        memcpy(&last_poscovgeodetic_, data_, sizeof(last_poscovgeodetic_));
-        msg = PosCovGeodeticCallback(last_poscovgeodetic_);
-        msg->header.frame_id = g_frame_id;
+            PosCovGeodeticCallback(poscovgeodetic);
+        msg->header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
         msg->block_header.id = 5906;
-        g_poscovgeodetic_has_arrived_gpsfix = true;
-        g_poscovgeodetic_has_arrived_navsatfix = true;
-        g_poscovgeodetic_has_arrived_pose = true;
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::PosCovGeodetic>(
-                "/poscovgeodetic", g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evPosCovGeodetic, msg);
         break;
     }
     case evAttEuler:
     {
-        septentrio_gnss_driver::AttEulerPtr msg =
-            boost::make_shared<septentrio_gnss_driver::AttEuler>();
-        memcpy(&last_atteuler_, data_, sizeof(last_atteuler_));
-        msg = AttEulerCallback(last_atteuler_);
-        msg->header.frame_id = g_frame_id;
+        const BlockView<AttEuler> atteuler(data_, count_);
+        septentrio_gnss_driver::AttEulerPtr msg = AttEulerCallback(atteuler);
+        msg->header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
         msg->block_header.id = 5938;
-        g_atteuler_has_arrived_gpsfix = true;
-        g_atteuler_has_arrived_pose = true;
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::AttEuler>("/atteuler",
-                                                              g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evAttEuler, msg);
         break;
     }
     case evAttCovEuler:
     {
+        const BlockView<AttCovEuler> attcoveuler(data_, count_);
         septentrio_gnss_driver::AttCovEulerPtr msg =
-            boost::make_shared<septentrio_gnss_driver::AttCovEuler>();
-        memcpy(&last_attcoveuler_, data_, sizeof(last_attcoveuler_));
-        msg = AttCovEulerCallback(last_attcoveuler_);
-        msg->header.frame_id = g_frame_id;
+            AttCovEulerCallback(attcoveuler);
+        msg->header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
         msg->block_header.id = 5939;
-        g_attcoveuler_has_arrived_gpsfix = true;
-        g_attcoveuler_has_arrived_pose = true;
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::AttCovEuler>("/attcoveuler",
-                                                                 g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evAttCovEuler, msg);
         break;
     }
     case evGPST:
     {
-        sensor_msgs::TimeReferencePtr msg =
-            boost::make_shared<sensor_msgs::TimeReference>();
+        sensor_msgs::TimeReferencePtr msg = timereference_pool_.acquire();
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, true); // We need the GPS time, hence true
+        time_obj = timestampSBF(tow, wnc, true); // We need the GPS time, hence true
         msg->time_ref.sec = time_obj.sec;
         msg->time_ref.nsec = time_obj.nsec;
         msg->source = "GPST";
-        static ros::Publisher publisher =
-            g_nh->advertise<sensor_msgs::TimeReference>("/gpst", g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evGPST, msg);
         break;
     }
     case evGPGGA:
     {
-        boost::char_separator<char> sep("\r");
-        typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
-        std::size_t nmea_size = this->messageSize();
-        std::string block_in_string(reinterpret_cast<const char*>(data_), nmea_size);
-        tokenizer tokens(block_in_string, sep);
-
-        std::string id = this->messageID();
-        std::string one_message = *tokens.begin();
-        // No kept delimiters, hence "". Also, we specify that empty tokens should
-        // show up in the output when two delimiters are next to each other. Hence we
-        // also append the checksum part of the GGA message to "body" below, though
-        // it is not parsed.
-        boost::char_separator<char> sep_2(",*", "", boost::keep_empty_tokens);
-        tokenizer tokens_2(one_message, sep_2);
-        std::vector<std::string> body;
-        for (tokenizer::iterator tok_iter = tokens_2.begin();
-             tok_iter != tokens_2.end(); ++tok_iter)
-        {
-            body.push_back(*tok_iter);
-        }
-        // Create NmeaSentence struct to pass to GpggaParser::parseASCII
-        NMEASentence gga_message(id, body);
-        septentrio_gnss_driver::GpggaPtr msg =
-            boost::make_shared<septentrio_gnss_driver::Gpgga>();
+        // Split the sentence once, in place, to pass it to GpggaParser::parseASCII
+        NMEASentence gga_message(reinterpret_cast<const char*>(data_),
+                                 this->messageSize());
+        septentrio_gnss_driver::GpggaPtr msg;
         GpggaParser parser_obj;
         try
         {
-            msg = parser_obj.parseASCII(gga_message);
+            msg = parser_obj.parseASCII(gga_message, context_->frame_id);
         } catch (ParseException& e)
         {
             throw std::runtime_error(e.what());
         }
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::Gpgga>("/gpgga",
-                                                           g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time.sec = msg->header.stamp.sec;
-            g_unix_time.nsec = msg->header.stamp.nsec;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evGPGGA, msg);
         break;
     }
     case evGPRMC:
     {
-        boost::char_separator<char> sep("\r");
-        typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
-        std::size_t nmea_size = this->messageSize();
-        std::string block_in_string(reinterpret_cast<const char*>(data_), nmea_size);
-        tokenizer tokens(block_in_string, sep);
-
-        std::string id = this->messageID();
-        std::string one_message = *tokens.begin();
-        boost::char_separator<char> sep_2(",*", "", boost::keep_empty_tokens);
-        tokenizer tokens_2(one_message, sep_2);
-        std::vector<std::string> body;
-        for (tokenizer::iterator tok_iter = tokens_2.begin();
-             tok_iter != tokens_2.end(); ++tok_iter)
-        {
-            body.push_back(*tok_iter);
-        }
-        // Create NmeaSentence struct to pass to GprmcParser::parseASCII
-        NMEASentence rmc_message(id, body);
-        septentrio_gnss_driver::GprmcPtr msg =
-            boost::make_shared<septentrio_gnss_driver::Gprmc>();
+        // Split the sentence once, in place, to pass it to GprmcParser::parseASCII
+        NMEASentence rmc_message(reinterpret_cast<const char*>(data_),
+                                 this->messageSize());
+        septentrio_gnss_driver::GprmcPtr msg;
         GprmcParser parser_obj;
         try
         {
-            msg = parser_obj.parseASCII(rmc_message);
+            msg = parser_obj.parseASCII(rmc_message, context_->frame_id);
         } catch (ParseException& e)
         {
             throw std::runtime_error(e.what());
         }
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::Gprmc>("/gprmc",
-                                                           g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time.sec = msg->header.stamp.sec;
-            g_unix_time.nsec = msg->header.stamp.nsec;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evGPRMC, msg);
         break;
     }
     case evGPGSA:
     {
-        boost::char_separator<char> sep("\r");
-        typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
-        std::size_t nmea_size = this->messageSize();
-        std::string block_in_string(reinterpret_cast<const char*>(data_), nmea_size);
-        tokenizer tokens(block_in_string, sep);
-
-        std::string id = this->messageID();
-        std::string one_message = *tokens.begin();
-        boost::char_separator<char> sep_2(",*", "", boost::keep_empty_tokens);
-        tokenizer tokens_2(one_message, sep_2);
-        std::vector<std::string> body;
-        for (tokenizer::iterator tok_iter = tokens_2.begin();
-             tok_iter != tokens_2.end(); ++tok_iter)
-        {
-            body.push_back(*tok_iter);
-        }
-        // Create NmeaSentence struct to pass to GpgsaParser::parseASCII
-        NMEASentence gsa_message(id, body);
-        septentrio_gnss_driver::GpgsaPtr msg =
-            boost::make_shared<septentrio_gnss_driver::Gpgsa>();
+        // Split the sentence once, in place, to pass it to GpgsaParser::parseASCII
+        NMEASentence gsa_message(reinterpret_cast<const char*>(data_),
+                                 this->messageSize());
+        septentrio_gnss_driver::GpgsaPtr msg;
         GpgsaParser parser_obj;
         try
         {
-            msg = parser_obj.parseASCII(gsa_message);
+            msg = parser_obj.parseASCII(gsa_message, context_->frame_id);
         } catch (ParseException& e)
         {
             throw std::runtime_error(e.what());
         }
-        uint32_t tow = last_pvtgeodetic_.tow;
+        const uint64_t last_pvt_time = context_->last_pvt_time.load();
+        uint32_t tow = static_cast<uint32_t>(last_pvt_time);
+        uint16_t wnc = static_cast<uint16_t>(last_pvt_time >> 32);
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::Gpgsa>("/gpgsa",
-                                                           g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time.sec = msg->header.stamp.sec;
-            g_unix_time.nsec = msg->header.stamp.nsec;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evGPGSA, msg);
         break;
     }
     case evGPGSV:
     case evGLGSV:
     case evGAGSV:
+    case evGBGSV:
     {
-        boost::char_separator<char> sep("\r");
-        typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
-        std::size_t nmea_size = this->messageSize();
-        std::string block_in_string(reinterpret_cast<const char*>(data_), nmea_size);
-        tokenizer tokens(block_in_string, sep);
-
-        std::string id = this->messageID();
-        std::string one_message = *tokens.begin();
-        boost::char_separator<char> sep_2(",*", "", boost::keep_empty_tokens);
-        tokenizer tokens_2(one_message, sep_2);
-        std::vector<std::string> body;
-        for (tokenizer::iterator tok_iter = tokens_2.begin();
-             tok_iter != tokens_2.end(); ++tok_iter)
-        {
-            body.push_back(*tok_iter);
-        }
-        // Create NmeaSentence struct to pass to GpgsvParser::parseASCII
-        NMEASentence gsv_message(id, body);
-        septentrio_gnss_driver::GpgsvPtr msg =
-            boost::make_shared<septentrio_gnss_driver::Gpgsv>();
+        // Split the sentence once, in place, to pass it to GpgsvParser::parseASCII
+        NMEASentence gsv_message(reinterpret_cast<const char*>(data_),
+                                 this->messageSize());
+        septentrio_gnss_driver::GpgsvPtr msg;
         GpgsvParser parser_obj;
         try
         {
-            msg = parser_obj.parseASCII(gsv_message);
+            msg = parser_obj.parseASCII(gsv_message, context_->frame_id);
         } catch (ParseException& e)
         {
             throw std::runtime_error(e.what());
         }
-        uint32_t tow = last_pvtgeodetic_.tow;
+        const uint64_t last_pvt_time = context_->last_pvt_time.load();
+        uint32_t tow = static_cast<uint32_t>(last_pvt_time);
+        uint16_t wnc = static_cast<uint16_t>(last_pvt_time >> 32);
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
-        static ros::Publisher publisher =
-            g_nh->advertise<septentrio_gnss_driver::Gpgsv>("/gpgsv",
-                                                           g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time.sec = msg->header.stamp.sec;
-            g_unix_time.nsec = msg->header.stamp.nsec;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evGPGSV, msg);
         break;
     }
     case evNavSatFix:
     {
-        sensor_msgs::NavSatFixPtr msg = boost::make_shared<sensor_msgs::NavSatFix>();
+        sensor_msgs::NavSatFixPtr msg;
         try
         {
             msg = NavSatFixCallback();
@@ -1794,42 +1406,19 @@ bool io_comm_rx::RxMessage::read(std::string message_key, bool search)
         {
             throw std::runtime_error(e.what());
         }
-        msg->header.frame_id = g_frame_id;
+        msg->header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
-        g_pvtgeodetic_has_arrived_navsatfix = false;
-        g_poscovgeodetic_has_arrived_navsatfix = false;
-        static ros::Publisher publisher =
-            g_nh->advertise<sensor_msgs::NavSatFix>("/navsatfix", g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        publishers_->publish(evNavSatFix, msg);
         break;
     }
     case evGPSFix:
     {
-        gps_common::GPSFixPtr msg = boost::make_shared<gps_common::GPSFix>();
+        gps_common::GPSFixPtr msg;
         try
         {
             msg = GPSFixCallback();
@@ -1837,54 +1426,24 @@ bool io_comm_rx::RxMessage::read(std::string message_key, bool search)
         {
             throw std::runtime_error(e.what());
         }
-        msg->status.header.seq = count_gpsfix_;
-        msg->header.frame_id = g_frame_id;
-        msg->status.header.frame_id = g_frame_id;
+        msg->status.header.seq = context_->count_gpsfix;
+        msg->header.frame_id = context_->frame_id;
+        msg->status.header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->status.header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
         msg->status.header.stamp.nsec = time_obj.nsec;
-        ++count_gpsfix_;
-        g_channelstatus_has_arrived_gpsfix = false;
-        g_measepoch_has_arrived_gpsfix = false;
-        g_dop_has_arrived_gpsfix = false;
-        g_pvtgeodetic_has_arrived_gpsfix = false;
-        g_poscovgeodetic_has_arrived_gpsfix = false;
-        g_velcovgeodetic_has_arrived_gpsfix = false;
-        g_atteuler_has_arrived_gpsfix = false;
-        g_attcoveuler_has_arrived_gpsfix = false;
-        static ros::Publisher publisher =
-            g_nh->advertise<gps_common::GPSFix>("/gpsfix", g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
+        ++context_->count_gpsfix;
+        publishers_->publish(evGPSFix, msg);
         break;
     }
     case evPoseWithCovarianceStamped:
     {
-        geometry_msgs::PoseWithCovarianceStampedPtr msg =
-            boost::make_shared<geometry_msgs::PoseWithCovarianceStamped>();
+        geometry_msgs::PoseWithCovarianceStampedPtr msg;
         try
         {
             msg = PoseWithCovarianceStampedCallback();
@@ -1892,129 +1451,58 @@ bool io_comm_rx::RxMessage::read(std::string message_key, bool search)
         {
             throw std::runtime_error(e.what());
         }
-        msg->header.frame_id = g_frame_id;
+        msg->header.frame_id = context_->frame_id;
         uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
         ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
-        g_pvtgeodetic_has_arrived_pose = false;
-        g_poscovgeodetic_has_arrived_pose = false;
-        g_atteuler_has_arrived_pose = false;
-        g_attcoveuler_has_arrived_pose = false;
-        static ros::Publisher publisher =
-            g_nh->advertise<geometry_msgs::PoseWithCovarianceStamped>(
-                "/pose", g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
-        break;
-    }
-    case evChannelStatus:
-    {
-        memcpy(&last_channelstatus_, data_, sizeof(last_channelstatus_));
-        g_channelstatus_has_arrived_gpsfix = true;
-        break;
-    }
-    case evMeasEpoch:
-    {
-        memcpy(&last_measepoch_, data_, sizeof(last_measepoch_));
-        g_measepoch_has_arrived_gpsfix = true;
-        break;
-    }
-    case evDOP:
-    {
-        memcpy(&last_dop_, data_, sizeof(last_dop_));
-        g_dop_has_arrived_gpsfix = true;
-        break;
-    }
-    case evVelCovGeodetic:
-    {
-        memcpy(&last_velcovgeodetic_, data_, sizeof(last_velcovgeodetic_));
-        g_velcovgeodetic_has_arrived_gpsfix = true;
+        publishers_->publish(evPoseWithCovarianceStamped, msg);
         break;
     }
     case evDiagnosticArray:
     {
-        diagnostic_msgs::DiagnosticArrayPtr msg =
-            boost::make_shared<diagnostic_msgs::DiagnosticArray>();
+        uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
+        uint16_t wnc = *(reinterpret_cast<const uint16_t*>(data_ + 12));
+        ros::Time time_obj;
+        time_obj = timestampSBF(tow, wnc, g_use_gnss_time);
+        diagnostic_msgs::DiagnosticArrayPtr msg;
         try
         {
-            msg = DiagnosticArrayCallback();
+            msg = DiagnosticArrayCallback(time_obj);
         } catch (std::runtime_error& e)
         {
             throw std::runtime_error(e.what());
         }
-        msg->header.frame_id = g_frame_id;
-        uint32_t tow = *(reinterpret_cast<const uint32_t*>(data_ + 8));
-        ros::Time time_obj;
-        time_obj = timestampSBF(tow, g_use_gnss_time);
+        // Not due yet, or unchanged
+        if (!msg)
+            break;
+        msg->header.frame_id = context_->frame_id;
         msg->header.stamp.sec = time_obj.sec;
         msg->header.stamp.nsec = time_obj.nsec;
-        g_receiverstatus_has_arrived_diagnostics = false;
-        g_qualityind_has_arrived_diagnostics = false;
-        static ros::Publisher publisher =
-            g_nh->advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics",
-                                                              g_ROS_QUEUE_SIZE);
-        // Wait as long as necessary (only when reading from SBF/PCAP file)
-        if (g_read_from_sbf_log || g_read_from_pcap)
-        {
-            ros::Time unix_old = g_unix_time;
-            g_unix_time = time_obj;
-            if (!(unix_old.sec == 0 && unix_old.nsec == 0) &&
-                (g_unix_time.sec != unix_old.sec ||
-                 g_unix_time.nsec != unix_old.nsec))
-            {
-                std::stringstream ss;
-                ss << "Waiting for " << g_unix_time.sec - unix_old.sec
-                   << " seconds and "
-                   << abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))
-                   << " microseconds";
-                ROS_DEBUG("%s", ss.str().c_str());
-                sleep((unsigned int)(g_unix_time.sec - unix_old.sec));
-                usleep(static_cast<uint32_t>(
-                    abs(int((g_unix_time.nsec - unix_old.nsec) / 1000))));
-            }
-        }
-        publisher.publish(*msg);
-        break;
-    }
-    case evReceiverStatus:
-    {
-        memcpy(&last_receiverstatus_, data_, sizeof(last_receiverstatus_));
-        g_receiverstatus_has_arrived_diagnostics = true;
-        break;
-    }
-    case evQualityInd:
-    {
-        memcpy(&last_qualityind_, data_, sizeof(last_qualityind_));
-        g_qualityind_has_arrived_diagnostics = true;
+        publishers_->publish(evDiagnosticArray, msg);
         break;
     }
     case evReceiverSetup:
     {
-        memcpy(&last_receiversetup_, data_, sizeof(last_receiversetup_));
+        // The Rx sends the block periodically, mostly unchanged. Whether it
+        // changed is told by its content behind TOW and WNc.
+        const std::size_t length = blockLength(data_, count_);
+        std::vector<uint8_t>& last_receiversetup = context_->last_receiversetup;
+        const std::size_t header_size = 14;
+        if (length != last_receiversetup.size() || length < header_size ||
+            memcmp(data_ + header_size, last_receiversetup.data() + header_size,
+                   length - header_size) != 0)
+        {
+            last_receiversetup.assign(data_, data_ + length);
+            context_->diagnostics.setup_changed = true;
+        }
         break;
     }
+    default:
         // Many more to be implemented...
+        break;
     }
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,252 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <new>
+#include <sys/stat.h>
+#include <unistd.h>
+// Boost includes
+#include <boost/bind.hpp>
+// ROS includes
+#include <ros/ros.h>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/stream_recorder.hpp>
+
+/**
+ * @file stream_recorder.cpp
+ * @date 14/10/26
+ * @brief Records the raw byte stream from the Rx into rotating files
+ */
+
+namespace {
+    //! Milliseconds the writer sleeps once the queue is drained
+    const int64_t IDLE_WAIT_MS = 20;
+    //! Attempts at finding a file name that is not taken yet
+    const int MAX_NAME_ATTEMPTS = 100;
+} // namespace
+
+namespace io_comm_rx {
+
+    const std::size_t StreamRecorder::QUEUE_CAPACITY;
+    const std::size_t StreamRecorder::WRITE_SIZE;
+    const std::size_t StreamRecorder::ALIGNMENT;
+    const int64_t StreamRecorder::FLUSH_PERIOD_MS;
+
+    StreamRecorder::StreamRecorder(const RecordingSettings& settings) :
+        settings_(settings), queue_(QUEUE_CAPACITY), buffer_(nullptr), staged_(0),
+        fd_(-1), direct_(false), file_size_(0), recorded_bytes_(0),
+        lost_bytes_(0), stopping_(false)
+    {
+        void* buffer;
+        if (posix_memalign(&buffer, ALIGNMENT, WRITE_SIZE) != 0)
+            throw std::bad_alloc();
+        buffer_ = static_cast<uint8_t*>(buffer);
+        writer_thread_.reset(
+            new boost::thread(boost::bind(&StreamRecorder::run, this)));
+    }
+
+    StreamRecorder::~StreamRecorder()
+    {
+        stopping_ = true;
+        writer_thread_->join();
+        free(buffer_);
+    }
+
+    void StreamRecorder::run()
+    {
+        std::chrono::steady_clock::time_point flushed_at =
+            std::chrono::steady_clock::now();
+        while (true)
+        {
+            // Checked before draining, such that nothing queued before the
+            // destructor was called is left behind
+            const bool stopping = stopping_.load();
+            const std::size_t bytes =
+                queue_.read(buffer_ + staged_, WRITE_SIZE - staged_);
+            staged_ += bytes;
+            std::chrono::steady_clock::time_point now =
+                std::chrono::steady_clock::now();
+            if (staged_ == WRITE_SIZE ||
+                (bytes == 0 && staged_ > 0 &&
+                 now - flushed_at >=
+                     std::chrono::milliseconds(FLUSH_PERIOD_MS)))
+            {
+                flush(false);
+                flushed_at = now;
+            }
+            if (bytes == 0)
+            {
+                if (stopping)
+                    break;
+                boost::this_thread::sleep_for(
+                    boost::chrono::milliseconds(IDLE_WAIT_MS));
+            }
+        }
+        flush(true);
+        close();
+    }
+
+    void StreamRecorder::flush(bool all)
+    {
+        if (staged_ == 0)
+            return;
+        if (fd_ >= 0 &&
+            ((settings_.max_file_size > 0 &&
+              file_size_ >= settings_.max_file_size) ||
+             (settings_.max_file_duration_s > 0.0 &&
+              std::chrono::steady_clock::now() - opened_at_ >=
+                  std::chrono::duration<double>(settings_.max_file_duration_s))))
+            close();
+        if (fd_ < 0 && !open())
+        {
+            lost_bytes_ += staged_;
+            staged_ = 0;
+            return;
+        }
+        std::size_t bytes = staged_;
+#ifdef O_DIRECT
+        if (direct_ && bytes % ALIGNMENT != 0)
+        {
+            if (all)
+            {
+                // The tail of the last file is written through the page cache
+                fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+                direct_ = false;
+            } else
+                bytes -= bytes % ALIGNMENT;
+        }
+#endif
+        if (bytes == 0)
+            return;
+        if (writeOut(bytes))
+            recorded_bytes_ += bytes;
+        else
+        {
+            lost_bytes_ += bytes;
+            close();
+        }
+        staged_ -= bytes;
+        std::memmove(buffer_, buffer_ + bytes, staged_);
+    }
+
+    bool StreamRecorder::open()
+    {
+        if (mkdir(settings_.directory.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            ROS_ERROR_THROTTLE(10, "Cannot create recording directory %s: %s",
+                               settings_.directory.c_str(), std::strerror(errno));
+            return false;
+        }
+        char stamp[32];
+        std::time_t now = std::time(nullptr);
+        std::tm utc;
+        gmtime_r(&now, &utc);
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &utc);
+        std::string prefix = settings_.directory + "/rx_";
+        if (!settings_.name.empty())
+            prefix += settings_.name + "_";
+        int flags = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+#ifdef O_DIRECT
+        if (settings_.direct_io)
+            flags |= O_DIRECT;
+#endif
+        // Files started within the same second are told apart by a suffix
+        for (int attempt = 0; attempt < MAX_NAME_ATTEMPTS; ++attempt)
+        {
+            std::string file_name = prefix + stamp;
+            if (attempt > 0)
+                file_name += "_" + std::to_string(attempt);
+            file_name += ".sbf";
+            fd_ = ::open(file_name.c_str(), flags, 0644);
+#ifdef O_DIRECT
+            if (fd_ < 0 && errno == EINVAL && (flags & O_DIRECT))
+            {
+                ROS_WARN("File system of %s does not support direct I/O, falling back to buffered I/O",
+                         settings_.directory.c_str());
+                flags &= ~O_DIRECT;
+                fd_ = ::open(file_name.c_str(), flags, 0644);
+            }
+#endif
+            if (fd_ >= 0)
+            {
+#ifdef O_DIRECT
+                direct_ = (flags & O_DIRECT) != 0;
+#endif
+                file_name_ = file_name;
+                file_size_ = 0;
+                opened_at_ = std::chrono::steady_clock::now();
+                ROS_INFO("Recording the stream from the Rx to %s",
+                         file_name_.c_str());
+                return true;
+            }
+            if (errno != EEXIST)
+                break;
+        }
+        ROS_ERROR_THROTTLE(10, "Cannot create recording file in %s: %s",
+                           settings_.directory.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    void StreamRecorder::close()
+    {
+        if (fd_ < 0)
+            return;
+        if (::close(fd_) != 0)
+            ROS_ERROR("Error while closing %s: %s", file_name_.c_str(),
+                      std::strerror(errno));
+        fd_ = -1;
+        direct_ = false;
+    }
+
+    bool StreamRecorder::writeOut(std::size_t bytes)
+    {
+        std::size_t written = 0;
+        while (written < bytes)
+        {
+            ssize_t result = ::write(fd_, buffer_ + written, bytes - written);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                ROS_ERROR_THROTTLE(10, "Error while writing to %s: %s",
+                                   file_name_.c_str(), std::strerror(errno));
+                return false;
+            }
+            written += static_cast<std::size_t>(result);
+        }
+        file_size_ += bytes;
+        return true;
+    }
+} // namespace io_comm_rx
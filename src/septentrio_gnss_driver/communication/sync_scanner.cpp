@@ -0,0 +1,136 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/rx_message.hpp>
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+
+/**
+ * @file sync_scanner.cpp
+ * @date 14/10/26
+ * @brief Defines a vectorized search for the first byte of message headers
+ */
+
+namespace {
+    //! Builds the second byte to SyncKind_Enum table once at startup
+    const uint8_t* buildSyncKindTable()
+    {
+        static uint8_t table[256];
+        std::fill(table, table + 256, static_cast<uint8_t>(io_comm_rx::evNoSync));
+        table[SBF_SYNC_BYTE_2] = io_comm_rx::evSBFSync;
+        table[NMEA_SYNC_BYTE_2_1] = io_comm_rx::evNMEASync;
+        table[NMEA_SYNC_BYTE_2_2] = io_comm_rx::evNMEASync;
+        table[RESPONSE_SYNC_BYTE_2] = io_comm_rx::evResponseSync;
+        return table;
+    }
+} // namespace
+
+namespace io_comm_rx {
+
+    const uint8_t* SyncScanner::kinds_ = buildSyncKindTable();
+
+    //! Each block of bytes is compared against both first bytes at once, without
+    //! connection descriptors against '$' twice. The remainder that does not
+    //! fill a block is scanned one byte at a time.
+    std::size_t SyncScanner::find(const uint8_t* data, std::size_t size,
+                                  bool connection_descriptors)
+    {
+        const uint8_t first = SBF_SYNC_BYTE_1;
+        const uint8_t other =
+            connection_descriptors ? CONNECTION_DESCRIPTOR_BYTE_1 : first;
+        std::size_t pos = 0;
+#if defined(__AVX2__)
+        const __m256i firsts = _mm256_set1_epi8(static_cast<char>(first));
+        const __m256i others = _mm256_set1_epi8(static_cast<char>(other));
+        for (; pos + 32 <= size; pos += 32)
+        {
+            const __m256i chunk =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+            const __m256i matches = _mm256_or_si256(
+                _mm256_cmpeq_epi8(chunk, firsts), _mm256_cmpeq_epi8(chunk, others));
+            const uint32_t mask =
+                static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+            if (mask != 0)
+                return pos + __builtin_ctz(mask);
+        }
+#elif defined(__SSE2__)
+        const __m128i firsts = _mm_set1_epi8(static_cast<char>(first));
+        const __m128i others = _mm_set1_epi8(static_cast<char>(other));
+        for (; pos + 16 <= size; pos += 16)
+        {
+            const __m128i chunk =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, firsts),
+                                                 _mm_cmpeq_epi8(chunk, others));
+            const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+            if (mask != 0)
+                return pos + __builtin_ctz(mask);
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        const uint8x16_t firsts = vdupq_n_u8(first);
+        const uint8x16_t others = vdupq_n_u8(other);
+        for (; pos + 16 <= size; pos += 16)
+        {
+            const uint8x16_t chunk = vld1q_u8(data + pos);
+            const uint8x16_t matches =
+                vorrq_u8(vceqq_u8(chunk, firsts), vceqq_u8(chunk, others));
+            if (vmaxvq_u8(matches) == 0)
+                continue;
+            // Narrows each byte of the comparison to 4 bits of a 64-bit mask
+            const uint64_t mask = vget_lane_u64(
+                vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)),
+                0);
+            return pos + (__builtin_ctzll(mask) >> 2);
+        }
+#else
+        if (!connection_descriptors)
+        {
+            const void* match = memchr(data, first, size);
+            return match ? static_cast<const uint8_t*>(match) - data : size;
+        }
+#endif
+        for (; pos < size; ++pos)
+        {
+            if (data[pos] == first || data[pos] == other)
+                return pos;
+        }
+        return size;
+    }
+} // namespace io_comm_rx
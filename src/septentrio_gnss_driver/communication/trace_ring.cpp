@@ -0,0 +1,189 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+// Boost includes
+#include <boost/thread/mutex.hpp>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/trace_ring.hpp>
+
+/**
+ * @file trace_ring.cpp
+ * @date 14/10/26
+ * @brief Defines per-thread rings of binary trace records and their dump
+ */
+
+namespace {
+    //! Names of the events, in the order of TraceEvent_Enum
+    const char* const EVENT_NAMES[io_comm_rx::evTraceEventCount] = {
+        "read",     "overflow",     "parse", "frame",       "resync",
+        "response", "decode_error", "drop",  "replay_wait", "write"};
+
+    //! File written by the signal handlers, NUL-terminated
+    char g_dump_path[256];
+
+    //! Serializes the allocation of rings, never taken while recording
+    boost::mutex g_attach_mutex;
+
+    //! Appends the decimal digits of "value" to "text" at "pos"
+    void appendNumber(char* text, std::size_t& pos, uint64_t value)
+    {
+        char digits[20];
+        std::size_t count = 0;
+        do
+        {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (count > 0)
+            text[pos++] = digits[--count];
+    }
+
+    void appendText(char* text, std::size_t& pos, const char* append)
+    {
+        while (*append)
+            text[pos++] = *append++;
+    }
+
+    //! Writes all of "size" bytes, giving up on errors
+    void writeAll(int fd, const char* text, std::size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t written = ::write(fd, text, size);
+            if (written <= 0)
+                return;
+            text += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+
+    //! Replaces the file at g_dump_path by a new one. Whatever is found there,
+    //! e.g. a symlink planted in /tmp, is unlinked rather than followed, and the
+    //! dump is skipped should the path be taken again before it is created.
+    void dumpToPath()
+    {
+        ::unlink(g_dump_path);
+        const int fd = ::open(g_dump_path,
+                              O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0600);
+        if (fd < 0)
+            return;
+        io_comm_rx::TraceRing::dump(fd);
+        ::close(fd);
+    }
+
+    void onDumpSignal(int) { dumpToPath(); }
+
+    //! The handler is reset by SA_RESETHAND, hence raising the signal again
+    //! terminates the process as it would have without us
+    void onFatalSignal(int signal)
+    {
+        dumpToPath();
+        ::raise(signal);
+    }
+} // namespace
+
+namespace io_comm_rx {
+
+    const std::size_t TraceRing::CAPACITY;
+    const std::size_t TraceRing::MAX_THREADS;
+    thread_local TraceRing::Ring* TraceRing::ring_ = nullptr;
+    std::atomic<TraceRing::Ring*> TraceRing::rings_[TraceRing::MAX_THREADS];
+    std::atomic<std::size_t> TraceRing::ring_count_(0);
+    std::atomic<bool> TraceRing::enabled_(true);
+
+    TraceRing::Ring* TraceRing::attach()
+    {
+        boost::mutex::scoped_lock lock(g_attach_mutex);
+        const std::size_t count = ring_count_.load();
+        if (count == MAX_THREADS)
+            return nullptr;
+        Ring* ring = new Ring;
+        ring->head.store(0);
+        rings_[count].store(ring);
+        ring_count_.store(count + 1);
+        ring_ = ring;
+        return ring;
+    }
+
+    void TraceRing::dump(int fd)
+    {
+        static const char header[] =
+            "# thread time_ns event block offset size\n";
+        writeAll(fd, header, sizeof(header) - 1);
+        const std::size_t count = ring_count_.load();
+        for (std::size_t thread = 0; thread < count; ++thread)
+        {
+            const Ring* ring = rings_[thread].load();
+            const uint64_t head = ring->head.load(std::memory_order_acquire);
+            const uint64_t first = head > CAPACITY ? head - CAPACITY : 0;
+            for (uint64_t i = first; i < head; ++i)
+            {
+                const TraceRecord& entry = ring->records[i & (CAPACITY - 1)];
+                char line[128];
+                std::size_t pos = 0;
+                appendNumber(line, pos, thread);
+                line[pos++] = ' ';
+                appendNumber(line, pos, entry.time_ns);
+                line[pos++] = ' ';
+                appendText(line, pos,
+                           entry.event < evTraceEventCount ? EVENT_NAMES[entry.event]
+                                                           : "unknown");
+                line[pos++] = ' ';
+                appendNumber(line, pos, entry.block);
+                line[pos++] = ' ';
+                appendNumber(line, pos, entry.offset);
+                line[pos++] = ' ';
+                appendNumber(line, pos, entry.size);
+                line[pos++] = '\n';
+                writeAll(fd, line, pos);
+            }
+        }
+    }
+
+    void TraceRing::installSignalHandlers(const std::string& path)
+    {
+        strncpy(g_dump_path, path.c_str(), sizeof(g_dump_path) - 1);
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        sigemptyset(&action.sa_mask);
+        action.sa_handler = onDumpSignal;
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGUSR1, &action, nullptr);
+        action.sa_handler = onFatalSignal;
+        action.sa_flags = SA_RESETHAND;
+        for (int signal : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT})
+            sigaction(signal, &action, nullptr);
+    }
+} // namespace io_comm_rx
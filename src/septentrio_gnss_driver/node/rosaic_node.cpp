@@ -28,6 +28,10 @@
 //
 // ****************************************************************************
 
+// C++ library includes
+#include <algorithm>
+#include <set>
+// ROSaic includes
 #include <septentrio_gnss_driver/node/rosaic_node.hpp>
 
 /**
@@ -36,13 +40,30 @@
  * @brief The heart of the ROSaic driver: The ROS node that represents it
  */
 
-rosaic_node::ROSaicNode::ROSaicNode()
+rosaic_node::ROSaicNode::ROSaicNode(
+    const std::string& name,
+    const boost::shared_ptr<io_comm_rx::IoServicePool>& pool) :
+    name_(name),
+    nh_(name.empty() ? g_nh : boost::make_shared<ros::NodeHandle>(*g_nh, name)),
+    topic_prefix_(name.empty() ? std::string() : "/" + name)
 {
     ROS_DEBUG("Called ROSaicNode() constructor..");
 
-    // Parameters must be set before initializing IO
-    connected_ = false;
+    // Parameters must be set before initializing io_
+    connections_ = 0;
     getROSParams();
+    io_.setIoServicePool(pool);
+
+    // Latencies are sampled from the first byte on, hence ahead of initializeIO()
+    if (statistics_period_s_ > 0)
+    {
+        io_.handlers_.statistics().setTiming(true);
+        statistics_publisher_ =
+            g_nh->advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 10);
+        statistics_timer_ =
+            g_nh->createTimer(ros::Duration(statistics_period_s_),
+                              &ROSaicNode::publishStatistics, this);
+    }
 
     // Initializes Connection
     initializeIO();
@@ -52,17 +73,94 @@ rosaic_node::ROSaicNode::ROSaicNode()
     defineMessages();
 
     // Sends commands to the Rx regarding which SBF/NMEA messages it should output
-    // and sets all its necessary corrections-related parameters
+    // and sets all its necessary corrections-related parameters, once connected.
+    // Not waiting here lets the other Rxs of the node connect meanwhile.
     if (!g_read_from_sbf_log && !g_read_from_pcap)
     {
-        boost::mutex::scoped_lock lock(connection_mutex_);
-        connection_condition_.wait(lock, [this]() { return connected_; });
+        reconfiguration_thread_ =
+            boost::thread(boost::bind(&ROSaicNode::reconfigure, this, 0));
+    }
+    ROS_DEBUG("Leaving ROSaicNode() constructor..");
+}
+
+rosaic_node::ROSaicNode::~ROSaicNode()
+{
+    reconfiguration_thread_.interrupt();
+    reconfiguration_thread_.join();
+}
+
+uint32_t rosaic_node::ROSaicNode::waitForConnection(uint32_t configured)
+{
+    boost::mutex::scoped_lock lock(connection_mutex_);
+    connection_condition_.wait(
+        lock, [this, configured]() { return connections_ != configured; });
+    return connections_;
+}
+
+//! The settings of the Rx survive a lost connection, but its output streams are
+//! bound to the Rx port, which is a different one for every TCP connection.
+void rosaic_node::ROSaicNode::reconfigure(uint32_t configured)
+{
+    // Ends once the destructor interrupts one of the waits
+    while (true)
+    {
+        const bool reconnected = configured > 0;
+        configured = waitForConnection(configured);
+        ROS_INFO_COND(reconnected,
+                      "Connection to the Rx re-established, configuring it anew");
         configureRx();
     }
+}
 
-    // Since we already have a ros::Spin() elsewhere, we use waitForShutdown() here
-    ros::waitForShutdown();
-    ROS_DEBUG("Leaving ROSaicNode() constructor..");
+void rosaic_node::ROSaicNode::connectionEstablished()
+{
+    boost::mutex::scoped_lock lock(connection_mutex_);
+    ++connections_;
+    lock.unlock();
+    connection_condition_.notify_one();
+}
+
+void rosaic_node::ROSaicNode::publishStatistics(const ros::TimerEvent& event)
+{
+    diagnostic_msgs::DiagnosticArrayPtr msg(new diagnostic_msgs::DiagnosticArray);
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = name_.empty() ? "septentrio_gnss_driver: pipeline"
+                                : "septentrio_gnss_driver: " + name_ + " pipeline";
+    status.hardware_id = device_;
+    io_.handlers_.statistics().report(status);
+    if (!g_read_from_sbf_log && !g_read_from_pcap)
+    {
+        const io_comm_rx::ConnectionStatistics connection =
+            io_.connectionStatistics();
+        const io_comm_rx::StreamRecorder* recorder = io_.recorder();
+        const std::pair<std::string, std::string> values[] = {
+            std::make_pair("Connected", connection.connected ? "true" : "false"),
+            std::make_pair("Reconnects", std::to_string(connection.reconnects)),
+            std::make_pair("Failed connection attempts",
+                           std::to_string(connection.failed_attempts)),
+            std::make_pair("Watchdog timeouts",
+                           std::to_string(connection.watchdog_timeouts)),
+            std::make_pair("Downtime [s]", std::to_string(connection.downtime_s)),
+            std::make_pair("Recorded bytes",
+                           std::to_string(recorder ? recorder->recordedBytes() : 0)),
+            std::make_pair("Recording dropped bytes",
+                           std::to_string(recorder ? recorder->droppedBytes() : 0))};
+        for (const std::pair<std::string, std::string>& value : values)
+        {
+            diagnostic_msgs::KeyValue key_value;
+            key_value.key = value.first;
+            key_value.value = value.second;
+            status.values.push_back(key_value);
+        }
+        if (!connection.connected)
+        {
+            status.level = diagnostic_msgs::DiagnosticStatus::ERROR;
+            status.message = "Disconnected from the Rx";
+        }
+    }
+    msg->header.stamp = ros::Time::now();
+    msg->status.push_back(status);
+    statistics_publisher_.publish(msg);
 }
 
 //! The send() method of AsyncManager class is paramount for this purpose.
@@ -76,11 +174,13 @@ void rosaic_node::ROSaicNode::configureRx()
 {
     ROS_DEBUG("Called configureRx() method");
 
-    // It is imperative to hold a lock on the mutex "g_response_mutex" while
-    // modifying the variable "g_response_received". Same for "g_cd_mutex" and
-    // "g_cd_received".
-    boost::mutex::scoped_lock lock(g_response_mutex);
-    boost::mutex::scoped_lock lock_cd(g_cd_mutex);
+    // It is imperative to hold a lock on the mutex "response_mutex" while
+    // modifying the variable "response_received". Same for "cd_mutex" and
+    // "cd_received". Both are released before the configuration script is sent,
+    // whose replies are matched by the script itself.
+    io_comm_rx::ReceiverContext& context = io_.handlers_.context();
+    boost::mutex::scoped_lock lock(context.response_mutex);
+    boost::mutex::scoped_lock lock_cd(context.cd_mutex);
 
     // Determining communication mode: TCP vs USB/Serial
     unsigned stream = 1;
@@ -90,24 +190,50 @@ void rosaic_node::ROSaicNode::configureRx()
     std::string rx_port;
     if (proto == "tcp")
     {
+        // Every TCP connection comes with its own connection descriptor
+        context.read_cd = true;
+        context.cd_count = 0;
         // Escape sequence (escape from correction mode), ensuring that we can send
         // our real commands afterwards...
-        IO.send("\x0DSSSSSSSSSSSSSSSSSSS\x0D\x0D");
+        io_.send("\x0DSSSSSSSSSSSSSSSSSSS\x0D\x0D");
         // We wait for the connection descriptor before we send another command,
         // otherwise the latter would not be processed.
-        g_cd_condition.wait(lock_cd, []() { return g_cd_received; });
-        g_cd_received = false;
-        rx_port = g_rx_tcp_port;
+        if (!context.cd_condition.wait_for(
+                lock_cd, boost::chrono::milliseconds(COMMAND_TIMEOUT_MS_),
+                [&context]() { return context.cd_received; }))
+        {
+            ROS_ERROR("The Rx sent no connection descriptor within %u ms, hence it "
+                      "was not configured",
+                      COMMAND_TIMEOUT_MS_);
+            return;
+        }
+        context.cd_received = false;
+        rx_port = context.rx_tcp_port;
     } else
     {
         rx_port = rx_serial_port_;
         // After booting, the Rx sends the characters "x?" to all ports, which could
         // potentially mingle with our first command. Hence send a safeguard command
         // "lif", whose potentially false processing is harmless.
-        IO.send("lif, Identification \x0D");
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
+        io_.send("lif, Identification \x0D");
+        if (!context.response_condition.wait_for(
+                lock, boost::chrono::milliseconds(COMMAND_TIMEOUT_MS_),
+                [&context]() { return context.response_received; }))
+        {
+            ROS_ERROR("The Rx did not answer within %u ms, hence it was not "
+                      "configured",
+                      COMMAND_TIMEOUT_MS_);
+            return;
+        }
+        context.response_received = false;
     }
+    lock.unlock();
+    lock_cd.unlock();
+
+    // All further commands are collected into one script, which is written at once
+    // and answered by the Rx command by command
+    boost::shared_ptr<io_comm_rx::CommandBatch> batch(
+        new io_comm_rx::CommandBatch());
     uint32_t rx_period_pvt =
         parsing_utilities::convertUserPeriodToRxCommand(polling_period_pvt_);
     uint32_t rx_period_rest =
@@ -127,15 +253,9 @@ void rosaic_node::ROSaicNode::configureRx()
 
     // Turning off all current SBF/NMEA output
     // Authentication, leaving anonymous mode
-    IO.send("login, Tibor, Tibor \x0D");
-    g_response_condition.wait(lock, []() { return g_response_received; });
-    g_response_received = false;
-    IO.send("sso, all, none, none, off \x0D");
-    g_response_condition.wait(lock, []() { return g_response_received; });
-    g_response_received = false;
-    IO.send("sno, all, none, none, off \x0D");
-    g_response_condition.wait(lock, []() { return g_response_received; });
-    g_response_received = false;
+    batch->add("login, Tibor, Tibor \x0D");
+    batch->add("sso, all, none, none, off \x0D");
+    batch->add("sno, all, none, none, off \x0D");
 
     // Setting the datum to be used by the Rx (not the NMEA output though, which only
     // provides MSL and undulation (by default with respect to WGS84), but not
@@ -143,10 +263,8 @@ void rosaic_node::ROSaicNode::configureRx()
     {
         std::stringstream ss;
         ss << "sgd, " << datum_ << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
     }
-    g_response_condition.wait(lock, []() { return g_response_received; });
-    g_response_received = false;
 
     // Setting SBF/NMEA output of Rx
     if (publish_gpgga_ == true)
@@ -155,10 +273,8 @@ void rosaic_node::ROSaicNode::configureRx()
 
         ss << "sno, Stream" << std::to_string(stream) << ", " << rx_port << ", GGA, "
            << pvt_sec_or_msec << std::to_string(rx_period_pvt) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_gprmc_ == true)
     {
@@ -166,10 +282,8 @@ void rosaic_node::ROSaicNode::configureRx()
 
         ss << "sno, Stream" << std::to_string(stream) << ", " << rx_port << ", RMC, "
            << pvt_sec_or_msec << std::to_string(rx_period_pvt) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_gpgsa_ == true)
     {
@@ -177,10 +291,8 @@ void rosaic_node::ROSaicNode::configureRx()
 
         ss << "sno, Stream" << std::to_string(stream) << ", " << rx_port << ", GSA, "
            << pvt_sec_or_msec << std::to_string(rx_period_pvt) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_gpgsv_ == true)
     {
@@ -188,10 +300,8 @@ void rosaic_node::ROSaicNode::configureRx()
 
         ss << "sno, Stream" << std::to_string(stream) << ", " << rx_port << ", GSV, "
            << rest_sec_or_msec << std::to_string(rx_period_rest) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_pvtcartesian_ == true)
     {
@@ -199,10 +309,8 @@ void rosaic_node::ROSaicNode::configureRx()
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", PVTCartesian, " << pvt_sec_or_msec << std::to_string(rx_period_pvt)
            << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_pvtgeodetic_ == true)
     {
@@ -210,10 +318,8 @@ void rosaic_node::ROSaicNode::configureRx()
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", PVTGeodetic, " << pvt_sec_or_msec << std::to_string(rx_period_pvt)
            << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_poscovcartesian_ == true)
     {
@@ -221,10 +327,8 @@ void rosaic_node::ROSaicNode::configureRx()
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", PosCovCartesian, " << pvt_sec_or_msec
            << std::to_string(rx_period_pvt) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_poscovgeodetic_ == true)
     {
@@ -232,10 +336,8 @@ void rosaic_node::ROSaicNode::configureRx()
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", PosCovGeodetic, " << pvt_sec_or_msec
            << std::to_string(rx_period_pvt) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_atteuler_ == true)
     {
@@ -243,10 +345,8 @@ void rosaic_node::ROSaicNode::configureRx()
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", AttEuler, " << rest_sec_or_msec << std::to_string(rx_period_rest)
            << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
     if (publish_attcoveuler_ == true)
     {
@@ -254,71 +354,55 @@ void rosaic_node::ROSaicNode::configureRx()
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", AttCovEuler, " << rest_sec_or_msec << std::to_string(rx_period_rest)
            << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
-    if (g_publish_gpsfix == true)
+    if (context.publish_gpsfix == true)
     {
         std::stringstream ss;
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", ChannelStatus, " << pvt_sec_or_msec << std::to_string(rx_period_pvt)
            << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
         ss.str(std::string()); // avoids invoking the std::string constructor
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", MeasEpoch, " << pvt_sec_or_msec << std::to_string(rx_period_pvt)
            << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
         ss.str(std::string());
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port << ", DOP, "
            << pvt_sec_or_msec << std::to_string(rx_period_pvt) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
         ss.str(std::string());
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", VelCovGeodetic, " << pvt_sec_or_msec
            << std::to_string(rx_period_pvt) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
-    if (g_publish_diagnostics == true)
+    if (context.publish_diagnostics == true)
     {
         std::stringstream ss;
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", ReceiverStatus, " << rest_sec_or_msec
            << std::to_string(rx_period_rest) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
         ss.str(std::string());
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", QualityInd, " << rest_sec_or_msec << std::to_string(rx_period_rest)
            << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
         ss.str(std::string());
         ss << "sso, Stream" << std::to_string(stream) << ", " << rx_port
            << ", ReceiverSetup, " << rest_sec_or_msec
            << std::to_string(rx_period_rest) << "\x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
         ++stream;
-        g_response_condition.wait(lock, []() { return g_response_received; });
-        g_response_received = false;
     }
 
     // Setting the marker-to-ARP offsets. This comes after the "sso, ...,
@@ -330,20 +414,16 @@ void rosaic_node::ROSaicNode::configureRx()
            << ", " << string_utilities::trimString(std::to_string(delta_n_)) << ", "
            << string_utilities::trimString(std::to_string(delta_u_)) << ", \""
            << ant_type_ << "\", \"" << ant_serial_nr_ << "\", 0 \x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
     }
-    g_response_condition.wait(lock, []() { return g_response_received; });
-    g_response_received = false;
 
     // Configuring the NTRIP connection
     // First disable any existing NTRIP connection on NTR1
     {
         std::stringstream ss;
         ss << "snts, NTR1, off \x0D";
-        IO.send(ss.str());
+        batch->add(ss.str());
     }
-    g_response_condition.wait(lock, []() { return g_response_received; });
-    g_response_received = false;
     if (rx_has_internet_)
     {
         if (mode_ == "off")
@@ -356,19 +436,15 @@ void rosaic_node::ROSaicNode::configureRx()
                    << std::to_string(caster_port_) << ", " << username_ << ", "
                    << password_ << ", " << mountpoint_ << ", " << ntrip_version_
                    << ", " << send_gga_ << " \x0D";
-                IO.send(ss.str());
+                batch->add(ss.str());
             }
-            g_response_condition.wait(lock, []() { return g_response_received; });
-            g_response_received = false;
         } else if (mode_ == "Client-Sapcorda")
         {
             {
                 std::stringstream ss;
                 ss << "snts, NTR1, Client-Sapcorda, , , , , , , , \x0D";
-                IO.send(ss.str());
+                batch->add(ss.str());
             }
-            g_response_condition.wait(lock, []() { return g_response_received; });
-            g_response_received = false;
         } else
         {
             ROS_ERROR("Invalid mode specified for NTRIP settings.");
@@ -385,19 +461,15 @@ void rosaic_node::ROSaicNode::configureRx()
                 // In case IPS1 was used before, old configuration is lost of course.
                 ss << "siss, IPS1, " << std::to_string(rx_input_corrections_tcp_)
                    << ", TCP2Way \x0D";
-                IO.send(ss.str());
+                batch->add(ss.str());
             }
-            g_response_condition.wait(lock, []() { return g_response_received; });
-            g_response_received = false;
             {
                 std::stringstream ss;
                 ss << "sno, Stream" << std::to_string(stream) << ", IPS1, GGA, "
                    << pvt_sec_or_msec << std::to_string(rx_period_pvt) << " \x0D";
                 ++stream;
-                IO.send(ss.str());
+                batch->add(ss.str());
             }
-            g_response_condition.wait(lock, []() { return g_response_received; });
-            g_response_received = false;
         }
         {
             std::stringstream ss;
@@ -409,20 +481,72 @@ void rosaic_node::ROSaicNode::configureRx()
                 ss << "sdio, " << rx_input_corrections_serial_ << ", "
                    << rtcm_version_ << ", +SBF+NMEA \x0D";
             }
-            IO.send(ss.str());
+            batch->add(ss.str());
         }
     }
+
+    io_.send(batch);
+    if (!batch->waitForReplies(COMMAND_TIMEOUT_MS_))
+        ROS_ERROR("The Rx did not answer all %li configuration commands within "
+                  "%u ms", batch->commands().size(), COMMAND_TIMEOUT_MS_);
+    std::size_t failures = batch->report();
+    io_.handlers_.setCommandBatch(boost::shared_ptr<io_comm_rx::CommandBatch>());
+    ROS_INFO_COND(failures == 0, "Rx configured with %li commands",
+                  batch->commands().size());
     ROS_DEBUG("Leaving configureRx() method");
 }
 void rosaic_node::ROSaicNode::getROSParams()
 {
     // Communication parameters
-    g_nh->param("device", device_, std::string("/dev/ttyACM0"));
+    param("device", device_, std::string("/dev/ttyACM0"));
     getROSInt("serial/baudrate", baudrate_, static_cast<uint32_t>(115200));
-    g_nh->param("serial/hw_flow_control", hw_flow_control_, std::string("off"));
-    g_nh->param("serial/rx_serial_port", rx_serial_port_, std::string("USB1"));
-
-    g_nh->param("reconnect_delay_s", reconnect_delay_s_, 4.0f);
+    param("serial/hw_flow_control", hw_flow_control_, std::string("off"));
+    param("serial/rx_serial_port", rx_serial_port_, std::string("USB1"));
+
+    param("reconnect_delay_s", reconnect_delay_s_, 4.0f);
+    param("reconnect_delay_max_s", reconnect_delay_max_s_, 32.0f);
+    param("watchdog_timeout_s", watchdog_timeout_s_, 10.0f);
+    param("statistics_period_s", statistics_period_s_, 1.0f);
+
+    // Sizing and tuning of the stream to the Rx
+    uint32_t read_buffer_size;
+    getROSInt("stream/read_buffer_size", read_buffer_size,
+              static_cast<uint32_t>(65536));
+    stream_settings_.read_buffer_size = read_buffer_size;
+    getROSInt("stream/tcp_receive_buffer_size",
+              stream_settings_.tcp_receive_buffer_size, 0);
+    param("stream/tcp_no_delay", stream_settings_.tcp_no_delay, true);
+    param("stream/serial_low_latency", stream_settings_.serial_low_latency, true);
+
+    // Recording of the raw stream from the Rx
+    param("recording/directory", recording_settings_.directory, std::string());
+    // Names may be nested namespaces, which must not turn into subdirectories
+    recording_settings_.name = name_;
+    std::replace(recording_settings_.name.begin(), recording_settings_.name.end(),
+                 '/', '_');
+    uint32_t max_file_size_mb;
+    getROSInt("recording/max_file_size_mb", max_file_size_mb,
+              static_cast<uint32_t>(1024));
+    recording_settings_.max_file_size =
+        static_cast<std::size_t>(max_file_size_mb) * 1024 * 1024;
+    param("recording/max_file_duration_s", recording_settings_.max_file_duration_s,
+          3600.0);
+    param("recording/direct_io", recording_settings_.direct_io, false);
+
+    // Part of SBF logs that is replayed
+    param("replay/start_time", replay_settings_.start_time, 0.0);
+    param("replay/end_time", replay_settings_.end_time, 0.0);
+    // A double, since XML-RPC integers cannot address logs beyond 2 GiB
+    double start_offset;
+    param("replay/start_offset", start_offset, 0.0);
+    replay_settings_.start_offset =
+        static_cast<uint64_t>(std::max(start_offset, 0.0));
+    getROSInt("replay/index_interval", replay_settings_.index_interval,
+              static_cast<uint32_t>(100));
+
+    // Replay of PCAP captures
+    getROSInt("pcap/port", pcap_port_, static_cast<uint32_t>(3001));
+    param("pcap/filter", pcap_filter_, std::string());
 
     // Polling period parameters
     getROSInt("polling_period/pvt", polling_period_pvt_,
@@ -451,41 +575,55 @@ void rosaic_node::ROSaicNode::getROSParams()
     }
 
     // Datum and marker-to-ARP offset
-    g_nh->param("datum", datum_, std::string("ETRS89"));
-    g_nh->param("ant_type", ant_type_, std::string("Unknown"));
-    g_nh->param("ant_serial_nr", ant_serial_nr_, std::string("Unknown"));
-    g_nh->param("marker_to_arp/delta_e", delta_e_, 0.0f);
-    g_nh->param("marker_to_arp/delta_n", delta_n_, 0.0f);
-    g_nh->param("marker_to_arp/delta_u", delta_u_, 0.0f);
+    param("datum", datum_, std::string("ETRS89"));
+    param("ant_type", ant_type_, std::string("Unknown"));
+    param("ant_serial_nr", ant_serial_nr_, std::string("Unknown"));
+    param("marker_to_arp/delta_e", delta_e_, 0.0f);
+    param("marker_to_arp/delta_n", delta_n_, 0.0f);
+    param("marker_to_arp/delta_u", delta_u_, 0.0f);
 
     // Correction service parameters
-    g_nh->param("ntrip_settings/mode", mode_, std::string("off"));
-    g_nh->param("ntrip_settings/caster", caster_, std::string());
+    param("ntrip_settings/mode", mode_, std::string("off"));
+    param("ntrip_settings/caster", caster_, std::string());
     getROSInt("ntrip_settings/caster_port", caster_port_, static_cast<uint32_t>(0));
-    g_nh->param("ntrip_settings/username", username_, std::string());
-    g_nh->param("ntrip_settings/password", password_, std::string());
-    g_nh->param("ntrip_settings/mountpoint", mountpoint_, std::string());
-    g_nh->param("ntrip_settings/ntrip_version", ntrip_version_, std::string("v2"));
-    g_nh->param("ntrip_settings/send_gga", send_gga_, std::string("auto"));
-    g_nh->param("ntrip_settings/rx_has_internet", rx_has_internet_, false);
-    g_nh->param("ntrip_settings/rtcm_version", rtcm_version_, std::string("RTCMv3"));
+    param("ntrip_settings/username", username_, std::string());
+    param("ntrip_settings/password", password_, std::string());
+    param("ntrip_settings/mountpoint", mountpoint_, std::string());
+    param("ntrip_settings/ntrip_version", ntrip_version_, std::string("v2"));
+    param("ntrip_settings/send_gga", send_gga_, std::string("auto"));
+    param("ntrip_settings/rx_has_internet", rx_has_internet_, false);
+    param("ntrip_settings/rtcm_version", rtcm_version_, std::string("RTCMv3"));
     getROSInt("ntrip_settings/rx_input_corrections_tcp", rx_input_corrections_tcp_,
               static_cast<uint32_t>(28785));
-    g_nh->param("ntrip_settings/rx_input_corrections_serial",
-                rx_input_corrections_serial_, std::string("USB2"));
-
-    // Publishing parameters, the others remained global since they need to be
-    // accessed in the callbackhandlers.hpp file
-    g_nh->param("publish/gpgga", publish_gpgga_, true);
-    g_nh->param("publish/gprmc", publish_gprmc_, true);
-    g_nh->param("publish/gpgsa", publish_gpgsa_, true);
-    g_nh->param("publish/gpgsv", publish_gpgsv_, true);
-    g_nh->param("publish/pvtcartesian", publish_pvtcartesian_, true);
-    g_nh->param("publish/pvtgeodetic", publish_pvtgeodetic_, true);
-    g_nh->param("publish/poscovcartesian", publish_poscovcartesian_, true);
-    g_nh->param("publish/poscovgeodetic", publish_poscovgeodetic_, true);
-    g_nh->param("publish/atteuler", publish_atteuler_, true);
-    g_nh->param("publish/attcoveuler", publish_attcoveuler_, true);
+    param("ntrip_settings/rx_input_corrections_serial",
+          rx_input_corrections_serial_, std::string("USB2"));
+
+    // Every Rx needs a frame of its own, hence the frame ID of a named one is not
+    // taken from the shared parameters
+    io_comm_rx::ReceiverContext& context = io_.handlers_.context();
+    nh_->param("frame_id", context.frame_id,
+               name_.empty() ? std::string("gnss") : name_);
+
+    // Publishing parameters, those of the composite ROS messages are kept in the
+    // context since they need to be accessed by the callback handlers
+    param("publish/gpst", context.publish_gpst, true);
+    param("publish/navsatfix", context.publish_navsatfix, true);
+    param("publish/gpsfix", context.publish_gpsfix, true);
+    param("publish/pose", context.publish_pose, true);
+    param("publish/diagnostics", context.publish_diagnostics, true);
+    param("diagnostics/period_s", context.diagnostics_period_s, 0.0);
+    param("diagnostics/on_change", context.diagnostics_on_change, false);
+    param("publish/gpgga", publish_gpgga_, true);
+    param("publish/gprmc", publish_gprmc_, true);
+    param("publish/gpgsa", publish_gpgsa_, true);
+    param("publish/gpgsv", publish_gpgsv_, true);
+    param("publish/pvtcartesian", publish_pvtcartesian_, true);
+    param("publish/pvtgeodetic", publish_pvtgeodetic_, true);
+    param("publish/poscovcartesian", publish_poscovcartesian_, true);
+    param("publish/poscovgeodetic", publish_poscovgeodetic_, true);
+    param("publish/atteuler", publish_atteuler_, true);
+    param("publish/attcoveuler", publish_attcoveuler_, true);
+    param("lazy_decoding", context.lazy_decoding, false);
 
     // To be implemented: RTCM, setting datum, raw data settings, PPP, SBAS, fix
     // mode...
@@ -514,16 +652,13 @@ void rosaic_node::ROSaicNode::initializeIO()
         serial_ = false;
         g_read_from_sbf_log = false;
         g_read_from_pcap = false;
-        boost::thread temporary_thread(boost::bind(&ROSaicNode::connect, this));
-        temporary_thread.detach();
+        connect();
     } else if (boost::regex_match(device_, match,
                                   boost::regex("(file_name):(/|(?:/[\\w-]+)+.sbf)")))
     {
         serial_ = false;
         g_read_from_sbf_log = true;
         g_read_from_pcap = false;
-        g_unix_time.sec = 0;
-        g_unix_time.nsec = 0;
         boost::thread temporary_thread(
             boost::bind(&ROSaicNode::prepareSBFFileReading, this, match[2]));
         temporary_thread.detach();
@@ -535,8 +670,6 @@ void rosaic_node::ROSaicNode::initializeIO()
         serial_ = false;
         g_read_from_sbf_log = false;
         g_read_from_pcap = true;
-        g_unix_time.sec = 0;
-        g_unix_time.nsec = 0;
         boost::thread temporary_thread(
             boost::bind(&ROSaicNode::preparePCAPFileReading, this, match[2]));
         temporary_thread.detach();
@@ -550,8 +683,7 @@ void rosaic_node::ROSaicNode::initializeIO()
         std::stringstream ss;
         ss << "Searching for serial port" << proto;
         ROS_DEBUG("%s", ss.str().c_str());
-        boost::thread temporary_thread(boost::bind(&ROSaicNode::connect, this));
-        temporary_thread.detach();
+        connect();
     } else
     {
         std::stringstream ss;
@@ -568,7 +700,8 @@ void rosaic_node::ROSaicNode::prepareSBFFileReading(std::string file_name)
         std::stringstream ss;
         ss << "Setting up everything needed to read from" << file_name;
         ROS_DEBUG("%s", ss.str().c_str());
-        IO.initializeSBFFileReading(file_name);
+        io_.setReplaySettings(replay_settings_);
+        io_.initializeSBFFileReading(file_name);
     } catch (std::runtime_error& e)
     {
         std::stringstream ss;
@@ -585,7 +718,10 @@ void rosaic_node::ROSaicNode::preparePCAPFileReading(std::string file_name)
         std::stringstream ss;
         ss << "Setting up everything needed to read from " << file_name;
         ROS_DEBUG("%s", ss.str().c_str());
-        IO.initializePCAPFileReading(file_name);
+        std::string filter = pcap_filter_;
+        if (filter.empty())
+            filter = "tcp dst port " + std::to_string(pcap_port_);
+        io_.initializePCAPFileReading(file_name, filter);
     } catch (std::runtime_error& e)
     {
         std::stringstream ss;
@@ -595,85 +731,27 @@ void rosaic_node::ROSaicNode::preparePCAPFileReading(std::string file_name)
     }
 }
 
-void rosaic_node::ROSaicNode::connect()
-{
-    ROS_DEBUG("Called connect() method");
-    ROS_DEBUG(
-        "Setting ROS timer for calling reconnect() method until connection succeds");
-    reconnect_timer_ = g_nh->createTimer(ros::Duration(reconnect_delay_s_),
-                                         &ROSaicNode::reconnect, this);
-    reconnect_timer_.start();
-    ROS_DEBUG(
-        "Started ROS timer for calling reconnect() method until connection succeds");
-    ros::spin();
-    ROS_DEBUG("Leaving connect() method"); // This will never be output since
-                                           // ros::spin() is on the line above.
-}
-
 //! In serial mode (not USB, since the Rx port is then called USB1 or USB2), please
 //! ensure that you are connected to the Rx's COM1, COM2 or COM3 port, !if! you
 //! employ UART hardware flow control.
-void rosaic_node::ROSaicNode::reconnect(const ros::TimerEvent& event)
+void rosaic_node::ROSaicNode::connect()
 {
-    ROS_DEBUG("Called reconnect() method");
-    if (connected_ == true)
-    {
-        reconnect_timer_.stop();
-        ROS_DEBUG("Stopped ROS timer since successully connected.");
-    } else
-    {
-        if (serial_)
-        {
-            bool initialize_serial_return = false;
-            try
-            {
-                ROS_INFO("Connecting serially to device %s, targeted baudrate: %u",
-                         device_.c_str(), baudrate_);
-                initialize_serial_return =
-                    IO.initializeSerial(device_, baudrate_, hw_flow_control_);
-            } catch (std::runtime_error& e)
-            {
-                {
-                    std::stringstream ss;
-                    ss << "IO.initializeSerial() failed for device " << device_
-                       << " due to: " << e.what();
-                    ROS_ERROR("%s", ss.str().c_str());
-                }
-            }
-            if (initialize_serial_return)
-            {
-                boost::mutex::scoped_lock lock(connection_mutex_);
-                connected_ = true;
-                lock.unlock();
-                connection_condition_.notify_one();
-            }
-        } else
-        {
-            bool initialize_tcp_return = false;
-            try
-            {
-                ROS_INFO("Connecting to tcp://%s:%s ...", tcp_host_.c_str(),
-                         tcp_port_.c_str());
-                initialize_tcp_return = IO.initializeTCP(tcp_host_, tcp_port_);
-            } catch (std::runtime_error& e)
-            {
-                {
-                    std::stringstream ss;
-                    ss << "IO.initializeTCP() failed for host " << tcp_host_
-                       << " on port " << tcp_port_ << " due to: " << e.what();
-                    ROS_ERROR("%s", ss.str().c_str());
-                }
-            }
-            if (initialize_tcp_return)
-            {
-                boost::mutex::scoped_lock lock(connection_mutex_);
-                connected_ = true;
-                lock.unlock();
-                connection_condition_.notify_one();
-            }
-        }
-    }
-    ROS_DEBUG("Leaving reconnect() method");
+    ROS_DEBUG("Called connect() method");
+    io_comm_rx::ReconnectPolicy policy;
+    // A lower bound on the delay, lest a refusing Rx be hammered with attempts
+    policy.initial_delay_s = std::max(reconnect_delay_s_, 0.1f);
+    policy.max_delay_s = std::max(reconnect_delay_max_s_, reconnect_delay_s_);
+    policy.watchdog_timeout_s = watchdog_timeout_s_;
+    io_.setReconnectPolicy(policy);
+    io_.setStreamSettings(stream_settings_);
+    io_.setRecordingSettings(recording_settings_);
+    io_.setConnectionCallback(boost::bind(&ROSaicNode::connectionEstablished, this));
+    // Both return right away, the AsyncManager connecting on its own thread
+    if (serial_)
+        io_.initializeSerial(device_, baudrate_, hw_flow_control_);
+    else
+        io_.initializeTCP(tcp_host_, tcp_port_);
+    ROS_DEBUG("Leaving connect() method");
 }
 
 //! initializeSerial is not self-contained: The for loop in Callbackhandlers' handle
@@ -684,98 +762,102 @@ void rosaic_node::ROSaicNode::reconnect(const ros::TimerEvent& event)
 void rosaic_node::ROSaicNode::defineMessages()
 {
     ROS_DEBUG("Called defineMessages() method");
+    const io_comm_rx::ReceiverContext& context = io_.handlers_.context();
 
     if (publish_gpgga_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::Gpgga>("$GPGGA");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::Gpgga>(evGPGGA);
+        advertise<septentrio_gnss_driver::Gpgga>(evGPGGA, "/gpgga");
     }
     if (publish_gprmc_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::Gprmc>("$GPRMC");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::Gprmc>(evGPRMC);
+        advertise<septentrio_gnss_driver::Gprmc>(evGPRMC, "/gprmc");
     }
     if (publish_gpgsa_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::Gpgsa>("$GPGSA");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::Gpgsa>(evGPGSA);
+        advertise<septentrio_gnss_driver::Gpgsa>(evGPGSA, "/gpgsa");
     }
     if (publish_gpgsv_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::Gpgsv>("$GPGSV");
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::Gpgsv>("$GLGSV");
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::Gpgsv>("$GAGSV");
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::Gpgsv>("$GBGSV");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::Gpgsv>(evGPGSV);
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::Gpgsv>(evGLGSV);
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::Gpgsv>(evGAGSV);
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::Gpgsv>(evGBGSV);
+        advertise<septentrio_gnss_driver::Gpgsv>(evGPGSV, "/gpgsv");
     }
     if (publish_pvtcartesian_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::PVTCartesian>("4006");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::PVTCartesian>(evPVTCartesian);
+        advertise<septentrio_gnss_driver::PVTCartesian>(evPVTCartesian, "/pvtcartesian");
     }
     if (publish_pvtgeodetic_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::PVTGeodetic>("4007");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::PVTGeodetic>(evPVTGeodetic);
+        advertise<septentrio_gnss_driver::PVTGeodetic>(evPVTGeodetic, "/pvtgeodetic");
     }
     if (publish_poscovcartesian_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::PosCovCartesian>("5905");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::PosCovCartesian>(evPosCovCartesian);
+        advertise<septentrio_gnss_driver::PosCovCartesian>(evPosCovCartesian, "/poscovcartesian");
     }
     if (publish_poscovgeodetic_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::PosCovGeodetic>("5906");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::PosCovGeodetic>(evPosCovGeodetic);
+        advertise<septentrio_gnss_driver::PosCovGeodetic>(evPosCovGeodetic, "/poscovgeodetic");
     }
     if (publish_atteuler_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::AttEuler>("5938");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::AttEuler>(evAttEuler);
+        advertise<septentrio_gnss_driver::AttEuler>(evAttEuler, "/atteuler");
     }
     if (publish_attcoveuler_ == true)
     {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<septentrio_gnss_driver::AttCovEuler>("5939");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<septentrio_gnss_driver::AttCovEuler>(evAttCovEuler);
+        advertise<septentrio_gnss_driver::AttCovEuler>(evAttCovEuler, "/attcoveuler");
     }
-    if (g_publish_gpst == true)
+    if (context.publish_gpst == true)
     {
-        IO.handlers_.callbackmap_ = IO.getHandlers().insert<int32_t>("GPST");
+        io_.handlers_.callbackmap_ = io_.getHandlers().insert<int32_t>(evGPST);
+        advertise<sensor_msgs::TimeReference>(evGPST, "/gpst");
     }
-    if (g_publish_navsatfix == true)
+    if (context.publish_navsatfix == true)
     {
         if (publish_pvtgeodetic_ == false || publish_poscovgeodetic_ == false)
         {
             ROS_ERROR(
                 "For a proper NavSatFix message, please set the publish/pvtgeodetic and the publish/poscovgeodetic ROSaic parameters both to true.");
         }
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<sensor_msgs::NavSatFix>("NavSatFix");
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<sensor_msgs::NavSatFix>(evNavSatFix);
+        advertise<sensor_msgs::NavSatFix>(evNavSatFix, "/navsatfix");
     }
-    if (g_publish_gpsfix == true)
+    if (context.publish_gpsfix == true)
     {
         if (publish_pvtgeodetic_ == false || publish_poscovgeodetic_ == false)
         {
             ROS_ERROR(
                 "For a proper GPSFix message, please set the publish/pvtgeodetic and the publish/poscovgeodetic ROSaic parameters both to true.");
         }
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<gps_common::GPSFix>("GPSFix");
-        // The following blocks are never published, yet are needed for the
-        // construction of the GPSFix message, hence we have empty callbacks.
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<int32_t>("4013"); // ChannelStatus block
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<int32_t>("4027"); // MeasEpoch block
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<int32_t>("4001"); // DOP block
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<int32_t>("5908"); // VelCovGeodetic block
-    }
-    if (g_publish_pose == true)
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<gps_common::GPSFix>(evGPSFix);
+        advertise<gps_common::GPSFix>(evGPSFix, "/gpsfix");
+    }
+    if (context.publish_pose == true)
     {
         if (publish_pvtgeodetic_ == false || publish_poscovgeodetic_ == false ||
             publish_atteuler_ == false || publish_attcoveuler_ == false)
@@ -783,21 +865,21 @@ void rosaic_node::ROSaicNode::defineMessages()
             ROS_ERROR(
                 "For a proper PoseWithCovarianceStamped message, please set the publish/pvtgeodetic, publish/poscovgeodetic, publish_atteuler and publish_attcoveuler ROSaic parameters all to true.");
         }
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<geometry_msgs::PoseWithCovarianceStamped>(
-                "PoseWithCovarianceStamped");
-    }
-    if (g_publish_diagnostics == true)
-    {
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<diagnostic_msgs::DiagnosticArray>(
-                "DiagnosticArray");
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<int32_t>("4014"); // ReceiverStatus block
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<int32_t>("4082"); // QualityInd block
-        IO.handlers_.callbackmap_ =
-            IO.getHandlers().insert<int32_t>("5902"); // ReceiverSetup block
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<geometry_msgs::PoseWithCovarianceStamped>(
+                evPoseWithCovarianceStamped);
+        advertise<geometry_msgs::PoseWithCovarianceStamped>(evPoseWithCovarianceStamped, "/pose");
+    }
+    if (context.publish_diagnostics == true)
+    {
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<diagnostic_msgs::DiagnosticArray>(
+                evDiagnosticArray);
+        advertise<diagnostic_msgs::DiagnosticArray>(evDiagnosticArray, "/diagnostics");
+        // ReceiverSetup is never published, yet the latest one is needed for the
+        // construction of the DiagnosticArray message, hence an empty callback.
+        io_.handlers_.callbackmap_ =
+            io_.getHandlers().insert<int32_t>(evReceiverSetup); // ReceiverSetup block
     }
     // so on and so forth...
     ROS_DEBUG("Leaving defineMessages() method");
@@ -807,86 +889,15 @@ void rosaic_node::ROSaicNode::defineMessages()
 //! the SBF case) and UTC (in the NMEA case) data. If false, times are constructed
 //! within the driver via time(NULL) of the \<ctime\> library.
 bool g_use_gnss_time;
-//! Whether or not to publish the sensor_msgs::TimeReference message with GPST
-bool g_publish_gpst;
-//! Whether or not to publish the sensor_msgs::NavSatFix message
-bool g_publish_navsatfix;
-//! Whether or not to publish the gps_common::GPSFix message
-bool g_publish_gpsfix;
-//! Whether or not to publish the geometry_msgs::PoseWithCovarianceStamped message
-bool g_publish_pose;
-//! Whether or not to publish the diagnostic_msgs::DiagnosticArray message
-bool g_publish_diagnostics;
-//! The frame ID used in the header of every published ROS message
-std::string g_frame_id;
 //! The number of leap seconds that have been inserted into the UTC time
 uint32_t g_leap_seconds;
-//! Mutex to control changes of global variable "g_response_received"
-boost::mutex g_response_mutex;
-//! Determines whether a command reply was received from the Rx
-bool g_response_received;
-//! Condition variable complementing "g_response_mutex"
-boost::condition_variable g_response_condition;
-//! Mutex to control changes of global variable "g_cd_received"
-boost::mutex g_cd_mutex;
-//! Determines whether the connection descriptor was received from the Rx
-bool g_cd_received;
-//! Condition variable complementing "g_cd_mutex"
-boost::condition_variable g_cd_condition;
-//! Whether or not we still want to read the connection descriptor, which we only
-//! want in the very beginning to know whether it is IP10, IP11 etc.
-bool g_read_cd;
-//! Rx TCP port, e.g. IP10 or IP11, to which ROSaic is connected to
-std::string g_rx_tcp_port;
-//! Since after SSSSSSSSSSS we need to wait for second connection descriptor, we have
-//! to count the connection descriptors
-uint32_t g_cd_count;
-//! For GPSFix: Whether the ChannelStatus block of the current epoch has arrived or
-//! not
-bool g_channelstatus_has_arrived_gpsfix;
-//! For GPSFix: Whether the MeasEpoch block of the current epoch has arrived or not
-bool g_measepoch_has_arrived_gpsfix;
-//! For GPSFix: Whether the DOP block of the current epoch has arrived or not
-bool g_dop_has_arrived_gpsfix;
-//! For GPSFix: Whether the PVTGeodetic block of the current epoch has arrived or not
-bool g_pvtgeodetic_has_arrived_gpsfix;
-//! For GPSFix: Whether the PosCovGeodetic block of the current epoch has arrived or
-//! not
-bool g_poscovgeodetic_has_arrived_gpsfix;
-//! For GPSFix: Whether the VelCovGeodetic block of the current epoch has arrived or
-//! not
-bool g_velcovgeodetic_has_arrived_gpsfix;
-//! For GPSFix: Whether the AttEuler block of the current epoch has arrived or not
-bool g_atteuler_has_arrived_gpsfix;
-//! For GPSFix: Whether the AttCovEuler block of the current epoch has arrived or not
-bool g_attcoveuler_has_arrived_gpsfix;
-//! For NavSatFix: Whether the PVTGeodetic block of the current epoch has arrived or
-//! not
-bool g_pvtgeodetic_has_arrived_navsatfix;
-//! For NavSatFix: Whether the PosCovGeodetic block of the current epoch has arrived
-//! or not
-bool g_poscovgeodetic_has_arrived_navsatfix;
-//! For PoseWithCovarianceStamped: Whether the PVTGeodetic block of the current epoch
-//! has arrived or not
-bool g_pvtgeodetic_has_arrived_pose;
-//! For PoseWithCovarianceStamped: Whether the PosCovGeodetic block of the current
-//! epoch has arrived or not
-bool g_poscovgeodetic_has_arrived_pose;
-//! For PoseWithCovarianceStamped: Whether the AttEuler block of the current epoch
-//! has arrived or not
-bool g_atteuler_has_arrived_pose;
-//! For PoseWithCovarianceStamped: Whether the AttCovEuler block of the current epoch
-//! has arrived or not
-bool g_attcoveuler_has_arrived_pose;
-//! For DiagnosticArray: Whether the ReceiverStatus block of the current epoch has
-//! arrived or not
-bool g_receiverstatus_has_arrived_diagnostics;
-//! For DiagnosticArray: Whether the QualityInd block of the current epoch has
-//! arrived or not
-bool g_qualityind_has_arrived_diagnostics;
-//! When reading from an SBF file, the ROS publishing frequency is governed by the
-//! time stamps found in the SBF blocks therein.
-ros::Time g_unix_time;
+//! When reading from an SBF/PCAP file, the ROS publishing frequency is governed by
+//! the time stamps found therein, sped up by this factor. 0 means as fast as
+//! possible.
+double g_replay_rate;
+//! Number of threads decoding and publishing messages, 0 to do so on the thread
+//! reading from the Rx or file
+uint32_t g_decode_threads;
 //! Whether or not we are reading from an SBF file
 bool g_read_from_sbf_log;
 //! Whether or not we are reading from a PCAP file
@@ -911,50 +922,60 @@ boost::shared_ptr<ros::NodeHandle> g_nh;
 //! Queue size for ROS publishers
 const uint32_t g_ROS_QUEUE_SIZE = 1;
 
-int main(int argc, char** argv)
+void rosaic_node::initializeGlobals(bool nodelet)
 {
-    ros::init(argc, argv, "septentrio_gnss");
-    g_nh.reset(new ros::NodeHandle("~"));
     g_nh->param("use_gnss_time", g_use_gnss_time, true);
-    g_nh->param("frame_id", g_frame_id, (std::string) "gnss");
-    g_nh->param("publish/gpst", g_publish_gpst, true);
-    g_nh->param("publish/navsatfix", g_publish_navsatfix, true);
-    g_nh->param("publish/gpsfix", g_publish_gpsfix, true);
-    g_nh->param("publish/pose", g_publish_pose, true);
-    g_nh->param("publish/diagnostics", g_publish_diagnostics, true);
-    rosaic_node::getROSInt("leap_seconds", g_leap_seconds,
-                           static_cast<uint32_t>(18));
-
-    g_response_received = false;
-    g_cd_received = false;
-    g_read_cd = true;
-    g_cd_count = 0;
-    g_channelstatus_has_arrived_gpsfix = false;
-    g_measepoch_has_arrived_gpsfix = false;
-    g_dop_has_arrived_gpsfix = false;
-    g_pvtgeodetic_has_arrived_gpsfix = false;
-    g_pvtgeodetic_has_arrived_navsatfix = false;
-    g_pvtgeodetic_has_arrived_pose = false;
-    g_poscovgeodetic_has_arrived_gpsfix = false;
-    g_poscovgeodetic_has_arrived_navsatfix = false;
-    g_poscovgeodetic_has_arrived_pose = false;
-    g_velcovgeodetic_has_arrived_gpsfix = false;
-    g_atteuler_has_arrived_gpsfix = false;
-    g_atteuler_has_arrived_pose = false;
-    g_attcoveuler_has_arrived_gpsfix = false;
-    g_attcoveuler_has_arrived_pose = false;
-    g_receiverstatus_has_arrived_diagnostics = false;
-    g_qualityind_has_arrived_diagnostics = false;
-
-    // The info logging level seems to be default, hence we modify log level
-    // momentarily.. The following is the C++ version of
-    // rospy.init_node('my_ros_node', log_level=rospy.DEBUG)
-    if (ros::console::set_logger_level(
-            ROSCONSOLE_DEFAULT_NAME,
-            ros::console::levels::Debug)) // debug is lowest level, shows everything
-        ros::console::notifyLoggerLevelsChanged();
-
-    rosaic_node::ROSaicNode
-        rx_node; // This launches everything we need, in theory :)
-    return 0;
+    g_nh->param("replay_rate", g_replay_rate, 1.0);
+    getROSInt("leap_seconds", g_leap_seconds, static_cast<uint32_t>(18));
+    getROSInt("decode_threads", g_decode_threads, static_cast<uint32_t>(2));
+
+    // The trace rings are shared by all Rxs of the process
+    bool trace_enabled;
+    std::string trace_dump_file;
+    g_nh->param("trace/enabled", trace_enabled, true);
+    g_nh->param("trace/dump_file", trace_dump_file, std::string());
+    io_comm_rx::TraceRing::setEnabled(trace_enabled);
+    if (trace_dump_file.empty())
+        return;
+    // The signal handlers are the process's, which belongs to the nodelet
+    // manager rather than to us in case of a nodelet
+    if (nodelet)
+    {
+        ROS_WARN("Ignoring trace/dump_file, since a nodelet does not install "
+                 "signal handlers in the manager's process");
+        return;
+    }
+    io_comm_rx::TraceRing::installSignalHandlers(trace_dump_file);
+}
+
+std::vector<boost::shared_ptr<rosaic_node::ROSaicNode>> rosaic_node::createNodes()
+{
+    std::vector<boost::shared_ptr<ROSaicNode>> nodes;
+    std::vector<std::string> receivers;
+    g_nh->param("receivers", receivers, std::vector<std::string>());
+    if (receivers.empty())
+    {
+        nodes.push_back(boost::make_shared<ROSaicNode>());
+        return nodes;
+    }
+    uint32_t io_threads;
+    getROSInt("io_threads", io_threads, static_cast<uint32_t>(0));
+    if (io_threads == 0)
+        io_threads = static_cast<uint32_t>(receivers.size());
+    boost::shared_ptr<io_comm_rx::IoServicePool> pool(
+        new io_comm_rx::IoServicePool(io_threads));
+    ROS_INFO("Serving %li Rxs on %u I/O threads", receivers.size(), io_threads);
+    std::set<std::string> names;
+    for (const std::string& name : receivers)
+    {
+        if (name.empty() || !names.insert(name).second)
+        {
+            ROS_ERROR("Ignoring the Rx named \"%s\", since its name is empty or "
+                      "taken already",
+                      name.c_str());
+            continue;
+        }
+        nodes.push_back(boost::make_shared<ROSaicNode>(name, pool));
+    }
+    return nodes;
 }
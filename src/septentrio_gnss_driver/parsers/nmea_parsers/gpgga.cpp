@@ -51,7 +51,8 @@ const std::string GpggaParser::getMessageID() const
  * sentence.get_body()[15] if anybody ever needs it.
  */
 septentrio_gnss_driver::GpggaPtr
-GpggaParser::parseASCII(const NMEASentence& sentence) noexcept(false)
+GpggaParser::parseASCII(const NMEASentence& sentence,
+                        const std::string& frame_id) noexcept(false)
 {
     // ROS_DEBUG("Just testing that first entry is indeed what we expect it to be:
     // %s", sentence.get_body()[0].c_str());
@@ -67,9 +68,9 @@ GpggaParser::parseASCII(const NMEASentence& sentence) noexcept(false)
 
     septentrio_gnss_driver::GpggaPtr msg =
         boost::make_shared<septentrio_gnss_driver::Gpgga>();
-    msg->header.frame_id = g_frame_id;
+    msg->header.frame_id = frame_id;
 
-    msg->message_id = sentence.get_body()[0];
+    msg->message_id = sentence.get_body()[0].to_string();
 
     if (sentence.get_body()[1].empty() || sentence.get_body()[1] == "0")
     {
@@ -85,15 +86,10 @@ GpggaParser::parseASCII(const NMEASentence& sentence) noexcept(false)
                 msg->utc_seconds =
                     parsing_utilities::convertUTCDoubleToSeconds(utc_double);
 
-                // The Header's Unix Epoch time stamp
-                time_t unix_time_seconds =
-                    parsing_utilities::convertUTCtoUnix(utc_double);
-                // The following assumes that there are two digits after the decimal
-                // point in utc_double, i.e. in the NMEA UTC time.
-                uint32_t unix_time_nanoseconds =
-                    (static_cast<uint32_t>(utc_double * 100) % 100) * 10000;
-                msg->header.stamp.sec = unix_time_seconds;
-                msg->header.stamp.nsec = unix_time_nanoseconds;
+                // The Header's Unix Epoch time stamp, including the fractional
+                // seconds of the NMEA UTC time
+                msg->header.stamp = parsing_utilities::convertUTCTimeOfDayToUnix(
+                    parsing_utilities::convertUTCDoubleToMilliseconds(utc_double));
             } else
             {
                 ros::Time time_obj;
@@ -122,8 +118,8 @@ GpggaParser::parseASCII(const NMEASentence& sentence) noexcept(false)
         valid && parsing_utilities::parseDouble(sentence.get_body()[4], longitude);
     msg->lon = parsing_utilities::convertDMSToDegrees(longitude);
 
-    msg->lat_dir = sentence.get_body()[3];
-    msg->lon_dir = sentence.get_body()[5];
+    msg->lat_dir = sentence.get_body()[3].to_string();
+    msg->lon_dir = sentence.get_body()[5].to_string();
     valid = valid &&
             parsing_utilities::parseUInt32(sentence.get_body()[6], msg->gps_qual);
     valid = valid &&
@@ -134,15 +130,15 @@ GpggaParser::parseASCII(const NMEASentence& sentence) noexcept(false)
     valid =
         valid && parsing_utilities::parseFloat(sentence.get_body()[8], msg->hdop);
     valid = valid && parsing_utilities::parseFloat(sentence.get_body()[9], msg->alt);
-    msg->altitude_units = sentence.get_body()[10];
+    msg->altitude_units = sentence.get_body()[10].to_string();
     valid = valid &&
             parsing_utilities::parseFloat(sentence.get_body()[11], msg->undulation);
-    msg->undulation_units = sentence.get_body()[12];
+    msg->undulation_units = sentence.get_body()[12].to_string();
     double diff_age_temp;
     valid = valid &&
             parsing_utilities::parseDouble(sentence.get_body()[13], diff_age_temp);
     msg->diff_age = static_cast<uint32_t>(round(diff_age_temp));
-    msg->station_id = sentence.get_body()[14];
+    msg->station_id = sentence.get_body()[14].to_string();
 
     if (!valid)
     {
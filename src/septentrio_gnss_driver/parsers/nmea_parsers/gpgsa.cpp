@@ -51,7 +51,8 @@ const std::string GpgsaParser::getMessageID() const
  * sentence.get_body()[18] if anybody ever needs it.
  */
 septentrio_gnss_driver::GpgsaPtr
-GpgsaParser::parseASCII(const NMEASentence& sentence) noexcept(false)
+GpgsaParser::parseASCII(const NMEASentence& sentence,
+                        const std::string& frame_id) noexcept(false)
 {
 
     // Checking the length first, it should be 19 elements
@@ -66,17 +67,16 @@ GpgsaParser::parseASCII(const NMEASentence& sentence) noexcept(false)
 
     septentrio_gnss_driver::GpgsaPtr msg =
         boost::make_shared<septentrio_gnss_driver::Gpgsa>();
-    msg->header.frame_id = g_frame_id;
-    msg->message_id = sentence.get_body()[0];
-    msg->auto_manual_mode = sentence.get_body()[1];
+    msg->header.frame_id = frame_id;
+    msg->message_id = sentence.get_body()[0].to_string();
+    msg->auto_manual_mode = sentence.get_body()[1].to_string();
     parsing_utilities::parseUInt8(sentence.get_body()[2], msg->fix_mode);
     // Words 3-14 of the sentence are SV PRNs. Copying only the non-null strings..
     // 0 is the character needed to fill the new character space, in case 12 (first
     // argument) is larger than sv_ids.
     msg->sv_ids.resize(12, 0);
     size_t n_svs = 0;
-    for (std::vector<std::string>::const_iterator id =
-             sentence.get_body().begin() + 3;
+    for (NMEASentence::Body::const_iterator id = sentence.get_body().begin() + 3;
          id < sentence.get_body().begin() + 15; ++id)
     {
         if (!id->empty())
@@ -51,7 +51,8 @@ const std::string GpgsvParser::getMessageID() const
  * message with 4 Svs it would be sentence.get_body()[20] if anybody ever needs it.
  */
 septentrio_gnss_driver::GpgsvPtr
-GpgsvParser::parseASCII(const NMEASentence& sentence) noexcept(false)
+GpgsvParser::parseASCII(const NMEASentence& sentence,
+                        const std::string& frame_id) noexcept(false)
 {
 
     const size_t MIN_LENGTH = 4;
@@ -65,8 +66,8 @@ GpgsvParser::parseASCII(const NMEASentence& sentence) noexcept(false)
     }
     septentrio_gnss_driver::GpgsvPtr msg =
         boost::make_shared<septentrio_gnss_driver::Gpgsv>();
-    msg->header.frame_id = g_frame_id;
-    msg->message_id = sentence.get_body()[0];
+    msg->header.frame_id = frame_id;
+    msg->message_id = sentence.get_body()[0].to_string();
     if (!parsing_utilities::parseUInt8(sentence.get_body()[1], msg->n_msgs))
     {
         throw ParseException("Error parsing n_msgs in GSV.");
@@ -55,7 +55,8 @@ const std::string GprmcParser::getMessageID() const
  * satellites. WasLastGPRMCValid() will return false in this case.
  */
 septentrio_gnss_driver::GprmcPtr
-GprmcParser::parseASCII(const NMEASentence& sentence) noexcept(false)
+GprmcParser::parseASCII(const NMEASentence& sentence,
+                        const std::string& frame_id) noexcept(false)
 {
 
     // Checking the length first, it should be between 13 and 14 elements
@@ -73,9 +74,9 @@ GprmcParser::parseASCII(const NMEASentence& sentence) noexcept(false)
     septentrio_gnss_driver::GprmcPtr msg =
         boost::make_shared<septentrio_gnss_driver::Gprmc>();
 
-    msg->header.frame_id = g_frame_id;
+    msg->header.frame_id = frame_id;
 
-    msg->message_id = sentence.get_body()[0];
+    msg->message_id = sentence.get_body()[0].to_string();
 
     if (sentence.get_body()[1].empty() || sentence.get_body()[1] == "0")
     {
@@ -89,15 +90,10 @@ GprmcParser::parseASCII(const NMEASentence& sentence) noexcept(false)
                 parsing_utilities::convertUTCDoubleToSeconds(utc_double);
             if (g_use_gnss_time)
             {
-                // The Header's Unix Epoch time stamp
-                time_t unix_time_seconds =
-                    parsing_utilities::convertUTCtoUnix(utc_double);
-                // The following assumes that there are two digits after the decimal
-                // point in utc_double, i.e. in the NMEA UTC time.
-                uint32_t unix_time_nanoseconds =
-                    (static_cast<uint32_t>(utc_double * 100) % 100) * 10000;
-                msg->header.stamp.sec = unix_time_seconds;
-                msg->header.stamp.nsec = unix_time_nanoseconds;
+                // The Header's Unix Epoch time stamp, including the fractional
+                // seconds of the NMEA UTC time
+                msg->header.stamp = parsing_utilities::convertUTCTimeOfDayToUnix(
+                    parsing_utilities::convertUTCDoubleToMilliseconds(utc_double));
             } else
             {
                 ros::Time time_obj;
@@ -116,7 +112,7 @@ GprmcParser::parseASCII(const NMEASentence& sentence) noexcept(false)
     bool valid = true;
     bool to_be_ignored = false;
 
-    msg->position_status = sentence.get_body()[2];
+    msg->position_status = sentence.get_body()[2].to_string();
     // Check to see whether this message should be ignored
     to_be_ignored &= !(sentence.get_body()[2].compare("A") ==
                        0); // 0 : if both strings are equal.
@@ -133,8 +129,8 @@ GprmcParser::parseASCII(const NMEASentence& sentence) noexcept(false)
         valid && parsing_utilities::parseDouble(sentence.get_body()[5], longitude);
     msg->lon = parsing_utilities::convertDMSToDegrees(longitude);
 
-    msg->lat_dir = sentence.get_body()[4];
-    msg->lon_dir = sentence.get_body()[6];
+    msg->lat_dir = sentence.get_body()[4].to_string();
+    msg->lon_dir = sentence.get_body()[6].to_string();
 
     valid =
         valid && parsing_utilities::parseFloat(sentence.get_body()[7], msg->speed);
@@ -143,18 +139,19 @@ GprmcParser::parseASCII(const NMEASentence& sentence) noexcept(false)
     valid =
         valid && parsing_utilities::parseFloat(sentence.get_body()[8], msg->track);
 
-    std::string date_str = sentence.get_body()[9];
+    boost::string_view date_str = sentence.get_body()[9];
     if (!date_str.empty())
     {
-        msg->date = std::string("20") + date_str.substr(4, 2) + std::string("-") +
-                    date_str.substr(2, 2) + std::string("-") + date_str.substr(0, 2);
+        msg->date = std::string("20") + date_str.substr(4, 2).to_string() +
+                    std::string("-") + date_str.substr(2, 2).to_string() +
+                    std::string("-") + date_str.substr(0, 2).to_string();
     }
     valid = valid &&
             parsing_utilities::parseFloat(sentence.get_body()[10], msg->mag_var);
-    msg->mag_var_direction = sentence.get_body()[11];
+    msg->mag_var_direction = sentence.get_body()[11].to_string();
     if (sentence.get_body().size() == LEN_MAX)
     {
-        msg->mode_indicator = sentence.get_body()[12];
+        msg->mode_indicator = sentence.get_body()[12].to_string();
     }
 
     if (!valid)
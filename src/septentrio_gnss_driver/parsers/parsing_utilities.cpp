@@ -62,7 +62,7 @@ namespace parsing_utilities {
      * exist within "string", and returns true if the latter two tests are negative
      * or when the string is empty, false otherwise.
      */
-    bool parseDouble(const std::string& string, double& value)
+    bool parseDouble(boost::string_view string, double& value)
     {
         return string_utilities::toDouble(string, value) || string.empty();
     }
@@ -87,7 +87,7 @@ namespace parsing_utilities {
      * exist within "string", and returns true if the latter two tests are negative
      * or when the string is empty, false otherwise.
      */
-    bool parseFloat(const std::string& string, float& value)
+    bool parseFloat(boost::string_view string, float& value)
     {
         return string_utilities::toFloat(string, value) || string.empty();
     }
@@ -111,7 +111,7 @@ namespace parsing_utilities {
      * exist within "string", and returns true if the latter two tests are negative
      * or when the string is empty, false otherwise.
      */
-    bool parseInt16(const std::string& string, int16_t& value, int32_t base)
+    bool parseInt16(boost::string_view string, int16_t& value, int32_t base)
     {
         value = 0;
         if (string.empty())
@@ -150,7 +150,7 @@ namespace parsing_utilities {
      * exist within "string", and returns true if the latter two tests are negative
      * or when the string is empty, false otherwise.
      */
-    bool parseInt32(const std::string& string, int32_t& value, int32_t base)
+    bool parseInt32(boost::string_view string, int32_t& value, int32_t base)
     {
         return string_utilities::toInt32(string, value, base) || string.empty();
     }
@@ -160,7 +160,7 @@ namespace parsing_utilities {
      * exist within "string", and returns true if the latter two tests are negative
      * or when the string is empty, false otherwise.
      */
-    bool parseUInt8(const std::string& string, uint8_t& value, int32_t base)
+    bool parseUInt8(boost::string_view string, uint8_t& value, int32_t base)
     {
         value = 0;
         if (string.empty())
@@ -198,7 +198,7 @@ namespace parsing_utilities {
      * exist within "string", and returns true if the latter two tests are negative
      * or when the string is empty, false otherwise.
      */
-    bool parseUInt16(const std::string& string, uint16_t& value, int32_t base)
+    bool parseUInt16(boost::string_view string, uint16_t& value, int32_t base)
     {
         value = 0;
         if (string.empty())
@@ -236,7 +236,7 @@ namespace parsing_utilities {
      * exist within "string", and returns true if the latter two tests are negative
      * or when the string is empty, false otherwise.
      */
-    bool parseUInt32(const std::string& string, uint32_t& value, int32_t base)
+    bool parseUInt32(boost::string_view string, uint32_t& value, int32_t base)
     {
         return string_utilities::toUInt32(string, value, base) || string.empty();
     }
@@ -321,6 +321,42 @@ namespace parsing_utilities {
         return date;
     }
 
+    ros::Time convertGPSWeekTOWToUnix(uint16_t wnc, uint32_t tow,
+                                      uint32_t leap_seconds)
+    {
+        int64_t unix_ms = (GPS_EPOCH_UNIX_SECONDS - static_cast<int64_t>(leap_seconds)) *
+                              1000 +
+                          static_cast<int64_t>(wnc) * MS_PER_WEEK +
+                          static_cast<int64_t>(tow);
+        return ros::Time(static_cast<uint32_t>(unix_ms / 1000),
+                         static_cast<uint32_t>(unix_ms % 1000) * 1000000);
+    }
+
+    int64_t convertUTCDoubleToMilliseconds(double utc_double)
+    {
+        int64_t hhmmss = static_cast<int64_t>(utc_double);
+        int64_t fraction_ms = std::llround((utc_double - hhmmss) * 1000.0);
+        return ((hhmmss / 10000) * 3600 + ((hhmmss / 100) % 100) * 60 +
+                hhmmss % 100) *
+                   1000 +
+               fraction_ms;
+    }
+
+    //! The host time is read via time(0) only to determine the current day; the
+    //! NMEA time of day is then placed on the day that brings it closest to the
+    //! host time, i.e. within +/- 12 hours.
+    ros::Time convertUTCTimeOfDayToUnix(int64_t ms_of_day)
+    {
+        int64_t now_ms = static_cast<int64_t>(time(0)) * 1000;
+        int64_t unix_ms = now_ms - now_ms % MS_PER_DAY + ms_of_day;
+        if (unix_ms - now_ms > MS_PER_DAY / 2)
+            unix_ms -= MS_PER_DAY;
+        else if (now_ms - unix_ms > MS_PER_DAY / 2)
+            unix_ms += MS_PER_DAY;
+        return ros::Time(static_cast<uint32_t>(unix_ms / 1000),
+                         static_cast<uint32_t>(unix_ms % 1000) * 1000000);
+    }
+
     //! The rotational sequence convention we adopt here (and Septentrio receivers'
     //! pitch, roll, yaw definition too) is the yaw-pitch-roll sequence, i.e. the
     //! 3-2-1 sequence: The body first does yaw around the Z=Down-axis, then pitches
@@ -41,25 +41,74 @@
  * @date 13/08/20
  */
 
+namespace {
+    //! Longest field that toDouble() and toFloat() convert, larger than any numeric
+    //! NMEA field
+    const std::size_t MAX_FLOAT_LENGTH = 63;
+
+    //! Converts "string" as a whole into an integer of the given base, without
+    //! requiring null-termination. Overflow beyond the int64_t range is rejected.
+    bool toInt64(boost::string_view string, int64_t& value, int32_t base)
+    {
+        if (string.empty() || base < 2 || base > 36)
+            return false;
+        std::size_t pos = 0;
+        bool negative = false;
+        if (string[0] == '+' || string[0] == '-')
+        {
+            negative = (string[0] == '-');
+            ++pos;
+        }
+        if (pos == string.size())
+            return false;
+        const int64_t limit = std::numeric_limits<int64_t>::max() / base;
+        int64_t value_new = 0;
+        for (; pos < string.size(); ++pos)
+        {
+            char c = string[pos];
+            int32_t digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'z')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'Z')
+                digit = c - 'A' + 10;
+            else
+                return false;
+            if (digit >= base || value_new > limit)
+                return false;
+            value_new = value_new * base + digit;
+            if (value_new < 0)
+                return false;
+        }
+        value = negative ? -value_new : value_new;
+        return true;
+    }
+} // namespace
+
 namespace string_utilities {
     /**
      * It checks whether an error occurred (via errno) and whether junk characters
      * exist within "string", and returns true if the latter two tests are negative
-     * and the string is non-empty, false otherwise.
+     * and the string is non-empty, false otherwise. The field is copied to the stack
+     * to null-terminate it for strtod, so no heap allocation takes place.
      */
-    bool toDouble(const std::string& string, double& value)
+    bool toDouble(boost::string_view string, double& value)
     {
-        if (string.empty())
+        if (string.empty() || string.size() > MAX_FLOAT_LENGTH)
         {
             return false;
         }
 
+        char buffer[MAX_FLOAT_LENGTH + 1];
+        string.copy(buffer, string.size());
+        buffer[string.size()] = '\0';
         char* end;
         errno = 0;
 
-        double value_new = std::strtod(string.c_str(), &end);
+        double value_new = std::strtod(buffer, &end);
 
-        if (errno != 0 || end != string.c_str() + string.length())
+        if (errno != 0 || end != buffer + string.size())
         {
             return false;
         }
@@ -73,18 +122,21 @@ namespace string_utilities {
      * exist within "string", and returns true if the latter two tests are negative
      * and the string is non-empty, false otherwise.
      */
-    bool toFloat(const std::string& string, float& value)
+    bool toFloat(boost::string_view string, float& value)
     {
-        if (string.empty())
+        if (string.empty() || string.size() > MAX_FLOAT_LENGTH)
         {
             return false;
         }
 
+        char buffer[MAX_FLOAT_LENGTH + 1];
+        string.copy(buffer, string.size());
+        buffer[string.size()] = '\0';
         char* end;
         errno = 0;
-        float value_new = std::strtof(string.c_str(), &end);
+        float value_new = std::strtof(buffer, &end);
 
-        if (errno != 0 || end != string.c_str() + string.length())
+        if (errno != 0 || end != buffer + string.size())
         {
             return false;
         }
@@ -94,22 +146,14 @@ namespace string_utilities {
     }
 
     /**
-     * It checks whether an error occurred (via errno) and whether junk characters
-     * exist within "string", and returns true if the latter two tests are negative
-     * and the string is non-empty, false otherwise.
+     * It returns true if "string" is non-empty and consists of an optional sign
+     * followed by digits of the given base only, and if the value fits into int32_t,
+     * false otherwise.
      */
-    bool toInt32(const std::string& string, int32_t& value, int32_t base)
+    bool toInt32(boost::string_view string, int32_t& value, int32_t base)
     {
-        if (string.empty())
-        {
-            return false;
-        }
-
-        char* end;
-        errno = 0;
-        int64_t value_new = std::strtol(string.c_str(), &end, base);
-
-        if (errno != 0 || end != string.c_str() + string.length())
+        int64_t value_new;
+        if (!toInt64(string, value_new, base))
         {
             return false;
         }
@@ -125,22 +169,14 @@ namespace string_utilities {
     }
 
     /**
-     * It checks whether an error occurred (via errno) and whether junk characters
-     * exist within "string", and returns true if the latter two tests are negative
-     * and the string is non-empty, false otherwise.
+     * It returns true if "string" is non-empty and consists of an optional sign
+     * followed by digits of the given base only, and if the value fits into
+     * uint32_t, false otherwise.
      */
-    bool toUInt32(const std::string& string, uint32_t& value, int32_t base)
+    bool toUInt32(boost::string_view string, uint32_t& value, int32_t base)
     {
-        if (string.empty())
-        {
-            return false;
-        }
-
-        char* end;
-        errno = 0;
-        int64_t value_new = std::strtol(string.c_str(), &end, base);
-
-        if (errno != 0 || end != string.c_str() + string.length())
+        int64_t value_new;
+        if (!toInt64(string, value_new, base))
         {
             return false;
         }
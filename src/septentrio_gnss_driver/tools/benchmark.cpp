@@ -0,0 +1,743 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h> // for getopt() and mkstemp()
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/communication_core.hpp>
+#include <septentrio_gnss_driver/communication/pcap_reader.hpp>
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+#include <septentrio_gnss_driver/crc/crc.h>
+
+#include "sbf_synthesis.hpp"
+
+/**
+ * @file benchmark.cpp
+ * @date 14/10/26
+ * @brief Times the CRC, framing and decoding stages and the whole file replay
+ *
+ * Runs without roscore. Usage: septentrio_gnss_driver_bench [-i iterations]
+ * [-t decode_threads] [corpus.sbf|corpus.pcap ...]
+ *
+ * Each corpus is framed once, then every stage is timed on the frames it applies
+ * to, at least "iterations" times. Without corpus files, a synthetic one is
+ * generated, see makeCorpus(). Nothing is published, as no topic is advertised.
+ */
+
+using namespace io_comm_rx;
+
+namespace {
+    typedef uint16_t (*CRCFunction)(const void*, size_t);
+
+    struct CRCImplementation
+    {
+        const char* name;
+        CRCFunction function;
+    };
+
+    //! Per-Rx decoder state, its defaults matching a single unnamed Rx
+    ReceiverContext context;
+
+    //! Block sizes to time the CRC on: PVTGeodetic, a MeasEpoch with 24 satellites
+    //! tracked on two signals each, a MeasEpoch with 72 satellites on three signals,
+    //! and the largest MeasEpoch the receiver can send
+    const size_t BLOCK_SIZES[] = {96, 20 + 24 * (20 + 1 * 12),
+                                  20 + 72 * (20 + 2 * 12), sizeof(MeasEpoch)};
+
+    //! Keys that read() decodes straight from their own frame; the other SBF
+    //! blocks only feed the composites
+    const RxID_Enum DECODED_KEYS[] = {
+        evGPGGA,         evGPRMC,        evGPGSA,      evGPGSV,
+        evGLGSV,         evGAGSV,        evGBGSV,      evPVTCartesian,
+        evPVTGeodetic,   evPosCovCartesian, evPosCovGeodetic, evAttEuler,
+        evAttCovEuler,   evGPST,         evReceiverSetup};
+
+    //! Satellites tracked in each epoch of the synthetic corpus
+    const uint8_t SYNTHETIC_SATELLITES = 24;
+    //! Epochs of the synthetic corpus, one minute at 10 Hz
+    const uint32_t SYNTHETIC_EPOCHS = 600;
+
+    /**
+     * @struct Corpus
+     * @brief The byte stream of an SBF/PCAP file, with the frames found in it
+     */
+    struct Corpus
+    {
+        std::string name;
+        //! File to replay, empty if the corpus is to be written to one first
+        std::string file;
+        bool pcap;
+        std::vector<uint8_t> bytes;
+        std::vector<Frame> frames;
+    };
+
+    /**
+     * @struct Composite
+     * @brief A composite ROS message as handed out by the EpochAssembler, with
+     * copies of its epoch's blocks
+     */
+    struct Composite
+    {
+        RxID_Enum key;
+        std::vector<uint8_t> primary;
+        BlockArena epoch;
+    };
+
+    /**
+     * @brief Generates a deterministic stream resembling a 10 Hz rover output
+     *
+     * Every epoch holds all SBF blocks the driver decodes, with
+     * SYNTHETIC_SATELLITES satellites in MeasEpoch and ChannelStatus, followed by
+     * GGA, RMC, GSA and GSV sentences. ReceiverSetup is sent once up front, as by
+     * the receiver.
+     */
+    void makeCorpus(Corpus& corpus)
+    {
+        corpus.name = "synthetic";
+        corpus.pcap = false;
+        std::vector<uint8_t>& bytes = corpus.bytes;
+        const uint16_t wnc = 2200;
+        ReceiverSetup setup = emptyBlock<ReceiverSetup>();
+        strncpy(setup.rx_name, "mosaic-X5", sizeof(setup.rx_name));
+        appendBlock(bytes, setup, 5902, 100000, wnc);
+        for (uint32_t i = 0; i < SYNTHETIC_EPOCHS; ++i)
+        {
+            const uint32_t tow = 100000 + 100 * i;
+            PVTCartesian pvtcartesian = emptyBlock<PVTCartesian>();
+            pvtcartesian.mode = 4;
+            pvtcartesian.x = 4027894.0;
+            pvtcartesian.y = 307045.6;
+            pvtcartesian.z = 4919474.9;
+            pvtcartesian.nr_sv = SYNTHETIC_SATELLITES;
+            appendBlock(bytes, pvtcartesian, 4006, tow, wnc);
+            PVTGeodetic pvtgeodetic = emptyBlock<PVTGeodetic>();
+            pvtgeodetic.mode = 4;
+            pvtgeodetic.latitude = 0.8;
+            pvtgeodetic.longitude = 0.07;
+            pvtgeodetic.height = 100.0;
+            pvtgeodetic.nr_sv = SYNTHETIC_SATELLITES;
+            appendBlock(bytes, pvtgeodetic, 4007, tow, wnc);
+            PosCovCartesian poscovcartesian = emptyBlock<PosCovCartesian>();
+            poscovcartesian.cov_xx = 0.01f;
+            poscovcartesian.cov_yy = 0.01f;
+            poscovcartesian.cov_zz = 0.04f;
+            appendBlock(bytes, poscovcartesian, 5905, tow, wnc);
+            PosCovGeodetic poscovgeodetic = emptyBlock<PosCovGeodetic>();
+            poscovgeodetic.cov_latlat = 0.01f;
+            poscovgeodetic.cov_lonlon = 0.01f;
+            poscovgeodetic.cov_hgthgt = 0.04f;
+            appendBlock(bytes, poscovgeodetic, 5906, tow, wnc);
+            AttEuler atteuler = emptyBlock<AttEuler>();
+            atteuler.heading = 90.0f;
+            appendBlock(bytes, atteuler, 5938, tow, wnc);
+            appendBlock(bytes, emptyBlock<AttCovEuler>(), 5939, tow, wnc);
+            appendBlock(bytes, emptyBlock<DOP>(), 4001, tow, wnc);
+            appendBlock(bytes, emptyBlock<VelCovGeodetic>(), 5908, tow, wnc);
+
+            // MeasEpoch and ChannelStatus, one sub-block pair per satellite
+            std::vector<uint8_t> measepoch(BlockTraits<MeasEpoch>::FIXED_SIZE, 0);
+            measepoch[offsetof(MeasEpoch, n)] = SYNTHETIC_SATELLITES;
+            measepoch[offsetof(MeasEpoch, sb1_size)] = sizeof(MeasEpochChannelType1);
+            measepoch[offsetof(MeasEpoch, sb2_size)] = sizeof(MeasEpochChannelType2);
+            std::vector<uint8_t> channelstatus(
+                BlockTraits<ChannelStatus>::FIXED_SIZE, 0);
+            channelstatus[offsetof(ChannelStatus, n)] = SYNTHETIC_SATELLITES;
+            channelstatus[offsetof(ChannelStatus, sb1_size)] =
+                sizeof(ChannelSatInfo);
+            channelstatus[offsetof(ChannelStatus, sb2_size)] =
+                sizeof(ChannelStateInfo);
+            for (uint8_t sv = 1; sv <= SYNTHETIC_SATELLITES; ++sv)
+            {
+                MeasEpochChannelType1 type1 = emptyBlock<MeasEpochChannelType1>();
+                type1.sv_id = sv;
+                type1.cn0 = 180;
+                type1.n_type2 = 1;
+                appendBytes(measepoch, type1);
+                appendBytes(measepoch, emptyBlock<MeasEpochChannelType2>());
+                ChannelSatInfo sat_info = emptyBlock<ChannelSatInfo>();
+                sat_info.sv_id = sv;
+                sat_info.az_rise_set = static_cast<uint16_t>(15 * sv);
+                sat_info.elev = 45;
+                sat_info.n2 = 1;
+                appendBytes(channelstatus, sat_info);
+                ChannelStateInfo state_info = emptyBlock<ChannelStateInfo>();
+                state_info.pvt_status = 2;
+                appendBytes(channelstatus, state_info);
+            }
+            appendBlock(bytes, measepoch, 4027, tow, wnc);
+            appendBlock(bytes, channelstatus, 4013, tow, wnc);
+
+            ReceiverStatus receiverstatus = emptyBlock<ReceiverStatus>();
+            receiverstatus.cpu_load = 30;
+            appendBlock(bytes, receiverstatus, 4014, tow, wnc);
+            QualityInd qualityind = emptyBlock<QualityInd>();
+            qualityind.n = 2;
+            qualityind.indicators[0] = (10 << 8) | 0;
+            qualityind.indicators[1] = (9 << 8) | 1;
+            appendBlock(bytes, qualityind, 4082, tow, wnc);
+
+            appendSentence(bytes, "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,"
+                                  "545.4,M,46.9,M,,");
+            appendSentence(bytes, "GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,"
+                                  "084.4,230394,003.1,W");
+            appendSentence(bytes, "GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1");
+            appendSentence(bytes, "GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,"
+                                  "344,39,14,22,228,45");
+            appendSentence(bytes, "GLGSV,1,1,04,65,40,083,46,66,17,308,41,72,07,"
+                                  "344,39,81,22,228,45");
+        }
+    }
+
+    //! Reads an SBF file as it is, or the TCP stream reassembled from a PCAP file
+    bool loadCorpus(Corpus& corpus)
+    {
+        corpus.name = corpus.file;
+        if (!corpus.pcap)
+        {
+            std::ifstream file(corpus.file, std::ios::binary);
+            if (!file.good())
+                return false;
+            corpus.bytes.assign(std::istreambuf_iterator<char>(file),
+                                std::istreambuf_iterator<char>());
+            return true;
+        }
+        pcapReader::PcapDevice device(corpus.bytes);
+        if (!device.connect(corpus.file.c_str()))
+            return false;
+        while (device.isConnected() && device.read() == pcapReader::READ_SUCCESS)
+            ;
+        device.disconnect();
+        return true;
+    }
+
+    //! Frames the corpus once, all further stages work on the frames found
+    void frameCorpus(Corpus& corpus)
+    {
+        Framer framer;
+        Frame frame;
+        std::size_t pos = 0;
+        while (pos < corpus.bytes.size())
+        {
+            FramerResult_Enum result = framer.next(
+                corpus.bytes.data() + pos, corpus.bytes.size() - pos, frame);
+            if (result == evFrameNeedMore)
+                break;
+            if (result == evFrameResync)
+            {
+                pos += frame.offset + 1;
+                continue;
+            }
+            frame.offset += pos;
+            pos = frame.offset + frame.size;
+            corpus.frames.push_back(frame);
+        }
+    }
+
+    //! Number of passes over "count" items needed for "iterations" items in total
+    std::size_t passes(std::size_t iterations, std::size_t count)
+    {
+        if (count == 0)
+            return 0;
+        return std::max<std::size_t>(1, (iterations + count - 1) / count);
+    }
+
+    //! Prints one line of results, bytes/s are left out if "bytes" is 0
+    void report(const std::string& name, std::size_t blocks, std::size_t bytes,
+                double seconds, std::size_t failures = 0)
+    {
+        char rate[32] = "-";
+        if (bytes > 0)
+            snprintf(rate, sizeof(rate), "%.1f", bytes / seconds / 1e6);
+        printf("%-30s %10zu %14.0f %10s %10.1f", name.c_str(), blocks,
+               blocks / seconds, rate, seconds * 1e9 / blocks);
+        if (failures > 0)
+            printf("  (%zu failed)", failures);
+        printf("\n");
+    }
+
+    void printHeader(const char* section)
+    {
+        printf("\n%s\n%-30s %10s %14s %10s %10s\n", section, "case", "blocks",
+               "blocks/s", "MB/s", "ns/block");
+    }
+
+    //! Seconds elapsed since "start"
+    double since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+            .count();
+    }
+
+    //! Times every CRC-16-CCITT variant against the bytewise reference
+    bool benchmarkCRC(std::size_t iterations)
+    {
+        const CRCImplementation implementations[] = {
+            {"bytewise", compute16CCITTBytewise},
+            {"slice-by-8", compute16CCITTSlice8},
+            {"clmul", compute16CCITTClmul},
+            {"dispatch", compute16CCITT}};
+
+        printHeader(crc16ClmulAvailable() ? "CRC-16-CCITT (PCLMULQDQ available)"
+                                          : "CRC-16-CCITT (PCLMULQDQ unavailable)");
+        std::vector<uint8_t> corpus;
+        srand(1);
+        for (size_t length : BLOCK_SIZES)
+        {
+            std::vector<uint8_t> block(length);
+            for (size_t i = 0; i < length; ++i)
+                block[i] = static_cast<uint8_t>(rand());
+            corpus.clear();
+            appendBlock(corpus, block, 4027, 100000, 2200);
+            const uint16_t reference =
+                compute16CCITTBytewise(corpus.data() + 4, corpus.size() - 4);
+            for (const CRCImplementation& implementation : implementations)
+            {
+                uint16_t crc =
+                    implementation.function(corpus.data() + 4, corpus.size() - 4);
+                if (crc != reference || !isValid(corpus.data()))
+                {
+                    fprintf(stderr,
+                            "%s disagrees with the bytewise CRC for %zu bytes\n",
+                            implementation.name, corpus.size());
+                    return false;
+                }
+                // Accumulate the results so the calls cannot be optimized away
+                volatile uint32_t sink = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < iterations; ++i)
+                    sink += implementation.function(corpus.data() + 4,
+                                                    corpus.size() - 4);
+                report(std::string(implementation.name) + "/" +
+                           std::to_string(corpus.size()),
+                       iterations, iterations * corpus.size(), since(start));
+            }
+        }
+        return true;
+    }
+
+    //! Frames all of "bytes", returns the number of frames; "calls" counts the
+    //! calls of Framer::next()
+    std::size_t frameAll(const std::vector<uint8_t>& bytes, std::size_t& calls)
+    {
+        Framer framer;
+        Frame frame;
+        std::size_t frames = 0;
+        std::size_t pos = 0;
+        while (pos < bytes.size())
+        {
+            ++calls;
+            FramerResult_Enum result =
+                framer.next(bytes.data() + pos, bytes.size() - pos, frame);
+            if (result == evFrameNeedMore)
+                break;
+            if (result == evFrameResync)
+            {
+                pos += frame.offset + 1;
+                continue;
+            }
+            pos += frame.offset + frame.size;
+            ++frames;
+        }
+        return frames;
+    }
+
+    //! Times the Framer and the legacy RxMessage::search() over the whole corpus,
+    //! and isValid() on its SBF blocks
+    void benchmarkFraming(const Corpus& corpus, std::size_t iterations,
+                          const PublisherRegistry& publishers)
+    {
+        const std::size_t frame_passes = passes(iterations, corpus.frames.size());
+        std::size_t frames = 0;
+        std::size_t calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t pass = 0; pass < frame_passes; ++pass)
+            frames += frameAll(corpus.bytes, calls);
+        report("Framer::next", frames, frame_passes * corpus.bytes.size(),
+               since(start));
+
+        // Resyncing through a garbled burst as long as the corpus, whose '$' are
+        // never followed by the second byte of a header, hence skipped in a
+        // single call
+        std::vector<uint8_t> garbage(corpus.bytes.size());
+        std::mt19937 random(42);
+        for (std::size_t i = 0; i < garbage.size(); ++i)
+        {
+            garbage[i] = static_cast<uint8_t>(random());
+            if (i > 0 && garbage[i - 1] == SBF_SYNC_BYTE_1 &&
+                SyncScanner::classify(garbage[i]) != evNoSync)
+                garbage[i] = 0;
+        }
+        calls = 0;
+        start = std::chrono::steady_clock::now();
+        for (std::size_t pass = 0; pass < frame_passes; ++pass)
+            frameAll(garbage, calls);
+        report("Framer::next, garbage", calls, frame_passes * garbage.size(),
+               since(start));
+
+        std::size_t headers = 0;
+        start = std::chrono::steady_clock::now();
+        for (std::size_t pass = 0; pass < frame_passes; ++pass)
+        {
+            std::size_t size = corpus.bytes.size();
+            RxMessage rx_message(corpus.bytes.data(), size, publishers, context);
+            while (true)
+            {
+                rx_message.search();
+                if (rx_message.getCount() == 0)
+                    break;
+                ++headers;
+            }
+        }
+        report("RxMessage::search", headers, frame_passes * corpus.bytes.size(),
+               since(start));
+
+        std::vector<const Frame*> blocks;
+        std::size_t block_bytes = 0;
+        for (const Frame& frame : corpus.frames)
+        {
+            if (frame.type == evSBFFrame)
+            {
+                blocks.push_back(&frame);
+                block_bytes += frame.size;
+            }
+        }
+        const std::size_t crc_passes = passes(iterations, blocks.size());
+        std::size_t failures = 0;
+        start = std::chrono::steady_clock::now();
+        for (std::size_t pass = 0; pass < crc_passes; ++pass)
+        {
+            for (const Frame* frame : blocks)
+            {
+                if (!isValid(corpus.bytes.data() + frame->offset))
+                    ++failures;
+            }
+        }
+        if (!blocks.empty())
+            report("isValid", crc_passes * blocks.size(), crc_passes * block_bytes,
+                   since(start), failures);
+    }
+
+    //! Decodes "frames" as "key" once, returns the number of failures
+    std::size_t decodeFrames(RxID_Enum key, const std::vector<uint8_t>& bytes,
+                             const std::vector<const Frame*>& frames,
+                             const PublisherRegistry& publishers)
+    {
+        std::size_t failures = 0;
+        for (const Frame* frame : frames)
+        {
+            std::size_t size = frame->size;
+            RxMessage rx_message(bytes.data() + frame->offset, size, publishers,
+                                 context);
+            try
+            {
+                if (!rx_message.read(key))
+                    ++failures;
+            } catch (std::runtime_error& e)
+            {
+                ++failures;
+            }
+        }
+        return failures;
+    }
+
+    //! Times read() on the frames of "key", the NMEA parsers included
+    void benchmarkDecode(RxID_Enum key, const std::vector<uint8_t>& bytes,
+                         const std::vector<const Frame*>& frames,
+                         std::size_t iterations, const PublisherRegistry& publishers)
+    {
+        if (frames.empty())
+            return;
+        std::size_t bytes_per_pass = 0;
+        for (const Frame* frame : frames)
+            bytes_per_pass += frame->size;
+        const std::size_t decode_passes = passes(iterations, frames.size());
+        // One untimed pass to warm up the message pools
+        decodeFrames(key, bytes, frames, publishers);
+        std::size_t failures = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t pass = 0; pass < decode_passes; ++pass)
+            failures += decodeFrames(key, bytes, frames, publishers);
+        report(std::string("read/") + PipelineStatistics::keyName(key),
+               decode_passes * frames.size(),
+               decode_passes * bytes_per_pass, since(start), failures);
+    }
+
+    //! Collects the composites of the corpus as the EpochAssembler hands them out
+    std::vector<Composite> assembleComposites(const Corpus& corpus,
+                                              const PublisherRegistry& publishers)
+    {
+        const uint32_t enabled =
+            EpochAssembler::compositeBit(evNavSatFix) |
+            EpochAssembler::compositeBit(evGPSFix) |
+            EpochAssembler::compositeBit(evPoseWithCovarianceStamped) |
+            EpochAssembler::compositeBit(evDiagnosticArray);
+        EpochAssembler assembler;
+        std::vector<Composite> composites;
+        auto collect = [&]() {
+            EpochAssembler::Due due;
+            while (assembler.next(enabled, due))
+            {
+                Composite composite;
+                composite.key = due.composite;
+                composite.primary.assign(due.primary,
+                                         due.primary + due.primary_size);
+                composite.epoch = due.slot->blocks;
+                composites.push_back(composite);
+            }
+        };
+        for (const Frame& frame : corpus.frames)
+        {
+            if (frame.type != evSBFFrame)
+                continue;
+            const uint8_t* data = corpus.bytes.data() + frame.offset;
+            std::size_t size = frame.size;
+            RxMessage rx_message(data, size, publishers, context);
+            while (!assembler.add(data, size, rx_message.rxID(), enabled))
+                collect();
+            collect();
+        }
+        assembler.expireAll();
+        collect();
+        return composites;
+    }
+
+    //! Times read() on the composites, GPSFixCallback() and its siblings, built
+    //! from the retained blocks of their epochs
+    void benchmarkComposites(const Corpus& corpus, std::size_t iterations,
+                             const PublisherRegistry& publishers)
+    {
+        const std::vector<Composite> composites =
+            assembleComposites(corpus, publishers);
+        const RxID_Enum keys[] = {evNavSatFix, evGPSFix, evPoseWithCovarianceStamped,
+                                  evDiagnosticArray};
+        for (RxID_Enum key : keys)
+        {
+            std::vector<const Composite*> selected;
+            for (const Composite& composite : composites)
+            {
+                if (composite.key == key)
+                    selected.push_back(&composite);
+            }
+            if (selected.empty())
+                continue;
+            auto decode = [&]() {
+                std::size_t failures = 0;
+                for (const Composite* composite : selected)
+                {
+                    std::size_t size = composite->primary.size();
+                    RxMessage rx_message(composite->primary.data(), size, publishers,
+                                         context, &composite->epoch);
+                    try
+                    {
+                        if (!rx_message.read(key))
+                            ++failures;
+                    } catch (std::runtime_error& e)
+                    {
+                        ++failures;
+                    }
+                }
+                return failures;
+            };
+            const std::size_t decode_passes = passes(iterations, selected.size());
+            // One untimed pass to warm up the message pools
+            decode();
+            std::size_t failures = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t pass = 0; pass < decode_passes; ++pass)
+                failures += decode();
+            report(std::string("read/") + PipelineStatistics::keyName(key),
+                   decode_passes * selected.size(), 0, since(start), failures);
+        }
+    }
+
+    //! Times timestampSBF() with the GNSS time and with the current time
+    void benchmarkTimestamp(std::size_t iterations)
+    {
+        printHeader("Time stamping");
+        for (bool use_gnss : {true, false})
+        {
+            volatile uint32_t sink = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                const uint32_t tow = static_cast<uint32_t>((100 * i) % 604800000);
+                sink += timestampSBF(tow, 2200, use_gnss).nsec;
+            }
+            report(use_gnss ? "timestampSBF/gnss" : "timestampSBF/now", iterations,
+                   0, since(start));
+        }
+    }
+
+    /**
+     * @brief Times the replay of the corpus file as fast as possible, with a
+     * handler for every key, from mapping the file to the last composite
+     *
+     * The synthetic corpus is written to a temporary file first.
+     */
+    bool benchmarkReplay(const Corpus& corpus, std::size_t iterations)
+    {
+        std::string file = corpus.file;
+        if (file.empty())
+        {
+            char name[] = "/tmp/septentrio_gnss_driver_bench_XXXXXX";
+            const int fd = mkstemp(name);
+            if (fd < 0 || write(fd, corpus.bytes.data(), corpus.bytes.size()) !=
+                              static_cast<ssize_t>(corpus.bytes.size()))
+            {
+                fprintf(stderr, "Could not write the synthetic corpus to %s\n",
+                        name);
+                return false;
+            }
+            close(fd);
+            file = name;
+        }
+        g_read_from_sbf_log = !corpus.pcap;
+        g_read_from_pcap = corpus.pcap;
+        g_replay_rate = 0;
+        const std::size_t replay_passes = passes(iterations, corpus.frames.size());
+        double seconds = 0;
+        for (std::size_t pass = 0; pass < replay_passes; ++pass)
+        {
+            Comm_IO io;
+            // The message type only sizes the handler's unused placeholder
+            for (int key = 0; key < evUnknownMessage; ++key)
+                io.handlers_.insert<int32_t>(static_cast<RxID_Enum>(key));
+            auto start = std::chrono::steady_clock::now();
+            if (corpus.pcap)
+                io.initializePCAPFileReading(file, pcapReader::DEFAULT_FILTER);
+            else
+                io.initializeSBFFileReading(file);
+            seconds += since(start);
+        }
+        if (corpus.file.empty())
+            unlink(file.c_str());
+        report(std::string("replay, ") + std::to_string(g_decode_threads) +
+                   " decode threads",
+               replay_passes * corpus.frames.size(),
+               replay_passes * corpus.bytes.size(), seconds);
+        return true;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::size_t iterations = 20000;
+    int option;
+    while ((option = getopt(argc, argv, "i:t:")) != -1)
+    {
+        switch (option)
+        {
+        case 'i':
+            iterations = strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            g_decode_threads = static_cast<uint32_t>(strtoul(optarg, NULL, 10));
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-i iterations] [-t decode_threads] "
+                            "[corpus.sbf|corpus.pcap ...]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    // No node is started, ros::Time::now() runs on the wall clock
+    ros::Time::init();
+    g_use_gnss_time = true;
+    g_leap_seconds = 18;
+
+    std::vector<Corpus> corpora;
+    for (int i = optind; i < argc; ++i)
+    {
+        Corpus corpus;
+        corpus.file = argv[i];
+        corpus.pcap = corpus.file.size() > 5 &&
+                      corpus.file.compare(corpus.file.size() - 5, 5, ".pcap") == 0;
+        if (!loadCorpus(corpus))
+        {
+            fprintf(stderr, "Could not read %s\n", argv[i]);
+            return 1;
+        }
+        corpora.push_back(corpus);
+    }
+    if (corpora.empty())
+    {
+        corpora.push_back(Corpus());
+        makeCorpus(corpora.back());
+    }
+
+    if (!benchmarkCRC(iterations))
+        return 1;
+    benchmarkTimestamp(iterations);
+
+    // Nothing is advertised, such that decoded messages are dropped
+    const PublisherRegistry publishers;
+    for (Corpus& corpus : corpora)
+    {
+        frameCorpus(corpus);
+        printf("\nCorpus %s: %zu bytes, %zu frames\n", corpus.name.c_str(),
+               corpus.bytes.size(), corpus.frames.size());
+        printHeader("Framing");
+        benchmarkFraming(corpus, iterations, publishers);
+
+        printHeader("Decoding");
+        std::vector<std::vector<const Frame*>> frames_by_key(evRxIDCount);
+        for (const Frame& frame : corpus.frames)
+        {
+            std::size_t size = frame.size;
+            RxMessage rx_message(corpus.bytes.data() + frame.offset, size,
+                                 publishers, context);
+            frames_by_key[rx_message.rxID()].push_back(&frame);
+        }
+        // The GPST time reference is decoded from PVTGeodetic
+        frames_by_key[evGPST] = frames_by_key[evPVTGeodetic];
+        for (RxID_Enum key : DECODED_KEYS)
+            benchmarkDecode(key, corpus.bytes, frames_by_key[key], iterations,
+                            publishers);
+
+        printHeader("Composites");
+        benchmarkComposites(corpus, iterations, publishers);
+
+        printHeader("Replay");
+        if (!benchmarkReplay(corpus, iterations))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,709 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pty.h>     // for openpty()
+#include <termios.h> // for cfmakeraw()
+#include <unistd.h>  // for getopt()
+// Boost includes
+#include <boost/asio.hpp>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/communication_core.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+#include "sbf_synthesis.hpp"
+
+/**
+ * @file load_generator.cpp
+ * @date 15/10/26
+ * @brief Serves a synthetic Rx stream at high rates to the driver's own I/O and
+ * decode path and reports latencies and drops, without a ROS master
+ *
+ * Usage: septentrio_gnss_driver_loadgen [-r rate_hz] [-s satellites] [-g signals]
+ * [-b burst] [-x corruption] [-n] [-R reply_period] [-d seconds] [-p]
+ * [-t decode_threads]
+ *
+ * Every epoch holds all SBF blocks the driver decodes, MeasEpoch and
+ * ChannelStatus with "satellites" satellites on each of GPS, GLONASS, Galileo and
+ * BeiDou, tracked on "signals" signals. With -n, GGA, RMC, GSA and GSV sentences
+ * follow, and every "reply_period" epochs a command reply as the Rx sends them.
+ * Epochs are written "burst" at a time to a loopback TCP connection or, with -p,
+ * to a pseudo terminal, which a Comm_IO connects to as it would to an Rx. A
+ * "corruption" share of the messages have one byte flipped.
+ *
+ * Nothing is advertised. The messages the driver would publish are counted by a
+ * MessageSink instead, their latency being taken from the time their epoch was
+ * due to be sent, such that queueing anywhere on the way, the socket included,
+ * shows up. The pipeline statistics of the AsyncManager and decode workers, e.g.
+ * buffer overflows and decode queue drops, are printed as well.
+ */
+
+using namespace io_comm_rx;
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    //! GPS week and TOW in ms of the first epoch
+    const uint16_t FIRST_WNC = 2200;
+    const uint32_t FIRST_TOW = 100000;
+    //! First SVID of GPS, GLONASS, Galileo and BeiDou in SBF numbering
+    const uint8_t FIRST_SVIDS[] = {1, 38, 71, 141};
+    //! Number of constellations the satellites are spread over
+    const std::size_t CONSTELLATIONS = sizeof(FIRST_SVIDS) / sizeof(FIRST_SVIDS[0]);
+    //! Send times are kept for that many epochs, far more than can be in flight
+    const std::size_t SEND_TIME_SLOTS = 1 << 16;
+    //! Time given to the driver to process what is in flight once all is sent
+    const std::chrono::seconds DRAIN_TIME(1);
+    //! Time given to the driver to connect
+    const std::chrono::seconds CONNECT_TIMEOUT(10);
+    //! Reply of the Rx to a command, as sent while configuring it
+    const char COMMAND_REPLY[] =
+        "$R: setSBFOutput, Stream1, COM1, PVTGeodetic\r\n"
+        "  SBFOutput, Stream1, COM1, PVTGeodetic, msec10\r\n"
+        "COM1>";
+
+    /**
+     * @struct Settings
+     * @brief The command line options
+     */
+    struct Settings
+    {
+        Settings() :
+            rate_hz(100.0), satellites(12), signals(3), burst(1), corruption(0.0),
+            nmea(false), reply_period(0), duration_s(10.0), pty(false)
+        {
+        }
+        double rate_hz;
+        uint32_t satellites;
+        uint32_t signals;
+        uint32_t burst;
+        double corruption;
+        bool nmea;
+        uint32_t reply_period;
+        double duration_s;
+        bool pty;
+    };
+
+    void printUsage(const char* program)
+    {
+        fprintf(stderr,
+                "Usage: %s [-r rate_hz] [-s satellites] [-g signals] [-b burst] "
+                "[-x corruption] [-n] [-R reply_period] [-d seconds] [-p] "
+                "[-t decode_threads]\n",
+                program);
+    }
+
+    //! Whether the messages of "key" are time stamped by the Rx, such that their
+    //! epoch, hence their latency, is known
+    bool timed(RxID_Enum key)
+    {
+        switch (key)
+        {
+        case evPVTCartesian:
+        case evPVTGeodetic:
+        case evPosCovCartesian:
+        case evPosCovGeodetic:
+        case evAttEuler:
+        case evAttCovEuler:
+        case evGPST:
+        case evNavSatFix:
+        case evGPSFix:
+        case evPoseWithCovarianceStamped:
+        case evDiagnosticArray:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @class Synthesizer
+     * @brief Generates the byte stream of the Rx epoch by epoch
+     *
+     * The blocks are laid out once, each epoch only stamps and checksums them.
+     */
+    class Synthesizer
+    {
+    public:
+        Synthesizer(const Settings& settings, uint32_t period_ms) :
+            settings_(settings), period_ms_(period_ms), random_(42),
+            corruption_(settings.corruption), messages_(0), corrupted_(0),
+            sent_()
+        {
+            const uint8_t satellites =
+                static_cast<uint8_t>(settings.satellites * CONSTELLATIONS);
+            PVTCartesian pvtcartesian = emptyBlock<PVTCartesian>();
+            pvtcartesian.mode = 4;
+            pvtcartesian.x = 4027894.0;
+            pvtcartesian.y = 307045.6;
+            pvtcartesian.z = 4919474.9;
+            pvtcartesian.nr_sv = satellites;
+            addBlock(pvtcartesian, 4006, evPVTCartesian);
+            PVTGeodetic pvtgeodetic = emptyBlock<PVTGeodetic>();
+            pvtgeodetic.mode = 4;
+            pvtgeodetic.latitude = 0.8;
+            pvtgeodetic.longitude = 0.07;
+            pvtgeodetic.height = 100.0;
+            pvtgeodetic.nr_sv = satellites;
+            addBlock(pvtgeodetic, 4007, evPVTGeodetic);
+            PosCovCartesian poscovcartesian = emptyBlock<PosCovCartesian>();
+            poscovcartesian.cov_xx = 0.01f;
+            poscovcartesian.cov_yy = 0.01f;
+            poscovcartesian.cov_zz = 0.04f;
+            addBlock(poscovcartesian, 5905, evPosCovCartesian);
+            PosCovGeodetic poscovgeodetic = emptyBlock<PosCovGeodetic>();
+            poscovgeodetic.cov_latlat = 0.01f;
+            poscovgeodetic.cov_lonlon = 0.01f;
+            poscovgeodetic.cov_hgthgt = 0.04f;
+            addBlock(poscovgeodetic, 5906, evPosCovGeodetic);
+            AttEuler atteuler = emptyBlock<AttEuler>();
+            atteuler.heading = 90.0f;
+            addBlock(atteuler, 5938, evAttEuler);
+            addBlock(emptyBlock<AttCovEuler>(), 5939, evAttCovEuler);
+            addBlock(emptyBlock<DOP>(), 4001, evDOP);
+            addBlock(emptyBlock<VelCovGeodetic>(), 5908, evVelCovGeodetic);
+
+            // MeasEpoch and ChannelStatus, one sub-block set per satellite
+            std::vector<uint8_t> measepoch(BlockTraits<MeasEpoch>::FIXED_SIZE, 0);
+            measepoch[offsetof(MeasEpoch, n)] = satellites;
+            measepoch[offsetof(MeasEpoch, sb1_size)] = sizeof(MeasEpochChannelType1);
+            measepoch[offsetof(MeasEpoch, sb2_size)] = sizeof(MeasEpochChannelType2);
+            std::vector<uint8_t> channelstatus(
+                BlockTraits<ChannelStatus>::FIXED_SIZE, 0);
+            channelstatus[offsetof(ChannelStatus, n)] = satellites;
+            channelstatus[offsetof(ChannelStatus, sb1_size)] =
+                sizeof(ChannelSatInfo);
+            channelstatus[offsetof(ChannelStatus, sb2_size)] =
+                sizeof(ChannelStateInfo);
+            for (std::size_t constellation = 0; constellation < CONSTELLATIONS;
+                 ++constellation)
+            {
+                for (uint32_t i = 0; i < settings.satellites; ++i)
+                {
+                    const uint8_t sv =
+                        static_cast<uint8_t>(FIRST_SVIDS[constellation] + i);
+                    MeasEpochChannelType1 type1 =
+                        emptyBlock<MeasEpochChannelType1>();
+                    type1.sv_id = sv;
+                    type1.cn0 = 180;
+                    type1.n_type2 = static_cast<uint8_t>(settings.signals - 1);
+                    appendBytes(measepoch, type1);
+                    for (uint32_t signal = 1; signal < settings.signals; ++signal)
+                        appendBytes(measepoch, emptyBlock<MeasEpochChannelType2>());
+                    ChannelSatInfo sat_info = emptyBlock<ChannelSatInfo>();
+                    sat_info.sv_id = sv;
+                    sat_info.az_rise_set = static_cast<uint16_t>(15 * i);
+                    sat_info.elev = 45;
+                    sat_info.n2 = 1;
+                    appendBytes(channelstatus, sat_info);
+                    ChannelStateInfo state_info = emptyBlock<ChannelStateInfo>();
+                    state_info.pvt_status = 2;
+                    appendBytes(channelstatus, state_info);
+                }
+            }
+            blocks_.push_back(Block{4027, evMeasEpoch, measepoch});
+            blocks_.push_back(Block{4013, evChannelStatus, channelstatus});
+
+            ReceiverStatus receiverstatus = emptyBlock<ReceiverStatus>();
+            receiverstatus.cpu_load = 30;
+            addBlock(receiverstatus, 4014, evReceiverStatus);
+            QualityInd qualityind = emptyBlock<QualityInd>();
+            qualityind.n = 2;
+            qualityind.indicators[0] = (10 << 8) | 0;
+            qualityind.indicators[1] = (9 << 8) | 1;
+            addBlock(qualityind, 4082, evQualityInd);
+
+            ReceiverSetup setup = emptyBlock<ReceiverSetup>();
+            strncpy(setup.rx_name, "mosaic-X5", sizeof(setup.rx_name));
+            appendBytes(setup_, setup);
+        }
+
+        //! Appends the messages of epoch "epoch" to "bytes"
+        void appendEpoch(std::vector<uint8_t>& bytes, uint64_t epoch)
+        {
+            const uint64_t time = FIRST_TOW + epoch * period_ms_;
+            const uint32_t tow = static_cast<uint32_t>(
+                time % static_cast<uint64_t>(parsing_utilities::MS_PER_WEEK));
+            const uint16_t wnc = static_cast<uint16_t>(
+                FIRST_WNC + time / parsing_utilities::MS_PER_WEEK);
+            // ReceiverSetup is sent once per second, as the Rx sends it on change
+            // only and a stream may be joined at any time
+            const uint64_t setup_period =
+                std::max<uint64_t>(1000 / period_ms_, static_cast<uint64_t>(1));
+            if (epoch % setup_period == 0)
+            {
+                std::size_t begin = bytes.size();
+                appendBlock(bytes, setup_, 5902, tow, wnc);
+                corrupt(bytes, begin, evReceiverSetup);
+            }
+            for (const Block& block : blocks_)
+            {
+                std::size_t begin = bytes.size();
+                appendBlock(bytes, block.bytes, block.number, tow, wnc);
+                corrupt(bytes, begin, block.key);
+            }
+            if (settings_.nmea)
+            {
+                static const std::pair<RxID_Enum, const char*> SENTENCES[] = {
+                    {evGPGGA,
+                     "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,"
+                     "M,,"},
+                    {evGPRMC,
+                     "GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,"
+                     "003.1,W"},
+                    {evGPGSA, "GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1"},
+                    {evGPGSV,
+                     "GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,"
+                     "228,45"},
+                    {evGLGSV,
+                     "GLGSV,1,1,04,65,40,083,46,66,17,308,41,72,07,344,39,81,22,"
+                     "228,45"}};
+                for (const std::pair<RxID_Enum, const char*>& sentence : SENTENCES)
+                {
+                    std::size_t begin = bytes.size();
+                    appendSentence(bytes, sentence.second);
+                    corrupt(bytes, begin, sentence.first);
+                }
+            }
+            if (settings_.reply_period > 0 && epoch % settings_.reply_period == 0)
+            {
+                std::size_t begin = bytes.size();
+                bytes.insert(bytes.end(), COMMAND_REPLY,
+                             COMMAND_REPLY + sizeof(COMMAND_REPLY) - 1);
+                corrupt(bytes, begin, evUnknownMessage);
+            }
+        }
+
+        //! Number of messages generated so far
+        uint64_t messages() const { return messages_; }
+        //! Number of messages that had a byte flipped
+        uint64_t corrupted() const { return corrupted_; }
+        //! Number of SBF blocks or NMEA sentences of "key" generated so far, 0 for
+        //! the keys of messages the driver composes itself
+        uint64_t sent(RxID_Enum key) const { return sent_[key]; }
+
+    private:
+        //! An SBF block of every epoch
+        struct Block
+        {
+            uint16_t number;
+            RxID_Enum key;
+            std::vector<uint8_t> bytes;
+        };
+
+        template <typename T>
+        void addBlock(const T& block, uint16_t number, RxID_Enum key)
+        {
+            std::vector<uint8_t> bytes;
+            appendBytes(bytes, block);
+            blocks_.push_back(Block{number, key, bytes});
+        }
+
+        //! Counts the message of "key" from "begin" to the end of "bytes" and
+        //! flips one of its bytes with a probability of settings_.corruption
+        void corrupt(std::vector<uint8_t>& bytes, std::size_t begin, RxID_Enum key)
+        {
+            ++messages_;
+            ++sent_[key];
+            if (!corruption_(random_))
+                return;
+            std::uniform_int_distribution<std::size_t> position(begin,
+                                                                bytes.size() - 1);
+            std::uniform_int_distribution<int> flip(1, 255);
+            bytes[position(random_)] ^= static_cast<uint8_t>(flip(random_));
+            ++corrupted_;
+        }
+
+        const Settings settings_;
+        const uint32_t period_ms_;
+        //! The blocks of every epoch, header and time stamp being filled in by
+        //! appendBlock()
+        std::vector<Block> blocks_;
+        std::vector<uint8_t> setup_;
+        std::mt19937 random_;
+        std::bernoulli_distribution corruption_;
+        uint64_t messages_;
+        uint64_t corrupted_;
+        uint64_t sent_[evRxIDCount];
+    };
+
+    /**
+     * @class LatencySink
+     * @brief Takes the messages the driver publishes, counting them per key and
+     * recording the latency of those time stamped by the Rx
+     *
+     * Called on the decode workers, possibly concurrently.
+     */
+    class LatencySink : public MessageSink
+    {
+    public:
+        LatencySink(const std::atomic<int64_t>* send_times, uint32_t period_ms) :
+            send_times_(send_times), period_ms_(period_ms),
+            first_ms_(toMilliseconds(parsing_utilities::convertGPSWeekTOWToUnix(
+                FIRST_WNC, FIRST_TOW, g_leap_seconds))),
+            histograms_(new LatencyHistogram[evRxIDCount]), unmatched_(0)
+        {
+            for (std::atomic<uint64_t>& received : received_)
+                received.store(0);
+        }
+
+        void write(RxID_Enum message_key, const ros::Time& stamp,
+                   const MessageType& /* type */, const uint8_t* /* data */,
+                   std::size_t /* size */)
+        {
+            const int64_t now = Clock::now().time_since_epoch().count();
+            received_[message_key].fetch_add(1, std::memory_order_relaxed);
+            if (!timed(message_key))
+                return;
+            // The time stamp tells the epoch, hence when it was due to be sent
+            const int64_t epoch = (toMilliseconds(stamp) - first_ms_) / period_ms_;
+            if (epoch < 0)
+            {
+                unmatched_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            const int64_t sent =
+                send_times_[epoch % SEND_TIME_SLOTS].load(std::memory_order_acquire);
+            if (sent == 0 || now < sent)
+            {
+                unmatched_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            histograms_[message_key].record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::duration(now - sent))
+                    .count()));
+        }
+
+        //! Number of messages of "key" published
+        uint64_t received(RxID_Enum key) const { return received_[key].load(); }
+        //! Latencies of the messages of "key"
+        LatencyHistogram& histogram(RxID_Enum key) { return histograms_[key]; }
+        //! Number of time stamped messages whose epoch was not sent
+        uint64_t unmatched() const { return unmatched_.load(); }
+
+    private:
+        static int64_t toMilliseconds(const ros::Time& time)
+        {
+            return static_cast<int64_t>(time.sec) * 1000 + time.nsec / 1000000;
+        }
+
+        //! Clock::time_point ticks at which each epoch was due, 0 if not yet sent
+        const std::atomic<int64_t>* send_times_;
+        const int64_t period_ms_;
+        //! Unix time in ms of the first epoch
+        const int64_t first_ms_;
+        std::atomic<uint64_t> received_[evRxIDCount];
+        std::unique_ptr<LatencyHistogram[]> histograms_;
+        std::atomic<uint64_t> unmatched_;
+    };
+
+    //! Writes all "size" bytes at "data" to "fd", blocking while the driver does
+    //! not keep up
+    bool writeAll(int fd, const uint8_t* data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t written = ::write(fd, data, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    //! Waits until "io" is connected, at most CONNECT_TIMEOUT
+    bool waitForConnection(const Comm_IO& io)
+    {
+        const Clock::time_point deadline = Clock::now() + CONNECT_TIMEOUT;
+        while (!io.connectionStatistics().connected)
+        {
+            if (Clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    //! Prints the count and latency quantiles of the messages of "key", and the
+    //! share of the "sent" ones lost unless "key" is composed by the driver, such
+    //! that it is not known how many to expect
+    void reportKey(LatencySink& sink, RxID_Enum key, uint64_t sent)
+    {
+        const uint64_t received = sink.received(key);
+        if (received == 0 && !timed(key))
+            return;
+        printf("%-28s %10lu", PipelineStatistics::keyName(key),
+               static_cast<unsigned long>(received));
+        if (sent > 0)
+            printf(" %9.2f", 100.0 * (1.0 - static_cast<double>(received) / sent));
+        else
+            printf(" %9s", "");
+        if (timed(key))
+        {
+            LatencyHistogram::Snapshot snapshot;
+            sink.histogram(key).drain(snapshot);
+            printf(" %10.3f %10.3f %10.3f %10.3f", snapshot.quantile(0.5) / 1e6,
+                   snapshot.quantile(0.99) / 1e6, snapshot.quantile(0.999) / 1e6,
+                   snapshot.max_ns / 1e6);
+        }
+        printf("\n");
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Settings settings;
+    int option;
+    while ((option = getopt(argc, argv, "r:s:g:b:x:nR:d:pt:")) != -1)
+    {
+        switch (option)
+        {
+        case 'r':
+            settings.rate_hz = strtod(optarg, NULL);
+            break;
+        case 's':
+            settings.satellites = static_cast<uint32_t>(strtoul(optarg, NULL, 10));
+            break;
+        case 'g':
+            settings.signals = static_cast<uint32_t>(strtoul(optarg, NULL, 10));
+            break;
+        case 'b':
+            settings.burst = static_cast<uint32_t>(strtoul(optarg, NULL, 10));
+            break;
+        case 'x':
+            settings.corruption = strtod(optarg, NULL);
+            break;
+        case 'n':
+            settings.nmea = true;
+            break;
+        case 'R':
+            settings.reply_period = static_cast<uint32_t>(strtoul(optarg, NULL, 10));
+            break;
+        case 'd':
+            settings.duration_s = strtod(optarg, NULL);
+            break;
+        case 'p':
+            settings.pty = true;
+            break;
+        case 't':
+            g_decode_threads = static_cast<uint32_t>(strtoul(optarg, NULL, 10));
+            break;
+        default:
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    // The TOW resolution of 1 ms bounds the rate, the struct layouts the number of
+    // satellites and signals
+    if (settings.rate_hz <= 0.0 || settings.rate_hz > 1000.0 ||
+        settings.satellites == 0 ||
+        settings.satellites * CONSTELLATIONS > MAXSB_CHANNELSATINFO ||
+        settings.signals == 0 ||
+        settings.signals > MAX_NR_OF_SIGNALS_PER_SATELLITE || settings.burst == 0 ||
+        settings.corruption < 0.0 || settings.corruption > 1.0 ||
+        settings.duration_s <= 0.0)
+    {
+        printUsage(argv[0]);
+        fprintf(stderr, "Rate in (0, 1000], 1 to %lu satellites per constellation, "
+                        "1 to %d signals, corruption in [0, 1]\n",
+                static_cast<unsigned long>(MAXSB_CHANNELSATINFO / CONSTELLATIONS),
+                MAX_NR_OF_SIGNALS_PER_SATELLITE);
+        return 1;
+    }
+    const uint32_t period_ms =
+        std::max(static_cast<uint32_t>(1000.0 / settings.rate_hz + 0.5),
+                 static_cast<uint32_t>(1));
+    const uint64_t epochs = static_cast<uint64_t>(
+        settings.duration_s * 1000.0 / period_ms + 0.5);
+    // Epochs are stamped and due in whole ms
+    if (1000.0 / period_ms != settings.rate_hz)
+    {
+        printf("Running at %.2f Hz, the rate of the nearest period of %u ms\n",
+               1000.0 / period_ms, period_ms);
+    }
+    // No node is started, ros::Time::now() runs on the wall clock; messages are
+    // time stamped by the Rx
+    ros::Time::init();
+    g_use_gnss_time = true;
+    g_leap_seconds = 18;
+    g_read_from_sbf_log = false;
+    g_read_from_pcap = false;
+
+    std::unique_ptr<std::atomic<int64_t>[]> send_times(
+        new std::atomic<int64_t>[SEND_TIME_SLOTS]);
+    for (std::size_t i = 0; i < SEND_TIME_SLOTS; ++i)
+        send_times[i].store(0);
+    // Declared ahead of io, which publishes into it until destroyed
+    LatencySink sink(send_times.get(), period_ms);
+    Synthesizer synthesizer(settings, period_ms);
+
+    // The Rx side of the connection
+    boost::asio::io_service service;
+    boost::asio::ip::tcp::socket socket(service);
+    int fd = -1;
+    int pty_slave = -1;
+    Comm_IO io;
+    // The message type only sizes the handler's unused placeholder
+    for (int key = 0; key < evUnknownMessage; ++key)
+        io.handlers_.insert<int32_t>(static_cast<RxID_Enum>(key));
+    io.handlers_.publishers_.setSink(&sink);
+    io.handlers_.statistics().setTiming(true);
+    if (settings.pty)
+    {
+        char name[256];
+        if (openpty(&fd, &pty_slave, name, NULL, NULL) != 0)
+        {
+            fprintf(stderr, "Could not open a pseudo terminal: %s\n",
+                    strerror(errno));
+            return 1;
+        }
+        // The slave is kept open, lest writes fail before the driver opens it
+        struct termios raw;
+        tcgetattr(pty_slave, &raw);
+        cfmakeraw(&raw);
+        tcsetattr(pty_slave, TCSANOW, &raw);
+        printf("Serving %s\n", name);
+        io.initializeSerial(name);
+    } else
+    {
+        boost::asio::ip::tcp::acceptor acceptor(
+            service, boost::asio::ip::tcp::endpoint(
+                         boost::asio::ip::address_v4::loopback(), 0));
+        const uint16_t port = acceptor.local_endpoint().port();
+        printf("Serving tcp://127.0.0.1:%u\n", port);
+        io.initializeTCP("127.0.0.1", std::to_string(port));
+        boost::system::error_code error;
+        acceptor.accept(socket, error);
+        if (error)
+        {
+            fprintf(stderr, "Could not accept the driver's connection: %s\n",
+                    error.message().c_str());
+            return 1;
+        }
+        socket.set_option(boost::asio::ip::tcp::no_delay(true));
+        fd = socket.native_handle();
+    }
+    if (!waitForConnection(io))
+    {
+        fprintf(stderr, "The driver did not connect within %li s\n",
+                static_cast<long>(CONNECT_TIMEOUT.count()));
+        return 1;
+    }
+
+    // Epochs are due every period_ms, "burst" of them being written at once when
+    // the last of them is due
+    std::vector<uint8_t> bytes;
+    uint64_t sent_bytes = 0;
+    uint64_t late_writes = 0;
+    uint64_t epoch = 0;
+    const Clock::time_point start = Clock::now();
+    const Clock::duration period = std::chrono::milliseconds(period_ms);
+    while (epoch < epochs)
+    {
+        const uint64_t count = std::min<uint64_t>(settings.burst, epochs - epoch);
+        const Clock::time_point due =
+            start + period * static_cast<Clock::rep>(epoch + count - 1);
+        std::this_thread::sleep_until(due);
+        bytes.clear();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            synthesizer.appendEpoch(bytes, epoch + i);
+            send_times[(epoch + i) % SEND_TIME_SLOTS].store(
+                (start + period * static_cast<Clock::rep>(epoch + i))
+                    .time_since_epoch()
+                    .count(),
+                std::memory_order_release);
+        }
+        if (!writeAll(fd, bytes.data(), bytes.size()))
+        {
+            fprintf(stderr, "Writing to the driver failed: %s\n", strerror(errno));
+            break;
+        }
+        if (Clock::now() - due > period)
+            ++late_writes;
+        sent_bytes += bytes.size();
+        epoch += count;
+    }
+    const double seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    std::this_thread::sleep_for(DRAIN_TIME);
+
+    printf("\nSent %lu epochs in %.2f s (%.1f Hz), %lu messages, %.2f MB/s, "
+           "%lu corrupted, %lu writes late by more than a period\n",
+           static_cast<unsigned long>(epoch), seconds, epoch / seconds,
+           static_cast<unsigned long>(synthesizer.messages()),
+           sent_bytes / seconds / 1e6,
+           static_cast<unsigned long>(synthesizer.corrupted()),
+           static_cast<unsigned long>(late_writes));
+    printf("\n%-28s %10s %9s %10s %10s %10s %10s\n", "message", "published",
+           "loss [%]", "p50 [ms]", "p99 [ms]", "p99.9 [ms]", "max [ms]");
+    for (int key = 0; key < evUnknownMessage; ++key)
+    {
+        reportKey(sink, static_cast<RxID_Enum>(key),
+                  synthesizer.sent(static_cast<RxID_Enum>(key)));
+    }
+    if (sink.unmatched() > 0)
+        printf("%lu time stamped messages did not match a sent epoch\n",
+               static_cast<unsigned long>(sink.unmatched()));
+
+    diagnostic_msgs::DiagnosticStatus status;
+    io.handlers_.statistics().report(status);
+    printf("\nPipeline: %s\n", status.message.c_str());
+    for (const diagnostic_msgs::KeyValue& value : status.values)
+        printf("  %s: %s\n", value.key.c_str(), value.value.c_str());
+    const ConnectionStatistics connection = io.connectionStatistics();
+    printf("Connection: %u reconnects, %u watchdog timeouts\n",
+           connection.reconnects, connection.watchdog_timeouts);
+
+    if (pty_slave >= 0)
+    {
+        close(pty_slave);
+        close(fd);
+    }
+    return 0;
+}
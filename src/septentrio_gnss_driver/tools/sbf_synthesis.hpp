@@ -0,0 +1,113 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+// ROSaic includes
+#include <septentrio_gnss_driver/crc/crc.h>
+#include <septentrio_gnss_driver/packed_structs/sbf_structs.hpp>
+
+#ifndef SBF_SYNTHESIS_HPP
+#define SBF_SYNTHESIS_HPP
+
+/**
+ * @file sbf_synthesis.hpp
+ * @date 15/10/26
+ * @brief Helpers of the tools that synthesize SBF blocks and NMEA sentences
+ */
+
+namespace io_comm_rx {
+
+    //! Appends the raw bytes of "value" to "block"
+    template <typename T>
+    void appendBytes(std::vector<uint8_t>& block, const T& value)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        block.insert(block.end(), bytes, bytes + sizeof(T));
+    }
+
+    //! Returns a zero-initialized SBF block struct
+    template <typename T>
+    T emptyBlock()
+    {
+        T block;
+        memset(&block, 0, sizeof(block));
+        return block;
+    }
+
+    /**
+     * @brief Completes the header and time stamp of "block", padding it to a
+     * multiple of 4 bytes as every SBF block, and appends it to "corpus"
+     */
+    inline void appendBlock(std::vector<uint8_t>& corpus, std::vector<uint8_t> block,
+                            uint16_t number, uint32_t tow, uint16_t wnc)
+    {
+        block.resize((block.size() + 3) & ~static_cast<size_t>(3), 0);
+        BlockHeader_t header;
+        header.sync_1 = '$';
+        header.sync_2 = '@';
+        header.crc = 0;
+        header.id = number;
+        header.length = static_cast<uint16_t>(block.size());
+        memcpy(block.data(), &header, sizeof(header));
+        memcpy(block.data() + 8, &tow, sizeof(tow));
+        memcpy(block.data() + 12, &wnc, sizeof(wnc));
+        header.crc = compute16CCITT(block.data() + 4, block.size() - 4);
+        memcpy(block.data(), &header, sizeof(header));
+        corpus.insert(corpus.end(), block.begin(), block.end());
+    }
+
+    //! Appends the SBF block struct "block", all of its bytes
+    template <typename T>
+    void appendBlock(std::vector<uint8_t>& corpus, const T& block, uint16_t number,
+                     uint32_t tow, uint16_t wnc)
+    {
+        std::vector<uint8_t> bytes;
+        appendBytes(bytes, block);
+        appendBlock(corpus, bytes, number, tow, wnc);
+    }
+
+    //! Appends the NMEA sentence "$<body>*<checksum>" followed by CR/LF
+    inline void appendSentence(std::vector<uint8_t>& corpus, const std::string& body)
+    {
+        uint8_t checksum = 0;
+        for (char c : body)
+            checksum ^= static_cast<uint8_t>(c);
+        char trailer[8];
+        snprintf(trailer, sizeof(trailer), "*%02X\r\n", checksum);
+        const std::string sentence = "$" + body + trailer;
+        corpus.insert(corpus.end(), sentence.begin(), sentence.end());
+    }
+} // namespace io_comm_rx
+
+#endif // SBF_SYNTHESIS_HPP
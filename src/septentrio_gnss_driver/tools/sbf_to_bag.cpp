@@ -0,0 +1,554 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE. 
+//
+// *****************************************************************************
+
+// C++ library includes
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h> // for getopt()
+// Boost includes
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+// ROS includes
+#include <rosbag/bag.h>
+#include <topic_tools/shape_shifter.h>
+// ROSaic includes
+#include <septentrio_gnss_driver/communication/communication_core.hpp>
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+
+/**
+ * @file sbf_to_bag.cpp
+ * @date 15/10/26
+ * @brief Converts SBF files to bag files on all cores, without a ROS master
+ *
+ * Usage: septentrio_gnss_driver_sbf_to_bag [-j threads] [-c chunk_mib]
+ * [-f frame_id] [-l leap_seconds] [-z] input.sbf output.bag
+ *
+ * The mapped file is split into chunks of about "chunk_mib" MiB, each starting at
+ * the first block of an epoch, such that no epoch is split. The chunks are framed
+ * and decoded in parallel with the driver's own Framer, EpochAssembler and
+ * RxMessage, and the messages of each batch of chunks are written in time stamp
+ * order while the next batch is decoded. Every message the driver can publish is
+ * written, on the topic it is published on, time stamped by the Rx.
+ */
+
+using namespace io_comm_rx;
+
+namespace {
+    //! Chunks are extended to the next epoch within that many bytes at most,
+    //! e.g. for files holding NMEA sentences only
+    const std::size_t BOUNDARY_SCAN_LIMIT = 1 << 20;
+
+    void printUsage(const char* program)
+    {
+        fprintf(stderr,
+                "Usage: %s [-j threads] [-c chunk_mib] [-f frame_id] "
+                "[-l leap_seconds] [-z] input.sbf output.bag\n",
+                program);
+    }
+
+    //! The driver's topic of every key it publishes under, nullptr for the others
+    const char* topicName(RxID_Enum key)
+    {
+        switch (key)
+        {
+        case evGPGGA:
+            return "/gpgga";
+        case evGPRMC:
+            return "/gprmc";
+        case evGPGSA:
+            return "/gpgsa";
+        case evGPGSV:
+            return "/gpgsv";
+        case evPVTCartesian:
+            return "/pvtcartesian";
+        case evPVTGeodetic:
+            return "/pvtgeodetic";
+        case evPosCovCartesian:
+            return "/poscovcartesian";
+        case evPosCovGeodetic:
+            return "/poscovgeodetic";
+        case evAttEuler:
+            return "/atteuler";
+        case evAttCovEuler:
+            return "/attcoveuler";
+        case evGPST:
+            return "/gpst";
+        case evNavSatFix:
+            return "/navsatfix";
+        case evGPSFix:
+            return "/gpsfix";
+        case evPoseWithCovarianceStamped:
+            return "/pose";
+        case evDiagnosticArray:
+            return "/diagnostics";
+        default:
+            return nullptr;
+        }
+    }
+
+    /**
+     * @struct Record
+     * @brief A serialized message, located in the byte store of its chunk
+     */
+    struct Record
+    {
+        ros::Time stamp;
+        RxID_Enum key;
+        const MessageType* type;
+        std::size_t offset;
+        std::size_t size;
+        //! Chunk the message was decoded from, keeps equal time stamps in file
+        //! order
+        std::size_t chunk;
+    };
+
+    /**
+     * @struct Deferred
+     * @brief A message whose decoding depends on state left by earlier chunks,
+     * e.g. DiagnosticArray on the latest ReceiverSetup, with copies of its blocks
+     */
+    struct Deferred
+    {
+        RxID_Enum key;
+        std::vector<uint8_t> primary;
+        BlockArena epoch;
+    };
+
+    /**
+     * @class Chunk
+     * @brief Byte range of the file with the messages decoded from it
+     */
+    class Chunk : public MessageSink
+    {
+    public:
+        Chunk() : begin(0), end(0), index(0), pvt_time(0) {}
+
+        void write(RxID_Enum message_key, const ros::Time& stamp,
+                   const MessageType& type, const uint8_t* data,
+                   std::size_t size) override
+        {
+            Record record = {stamp, message_key, &type, bytes.size(), size, index};
+            bytes.insert(bytes.end(), data, data + size);
+            records.push_back(record);
+        }
+
+        //! Drops the decoded messages, keeping the capacity
+        void clear()
+        {
+            bytes.clear();
+            records.clear();
+            deferred.clear();
+            receiver_setup.clear();
+            pvt_time = 0;
+        }
+
+        std::size_t begin;
+        std::size_t end;
+        std::size_t index;
+        std::vector<uint8_t> bytes;
+        std::vector<Record> records;
+        //! Messages left for the merging thread, in file order
+        std::vector<Deferred> deferred;
+        //! Latest ReceiverSetup of the chunk, empty if there is none
+        std::vector<uint8_t> receiver_setup;
+        //! Latest PVTGeodetic time of the chunk as in ReceiverContext, 0 if none
+        uint64_t pvt_time;
+    };
+
+    //! Start of the first block at or after "from" whose TOW differs from that of
+    //! the block before it, i.e. of the next epoch, "size" if there is none
+    std::size_t findBoundary(const uint8_t* data, std::size_t size, std::size_t from)
+    {
+        Framer framer;
+        Frame frame;
+        std::size_t pos = from;
+        bool have_tow = false;
+        uint32_t epoch_tow = 0;
+        while (pos < size)
+        {
+            const FramerResult_Enum result =
+                framer.next(data + pos, size - pos, frame);
+            if (result == evFrameNeedMore)
+                return size;
+            if (result == evFrameResync)
+            {
+                pos += frame.offset + 1;
+                continue;
+            }
+            const std::size_t start = pos + frame.offset;
+            if (start - from > BOUNDARY_SCAN_LIMIT)
+                return start;
+            if (frame.type == evSBFFrame)
+            {
+                uint32_t tow;
+                memcpy(&tow, data + start + 8, sizeof(tow));
+                if (have_tow && tow != epoch_tow)
+                    return start;
+                have_tow = true;
+                epoch_tow = tow;
+            }
+            pos = start + frame.size;
+        }
+        return size;
+    }
+
+    /**
+     * @class Converter
+     * @brief Decodes the chunks of one file and writes their messages to a bag
+     */
+    class Converter
+    {
+    public:
+        Converter(MappedFile& file, const std::string& frame_id,
+                  std::size_t threads) :
+            file_(file), frame_id_(frame_id), threads_(threads), written_(0),
+            failures_(0)
+        {
+            // All composites are written
+            enabled_ = EpochAssembler::compositeBit(evNavSatFix) |
+                       EpochAssembler::compositeBit(evGPSFix) |
+                       EpochAssembler::compositeBit(evPoseWithCovarianceStamped) |
+                       EpochAssembler::compositeBit(evDiagnosticArray);
+        }
+
+        /**
+         * @brief Converts the whole file, "threads" chunks of about "chunk_size"
+         * bytes at a time
+         * @return False if the bag could not be written
+         */
+        bool run(rosbag::Bag& bag, std::size_t chunk_size)
+        {
+            std::vector<Chunk> decoding(threads_);
+            std::vector<Chunk> writing;
+            std::size_t pos = 0;
+            std::size_t index = 0;
+            while (true)
+            {
+                std::size_t count = 0;
+                for (; count < threads_ && pos < file_.size(); ++count)
+                {
+                    Chunk& chunk = decoding[count];
+                    chunk.clear();
+                    chunk.index = index++;
+                    chunk.begin = pos;
+                    chunk.end = pos + chunk_size < file_.size()
+                                    ? findBoundary(file_.data(), file_.size(),
+                                                   pos + chunk_size)
+                                    : file_.size();
+                    pos = chunk.end;
+                }
+                decoding.resize(count);
+                boost::thread_group workers;
+                for (Chunk& chunk : decoding)
+                    workers.create_thread(
+                        boost::bind(&Converter::decode, this, boost::ref(chunk)));
+                // The previous batch is written while this one is decoded
+                const bool written = writing.empty() || writeBatch(bag, writing);
+                workers.join_all();
+                if (!written)
+                    return false;
+                if (decoding.empty())
+                    return true;
+                writing.swap(decoding);
+                decoding.resize(threads_);
+            }
+        }
+
+        //! Number of messages written
+        std::size_t written() const { return written_; }
+
+        //! Number of frames that could not be decoded
+        std::size_t failures() const { return failures_.load(); }
+
+    private:
+        //! Decodes "key" from "data", handing the message over to the sink of
+        //! "publishers"
+        void read(RxID_Enum key, const uint8_t* data, std::size_t size,
+                  const PublisherRegistry& publishers, ReceiverContext& context,
+                  const BlockArena* epoch = nullptr)
+        {
+            RxMessage rx_message(data, size, publishers, context, epoch);
+            try
+            {
+                if (!rx_message.read(key))
+                    ++failures_;
+            } catch (std::runtime_error& e)
+            {
+                ++failures_;
+            }
+        }
+
+        //! Leaves "key" to the merging thread
+        void defer(Chunk& chunk, RxID_Enum key, const uint8_t* data,
+                   std::size_t size, const BlockArena* epoch = nullptr)
+        {
+            chunk.deferred.push_back(Deferred());
+            Deferred& deferred = chunk.deferred.back();
+            deferred.key = key;
+            deferred.primary.assign(data, data + size);
+            if (epoch)
+                deferred.epoch = *epoch;
+        }
+
+        //! Frames and decodes "chunk" on a worker thread
+        void decode(Chunk& chunk)
+        {
+            PublisherRegistry publishers;
+            publishers.setSink(&chunk);
+            ReceiverContext context;
+            context.frame_id = frame_id_;
+            EpochAssembler assembler;
+            Framer framer;
+            Frame frame;
+            bool have_pvt = false;
+            const uint8_t* data = file_.data() + chunk.begin;
+            const std::size_t size = chunk.end - chunk.begin;
+
+            auto emit = [&]() {
+                EpochAssembler::Due due;
+                while (assembler.next(enabled_, due))
+                {
+                    // DiagnosticArray needs the latest ReceiverSetup, which may
+                    // be in an earlier chunk
+                    if (due.composite == evDiagnosticArray &&
+                        context.last_receiversetup.empty())
+                        defer(chunk, due.composite, due.primary, due.primary_size,
+                              &due.slot->blocks);
+                    else
+                        read(due.composite, due.primary, due.primary_size,
+                             publishers, context, &due.slot->blocks);
+                }
+            };
+
+            std::size_t pos = 0;
+            while (pos < size)
+            {
+                const FramerResult_Enum result =
+                    framer.next(data + pos, size - pos, frame);
+                if (result == evFrameNeedMore)
+                    break;
+                if (result == evFrameResync)
+                {
+                    pos += frame.offset + 1;
+                    continue;
+                }
+                pos += frame.offset;
+                const uint8_t* frame_data = data + pos;
+                pos += frame.size;
+                std::size_t frame_size = frame.size;
+                const RxID_Enum id =
+                    RxMessage(frame_data, frame_size, publishers, context).rxID();
+                if (frame.type == evSBFFrame)
+                {
+                    if (id == evPVTGeodetic)
+                    {
+                        uint32_t tow;
+                        uint16_t wnc;
+                        memcpy(&tow, frame_data + 8, sizeof(tow));
+                        memcpy(&wnc, frame_data + 12, sizeof(wnc));
+                        context.last_pvt_time =
+                            (static_cast<uint64_t>(wnc) << 32) | tow;
+                        have_pvt = true;
+                        read(evGPST, frame_data, frame.size, publishers, context);
+                    }
+                    if (topicName(id) || id == evReceiverSetup)
+                        read(id, frame_data, frame.size, publishers, context);
+                    while (!assembler.add(frame_data, frame.size, id, enabled_))
+                        emit();
+                    emit();
+                } else if (frame.type == evNMEAFrame && id != evUnknownMessage)
+                {
+                    // GSA and GSV are time stamped by the latest PVTGeodetic
+                    const bool stamped_by_pvt = id == evGPGSA || id == evGPGSV ||
+                                                id == evGLGSV || id == evGAGSV ||
+                                                id == evGBGSV;
+                    if (stamped_by_pvt && !have_pvt)
+                        defer(chunk, id, frame_data, frame.size);
+                    else
+                        read(id, frame_data, frame.size, publishers, context);
+                }
+            }
+            assembler.expireAll();
+            emit();
+            chunk.receiver_setup = context.last_receiversetup;
+            if (have_pvt)
+                chunk.pvt_time = context.last_pvt_time;
+        }
+
+        /**
+         * @brief Decodes the deferred messages of the batch with the state carried
+         * over from the chunks before, then writes all its messages in time stamp
+         * order
+         */
+        bool writeBatch(rosbag::Bag& bag, std::vector<Chunk>& batch)
+        {
+            std::vector<const Record*> order;
+            for (Chunk& chunk : batch)
+            {
+                PublisherRegistry publishers;
+                publishers.setSink(&chunk);
+                context_.frame_id = frame_id_;
+                for (const Deferred& deferred : chunk.deferred)
+                {
+                    read(deferred.key, deferred.primary.data(),
+                         deferred.primary.size(), publishers, context_,
+                         &deferred.epoch);
+                }
+                // The DiagnosticArray takes the setup over only when told so
+                if (!chunk.receiver_setup.empty() &&
+                    chunk.receiver_setup != context_.last_receiversetup)
+                {
+                    context_.last_receiversetup = chunk.receiver_setup;
+                    context_.diagnostics.setup_changed = true;
+                }
+                if (chunk.pvt_time)
+                    context_.last_pvt_time = chunk.pvt_time;
+            }
+            for (const Chunk& chunk : batch)
+            {
+                for (const Record& record : chunk.records)
+                    order.push_back(&record);
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [](const Record* a, const Record* b) {
+                                 return a->stamp < b->stamp;
+                             });
+            try
+            {
+                topic_tools::ShapeShifter message;
+                for (const Record* record : order)
+                {
+                    const Chunk& chunk = batch[record->chunk - batch.front().index];
+                    message.morph(record->type->md5sum, record->type->datatype,
+                                  record->type->definition, "");
+                    ros::serialization::IStream stream(
+                        const_cast<uint8_t*>(chunk.bytes.data()) + record->offset,
+                        static_cast<uint32_t>(record->size));
+                    message.read(stream);
+                    // Bags refuse time 0, e.g. before the Rx knows the GPS week
+                    bag.write(topicName(record->key),
+                              std::max(record->stamp, ros::TIME_MIN), message);
+                }
+            } catch (rosbag::BagException& e)
+            {
+                fprintf(stderr, "Could not write the bag: %s\n", e.what());
+                return false;
+            }
+            written_ += order.size();
+            // The batch is done with, its pages can go
+            file_.release(batch.back().end);
+            return true;
+        }
+
+        MappedFile& file_;
+        const std::string frame_id_;
+        const std::size_t threads_;
+        uint32_t enabled_;
+        //! State carried over from chunk to chunk by the merging thread
+        ReceiverContext context_;
+        std::size_t written_;
+        std::atomic<std::size_t> failures_;
+    };
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::size_t threads = boost::thread::hardware_concurrency();
+    std::size_t chunk_mib = 64;
+    std::string frame_id = "gnss";
+    bool compress = false;
+    g_leap_seconds = 18;
+    int option;
+    while ((option = getopt(argc, argv, "j:c:f:l:z")) != -1)
+    {
+        switch (option)
+        {
+        case 'j':
+            threads = strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            chunk_mib = strtoul(optarg, NULL, 10);
+            break;
+        case 'f':
+            frame_id = optarg;
+            break;
+        case 'l':
+            g_leap_seconds = static_cast<uint32_t>(strtoul(optarg, NULL, 10));
+            break;
+        case 'z':
+            compress = true;
+            break;
+        default:
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - optind != 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    // No node is started, ros::Time::now() runs on the wall clock; messages are
+    // time stamped by the Rx
+    ros::Time::init();
+    g_use_gnss_time = true;
+    g_read_from_sbf_log = true;
+
+    MappedFile file;
+    if (!file.open(argv[optind]))
+    {
+        fprintf(stderr, "Could not map %s\n", argv[optind]);
+        return 1;
+    }
+    rosbag::Bag bag;
+    try
+    {
+        bag.open(argv[optind + 1], rosbag::bagmode::Write);
+        if (compress)
+            bag.setCompression(rosbag::compression::LZ4);
+    } catch (rosbag::BagException& e)
+    {
+        fprintf(stderr, "Could not open %s: %s\n", argv[optind + 1], e.what());
+        return 1;
+    }
+    Converter converter(file, frame_id, std::max<std::size_t>(threads, 1));
+    const bool converted =
+        converter.run(bag, std::max<std::size_t>(chunk_mib, 1) << 20);
+    bag.close();
+    printf("%zu messages written, %zu frames could not be decoded\n",
+           converter.written(), converter.failures());
+    return converted ? 0 : 1;
+}